@@ -961,7 +961,7 @@ public:
 	}
 
 private:
-	enum { NUM_TXNIDS = 256, };
+	enum { NUM_TXNIDS = 1 << T::ReqFlit_t::TxnID_Width, };
 
 	typedef typename T::ReqFlit_t ReqFlit_t;
 	typedef typename T::RspFlit_t RspFlit_t;
@@ -995,8 +995,8 @@ private:
 
 		uint16_t GetTxnID() { return m_req->GetTxnID(); }
 
-		void SetDBID(uint8_t DBID) { m_DBID = DBID; }
-		uint8_t GetDBID() { return m_DBID; }
+		void SetDBID(uint16_t DBID) { m_DBID = DBID; }
+		uint16_t GetDBID() { return m_DBID; }
 
 		void SetHomeNID(uint16_t HomeNID) { m_HomeNID = HomeNID; }
 		uint16_t GetHomeNID() { return m_HomeNID; }
@@ -1012,7 +1012,7 @@ private:
 	private:
 		ReqFlit_t *m_req;
 
-		uint8_t m_DBID;
+		uint16_t m_DBID;
 		uint16_t m_HomeNID;
 		bool  m_HomeNIDValid;
 	};
@@ -1465,10 +1465,10 @@ private:
 			return m_gotCompData && m_snpDone;
 		}
 
-		uint8_t GetTxnID() { return m_snp->GetTxnID(); }
+		uint16_t GetTxnID() { return m_snp->GetTxnID(); }
 
 		uint16_t GetFwdNID() { return m_snp->GetFwdNID(); }
-		uint8_t GetFwdTxnID() { return m_snp->GetFwdTxnID(); }
+		uint16_t GetFwdTxnID() { return m_snp->GetFwdTxnID(); }
 		uint8_t GetSnpRespDone() { return m_snpDone; }
 
 	private:
@@ -1571,10 +1571,10 @@ private:
 			return m_sentSnpResp && m_gotCompData && m_sentCompAck;
 		}
 
-		uint8_t GetTxnID() { return m_snp->GetTxnID(); }
+		uint16_t GetTxnID() { return m_snp->GetTxnID(); }
 
-		uint8_t GetDBIDForCompData() { return m_DBIDForCompData; }
-		uint8_t GetDBID() { return m_DBID; }
+		uint16_t GetDBIDForCompData() { return m_DBIDForCompData; }
+		uint16_t GetDBID() { return m_DBID; }
 		uint16_t GetHomeNID() { return m_HomeNID; }
 		bool GetHomeNIDValid() { return m_HomeNIDValid; }
 		bool GetExpCompData() { return m_expCompData; }
@@ -1588,8 +1588,8 @@ private:
 
 		uint16_t m_HomeNID;
 		bool m_HomeNIDValid;
-		uint8_t m_DBID;
-		uint8_t m_DBIDForCompData;
+		uint16_t m_DBID;
+		uint16_t m_DBIDForCompData;
 	};
 
 	class SnpNonFwdNonStashTxn
@@ -1634,13 +1634,13 @@ private:
 			return m_snpDone;
 		}
 
-		uint8_t GetTxnID() { return m_snp->GetTxnID(); }
+		uint16_t GetTxnID() { return m_snp->GetTxnID(); }
 	private:
 		SnpFlit_t *m_snp;
 		bool m_snpDone;
 	};
 
-	ITxn *GetTxnWithIDs(uint16_t HomeNID, uint8_t DBID)
+	ITxn *GetTxnWithIDs(uint16_t HomeNID, uint16_t DBID)
 	{
 		int i;
 
@@ -1659,7 +1659,7 @@ private:
 
 	void CheckTxnID(ReqFlit_t *req)
 	{
-		uint8_t txnID = req->GetTxnID();
+		uint16_t txnID = req->GetTxnID();
 
 		if (m_txn[txnID]) {
 			std::ostringstream msg;
@@ -1672,7 +1672,7 @@ private:
 		}
 	}
 
-	SnpFwdTxn *LookupSnpFwd(uint8_t txnID)
+	SnpFwdTxn *LookupSnpFwd(uint16_t txnID)
 	{
 		typename std::list<SnpFwdTxn*>::iterator it;
 
@@ -1686,7 +1686,7 @@ private:
 		return NULL;
 	}
 
-	SnpFwdTxn *LookupSnpFwd(uint16_t TgtID, uint8_t txnID)
+	SnpFwdTxn *LookupSnpFwd(uint16_t TgtID, uint16_t txnID)
 	{
 		typename std::list<SnpFwdTxn*>::iterator it;
 
@@ -1702,7 +1702,7 @@ private:
 		return NULL;
 	}
 
-	SnpNonFwdNonStashTxn *LookupSnp(uint8_t txnID)
+	SnpNonFwdNonStashTxn *LookupSnp(uint16_t txnID)
 	{
 		typename std::list<SnpNonFwdNonStashTxn*>::iterator it;
 
@@ -1716,7 +1716,7 @@ private:
 		return NULL;
 	}
 
-	SnpStashTxn *LookupSnpStash(uint16_t TgtID, uint8_t txnID)
+	SnpStashTxn *LookupSnpStash(uint16_t TgtID, uint16_t txnID)
 	{
 		typename std::list<SnpStashTxn*>::iterator it;
 
@@ -1747,7 +1747,7 @@ private:
 		return NULL;
 	}
 
-	SnpStashTxn *LookupSnpStash(uint8_t txnID)
+	SnpStashTxn *LookupSnpStash(uint16_t txnID)
 	{
 		typename std::list<SnpStashTxn*>::iterator it;
 
@@ -2107,7 +2107,7 @@ private:
 	{
 		sc_bv<T::TXREQ_FLIT_W> flit = txreqflit.read();
 		ReqFlit_t *req = new ReqFlit_t(flit);
-		uint8_t txnID = req->GetTxnID();
+		uint16_t txnID = req->GetTxnID();
 
 		if (!req->IsPrefetchTgt() && !req->IsPCrdReturn() &&
 			!req->IsReqLCrdReturn()) {
@@ -2234,7 +2234,7 @@ public:
 	}
 
 private:
-	enum { NUM_TXNIDS = 256, };
+	enum { NUM_TXNIDS = 1 << T::ReqFlit_t::TxnID_Width, };
 
 	typedef typename T::ReqFlit_t ReqFlit_t;
 	typedef typename T::RspFlit_t RspFlit_t;
@@ -2643,7 +2643,7 @@ private:
 	{
 		sc_bv<T::TXREQ_FLIT_W> flit = txreqflit.read();
 		ReqFlit_t *req = new ReqFlit_t(flit);
-		uint8_t txnID = req->GetTxnID();
+		uint16_t txnID = req->GetTxnID();
 
 		// Ignore L-Credit returns
 		if (req->IsReqLCrdReturn()) {
@@ -24,6 +24,8 @@
 #ifndef CHECKER_FLITS_CHI_H__
 #define CHECKER_FLITS_CHI_H__
 
+#include "tlm-bridges/private/chi/flit-layout.h"
+
 namespace AMBA {
 namespace CHI {
 namespace CHECKERS {
@@ -31,7 +33,8 @@ namespace CHECKERS {
 template<
 	int ADDR_WIDTH,
 	int NODEID_WIDTH,
-	int RSVDC_WIDTH>
+	int RSVDC_WIDTH,
+	int TXNID_WIDTH = Req::TxnID_Width>
 class ReqFlit
 {
 public:
@@ -42,11 +45,11 @@ public:
 		QoS_Width 	= Req::QoS_Width,
 		TgtID_Width 	= NODEID_WIDTH,
 		SrcID_Width 	= NODEID_WIDTH,
-		TxnID_Width 	= Req::TxnID_Width,
+		TxnID_Width 	= TXNID_WIDTH,
 
 		ReturnNID_StashNID_Width = NODEID_WIDTH,
 		StashNIDValid_Endian_Width = Req::StashNIDValid_Endian_Width,
-		ReturnTxnID_Width = Req::ReturnTxnID_Width,
+		ReturnTxnID_Width = TXNID_WIDTH,
 
 		Opcode_Width 	= Req::Opcode_Width,
 		Size_Width 	= Req::Size_Width,
@@ -68,38 +71,16 @@ public:
 		TraceTag_Width 	= Req::TraceTag_Width,
 		RSVDC_Width 	= RSVDC_WIDTH,
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			ReturnNID_StashNID_Width +
-			StashNIDValid_Endian_Width+
-			ReturnTxnID_Width +
-			Opcode_Width +
-			Size_Width +
-			Addr_Width +
-			NS_Width +
-			LikelyShared_Width +
-			AllowRetry_Width +
-			Order_Width +
-			PCrdType_Width +
-			MemAttr_Width +
-			SnpAttr_Width +
-			LPID_Width +
-			ExclSnoopMe_Width +
-			ExpCompAck_Width +
-			TraceTag_Width +
-			RSVDC_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_REQ_FLIT_LAYOUT),
 	};
 
 	ReqFlit(sc_bv<FLIT_WIDTH>& flit) :
-		m_RSVDC(0),
-		m_pos(0)
+		m_RSVDC(0)
 	{
+		FlitWords<FLIT_WIDTH> words(flit);
+
 		// Init all fields except above
-		ParseFlit(flit);
+		ParseFlit(words);
 	}
 
 	uint8_t GetQoS() { return m_QoS; }
@@ -111,7 +92,7 @@ public:
 
 	bool GetStashNIDValid() { return m_StashNIDValid_Endian; }
 
-	bool GetReturnTxnID() { return m_ReturnTxnID; }
+	uint16_t GetReturnTxnID() { return m_ReturnTxnID; }
 
 	uint8_t GetOpcode() { return m_Opcode; }
 	uint8_t GetSize() { return m_Size; }
@@ -266,50 +247,45 @@ public:
 	}
 private:
 
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		m_QoS = Extract<uint8_t>(flit, QoS_Width);
-		m_TgtID = Extract<uint16_t>(flit, TgtID_Width);
-		m_SrcID = Extract<uint16_t>(flit, SrcID_Width);
-		m_TxnID = Extract<uint16_t>(flit, TxnID_Width);
+		ReqFlitFields<ReqFlit> f;
 
-		m_ReturnNID_StashNID =
-			Extract<uint16_t>(flit, ReturnNID_StashNID_Width);
+		f.Unpack(flit);
 
-		m_StashNIDValid_Endian = ExtractBool(flit);
+		m_QoS = f.QoS;
+		m_TgtID = f.TgtID;
+		m_SrcID = f.SrcID;
+		m_TxnID = f.TxnID;
+		m_ReturnNID_StashNID = f.ReturnNID_StashNID;
+		m_StashNIDValid_Endian = f.StashNIDValid_Endian;
 
 		//
 		// For stash transactions ReturnTxnID contains
 		// { [7:6]: 0b00, StashLPIDValid[5], StashLPID[4:0] }
 		//
-		m_ReturnTxnID = Extract<uint8_t>(flit, ReturnTxnID_Width);
-
-		m_Opcode = Extract<uint8_t>(flit, Opcode_Width);
-
-		m_Size = Extract<uint8_t>(flit, Size_Width);
-
-		m_Address = Extract<uint64_t>(flit, Addr_Width);
-
-		m_NonSecure = ExtractBool(flit);
-		m_LikelyShared = ExtractBool(flit);
-		m_AllowRetry = ExtractBool(flit);
-		m_Order = Extract<uint8_t>(flit, Order_Width);
-		m_PCrdType = Extract<uint8_t>(flit, PCrdType_Width);
-
-		ExtractMemAttr(Extract<uint8_t>(flit, MemAttr_Width));
+		m_ReturnTxnID = f.ReturnTxnID;
 
-		m_SnpAttr = ExtractBool(flit);
+		m_Opcode = f.Opcode;
+		m_Size = f.Size;
+		m_Address = f.Addr;
 
-		m_LPID = Extract<uint16_t>(flit, LPID_Width);
+		m_NonSecure = f.NS;
+		m_LikelyShared = f.LikelyShared;
+		m_AllowRetry = f.AllowRetry;
+		m_Order = f.Order;
+		m_PCrdType = f.PCrdType;
 
-		m_Excl_SnoopMe = ExtractBool(flit);
+		ExtractMemAttr(f.MemAttr);
 
-		m_ExpCompAck = ExtractBool(flit);
-		m_TraceTag = ExtractBool(flit);
+		m_SnpAttr = f.SnpAttr;
+		m_LPID = f.LPID;
+		m_Excl_SnoopMe = f.ExclSnoopMe;
+		m_ExpCompAck = f.ExpCompAck;
+		m_TraceTag = f.TraceTag;
 
 		if (RSVDC_WIDTH) {
-			m_RSVDC =
-				Extract<uint32_t>(flit, RSVDC_WIDTH);
+			m_RSVDC = f.RSVDC;
 		}
 	}
 
@@ -333,30 +309,10 @@ private:
 		m_EarlyWrAck = earlyWrAck;
 	}
 
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
 	uint8_t m_QoS;
 	uint16_t m_TgtID;
 	uint16_t m_SrcID;
-	uint8_t m_TxnID;
+	uint16_t m_TxnID;
 
 	uint16_t m_ReturnNID_StashNID;
 
@@ -366,7 +322,7 @@ private:
 	// For stash transactions ReturnTxnID contains
 	// { [7:6]: 0b00, StashLPIDValid[5], StashLPID[4:0] }
 	//
-	uint8_t m_ReturnTxnID;
+	uint16_t m_ReturnTxnID;
 
 	uint8_t m_Opcode;
 
@@ -396,11 +352,11 @@ private:
 	bool m_TraceTag;
 
 	uint32_t m_RSVDC;
-
-	unsigned int m_pos;
 };
 
-template<int NODEID_WIDTH>
+template<
+	int NODEID_WIDTH,
+	int TXNID_WIDTH = Rsp::TxnID_Width>
 class RspFlit
 {
 public:
@@ -411,44 +367,33 @@ public:
 		QoS_Width 	= Rsp::QoS_Width,
 		TgtID_Width 	= NODEID_WIDTH,
 		SrcID_Width 	= NODEID_WIDTH,
-		TxnID_Width 	= Rsp::TxnID_Width,
+		TxnID_Width 	= TXNID_WIDTH,
 		Opcode_Width 	= Rsp::Opcode_Width,
 		RespErr_Width 	= Rsp::RespErr_Width,
 		Resp_Width 	= Rsp::Resp_Width,
 
 		FwdState_DataPull_Width = Rsp::FwdState_DataPull_Width,
 
-		DBID_Width 	= Rsp::DBID_Width,
+		DBID_Width 	= TXNID_WIDTH,
 		PCrdType_Width 	= Rsp::PCrdType_Width,
 		TraceTag_Width 	= Rsp::TraceTag_Width,
 
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			Opcode_Width +
-			RespErr_Width +
-			Resp_Width +
-			FwdState_DataPull_Width +
-			DBID_Width +
-			PCrdType_Width +
-			TraceTag_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_RSP_FLIT_LAYOUT),
 	};
 
-	RspFlit(sc_bv<FLIT_WIDTH>& flit) :
-		m_pos(0)
+	RspFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
+		FlitWords<FLIT_WIDTH> words(flit);
+
 		// Init all fields except above
-		ParseFlit(flit);
+		ParseFlit(words);
 	}
 
 	uint16_t GetTgtID() { return m_TgtID; }
 	uint16_t GetSrcID() { return m_SrcID; }
-	uint8_t GetTxnID() { return m_TxnID; }
-	uint8_t GetDBID() { return m_DBID; }
+	uint16_t GetTxnID() { return m_TxnID; }
+	uint16_t GetDBID() { return m_DBID; }
 	uint8_t GetPCrdType() { return m_PCrdType; }
 
 	bool IsSnoopResponse()
@@ -504,49 +449,29 @@ public:
 	}
 
 private:
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
+		RspFlitFields<RspFlit> f;
 
-		m_pos += width;
+		f.Unpack(flit);
 
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
-		m_QoS = Extract<uint8_t>(flit, QoS_Width);
-		m_TgtID = Extract<uint16_t>(flit, TgtID_Width);
-		m_SrcID = Extract<uint16_t>(flit, SrcID_Width);
-		m_TxnID = Extract<uint8_t>(flit, TxnID_Width);
-		m_Opcode = Extract<uint8_t>(flit, Opcode_Width);
-
-		m_RespErr = Extract<uint8_t>(flit, RespErr_Width);
-		m_Resp = Extract<uint8_t>(flit, Resp_Width);
-
-		m_FwdState_DataPull =
-			Extract<uint8_t>(flit, FwdState_DataPull_Width);
-
-		m_DBID = Extract<uint8_t>(flit, DBID_Width);
-		m_PCrdType = Extract<uint8_t>(flit,  PCrdType_Width);
-		m_TraceTag = ExtractBool(flit);
+		m_QoS = f.QoS;
+		m_TgtID = f.TgtID;
+		m_SrcID = f.SrcID;
+		m_TxnID = f.TxnID;
+		m_Opcode = f.Opcode;
+		m_RespErr = f.RespErr;
+		m_Resp = f.Resp;
+		m_FwdState_DataPull = f.FwdState_DataPull;
+		m_DBID = f.DBID;
+		m_PCrdType = f.PCrdType;
+		m_TraceTag = f.TraceTag;
 	}
 
 	uint8_t m_QoS;
 	uint16_t m_TgtID;
 	uint16_t m_SrcID;
-	uint8_t m_TxnID;
+	uint16_t m_TxnID;
 	uint8_t m_Opcode;
 
 	uint8_t m_RespErr;
@@ -554,16 +479,15 @@ private:
 
 	uint8_t m_FwdState_DataPull;
 
-	uint8_t m_DBID;
+	uint16_t m_DBID;
 	uint8_t m_PCrdType;
 	bool m_TraceTag;
-
-	unsigned int m_pos;
 };
 
 template<
 	int ADDR_WIDTH,
-	int NODEID_WIDTH>
+	int NODEID_WIDTH,
+	int TXNID_WIDTH = Snp::TxnID_Width>
 class SnpFlit
 {
 public:
@@ -573,9 +497,9 @@ public:
 	enum {
 		QoS_Width 	= Snp::QoS_Width,
 		SrcID_Width 	= NODEID_WIDTH,
-		TxnID_Width 	= Snp::TxnID_Width,
+		TxnID_Width 	= TXNID_WIDTH,
 		FwdNID_Width 	= NODEID_WIDTH,
-		FwdTxnID_Width 	= Snp::FwdTxnID_Width,
+		FwdTxnID_Width 	= TXNID_WIDTH,
 		Opcode_Width 	= Snp::Opcode_Width,
 		Addr_Width 	= ADDR_WIDTH,
 		NS_Width 	= Snp::NS_Width,
@@ -586,33 +510,22 @@ public:
 		TraceTag_Width 	= Snp::TraceTag_Width,
 
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			SrcID_Width +
-			TxnID_Width +
-			FwdNID_Width +
-			FwdTxnID_Width +
-			Opcode_Width +
-			Addr_Width +
-			NS_Width +
-			DoNotGoToSD_Width +
-			RetToSrc_Width +
-			TraceTag_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_SNP_FLIT_LAYOUT),
 
 	};
 
-	SnpFlit(sc_bv<FLIT_WIDTH>& flit) :
-		m_pos(0)
+	SnpFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
+		FlitWords<FLIT_WIDTH> words(flit);
+
 		// Init all fields except above
-		ParseFlit(flit);
+		ParseFlit(words);
 	}
 
 
-	uint8_t GetTxnID() { return m_TxnID; }
+	uint16_t GetTxnID() { return m_TxnID; }
 	uint16_t GetFwdNID() { return m_FwdNID; }
-	uint8_t GetFwdTxnID() { return m_FwdTxnID; }
+	uint16_t GetFwdTxnID() { return m_FwdTxnID; }
 
 	bool IsSnpFwd()
 	{
@@ -676,49 +589,33 @@ public:
 	}
 
 private:
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
+		SnpFlitFields<SnpFlit> f;
 
-		val = flit.range(lastbit, firstbit).to_uint64();
+		f.Unpack(flit);
 
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
-		m_QoS = Extract<uint8_t>(flit, QoS_Width);
-		m_SrcID = Extract<uint16_t>(flit, SrcID_Width);
-		m_TxnID = Extract<uint8_t>(flit, TxnID_Width);
-		m_FwdNID = Extract<uint16_t>(flit, FwdNID_Width);
-		m_FwdTxnID = Extract<uint8_t>(flit, FwdTxnID_Width);
-		m_Opcode = Extract<uint8_t>(flit, Opcode_Width);
-		m_Address = Extract<uint64_t>(flit, Addr_Width) << 3;
-		m_NonSecure = ExtractBool(flit);
+		m_QoS = f.QoS;
+		m_SrcID = f.SrcID;
+		m_TxnID = f.TxnID;
+		m_FwdNID = f.FwdNID;
+		m_FwdTxnID = f.FwdTxnID;
+		m_Opcode = f.Opcode;
+		m_Address = f.Addr << 3;
+		m_NonSecure = f.NS;
 
 		// Bit is also DoNotDataPull
-		m_DoNotGoToSD = ExtractBool(flit);
+		m_DoNotGoToSD = f.DoNotGoToSD;
 
-		m_RetToSrc = ExtractBool(flit);
-		m_TraceTag = ExtractBool(flit);
+		m_RetToSrc = f.RetToSrc;
+		m_TraceTag = f.TraceTag;
 	}
 
 	uint8_t m_QoS;
 	uint16_t m_SrcID;
-	uint8_t m_TxnID;
+	uint16_t m_TxnID;
 	uint16_t m_FwdNID;
-	uint8_t m_FwdTxnID;
+	uint16_t m_FwdTxnID;
 	uint8_t m_Opcode;
 	uint64_t m_Address;
 	bool m_NonSecure;
@@ -728,8 +625,6 @@ private:
 
 	bool m_RetToSrc;
 	bool m_TraceTag;
-
-	unsigned int m_pos;
 };
 
 template<
@@ -738,7 +633,8 @@ template<
 	int RSVDC_WIDTH,
 	int DATACHECK_WIDTH,
 	int POISON_WIDTH,
-	int DAT_OPCODE_WIDTH>
+	int DAT_OPCODE_WIDTH,
+	int TXNID_WIDTH = Dat::TxnID_Width>
 class DatFlit
 {
 public:
@@ -749,7 +645,7 @@ public:
 		QoS_Width 	= Dat::QoS_Width,
 		TgtID_Width 	= NODEID_WIDTH,
 		SrcID_Width 	= NODEID_WIDTH,
-		TxnID_Width 	= Dat::TxnID_Width,
+		TxnID_Width 	= TXNID_WIDTH,
 		HomeNID_Width 	= NODEID_WIDTH,
 		Opcode_Width 	= DAT_OPCODE_WIDTH,
 		RespErr_Width 	= Dat::RespErr_Width,
@@ -757,7 +653,7 @@ public:
 
 		FwdState_DataPull_DataSource_Width = 3,
 
-		DBID_Width 	= Dat::DBID_Width,
+		DBID_Width 	= TXNID_WIDTH,
 		CCID_Width 	= Dat::CCID_Width,
 		DataID_Width 	= Dat::DataID_Width,
 		TraceTag_Width 	= Dat::TraceTag_Width,
@@ -769,49 +665,31 @@ public:
 		Poison_Width 	= POISON_WIDTH,
 
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			HomeNID_Width +
-			Opcode_Width +
-			RespErr_Width +
-			Resp_Width +
-			FwdState_DataPull_DataSource_Width +
-			DBID_Width +
-			CCID_Width +
-			DataID_Width +
-			TraceTag_Width +
-			RSVDC_Width +
-			BE_Width +
-			Data_Width +
-			DataCheck_Width +
-			Poison_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_DAT_FLIT_LAYOUT),
 	};
 
 	DatFlit(sc_bv<FLIT_WIDTH>& flit) :
 		m_RSVDC(0),
 		m_DataCheck(0),
-		m_Poison(0),
-		m_pos(0)
+		m_Poison(0)
 	{
 		memset(m_data, 0x0, sizeof(m_data));
 		memset(m_byteEnable,
 			TLM_BYTE_DISABLED,
 			sizeof(m_byteEnable));
 
+		FlitWords<FLIT_WIDTH> words(flit);
+
 		// Init all fields except above
-		ParseFlit(flit);
+		ParseFlit(words);
 	}
 
 	uint16_t GetTgtID() { return m_TgtID; }
 	uint16_t GetSrcID() { return m_SrcID; }
 	uint16_t GetHomeNID() { return m_HomeNID; }
 
-	uint8_t GetTxnID() { return m_TxnID; }
-	uint8_t GetDBID() { return m_DBID; }
+	uint16_t GetTxnID() { return m_TxnID; }
+	uint16_t GetDBID() { return m_DBID; }
 
 	bool IsSnoopResponse()
 	{
@@ -869,93 +747,47 @@ public:
 	}
 
 private:
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ExtractByteEnable(sc_bv<FLIT_WIDTH>& flit)
-	{
-		unsigned int be_len = BE_Width;
-		uint8_t *be = m_byteEnable;
-		unsigned int i;
-
-		for (i = 0; i < be_len; i++) {
-			if (ExtractBool(flit)) {
-				be[i] = TLM_BYTE_ENABLED;
-			} else {
-				be[i] = TLM_BYTE_DISABLED;
-			}
-		}
-	}
-
-	void ExtractData(sc_bv<FLIT_WIDTH>& flit)
-	{
-		unsigned int dataLen = Data_Width / 8;
-		unsigned int i;
-
-		for (i = 0; i < dataLen; i++) {
-			m_data[i] = Extract<uint8_t>(flit, 8);
-		}
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
-		m_QoS = Extract<uint8_t>(flit, QoS_Width);
-		m_TgtID = Extract<uint16_t>(flit, TgtID_Width);
-		m_SrcID = Extract<uint16_t>(flit, SrcID_Width);
-		m_TxnID = Extract<uint8_t>(flit, TxnID_Width);
-		m_HomeNID = Extract<uint16_t>(flit, HomeNID_Width);
-		m_Opcode = Extract<uint8_t>(flit, Opcode_Width);
-		m_RespErr = Extract<uint8_t>(flit, RespErr_Width);
-		m_Resp = Extract<uint8_t>(flit, Resp_Width);
-
-		m_FwdState_DataPull_DataSource =
-			Extract<uint8_t>(flit,
-					 FwdState_DataPull_DataSource_Width);
-
-		m_DBID = Extract<uint8_t>(flit, DBID_Width);
-		m_CCID = Extract<uint8_t>(flit, CCID_Width);
-		m_DataID = Extract<uint8_t>(flit, DataID_Width);
-		m_TraceTag = ExtractBool(flit);
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
+	{
+		DatFlitFields<DatFlit> f;
+
+		f.Data = m_data;
+		f.Unpack(flit);
+
+		m_QoS = f.QoS;
+		m_TgtID = f.TgtID;
+		m_SrcID = f.SrcID;
+		m_TxnID = f.TxnID;
+		m_HomeNID = f.HomeNID;
+		m_Opcode = f.Opcode;
+		m_RespErr = f.RespErr;
+		m_Resp = f.Resp;
+		m_FwdState_DataPull_DataSource = f.FwdState_DataPull_DataSource;
+		m_DBID = f.DBID;
+		m_CCID = f.CCID;
+		m_DataID = f.DataID;
+		m_TraceTag = f.TraceTag;
 
 		if (RSVDC_WIDTH) {
-			m_RSVDC = Extract<uint32_t>(flit, RSVDC_Width);
+			m_RSVDC = f.RSVDC;
 		}
 
-		ExtractByteEnable(flit);
-		ExtractData(flit);
+		FlitWords<FLIT_WIDTH>::MaskToByteEnable(f.BE, m_byteEnable,
+							BE_Width);
 
 		if (DATACHECK_WIDTH) {
-			m_DataCheck =
-				Extract<uint64_t>(flit, DataCheck_Width);
+			m_DataCheck = f.DataCheck;
 		}
 
 		if (POISON_WIDTH) {
-			m_Poison =
-				Extract<uint8_t>(flit, Poison_Width);
+			m_Poison = f.Poison;
 		}
 	}
 
 	uint8_t m_QoS;
 	uint16_t m_TgtID;
 	uint16_t m_SrcID;
-	uint8_t m_TxnID;
+	uint16_t m_TxnID;
 	uint16_t m_HomeNID;
 	uint8_t m_Opcode;
 	uint8_t m_RespErr;
@@ -963,7 +795,7 @@ private:
 
 	uint8_t m_FwdState_DataPull_DataSource;
 
-	uint8_t m_DBID;
+	uint16_t m_DBID;
 	uint8_t m_CCID;
 	uint8_t m_DataID;
 	bool m_TraceTag;
@@ -975,8 +807,6 @@ private:
 
 	uint64_t m_DataCheck;
 	uint8_t m_Poison;
-
-	unsigned int m_pos;
 };
 
 }; // namespace CHECKERS
@@ -44,7 +44,8 @@ template<
 	int RSVDC_WIDTH = 32,
 	int DATACHECK_WIDTH = 64,
 	int POISON_WIDTH = 8,
-	int DAT_OPCODE_WIDTH = Dat::Opcode_Width>
+	int DAT_OPCODE_WIDTH = Dat::Opcode_Width,
+	int TXNID_WIDTH = Req::TxnID_Width>
 class CHIProtocolChecker : public sc_core::sc_module
 {
 public:
@@ -55,23 +56,28 @@ public:
 				RSVDC_WIDTH,
 				DATACHECK_WIDTH,
 				POISON_WIDTH,
-				DAT_OPCODE_WIDTH> PCType;
+				DAT_OPCODE_WIDTH,
+				TXNID_WIDTH> PCType;
 
 	typedef CHECKERS::ReqFlit< ADDR_WIDTH,
 			NODEID_WIDTH,
-			RSVDC_WIDTH> ReqFlit_t;
+			RSVDC_WIDTH,
+			TXNID_WIDTH> ReqFlit_t;
 
-	typedef CHECKERS::RspFlit<NODEID_WIDTH> RspFlit_t;
+	typedef CHECKERS::RspFlit<NODEID_WIDTH, TXNID_WIDTH> RspFlit_t;
 
 	// lsb 3 bits on address not used
-	typedef CHECKERS::SnpFlit<ADDR_WIDTH-3, NODEID_WIDTH> SnpFlit_t;
+	typedef CHECKERS::SnpFlit<ADDR_WIDTH-3,
+			NODEID_WIDTH,
+			TXNID_WIDTH> SnpFlit_t;
 
 	typedef CHECKERS::DatFlit< DATA_WIDTH,
 			NODEID_WIDTH,
 			RSVDC_WIDTH,
 			DATACHECK_WIDTH,
 			POISON_WIDTH,
-			DAT_OPCODE_WIDTH> DatFlit_t;
+			DAT_OPCODE_WIDTH,
+			TXNID_WIDTH> DatFlit_t;
 
 	enum {
 		TXREQ_FLIT_W = ReqFlit_t::FLIT_WIDTH,
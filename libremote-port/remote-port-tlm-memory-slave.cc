@@ -44,6 +44,7 @@ extern "C" {
 
 #include "tlm-extensions/genattr.h"
 #include "tlm-extensions/atsattr.h"
+#include "utils/bytecopy.h"
 
 using namespace sc_core;
 using namespace std;
@@ -176,18 +177,7 @@ void remoteport_tlm_memory_slave::b_transport(tlm::tlm_generic_payload& trans,
 		// The remote peer does not control our buffer, so we
 		// do it here.
 		//
-		if (in.byte_enable_len) {
-			unsigned int i;
-
-			for (i = 0; i < len; i++) {
-				uint8_t b = be[i % in.byte_enable_len];
-				if (b == TLM_BYTE_ENABLED) {
-					data[i] = rx_data[i];
-				}
-			}
-		} else {
-			memcpy(data, rx_data, len);
-		}
+		bytecopy_be(data, rx_data, len, be, in.byte_enable_len);
 	}
 	// Give back the RP response slot.
 	response_done(ri);
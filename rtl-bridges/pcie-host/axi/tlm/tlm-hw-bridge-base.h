@@ -37,6 +37,7 @@
 #include "tlm-extensions/genattr.h"
 #include "utils/dev-access.h"
 #include "utils/bitops.h"
+#include "utils/bytecopy.h"
 
 #include "rtl-bridges/pcie-host/axi/tlm/private/user_slave_addr.h"
 
@@ -442,18 +443,8 @@ void tlm_hw_bridge_base::dev_copy_from(uint64_t offset, unsigned char *buf,
 		v = dev_read32(offset);
 		v >>= word_offset * 8;
 
-		if (be && be_len) {
-			unsigned int j;
-
-			for (j = 0; j < len_to_copy; j++) {
-				int pos = i + j;
-				if (be[pos % be_len] == TLM_BYTE_ENABLED)
-					buf[pos] = v;
-				v >>= 8;
-			}
-		} else {
-			memcpy(buf + i, &v, len_to_copy);
-		}
+		bytecopy_be(buf + i, reinterpret_cast<uint8_t*>(&v),
+				len_to_copy, be, be_len, i);
 
 		word_offset = 0;
 		i += len_to_copy;
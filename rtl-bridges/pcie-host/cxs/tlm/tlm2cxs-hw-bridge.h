@@ -283,17 +283,15 @@ private:
 	{
 		CXSCntl_t cntl(rx_cntl);
 
-		std::vector<unsigned int>::iterator ptr_it;
 		typename std::list<TLPAssembler_t*>::iterator tlpas_it;
+		unsigned int i;
 
 		//
 		// Parse all StartPtrs
 		//
-		ptr_it = cntl.GetStartPtrs().begin();
+		for (i = 0; i < cntl.GetNumStartPtrs(); i++) {
 
-		for (; ptr_it != cntl.GetStartPtrs().end(); ptr_it++) {
-
-			unsigned int ptr = (*ptr_it);
+			unsigned int ptr = cntl.GetStartPtr(i);
 			unsigned int flit_start_pos;
 
 			flit_start_pos = ptr * CXSCntl_t::Align_128;
@@ -308,11 +306,10 @@ private:
 		// Parse all EndPtrs
 		//
 		tlpas_it = m_assemblers.begin();
-		ptr_it = cntl.GetEndPtrs().begin();
 
-		for (;ptr_it != cntl.GetEndPtrs().end(); ptr_it++, tlpas_it++) {
+		for (i = 0; i < cntl.GetNumEndPtrs(); i++, tlpas_it++) {
 
-			unsigned int ptr = (*ptr_it);
+			unsigned int ptr = cntl.GetEndPtr(i);
 			unsigned int flit_end_pos = ptr * CXSCntl_t::Align_32;
 
 			TLPAssembler_t *tlpAs;
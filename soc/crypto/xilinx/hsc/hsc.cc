@@ -206,6 +206,16 @@ xilinx_hsc::xilinx_hsc(sc_module_name name):
 	user_if_socket.register_b_transport(this,
 					    &xilinx_hsc::user_if_b_transport);
 
+	for (int port = 0; port < XILINX_HSC_MAX_PORT; port++) {
+		this->enc_out[port].buf.resize(XILINX_HSC_OUT_BUF_SIZE);
+		this->dec_out[port].buf.resize(XILINX_HSC_OUT_BUF_SIZE);
+	}
+
+	for (int sa = 0; sa < XILINX_HSC_MAX_KEYS; sa++) {
+		this->encoder_key_sched[sa].key_len = 0;
+		this->decoder_key_sched[sa].key_len = 0;
+	}
+
 	SC_THREAD(reset_thread);
 }
 
@@ -216,6 +226,10 @@ void xilinx_hsc::reset_thread(void)
 		/* Zero the keys.  */
 		memset(this->encoder_keys, 0, sizeof(this->encoder_keys));
 		memset(this->decoder_keys, 0, sizeof(this->decoder_keys));
+		for (int sa = 0; sa < XILINX_HSC_MAX_KEYS; sa++) {
+			this->encoder_key_sched[sa].key_len = 0;
+			this->decoder_key_sched[sa].key_len = 0;
+		}
 		for (int port = 0; port < XILINX_HSC_MAX_PORT; port++) {
 			this->reset_enc_port(port);
 			this->reset_dec_port(port);
@@ -258,8 +272,11 @@ void xilinx_hsc::reg_indirect_access(bool tx)
 		   ? &this->regs[TX_INDIRECT_AXS_CTRL_REG]
 		   : &this->regs[RX_INDIRECT_AXS_CTRL_REG]);
 	void *key_reg = (tx
-			 ? &this->encoder_keys[0][ctrl_ptr->num]
-			 : &this->decoder_keys[0][ctrl_ptr->num]);
+			 ? &this->encoder_keys[ctrl_ptr->num][0]
+			 : &this->decoder_keys[ctrl_ptr->num][0]);
+	struct aes_gcm_key *key_sched = (tx
+			 ? &this->encoder_key_sched[ctrl_ptr->num]
+			 : &this->decoder_key_sched[ctrl_ptr->num]);
 
 	if (!ctrl_ptr->ena) {
 		/* Nothing to do, the transfert hasn't been triggered.  */
@@ -278,6 +295,13 @@ void xilinx_hsc::reg_indirect_access(bool tx)
 			       ? &this->regs[TX_INDIRECT_AXS_WDATA_REG(0)]
 			       : &this->regs[RX_INDIRECT_AXS_WDATA_REG(0)],
 			       XILINX_HSC_MAX_KEY_SIZE_BYTES);
+			/* Expand the key now rather than for each packet,
+			 * with the size the SA was last used with (128bits
+			 * by default).  */
+			aes_gcm_setkey(key_sched, (uint8_t *)key_reg,
+				       key_sched->key_len
+				       ? key_sched->key_len
+				       : 128 / 8);
 		} else {
 			/* Keys are not readable.  The user can read a CRC32
 			 * digest of the 256bits of the keys on LSB.  */
@@ -309,6 +333,97 @@ void xilinx_hsc::reg_indirect_access(bool tx)
 	}
 }
 
+const struct aes_gcm_key *
+xilinx_hsc::get_key_sched(bool tx, struct fixed_common *common)
+{
+	struct aes_gcm_key *sched;
+	unsigned int key_len;
+	uint8_t *key;
+
+	switch (common->crypto_cipher_suite) {
+	case xilinx_hsc::GCM_AES_128:
+	case xilinx_hsc::GCM_AES_XPN_128:
+		key_len = 128 / 8;
+		break;
+	default:
+		key_len = 256 / 8;
+		break;
+	}
+
+	/* For SAs < 1024 the internal keys are used, the external key input
+	 * is used otherwise.  */
+	if (common->crypto_sa_index >= XILINX_HSC_MAX_KEYS) {
+		key = common->crypto_ext_key;
+		sched = &common->ext_key_sched;
+	} else if (tx) {
+		key = (uint8_t *)this->encoder_keys[common->crypto_sa_index];
+		sched = &this->encoder_key_sched[common->crypto_sa_index];
+	} else {
+		key = (uint8_t *)this->decoder_keys[common->crypto_sa_index];
+		sched = &this->decoder_key_sched[common->crypto_sa_index];
+	}
+
+	if (sched->key_len != key_len) {
+		aes_gcm_setkey(sched, key, key_len);
+	}
+
+	return sched;
+}
+
+void xilinx_hsc::macsec_iv(uint8_t *iv, struct fixed_common *common,
+			   uint64_t sci, uint32_t ssci, uint64_t pn)
+{
+	switch (common->crypto_cipher_suite) {
+	case xilinx_hsc::GCM_AES_XPN_128:
+	case xilinx_hsc::GCM_AES_XPN_256:
+		/* IV = Salt ^ (SSCI || PN), IEEE 802.1AEbw.  */
+		aes_gcm_put_be32(iv, ssci);
+		aes_gcm_put_be64(iv + 4, pn);
+		for (int i = 0; i < AES_GCM_IV_SIZE; i++) {
+			iv[i] ^= common->crypto_iv_salt[i];
+		}
+		break;
+	default:
+		/* IV = SCI || PN[31:0], IEEE 802.1AE.  */
+		aes_gcm_put_be64(iv, sci);
+		aes_gcm_put_be32(iv + 8, pn);
+		break;
+	}
+}
+
+uint8_t *xilinx_hsc::stream_out_buf(struct stream_out *out, size_t len)
+{
+	/* Only grows, so that the allocation happens once for the largest
+	 * transaction.  */
+	if (out->buf.size() < len) {
+		out->buf.resize(len);
+	}
+
+	return out->buf.data();
+}
+
+void xilinx_hsc::stream_out_send(
+	tlm_utils::simple_initiator_socket<xilinx_hsc>& socket,
+	struct stream_out *out, uint8_t *data, size_t len, bool eop,
+	sc_time& delay)
+{
+	tlm::tlm_generic_payload& trans = out->trans;
+
+	trans.set_command(tlm::TLM_WRITE_COMMAND);
+	trans.set_address(0);
+	trans.set_data_ptr((unsigned char *)data);
+	trans.set_streaming_width(4);
+	trans.set_data_length(len);
+	trans.set_byte_enable_ptr(NULL);
+	trans.set_byte_enable_length(0);
+	trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+	out->attr.set_eop(eop);
+
+	trans.set_extension(&out->attr);
+	socket->b_transport(trans, delay);
+	trans.clear_extension(&out->attr);
+}
+
 void xilinx_hsc::plain_input_stream_b_transport(int port,
 						tlm::tlm_generic_payload& trans,
 						sc_time& delay)
@@ -321,11 +436,10 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 	unsigned char *byte_en = trans.get_byte_enable_ptr();
 	trans.get_extension(genattr);
 
-	/* Output transaction.  */
+	/* Output data.  */
 	uint8_t *crypt_data = 0;
 	size_t crypt_len = len;
-	tlm::tlm_generic_payload out_stream_trans;
-	genattr_extension *out_attr = new genattr_extension();
+	struct fixed_common *common;
 
 	/* Sanity check on the txn, and port.  */
 	if (port >= XILINX_HSC_MAX_PORT) {
@@ -333,6 +447,8 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 		return;
 	}
 
+	common = &this->fixed_enc[port].common;
+
 	if (byte_en || cmd != tlm::TLM_WRITE_COMMAND || addr) {
 		goto err;
 	}
@@ -347,32 +463,38 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 
 	/* This is a new packet, the configuration is latched at that time, and
 	 * can't be changed during the packet processing.  */
-	if (!this->fixed_enc[port].common.byte_count) {
-		this->fixed_enc[port].common.crypto_auth_only =
+	if (!common->byte_count) {
+		common->crypto_auth_only =
 			this->enc_igr_prtif_crypto_auth_only[port].read();
-		this->fixed_enc[port].common.crypto_byp =
+		common->crypto_byp =
 			this->enc_igr_prtif_crypto_byp[port].read();
-		this->fixed_enc[port].common.crypto_cipher_suite =
+		common->crypto_cipher_suite =
 			this->enc_igr_prtif_crypto_cipher_suite[port].read();
-		this->fixed_enc[port].common.crypto_conf_offset =
+		common->crypto_conf_offset =
 			this->enc_igr_prtif_crypto_conf_offset[port].read();
-		this->fixed_enc[port].common.crypto_iv_salt[0] =
-		       this->enc_igr_prtif_crypto_iv_salt[port].read().to_int();
-		this->fixed_enc[port].common.crypto_mode =
+		for (int i = 0; i < 12; i++) {
+			common->crypto_iv_salt[i] =
+				this->enc_igr_prtif_crypto_iv_salt[port].read()
+				.range(95 - i * 8, 88 - i * 8).to_uint();
+		}
+		common->crypto_mode =
 			this->enc_igr_prtif_crypto_mode[port].read();
 		this->fixed_enc[port].crypto_packet_number =
 			this->enc_igr_prtif_crypto_pkt_num[port].read();
-		this->fixed_enc[port].common.crypto_sa_index =
+		common->crypto_sa_index =
 			this->enc_igr_prtif_crypto_sa_index[port].read();
-		this->fixed_enc[port].common.crypto_spare_in =
+		common->crypto_spare_in =
 			this->enc_igr_prtif_crypto_spare_in[port].read();
-		this->fixed_enc[port].common.crypto_zlen =
+		common->crypto_zlen =
 			this->enc_igr_prtif_crypto_zlen[port].read();
 		for (int i = 0; i < 32; i++) {
-			this->fixed_enc[port].common.crypto_ext_key[i] =
+			common->crypto_ext_key[i] =
 				this->enc_igr_prtif_ext_key[port].read().range(
 					(i + 1) * 8 - 1, i * 8).to_int();
 		}
+		/* The external key can change from one packet to the
+		 * other.  */
+		common->ext_key_sched.key_len = 0;
 		this->fixed_enc[port].macsec_sectag_an =
 			this->enc_igr_prtif_macsec_sectag_an[port].read();
 		this->fixed_enc[port].macsec_sectag_sci =
@@ -385,40 +507,23 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 			this->enc_igr_prtif_macsec_sectag_tci[port].read();
 	}
 
-	switch (this->fixed_enc[port].common.crypto_mode) {
+	switch (common->crypto_mode) {
 	case xilinx_hsc::MACsec: {
 		/* There are two things happening for that packet:
 		 *    1/ It will have the SecTAG inserted in place of the
-		 *       ethernet type (16bytes).
+		 *       ethernet type (8 or 16 bytes).
 		 *    2/ It will have the ICV tag inserted at the end of the
 		 *       packet.
-		 * All in all, the size must be increased.  */
+		 * All in all, the size must be increased.  Bypassed packets
+		 * go through untouched.  */
 		size_t offset = 0;
 		size_t offset_crypt = 0;
+		/* Offset of the first byte of that transaction within the
+		 * MACsec user data (ie: starting at the ethertype).  */
+		size_t user_data_pos;
+		size_t clear_len;
 
-		/* Check if the ethernet header is already computed, hence if
-		 * we need to add 16 bytes for the MACsec tag.  */
-		if (this->fixed_enc[port].common.byte_count < 14) {
-			crypt_len += 16;
-		}
-		/* Check if this is the end of the packet, hence if we need to
-		 * add 16 bytes for the ICV tag.  */
-		if (genattr->get_eop()) {
-			crypt_len += 16;
-		}
-
-		crypt_data = new uint8_t[crypt_len];
-		if (!this->fixed_enc[port].common.byte_count) {
-			/* This is a new packet, process the Ethernet header
-			 * and datas.  */
-			struct __attribute__((__packed__)) {
-				uint64_t ethertype : 16;
-				uint64_t tci_an : 8;
-				uint64_t sl : 8;
-				uint64_t pn : 32;
-				uint64_t sci : 64;
-			} sec_tag;
-
+		if (!common->byte_count) {
 			/* This is a new packet, one limitation here is to
 			 * have the ethernet header in one step.  */
 			if (len < 14) {
@@ -429,6 +534,39 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 				return;
 			}
 
+			common->protect = !common->crypto_byp;
+			/* The SCI is only present if the SC bit of the TCI is
+			 * set.  */
+			common->sectag_len = !common->protect
+				? 0
+				: (this->fixed_enc[port].macsec_sectag_tci
+				   & 0x8) ? 16 : 8;
+			crypt_len += common->sectag_len;
+			user_data_pos = 0;
+		} else {
+			user_data_pos = common->byte_count - 12;
+		}
+
+		if (!common->protect) {
+			/* Bypassed packets go through untouched, forward the
+			 * input data.  */
+			crypt_data = data;
+			break;
+		}
+
+		/* Check if this is the end of the packet, hence if we need to
+		 * add 16 bytes for the ICV tag.  */
+		if (genattr->get_eop()) {
+			crypt_len += AES_GCM_TAG_SIZE;
+		}
+
+		crypt_data = this->stream_out_buf(&this->enc_out[port],
+						  crypt_len);
+		if (!common->byte_count) {
+			struct fixed_enc *enc = &this->fixed_enc[port];
+			uint8_t *sec_tag = crypt_data + 12;
+			uint8_t iv[AES_GCM_IV_SIZE];
+
 			/* Copy the ethernet header.  */
 			memcpy(crypt_data, data, 12);
 			offset += 12;
@@ -437,97 +575,73 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 			/* Compute the SecTag.  */
 			/* TODO: Channelized mode allows to customize the
 			 * EtherType, not totally sure in FixedPort mode.  */
-			sec_tag.ethertype = 0xE588;
+			sec_tag[0] = 0x88;
+			sec_tag[1] = 0xE5;
 			/* The user must ensure the TCI provided is correct.  */
-			sec_tag.tci_an =
-				this->fixed_enc[port].macsec_sectag_tci << 2;
-			sec_tag.tci_an |=
-				this->fixed_enc[port].macsec_sectag_an;
-			sec_tag.sl =
-				this->fixed_enc[port].macsec_sectag_shortlen
-				? 1
-				: 0;
-			sec_tag.pn = this->fixed_enc[port].crypto_packet_number
-				& 0xFFFFFFFF;
-			sec_tag.sci = this->fixed_enc[port].macsec_sectag_sci;
-
-			memcpy(crypt_data + offset_crypt,
-			       &sec_tag,
-			       sec_tag.tci_an | 0x20 ? 16 : 8);
-			offset_crypt += sec_tag.tci_an | 0x20 ? 16 : 8;
+			sec_tag[2] = (enc->macsec_sectag_tci << 2)
+				     | (enc->macsec_sectag_an & 0x3);
+			sec_tag[3] = enc->macsec_sectag_shortlen & 0x3F;
+			aes_gcm_put_be32(sec_tag + 4,
+					 enc->crypto_packet_number);
+			if (common->sectag_len == 16) {
+				aes_gcm_put_be64(sec_tag + 8,
+						 enc->macsec_sectag_sci);
+			}
+			offset_crypt += common->sectag_len;
+
+			/* The ethernet addresses and the SecTAG are
+			 * authenticated.  */
+			this->macsec_iv(iv, common,
+					enc->macsec_sectag_sci,
+					enc->macsec_sectag_ssci,
+					enc->crypto_packet_number);
+			aes_gcm_start(&common->gcm,
+				      this->get_key_sched(true, common),
+				      iv, true);
+			aes_gcm_aad(&common->gcm, crypt_data, offset_crypt);
 		}
 
-		/* Data encryption:
-		 * This is not implemented, for the simulation the data will
-		 * be only XOR'ed with the packet.  */
-
 		/* Compute the amount of unencrypted data:
-		 *  1/ First case is that the encryption is bypassed.
+		 *  1/ First case is that authentication only is requested.
 		 *  2/ Second case is the opposite but we need to be sure we
 		 *     go above the crypto_conf_offset.
 		 */
-		int unencrypted_len = 0;
+		clear_len = 0;
 
-		if (this->fixed_enc[port].common.crypto_byp
-		    || this->fixed_enc[port].common.crypto_auth_only) {
-			unencrypted_len = len - offset;
-		} else if (this->fixed_enc[port].common.crypto_conf_offset == 30
-		     || this->fixed_enc[port].common.crypto_conf_offset == 50) {
+		if (common->crypto_auth_only) {
+			clear_len = len - offset;
+		} else if (common->crypto_conf_offset == 30
+			   || common->crypto_conf_offset == 50) {
 			/* Those are the two only value allowed, others are
 			 * read as zero.  */
-			unencrypted_len =
-				this->fixed_enc[port].common.crypto_conf_offset
-				- this->fixed_enc[port].common.byte_count
-				+ 12;
+			if (user_data_pos < (size_t)common->crypto_conf_offset) {
+				clear_len = common->crypto_conf_offset
+					    - user_data_pos;
+			}
+			if (clear_len > len - offset) {
+				clear_len = len - offset;
+			}
 		}
 
-		memcpy(crypt_data + offset_crypt, data + offset,
-		       unencrypted_len);
-		offset_crypt += unencrypted_len;
-		offset += unencrypted_len;
+		/* The unencrypted data are authenticated.  */
+		memcpy(crypt_data + offset_crypt, data + offset, clear_len);
+		aes_gcm_aad(&common->gcm, crypt_data + offset_crypt, clear_len);
+		offset_crypt += clear_len;
+		offset += clear_len;
 
+		/* Not all datas have been consumed, that means there are some
+		 * data to encrypt.  */
 		if (offset < len) {
-			/* offset within the key of the first encrypted
-			 * byte.  */
-			int keyoffset = 0;
-			/* Keysize 128 or 256.  */
-			int keysize;
-			/* key in use.  */
-			uint8_t *key;
-
-			/* For SAs < 1024 the internal keys are used,
-			 * enc_igr_prtif_ext_key is used otherwise.  */
-			if (this->fixed_enc[port].common.crypto_sa_index
-			    >= XILINX_HSC_MAX_KEYS) {
-				key =
-				    this->fixed_enc[port].common.crypto_ext_key;
-			} else {
-				key = (uint8_t *)&(this->encoder_keys[0]
-				[this->fixed_enc[port].common.crypto_sa_index]);
-			}
-
-			switch (
-			    this->fixed_enc[port].common.crypto_cipher_suite) {
-			case xilinx_hsc::GCM_AES_128:
-			case xilinx_hsc::GCM_AES_XPN_128:
-				keysize = 128 / 8;
-				break;
-			default:
-				keysize = 256 / 8;
-				break;
-			}
-			/* Not all datas have been consumed, that means there
-			 * are some data to encrypt.  */
-			for (size_t i = offset; i < len; i++) {
-				crypt_data[offset_crypt] = data[offset]
-							^ key[(keyoffset + i) % keysize];
-				offset_crypt++;
-				offset++;
-			}
+			aes_gcm_update(&common->gcm, data + offset,
+				       crypt_data + offset_crypt, len - offset);
+			offset_crypt += len - offset;
 		}
 
-		/* TODO: No more data to process, if it's eop we must add
-		 * the ICV.  */
+		/* That's the end of the packet, add the ICV.  */
+		if (genattr->get_eop()) {
+			aes_gcm_finish(&common->gcm,
+				       crypt_data + offset_crypt);
+		}
 		break;
 		}
 	default:
@@ -536,17 +650,13 @@ void xilinx_hsc::plain_input_stream_b_transport(int port,
 		break;
 	}
 
-	out_stream_trans.set_command(tlm::TLM_WRITE_COMMAND);
-	out_stream_trans.set_data_ptr((unsigned char *)crypt_data);
-	out_stream_trans.set_streaming_width(4);
-	out_stream_trans.set_data_length(crypt_len);
-	out_attr->set_eop(genattr->get_eop());
-	out_stream_trans.set_extension(out_attr);
-	this->encrypted_data_stream_outputs[port]->b_transport(out_stream_trans,
-							       delay);
-	out_stream_trans.release_extension(out_attr);
-
-	delete crypt_data;
+	/* Keep track of the packet boundaries.  */
+	common->byte_count = genattr->get_eop() ? 0 : common->byte_count + len;
+
+	this->stream_out_send(this->encrypted_data_stream_outputs[port],
+			      &this->enc_out[port], crypt_data, crypt_len,
+			      genattr->get_eop(), delay);
+
 	/* XXX: check the response status??  */
 	/* Everything is okay.  */
 	trans.set_response_status(tlm::TLM_OK_RESPONSE);
@@ -568,12 +678,11 @@ void xilinx_hsc::encrypted_input_stream_b_transport(int port,
 	unsigned char *byte_en = trans.get_byte_enable_ptr();
 	trans.get_extension(genattr);
 
-	/* Output transaction.  */
+	/* Output data.  */
 	uint8_t *plain_data = 0;
 	size_t plain_len = 0;
-	tlm::tlm_generic_payload out_stream_trans;
-	genattr_extension *out_attr = new genattr_extension();
 	struct fixed_dec *config;
+	bool icv_ok = true;
 
 	/* Sanity check on the txn, and port.  */
 	if (port >= XILINX_HSC_MAX_PORT) {
@@ -606,8 +715,11 @@ void xilinx_hsc::encrypted_input_stream_b_transport(int port,
 			this->dec_igr_prtif_crypto_cipher_suite[port].read();
 		config->common.crypto_conf_offset =
 			this->dec_igr_prtif_crypto_conf_offset[port].read();
-		config->common.crypto_iv_salt[0] =
-		       this->dec_igr_prtif_crypto_iv_salt[port].read().to_int();
+		for (int i = 0; i < 12; i++) {
+			config->common.crypto_iv_salt[i] =
+				this->dec_igr_prtif_crypto_iv_salt[port].read()
+				.range(95 - i * 8, 88 - i * 8).to_uint();
+		}
 		config->common.crypto_mode =
 			this->dec_igr_prtif_crypto_mode[port].read();
 		config->common.crypto_sa_index =
@@ -621,125 +733,147 @@ void xilinx_hsc::encrypted_input_stream_b_transport(int port,
 				this->dec_igr_prtif_ext_key[port].read().range(
 					(i + 1) * 8 - 1, i * 8).to_int();
 		}
+		config->common.ext_key_sched.key_len = 0;
 	}
 
 	switch (config->common.crypto_mode) {
 	case xilinx_hsc::MACsec: {
-		/* There are two things happening for that packet:
-		 *    1/ It will have the SecTAG inserted in place of the
-		 *       ethernet type (16bytes).
-		 *    2/ It will have the ICV tag inserted at the end of the
-		 *       packet.
-		 * All in all, the size must be increased.  */
+		/* The SecTAG and the ICV are removed from the packet, the
+		 * ICV is checked.  */
+		struct fixed_common *common = &config->common;
 		size_t offset = 0;
-		plain_len = 0;
-
-		/* This is actually not totally correct, since the SecTAG and
-		 * ICV will be missing in the output we are allocating a little
-		 * too much here.  */
-		plain_data = new uint8_t[len];
-		if (!config->common.byte_count) {
-			/* This is a new packet, process the Ethernet header
-			 * and datas.  */
-			struct __attribute__((__packed__)) SecTag {
-				uint64_t ethertype : 16;
-				uint64_t tci_an : 8;
-				uint64_t sl : 8;
-				uint64_t pn : 32;
-				uint64_t sci : 64;
-			} *sec_tag;
-
+		/* End of the data to decrypt, the ICV follows.  */
+		size_t data_end = len;
+		/* Offset of the first byte of that transaction within the
+		 * MACsec user data (ie: starting at the ethertype).  */
+		size_t user_data_pos;
+		size_t clear_len;
+
+		if (!common->byte_count) {
 			/* This is a new packet, one limitation here is to
-			 * have the ethernet header in one step.
-			 * XXX: We need even more, the MACSec TAG et all.  */
-			if (len < 14) {
+			 * have the ethernet header and the SecTAG in one
+			 * step.  */
+			common->protect = !common->crypto_byp;
+			common->sectag_len = !common->protect
+				? 0
+				: (len >= 15 && (data[14] & 0x20)) ? 16 : 8;
+			if (len < 14 + common->sectag_len) {
 				SC_REPORT_ERROR("HSC/MACSec",
 						"Limitation: the ethernet"
 						" header must comes in one"
 						" transaction");
 				return;
 			}
+		}
+
+		if (!common->protect) {
+			/* Bypassed packets go through untouched, forward the
+			 * input data.  */
+			plain_data = data;
+			plain_len = len;
+			break;
+		}
+
+		/* The output can't be larger than the input.  */
+		plain_data = this->stream_out_buf(&this->dec_out[port], len);
+		if (!common->byte_count) {
+			/* This is a new packet, process the Ethernet header
+			 * and the SecTAG.  */
+			uint8_t *sec_tag = data + 12;
+			uint8_t iv[AES_GCM_IV_SIZE];
+			uint64_t sci;
 
 			/* Copy the ethernet header.  */
 			memcpy(plain_data, data, 12);
 			offset += 12;
 			plain_len += 12;
 
-			/* Check the TCI_AN field, it gives the information
-			 * about a 16 bytes or 8 bytes TAG (ie: jumping the
-			 * SCI).  */
-			sec_tag = (struct SecTag *)(data + offset);
-			offset += sec_tag->tci_an | 0x20 ? 16 : 8;
 			/* XXX: Check the ethertype?  */
 			/* XXX: Provide pkt_num on per-port Egress.  */
+			if (common->sectag_len == 16) {
+				sci = ((uint64_t)aes_gcm_get_be32(sec_tag + 8)
+				       << 32)
+				      | aes_gcm_get_be32(sec_tag + 12);
+			} else {
+				/* Implicit SCI: the source MAC address and
+				 * port identifier 1.  */
+				sci = ((uint64_t)aes_gcm_get_be32(data + 6)
+				       << 32)
+				      | ((uint64_t)data[10] << 24)
+				      | ((uint64_t)data[11] << 16)
+				      | 0x0001;
+			}
+
+			/* For the XPN cipher suites, the SSCI and the upper
+			 * half of the PN are expected to be folded into the
+			 * salt input.  */
+			this->macsec_iv(iv, common, sci, 0,
+					aes_gcm_get_be32(sec_tag + 4));
+			aes_gcm_start(&common->gcm,
+				      this->get_key_sched(false, common),
+				      iv, false);
+			aes_gcm_aad(&common->gcm, data, 12 + common->sectag_len);
+			offset += common->sectag_len;
 		}
 
-		/* Data decryption:
-		 * This is not implemented, for the simulation the data will
-		 * be only XOR'ed with the packet.  */
+		user_data_pos = common->byte_count + offset - 12
+				- common->sectag_len;
+
+		if (genattr->get_eop()) {
+			if (len - offset < AES_GCM_TAG_SIZE) {
+				SC_REPORT_ERROR("HSC/MACSec",
+						"Limitation: the ICV must"
+						" comes in one transaction");
+				return;
+			}
+			data_end = len - AES_GCM_TAG_SIZE;
+		}
 
 		/* Compute the amount of unencrypted data:
-		 *  1/ First case is that the encryption is bypassed.
+		 *  1/ First case is that authentication only is requested.
 		 *  2/ Second case is the opposite but we need to be sure we
 		 *     go above the crypto_conf_offset.
 		 */
-		int unencrypted_len = 0;
+		clear_len = 0;
 
-		if (config->common.crypto_byp
-		    || config->common.crypto_auth_only) {
-			unencrypted_len = len - offset;
-		} else if (config->common.crypto_conf_offset == 30
-		     || config->common.crypto_conf_offset == 50) {
+		if (common->crypto_auth_only) {
+			clear_len = data_end - offset;
+		} else if (common->crypto_conf_offset == 30
+			   || common->crypto_conf_offset == 50) {
 			/* Those are the two only value allowed, others are
 			 * read as zero.  */
-			unencrypted_len =
-				config->common.crypto_conf_offset
-				- config->common.byte_count
-				+ 12;
+			if (user_data_pos < (size_t)common->crypto_conf_offset) {
+				clear_len = common->crypto_conf_offset
+					    - user_data_pos;
+			}
+			if (clear_len > data_end - offset) {
+				clear_len = data_end - offset;
+			}
 		}
 
-		memcpy(plain_data + plain_len, data + offset,
-		       unencrypted_len);
-		plain_len += unencrypted_len;
-		offset += unencrypted_len;
+		memcpy(plain_data + plain_len, data + offset, clear_len);
+		aes_gcm_aad(&common->gcm, data + offset, clear_len);
+		plain_len += clear_len;
+		offset += clear_len;
+
+		/* Not all datas have been consumed, that means there are some
+		 * data to decrypt.  */
+		if (offset < data_end) {
+			aes_gcm_update(&common->gcm, data + offset,
+				       plain_data + plain_len,
+				       data_end - offset);
+			plain_len += data_end - offset;
+		}
 
-		if (offset < len) {
-			/* offset within the key of the first encrypted
-			 * byte.  */
-			int keyoffset = 0;
-			/* Keysize 128 or 256.  */
-			int keysize;
-			/* key in use.  */
-			uint8_t *key;
-
-			/* For SAs < 1024 the internal keys are used,
-			 * enc_igr_prtif_ext_key is used otherwise.  */
-			if (config->common.crypto_sa_index
-			    >= XILINX_HSC_MAX_KEYS) {
-				key = config->common.crypto_ext_key;
-			} else {
-				key = (uint8_t *)&(this->decoder_keys[0]
-				        [config->common.crypto_sa_index]);
-			}
+		/* That's the end of the packet, check the ICV.  */
+		if (genattr->get_eop()) {
+			uint8_t icv[AES_GCM_TAG_SIZE];
 
-			switch (
-			    config->common.crypto_cipher_suite) {
-			case xilinx_hsc::GCM_AES_128:
-			case xilinx_hsc::GCM_AES_XPN_128:
-				keysize = 128 / 8;
-				break;
-			default:
-				keysize = 256 / 8;
-				break;
-			}
-			/* Not all datas have been consumed, that means there
-			 * are some data to encrypt, also skip the ICV at the
-			 * end of that packet.  */
-			for (size_t i = offset; i < len - 16; i++) {
-				plain_data[plain_len] = data[offset]
-					^ key[(keyoffset + i) % keysize];
-				plain_len++;
-				offset++;
+			aes_gcm_finish(&common->gcm, icv);
+			if (memcmp(icv, data + data_end, sizeof(icv))) {
+				SC_REPORT_WARNING("HSC/MACSec",
+						  "ICV check failed");
+				icv_ok = false;
 			}
 		}
 		break;
@@ -750,20 +884,21 @@ void xilinx_hsc::encrypted_input_stream_b_transport(int port,
 		break;
 	}
 
-	out_stream_trans.set_command(tlm::TLM_WRITE_COMMAND);
-	out_stream_trans.set_data_ptr((unsigned char *)plain_data);
-	out_stream_trans.set_streaming_width(4);
-	out_stream_trans.set_data_length(plain_len);
-	out_attr->set_eop(genattr->get_eop());
-	out_stream_trans.set_extension(out_attr);
-	this->plain_data_stream_outputs[port]->b_transport(out_stream_trans,
-							   delay);
-	out_stream_trans.release_extension(out_attr);
-
-	delete plain_data;
+	/* Keep track of the packet boundaries.  */
+	config->common.byte_count = genattr->get_eop()
+				    ? 0
+				    : config->common.byte_count + len;
+
+	this->stream_out_send(this->plain_data_stream_outputs[port],
+			      &this->dec_out[port], plain_data, plain_len,
+			      genattr->get_eop(), delay);
+
 	/* XXX: check the response status??  */
-	/* Everything is okay.  */
-	trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	/* The packet failing the authentication is reported on the input
+	 * transaction.  */
+	trans.set_response_status(icv_ok
+				  ? tlm::TLM_OK_RESPONSE
+				  : tlm::TLM_GENERIC_ERROR_RESPONSE);
 	return;
 err:
 	trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
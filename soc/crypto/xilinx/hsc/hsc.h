@@ -31,9 +31,14 @@
 #define XILINX_HSC_MAX_KEY_SIZE_BYTES (256 / 8)
 #define XILINX_HSC_MAX_KEY_SIZE (8)
 #define XILINX_HSC_MAX_KEYS     (1024)
+/* Preallocated output buffer, large enough for a jumbo frame and the
+ * SecTAG / ICV.  */
+#define XILINX_HSC_OUT_BUF_SIZE (9216 + 32)
 
+#include <vector>
 #include <systemc>
 #include "tlm-extensions/genattr.h"
+#include "utils/aes-gcm.h"
 
 class xilinx_hsc
 	: public sc_core::sc_module
@@ -163,8 +168,13 @@ private:
 				 sc_core::sc_time& delay);
 
 	uint32_t regs[XILINX_HSC_MAX_REGS];
-	uint32_t encoder_keys[XILINX_HSC_MAX_KEY_SIZE][XILINX_HSC_MAX_KEYS];
-	uint32_t decoder_keys[XILINX_HSC_MAX_KEY_SIZE][XILINX_HSC_MAX_KEYS];
+	uint32_t encoder_keys[XILINX_HSC_MAX_KEYS][XILINX_HSC_MAX_KEY_SIZE];
+	uint32_t decoder_keys[XILINX_HSC_MAX_KEYS][XILINX_HSC_MAX_KEY_SIZE];
+
+	/* Key schedules of the SA keys, expanded when the keys are loaded
+	 * and re-expanded if a packet uses the key with another size.  */
+	struct aes_gcm_key encoder_key_sched[XILINX_HSC_MAX_KEYS];
+	struct aes_gcm_key decoder_key_sched[XILINX_HSC_MAX_KEYS];
 
 	/* TX/RX keys and stats access helper.  */
 	void reg_indirect_access(bool tx);
@@ -185,7 +195,7 @@ private:
 
 		/* Encryption cipher suite: selects between GCM-AES-128,
 		 * GCM-AES-256, GCM-AES-XPN-128 or
-		 * GCM-AES-XPN-256.  (Encryption is not implemented anyway).  */
+		 * GCM-AES-XPN-256.  */
 		int crypto_cipher_suite;
 
 		/* Encryption confidentiality offset: offset in the packet or
@@ -194,8 +204,8 @@ private:
 		 * 0.  */
 		int crypto_conf_offset;
 
-		/* Salt value (not used in this model).  */
-		uint64_t crypto_iv_salt[2];
+		/* Salt value, for the XPN cipher suites (big endian).  */
+		uint8_t crypto_iv_salt[12];
 
 		/* Crypto mode in use for this port.  */
 		int crypto_mode;
@@ -214,13 +224,25 @@ private:
 
 		/* External key, when SA > 1023.  */
 		uint8_t crypto_ext_key[32];
+
+		/* Key schedule of the external key.  */
+		struct aes_gcm_key ext_key_sched;
+
+		/* The packet is protected (not bypassed), and the length of
+		 * its SecTAG.  */
+		bool protect;
+		size_t sectag_len;
+
+		/* GCM state of the packet in progress.  */
+		struct aes_gcm_ctx gcm;
 	};
 
 	/* Current per-port state of the decoder.  */
 	struct fixed_dec {
 		struct fixed_common common;
 
-		/* ICV, not used in this model.  */
+		/* ICV, not used in this model (the ICV of the packet is
+		 * checked).  */
 		uint64_t decrypt_icv[2];
 
 		/* Enable replay protection (not modeled).  */
@@ -249,13 +271,39 @@ private:
 		uint8_t macsec_sectag_shortlen;
 
 		/* MACsec Short Secure Channel Identifier:
-		 * Used to construct the IV for XPN cipher suite (not used).
+		 * Used to construct the IV for XPN cipher suite.
 		 */
 		uint32_t macsec_sectag_ssci;
 
 		/* MACsec tag control information: used to for the sectag.  */
 		uint8_t macsec_sectag_tci;
 	} fixed_enc[XILINX_HSC_MAX_PORT];
+
+	/* Key schedule for the SA (or external key) and cipher suite of the
+	 * packet.  */
+	const struct aes_gcm_key *get_key_sched(bool tx,
+						struct fixed_common *common);
+	/* Build the 96 bits GCM IV of a MACsec packet.  */
+	void macsec_iv(uint8_t *iv, struct fixed_common *common,
+		       uint64_t sci, uint32_t ssci, uint64_t pn);
+
+	/* Per-port output stream, the transaction, its extension and the
+	 * packet buffer are reused from one transaction to the other.  */
+	struct stream_out {
+		tlm::tlm_generic_payload trans;
+		genattr_extension attr;
+		std::vector<uint8_t> buf;
+	};
+	struct stream_out enc_out[XILINX_HSC_MAX_PORT];
+	struct stream_out dec_out[XILINX_HSC_MAX_PORT];
+
+	/* Output buffer of at least len bytes.  */
+	uint8_t *stream_out_buf(struct stream_out *out, size_t len);
+	/* Send the data on the output stream.  */
+	void stream_out_send(
+		tlm_utils::simple_initiator_socket<xilinx_hsc>& socket,
+		struct stream_out *out, uint8_t *data, size_t len, bool eop,
+		sc_core::sc_time& delay);
 };
 
 #endif /* HSC_H */
@@ -1,9 +1,6 @@
 /*
  * Model of the Xilinx MCDMA.
  *
- * TODO:
- *    * Fragmented packets on the RX path are not supported.
- *
  * Copyright (c) 2022 Advanced Micro Devices Inc.
  * Written by Edgar E. Iglesias
  *
@@ -57,7 +54,12 @@ using namespace std;
 	| R_S2MM_CH1SR_DLY_IRQ_MASK			\
 	| R_S2MM_CH1SR_IOC_IRQ_MASK)
 
-xilinx_mcdma::xilinx_mcdma(sc_module_name name, int num_channels)
+/* MM2S_CH_SCHD_TYPE, strict priority is served round robin.  */
+#define MM2S_SCHD_TYPE_MASK 0x3
+#define MM2S_SCHD_WRR 0x2
+
+xilinx_mcdma::xilinx_mcdma(sc_module_name name, int num_channels,
+		sc_time irq_delay_unit)
 	: sc_module(name),
 	  init_socket("init_socket"),
 	  target_socket("target_socket"),
@@ -67,29 +69,79 @@ xilinx_mcdma::xilinx_mcdma(sc_module_name name, int num_channels)
 	  s2mm_irq("s2mm_irq"),
 	  mm2s_irq("mm2s_irq"),
 	  num_channels(num_channels),
+	  irq_delay_unit(irq_delay_unit),
+	  mm2s(new mm2s_chan[num_channels]),
+	  mm2s_owner(-1),
+	  s2mm(new s2mm_chan[num_channels]),
+	  dmi_valid(false),
 	  rb("rb", mcdma_reginfo)
 {
 	int ch;
 
 	for (ch = 0; ch < num_channels; ch++) {
 		s2mm_stream_socket[ch].register_b_transport(this, &xilinx_mcdma::stream_b_transport, ch);
+
+		mm2s[ch].waiting = false;
+		mm2s[ch].bds.len = 0;
+		s2mm[ch].bds.len = 0;
 	}
 
 	target_socket.register_b_transport(this, &xilinx_mcdma::b_transport);
+	init_socket.register_invalidate_direct_mem_ptr(this,
+			&xilinx_mcdma::invalidate_direct_mem_ptr);
 
 	SC_METHOD(update_irqs);
 	dont_initialize();
 	sensitive << ev_update_irqs;
 
 	SC_THREAD(reset_thread);
-	SC_THREAD(dma_thread);
+
+	for (ch = 0; ch < num_channels; ch++) {
+		sc_spawn_options mm2s_opts;
+		sc_spawn_options s2mm_opts;
+
+		sc_spawn(sc_bind(&xilinx_mcdma::mm2s_thread, this, ch),
+			 sc_gen_unique_name("mm2s_thread"));
+
+		/* IRQ delay timers.  */
+		mm2s_opts.spawn_method();
+		mm2s_opts.dont_initialize();
+		mm2s_opts.set_sensitivity(&mm2s[ch].ev_irq_delay);
+		sc_spawn(sc_bind(&xilinx_mcdma::irq_delay_expired, this,
+				 CH_OFFSET(ch) + R_MM2S_CH1CR,
+				 CH_OFFSET(ch) + R_MM2S_CH1SR),
+			 sc_gen_unique_name("mm2s_irq_delay"), &mm2s_opts);
+
+		s2mm_opts.spawn_method();
+		s2mm_opts.dont_initialize();
+		s2mm_opts.set_sensitivity(&s2mm[ch].ev_irq_delay);
+		sc_spawn(sc_bind(&xilinx_mcdma::irq_delay_expired, this,
+				 CH_OFFSET(ch) + R_S2MM_CH1CR,
+				 CH_OFFSET(ch) + R_S2MM_CH1SR),
+			 sc_gen_unique_name("s2mm_irq_delay"), &s2mm_opts);
+	}
+}
+
+xilinx_mcdma::~xilinx_mcdma()
+{
+	delete[] mm2s;
+	delete[] s2mm;
 }
 
 void xilinx_mcdma::reset_thread(void)
 {
+	int ch;
+
 	while (true) {
 		wait(rst.posedge_event());
 		rb.reg_reset_all();
+
+		for (ch = 0; ch < num_channels; ch++) {
+			mm2s[ch].bds.len = 0;
+			mm2s[ch].ev_irq_delay.cancel();
+			s2mm[ch].bds.len = 0;
+			s2mm[ch].ev_irq_delay.cancel();
+		}
 	}
 }
 
@@ -118,9 +170,65 @@ void xilinx_mcdma::update_irqs(void)
 	s2mm_irq.write(!!rb.regs[R_S2MM_INTR_STATUS]);
 }
 
+//
+// Interrupt coalescing. The CR and SR layout is the same for MM2S and
+// S2MM channels.
+//
+// IOC is raised once IRQ_THRESHOLD packets completed, the SR field counts
+// down the packets left. With an IRQ_DELAY, a packet that doesn't reach
+// the threshold starts the delay timer, which raises DLY when no other
+// packet completes in time.
+//
+void xilinx_mcdma::irq_complete(int cr, int sr, sc_event& ev_irq_delay)
+{
+	unsigned int tmp;
+	unsigned int dly;
+
+	tmp = FIELD_EX(rb.regs[sr], MM2S_CH1SR, IRQ_THRESHOLD);
+	D(printf("IRQ threshold = %x\n", tmp));
+	if (tmp <= 1) {
+		tmp = FIELD_EX(rb.regs[cr], MM2S_CH1CR, IRQ_THRESHOLD);
+		rb.regs[sr] |= R_MM2S_CH1SR_IOC_IRQ_MASK;
+		ev_irq_delay.cancel();
+		ev_update_irqs.notify();
+	} else {
+		tmp--;
+
+		dly = FIELD_EX(rb.regs[cr], MM2S_CH1CR, IRQ_DELAY);
+		if (dly) {
+			/* Restart the timer.  */
+			ev_irq_delay.cancel();
+			ev_irq_delay.notify(irq_delay_unit * dly);
+		}
+	}
+	FIELD_DP(rb, rb.regs[sr], MM2S_CH1SR, IRQ_THRESHOLD, tmp);
+	D(printf("SR=%x tmp=%x\n", rb.regs[sr], tmp));
+}
+
+void xilinx_mcdma::irq_delay_expired(int cr, int sr)
+{
+	unsigned int tmp = FIELD_EX(rb.regs[cr], MM2S_CH1CR, IRQ_THRESHOLD);
+
+	/* The packets seen so far are reported, start counting again.  */
+	rb.regs[sr] |= R_MM2S_CH1SR_DLY_IRQ_MASK;
+	FIELD_DP(rb, rb.regs[sr], MM2S_CH1SR, IRQ_THRESHOLD, tmp);
+	ev_update_irqs.notify();
+}
+
+// CR written, reload the threshold counter.
+void xilinx_mcdma::irq_config(int cr, int sr, sc_event& ev_irq_delay)
+{
+	unsigned int tmp = FIELD_EX(rb.regs[cr], MM2S_CH1CR, IRQ_THRESHOLD);
+
+	FIELD_DP(rb, rb.regs[sr], MM2S_CH1SR, IRQ_THRESHOLD, tmp);
+	if (!FIELD_EX(rb.regs[cr], MM2S_CH1CR, IRQ_DELAY)) {
+		ev_irq_delay.cancel();
+	}
+}
+
 void xilinx_mcdma::push_stream(int ch, unsigned char *buf, int len, bool eop)
 {
-	genattr_extension *genattr = new genattr_extension();
+	genattr_extension *genattr = &mm2s[ch].genattr;
 	tlm::tlm_generic_payload tr;
 	sc_time delay = SC_ZERO_TIME;
 
@@ -137,14 +245,50 @@ void xilinx_mcdma::push_stream(int ch, unsigned char *buf, int len, bool eop)
 
 	mm2s_stream_socket[ch]->b_transport(tr, delay);
 
-	tr.release_extension(genattr);
+	tr.clear_extension(genattr);
+}
+
+// Host pointer to [addr, addr + len) if covered by the DMI region.
+unsigned char *xilinx_mcdma::dmi_ptr(tlm::tlm_command cmd, uint64_t addr,
+		int len)
+{
+	if (!dmi_valid || addr < dmi.get_start_address() ||
+	    addr + len - 1 > dmi.get_end_address()) {
+		return NULL;
+	}
+
+	if (cmd == tlm::TLM_READ_COMMAND ? !dmi.is_read_allowed() :
+					   !dmi.is_write_allowed()) {
+		return NULL;
+	}
+
+	return dmi.get_dmi_ptr() + (addr - dmi.get_start_address());
+}
+
+void xilinx_mcdma::invalidate_direct_mem_ptr(sc_dt::uint64 start,
+		sc_dt::uint64 end)
+{
+	if (dmi_valid && start <= dmi.get_end_address() &&
+	    end >= dmi.get_start_address()) {
+		dmi_valid = false;
+	}
 }
 
-void xilinx_mcdma::dma_access(tlm::tlm_command cmd, unsigned char *buf,
+bool xilinx_mcdma::dma_access(tlm::tlm_command cmd, unsigned char *buf,
 		uint64_t addr, int len)
 {
 	tlm::tlm_generic_payload tr;
 	sc_time delay = SC_ZERO_TIME;
+	unsigned char *p = dmi_ptr(cmd, addr, len);
+
+	if (p) {
+		if (cmd == tlm::TLM_READ_COMMAND) {
+			memcpy(buf, p, len);
+		} else {
+			memcpy(p, buf, len);
+		}
+		return true;
+	}
 
 	tr.set_command(cmd);
 	tr.set_address(addr);
@@ -156,41 +300,103 @@ void xilinx_mcdma::dma_access(tlm::tlm_command cmd, unsigned char *buf,
 
 	init_socket->b_transport(tr, delay);
 	if (tr.get_response_status() != tlm::TLM_OK_RESPONSE) {
-		printf("%s:%d DMA transaction error!\n", __func__, __LINE__);
+		return false;
 	}
+
+	/* The memory offers DMI, use it for the next accesses.  */
+	if (tr.is_dmi_allowed()) {
+		tr.set_address(addr);
+		dmi_valid = init_socket->get_direct_mem_ptr(tr, dmi);
+	}
+	return true;
 }
 
 void xilinx_mcdma::dma_load(unsigned char *buf, uint64_t addr, int len)
 {
-	dma_access(tlm::TLM_READ_COMMAND, buf, addr, len);
+	if (!dma_access(tlm::TLM_READ_COMMAND, buf, addr, len)) {
+		printf("%s:%d DMA transaction error!\n", __func__, __LINE__);
+	}
 }
 
 void xilinx_mcdma::dma_store(unsigned char *buf, uint64_t addr, int len)
 {
-	dma_access(tlm::TLM_WRITE_COMMAND, buf, addr, len);
+	if (!dma_access(tlm::TLM_WRITE_COMMAND, buf, addr, len)) {
+		printf("%s:%d DMA transaction error!\n", __func__, __LINE__);
+	}
 }
 
-void xilinx_mcdma::mm2s_desc_load(mm2s_bd *bd, uint64_t addr)
+//
+// Descriptors up to the tail belong to the DMA until the tail is moved, so
+// they are read ahead in one access and served from the cache. Writes to
+// the tail or current descriptor registers drop the cache.
+//
+void xilinx_mcdma::desc_load(struct bd_cache *c, unsigned char *bd, int size,
+		uint64_t addr, uint64_t tail)
 {
-	dma_load(reinterpret_cast<unsigned char *> (bd), addr, sizeof *bd);
+	if (addr < c->addr || addr + size > c->addr + c->len) {
+		uint64_t len = size;
+
+		/* Read ahead up to the tail, unless the chain wraps.  */
+		if (tail > addr) {
+			len = tail - addr + size;
+			if (len > sizeof c->data) {
+				len = sizeof c->data;
+			}
+		}
+
+		/*
+		 * A lone descriptor is read as is, so are descriptors spread
+		 * over memories where the read ahead fails. dma_load reports
+		 * the errors and nothing is cached.
+		 */
+		c->len = 0;
+		if (len == (uint64_t) size ||
+		    !dma_access(tlm::TLM_READ_COMMAND, c->data, addr, len)) {
+			dma_load(bd, addr, size);
+			return;
+		}
+		c->addr = addr;
+		c->len = len;
+	}
+
+	memcpy(bd, c->data + (addr - c->addr), size);
+}
+
+void xilinx_mcdma::desc_store(struct bd_cache *c, unsigned char *bd, int size,
+		uint64_t addr)
+{
+	dma_store(bd, addr, size);
+
+	if (addr >= c->addr && addr + size <= c->addr + c->len) {
+		memcpy(c->data + (addr - c->addr), bd, size);
+	}
+}
+
+void xilinx_mcdma::mm2s_desc_load(int ch, mm2s_bd *bd, uint64_t addr)
+{
+	desc_load(&mm2s[ch].bds, reinterpret_cast<unsigned char *> (bd),
+		  sizeof *bd, addr, mm2s_tail(ch));
 	D(printf("mm2s descr load: desc-addr=%lx next=%lx buffer=%lx ctrl=%x\n", addr, bd->next, bd->buffer, bd->ctrl));
 }
 
-void xilinx_mcdma::mm2s_desc_store(mm2s_bd *bd, uint64_t addr)
+void xilinx_mcdma::mm2s_desc_store(int ch, mm2s_bd *bd, uint64_t addr)
 {
-	dma_store(reinterpret_cast<unsigned char *> (bd), addr, sizeof *bd);
+	desc_store(&mm2s[ch].bds, reinterpret_cast<unsigned char *> (bd),
+		   sizeof *bd, addr);
 	D(printf("mm2s descr store: desc-addr=%lx next=%lx buffer=%lx ctrl=%x\n", addr, bd->next, bd->buffer, bd->ctrl));
 }
 
-void xilinx_mcdma::s2mm_desc_load(s2mm_bd *bd, uint64_t addr)
+void xilinx_mcdma::s2mm_desc_load(int ch, s2mm_bd *bd, uint64_t addr)
 {
-	dma_load(reinterpret_cast<unsigned char *> (bd), addr, sizeof *bd);
+	desc_load(&s2mm[ch].bds, reinterpret_cast<unsigned char *> (bd),
+		  sizeof *bd, addr, s2mm_tail(ch));
 	D(printf("s2mm descr load: desc-addr=%lx next=%lx buffer=%lx ctrl=%x\n", addr, bd->next, bd->buffer, bd->ctrl));
 }
 
-void xilinx_mcdma::s2mm_desc_store(s2mm_bd *bd, uint64_t addr)
+void xilinx_mcdma::s2mm_desc_store(int ch, s2mm_bd *bd, uint64_t addr)
 {
-	dma_store(reinterpret_cast<unsigned char *> (bd), addr, sizeof *bd);
+	desc_store(&s2mm[ch].bds, reinterpret_cast<unsigned char *> (bd),
+		   sizeof *bd, addr);
 	D(printf("s2mm descr store: desc-addr=%lx next=%lx buffer=%lx ctrl=%x\n", addr, bd->next, bd->buffer, bd->ctrl));
 }
 
@@ -232,88 +438,206 @@ void xilinx_mcdma::s2mm_set_idle(int ch, bool idle) {
 	rb.regs[CH_OFFSET(ch) + R_S2MM_CH1SR] |= idle << R_S2MM_CH1SR_IDLE_SHIFT;
 }
 
-void xilinx_mcdma::dma_thread(void)
+bool xilinx_mcdma::mm2s_runnable(int ch)
 {
-	unsigned char buf[128 * 1024];
+	int ch_offset = CH_OFFSET(ch);
 
-	while (true) {
-		int num_running = 0;
-		int ch;
+	if (!FIELD_EX(rb.regs[R_MM2S_CCR], MM2S_CCR, RS)) {
+		D(printf("MM2S STOPPED\n"));
+		return false;
+	}
 
-		/* MM2S.  */
-		for (ch = 0; ch < num_channels; ch++) {
-			int ch_offset = CH_OFFSET(ch);
-			bool tx_eof;
-			unsigned int tmp;
-			int len;
-			mm2s_bd bd;
-
-			if (!FIELD_EX(rb.regs[R_MM2S_CCR], MM2S_CCR, RS)) {
-				D(printf("MM2S STOPPED\n"));
-				continue;
-			}
+	if (!(rb.regs[R_MM2S_CHEN] & (1U << ch))) {
+		D(printf("MM2S: ch%d DISABLED\n", ch));
+		return false;
+	}
 
-			if (!(rb.regs[R_MM2S_CHEN] & (1U << ch))) {
-				D(printf("MM2S: ch%d DISABLED\n", ch));
-				continue;
-			}
+	if (!FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1CR], MM2S_CH1CR, RS)) {
+		D(printf("MM2S: ch%d STOPPED\n", ch));
+		return false;
+	}
 
-			if (!FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1CR], MM2S_CH1CR, RS)) {
-				D(printf("MM2S: ch%d STOPPED\n", ch));
-				continue;
-			}
+	if (FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1SR], MM2S_CH1SR, IDLE)) {
+		D(printf("MM2S: ch%d IDLE\n", ch));
+		return false;
+	}
+	return true;
+}
 
-			if (FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1SR], MM2S_CH1SR, IDLE)) {
-				D(printf("MM2S: ch%d IDLE\n", ch));
-				continue;
-			}
+// Descriptors a channel fetches per grant of the memory port.
+unsigned int xilinx_mcdma::mm2s_weight(int ch)
+{
+	uint32_t wrr;
+	unsigned int w;
 
-			/* Process this channel.  */
-			mm2s_desc_load(&bd, mm2s_cur(ch));
-			if (bd.status & (1U << 31)) {
-				mm2s_set_idle(ch, true);
-				continue;
-			}
+	if ((rb.regs[R_MM2S_CH_SCHD_TYPE] & MM2S_SCHD_TYPE_MASK) != MM2S_SCHD_WRR) {
+		return 1;
+	}
+
+	/* 4-bit weights, channels 1-8 in WRR_REG1 and 9-16 in WRR_REG2.  */
+	if (ch < 8) {
+		wrr = rb.regs[R_MM2S_WRR_REG1];
+	} else {
+		wrr = rb.regs[R_MM2S_WRR_REG2];
+	}
+	w = (wrr >> ((ch % 8) * 4)) & 0xf;
+	return w ? w : 1;
+}
 
-			tx_eof = bd.ctrl & (1U << 30);
-			len = bd.ctrl & bitops_mask64(0, 26);
-			dma_load(buf, bd.buffer, len);
+void xilinx_mcdma::mm2s_port_acquire(int ch)
+{
+	if (mm2s_owner < 0) {
+		mm2s_owner = ch;
+		return;
+	}
+
+	mm2s[ch].waiting = true;
+	while (mm2s_owner != ch) {
+		wait(mm2s[ch].ev_grant);
+	}
+}
 
-			D(printf("MM2S: ch%d: push-stream len=%d eof=%d\n", ch, len, tx_eof));
-			D(hexdump("tx-pkt", buf, len));
-			push_stream(ch, buf, len, tx_eof);
+// Hand the port to the next waiting channel, round robin.
+void xilinx_mcdma::mm2s_port_release(int ch)
+{
+	int i;
 
-			bd.status |= 1U << 31;	/* Completed.  */
-			bd.status |= len;
-			mm2s_desc_store(&bd, mm2s_cur(ch));
+	mm2s_owner = -1;
+	for (i = 1; i <= num_channels; i++) {
+		int next = (ch + i) % num_channels;
 
-			D(printf("MM2S: ch%d cur=%lx tail=%lx\n", ch, mm2s_cur(ch), mm2s_tail(ch)));
-			if (mm2s_cur(ch) == mm2s_tail(ch)) {
+		if (mm2s[next].waiting) {
+			mm2s[next].waiting = false;
+			mm2s_owner = next;
+			mm2s[next].ev_grant.notify();
+			break;
+		}
+	}
+}
+
+//
+// Fetches up to the weight of the channel of descriptors and their
+// payloads, with the memory port held. Returns how many.
+//
+unsigned int xilinx_mcdma::mm2s_fetch_bds(int ch)
+{
+	struct mm2s_chan *c = &mm2s[ch];
+	unsigned int weight = mm2s_weight(ch);
+	uint64_t addr = mm2s_cur(ch);
+	unsigned int buf_len = 0;
+	unsigned int n;
+
+	for (n = 0; n < weight && mm2s_runnable(ch); n++) {
+		struct mm2s_fetch *f = &c->fetch[n];
+		int len;
+
+		mm2s_desc_load(ch, &f->bd, addr);
+		if (f->bd.status & (1U << 31)) {
+			if (!n) {
 				mm2s_set_idle(ch, true);
 			}
+			break;
+		}
 
-			rb.regs[ch_offset + R_MM2S_CH1CURDESC_LSB] = bd.next;
-			rb.regs[ch_offset + R_MM2S_CH1CURDESC_MSB] = bd.next >> 32;
+		f->addr = addr;
+		len = f->bd.ctrl & bitops_mask64(0, 26);
 
-			tmp = FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1SR], MM2S_CH1SR, IRQ_THRESHOLD);
-			D(printf("MM2S: IRQ threshold = %x\n", tmp));
-			if (tmp == 0 || 1) {
-				tmp = FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1CR], MM2S_CH1CR, IRQ_THRESHOLD);
-				rb.regs[ch_offset + R_MM2S_CH1SR] |= R_MM2S_CH1SR_IOC_IRQ_MASK;
-			} else {
-				tmp--;
+		/* Straight from memory if it offers DMI, otherwise a copy.  */
+		f->data = dmi_ptr(tlm::TLM_READ_COMMAND, f->bd.buffer, len);
+		if (!f->data) {
+			f->buf_pos = buf_len;
+			buf_len += len;
+			if (c->buf.size() < buf_len) {
+				c->buf.resize(buf_len);
 			}
-			FIELD_DP(rb, rb.regs[ch_offset + R_MM2S_CH1SR], MM2S_CH1SR, IRQ_THRESHOLD, tmp);
-			D(printf("MM2S: SR=%x tmp=%x\n", rb.regs[ch_offset + R_MM2S_CH1SR], tmp));
+			dma_load(c->buf.data() + f->buf_pos, f->bd.buffer, len);
+		}
 
-			ev_update_irqs.notify();
-			num_running++;
+		/* Descriptors past the tail don't belong to the DMA.  */
+		if (addr == mm2s_tail(ch)) {
+			n++;
+			break;
 		}
+		addr = f->bd.next;
+	}
+	return n;
+}
 
-		if (!num_running) {
-			wait(ev_dma);
+void xilinx_mcdma::mm2s_complete_bd(int ch, struct mm2s_fetch *f)
+{
+	struct mm2s_chan *c = &mm2s[ch];
+	int ch_offset = CH_OFFSET(ch);
+	unsigned char *data;
+	bool tx_eof;
+	int len;
+
+	tx_eof = f->bd.ctrl & (1U << 30);
+	len = f->bd.ctrl & bitops_mask64(0, 26);
+	data = c->buf.data() + f->buf_pos;
+
+	/*
+	 * The DMI region may have been invalidated while the stream took
+	 * the previous payloads, if so the payload is read again.
+	 */
+	if (f->data) {
+		data = dmi_ptr(tlm::TLM_READ_COMMAND, f->bd.buffer, len);
+		if (!data) {
+			if (c->reload.size() < (unsigned int) len) {
+				c->reload.resize(len);
+			}
+			data = c->reload.data();
+			dma_load(data, f->bd.buffer, len);
 		}
 	}
+
+	D(printf("MM2S: ch%d: push-stream len=%d eof=%d\n", ch, len, tx_eof));
+	D(hexdump("tx-pkt", data, len));
+	push_stream(ch, data, len, tx_eof);
+
+	f->bd.status |= 1U << 31;	/* Completed.  */
+	f->bd.status |= len;
+	mm2s_desc_store(ch, &f->bd, f->addr);
+
+	D(printf("MM2S: ch%d cur=%lx tail=%lx\n", ch, mm2s_cur(ch), mm2s_tail(ch)));
+	if (mm2s_cur(ch) == mm2s_tail(ch)) {
+		mm2s_set_idle(ch, true);
+	}
+
+	rb.regs[ch_offset + R_MM2S_CH1CURDESC_LSB] = f->bd.next;
+	rb.regs[ch_offset + R_MM2S_CH1CURDESC_MSB] = f->bd.next >> 32;
+
+	/* Interrupts count packets.  */
+	if (tx_eof) {
+		irq_complete(ch_offset + R_MM2S_CH1CR, ch_offset + R_MM2S_CH1SR,
+			     c->ev_irq_delay);
+	}
+}
+
+void xilinx_mcdma::mm2s_thread(int ch)
+{
+	while (true) {
+		unsigned int i, n;
+
+		if (!mm2s_runnable(ch)) {
+			wait(mm2s[ch].ev_run);
+			continue;
+		}
+
+		mm2s_port_acquire(ch);
+		n = mm2s_fetch_bds(ch);
+		mm2s_port_release(ch);
+
+		/*
+		 * The port is free while the stream takes the data, a stream
+		 * pushing back doesn't hold up the other channels.
+		 */
+		for (i = 0; i < n; i++) {
+			mm2s_complete_bd(ch, &mm2s[ch].fetch[i]);
+		}
+
+		/* Let the other channels get in line.  */
+		wait(SC_ZERO_TIME);
+	}
 }
 
 void xilinx_mcdma::stream_b_transport(int ch, tlm::tlm_generic_payload& trans, sc_time& delay)
@@ -321,9 +645,9 @@ void xilinx_mcdma::stream_b_transport(int ch, tlm::tlm_generic_payload& trans, s
 	unsigned char *buf = trans.get_data_ptr();
 	int len = trans.get_data_length();
 	int ch_offset = CH_OFFSET(ch);
-	unsigned int tmp;
 	int pos = 0;
 	int bdlen;
+	int n;
 	s2mm_bd bd;
 
 	D(printf("Got packet on ch=%d\n", ch));
@@ -350,24 +674,32 @@ void xilinx_mcdma::stream_b_transport(int ch, tlm::tlm_generic_payload& trans, s
 		}
 
 		/* Process this channel.  */
-		s2mm_desc_load(&bd, s2mm_cur(ch));
-		bdlen = bd.ctrl & bitops_mask64(0, 26);
-		assert(bdlen >= len);
-		dma_store(buf + pos, bd.buffer, len - pos);
-
+		s2mm_desc_load(ch, &bd, s2mm_cur(ch));
 		if (bd.status & (1U << 31)) {
 			s2mm_set_idle(ch, true);
 			goto drop;
 		}
 
+		/* Packets larger than a buffer are scattered over BDs.  */
+		bdlen = bd.ctrl & bitops_mask64(0, 26);
+		if (bdlen == 0) {
+			goto drop;
+		}
+		n = len - pos < bdlen ? len - pos : bdlen;
+		dma_store(buf + pos, bd.buffer, n);
+
 		bd.status = 1U << 31;	/* Completed.  */
-		bd.status |= 1U << 27;	/* SOF.  */
-		bd.status |= 1U << 26;	/* EOF.  */
-		bd.status |= len;
+		if (pos == 0) {
+			bd.status |= 1U << 27;	/* SOF.  */
+		}
+		if (pos + n == len) {
+			bd.status |= 1U << 26;	/* EOF.  */
+		}
+		bd.status |= n;
 		D(printf("S2MM: cur=%lx bd.buffer=%lx bdlen=%d len=%d status=%x offsetof-status=%ld\n",
-			 s2mm_cur(ch), bd.buffer, bdlen, len, bd.status, offsetof(typeof(bd), status)));
-		D(hexdump("rx-pkt", buf + pos, len - pos));
-		s2mm_desc_store(&bd, s2mm_cur(ch));
+			 s2mm_cur(ch), bd.buffer, bdlen, n, bd.status, offsetof(typeof(bd), status)));
+		D(hexdump("rx-pkt", buf + pos, n));
+		s2mm_desc_store(ch, &bd, s2mm_cur(ch));
 
 		D(printf("S2MM: ch%d cur=%lx tail=%lx\n", ch, s2mm_cur(ch), s2mm_tail(ch)));
 		if (s2mm_cur(ch) == s2mm_tail(ch)) {
@@ -377,19 +709,12 @@ void xilinx_mcdma::stream_b_transport(int ch, tlm::tlm_generic_payload& trans, s
 		rb.regs[ch_offset + R_S2MM_CH1CURDESC_LSB] = bd.next;
 		rb.regs[ch_offset + R_S2MM_CH1CURDESC_MSB] = bd.next >> 32;
 
-		tmp = FIELD_EX(rb.regs[ch_offset + R_S2MM_CH1SR], S2MM_CH1SR, IRQ_THRESHOLD);
-		D(printf("S2MM: RX: IRQ threshold = %x\n", tmp));
-		if (tmp == 0 || 1) {
-			tmp = FIELD_EX(rb.regs[ch_offset + R_S2MM_CH1CR], S2MM_CH1CR, IRQ_THRESHOLD);
-			rb.regs[ch_offset + R_S2MM_CH1SR] |= R_S2MM_CH1SR_IOC_IRQ_MASK;
-		} else {
-			tmp--;
+		pos += n;
+		if (pos == len) {
+			irq_complete(ch_offset + R_S2MM_CH1CR,
+				     ch_offset + R_S2MM_CH1SR,
+				     s2mm[ch].ev_irq_delay);
 		}
-		FIELD_DP(rb, rb.regs[ch_offset + R_S2MM_CH1SR], S2MM_CH1SR, IRQ_THRESHOLD, tmp);
-		D(printf("S2MM: SR=%x tmp=%x\n", rb.regs[ch_offset + R_S2MM_CH1SR], tmp));
-
-		ev_update_irqs.notify();
-		pos += len;
 	}
 
 	trans.set_response_status(tlm::TLM_OK_RESPONSE);
@@ -413,22 +738,58 @@ void xilinx_mcdma::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
 		rb.reg_b_transport(trans, delay);
 	} else {
 		switch (regindex) {
-		case R_MM2S_CH1CR...R_MM2S_CH15PKTCOUNT_STAT:
+		case R_MM2S_CH1CR...R_MM2S_CH16PKTCOUNT_STAT:
 			ch = (regindex - R_MM2S_CH1CR) / (0x40 / 4);
 			ch_offset = CH_OFFSET(ch);
 
 			rb.reg_b_transport(trans, delay);
+			if (ch >= num_channels) {
+				break;
+			}
 
 			switch (regindex - ch_offset) {
+			case R_MM2S_CH1CR:
+				irq_config(ch_offset + R_MM2S_CH1CR,
+					   ch_offset + R_MM2S_CH1SR,
+					   mm2s[ch].ev_irq_delay);
+				break;
+			case R_MM2S_CH1CURDESC_LSB:
+			case R_MM2S_CH1CURDESC_MSB:
+				mm2s[ch].bds.len = 0;
+				break;
 			case R_MM2S_CH1TAILDESC_MSB:
+				/* Descriptors past the old tail may have changed.  */
+				mm2s[ch].bds.len = 0;
 				if (FIELD_EX(rb.regs[ch_offset + R_MM2S_CH1CR], MM2S_CH1CR, RS)) {
 					/* Unpause.  */
 					mm2s_set_idle(ch, false);
-					ev_dma.notify();
+					mm2s[ch].ev_run.notify();
 				}
 				break;
 			}
 			break;
+		case R_S2MM_CH1CR...R_S2MM_CH16PKTCOUNT_STAT:
+			ch = (regindex - R_S2MM_CH1CR) / (0x40 / 4);
+			ch_offset = CH_OFFSET(ch);
+
+			rb.reg_b_transport(trans, delay);
+			if (ch >= num_channels) {
+				break;
+			}
+
+			switch (regindex - ch_offset) {
+			case R_S2MM_CH1CR:
+				irq_config(ch_offset + R_S2MM_CH1CR,
+					   ch_offset + R_S2MM_CH1SR,
+					   s2mm[ch].ev_irq_delay);
+				break;
+			case R_S2MM_CH1CURDESC_LSB:
+			case R_S2MM_CH1CURDESC_MSB:
+			case R_S2MM_CH1TAILDESC_MSB:
+				s2mm[ch].bds.len = 0;
+				break;
+			}
+			break;
 		default:
 			rb.reg_b_transport(trans, delay);
 			break;
@@ -21,10 +21,18 @@
  * THE SOFTWARE.
  */
 
+#include <vector>
+
 #include "tlm-extensions/genattr.h"
 #include "utils/regapi.h"
 #include "regs-mcdma.h"
 
+/* Bytes of descriptors read ahead in a single access.  */
+#define MCDMA_BD_PREFETCH_SIZE (8 * 64)
+
+/* Most MM2S descriptors fetched per grant, the WRR weights are 4 bits.  */
+#define MCDMA_MM2S_MAX_WEIGHT 15
+
 class mm2s_bd {
 public:
 	uint64_t next;
@@ -60,17 +68,76 @@ public:
 	sc_in<bool> rst;
 	sc_out<bool> s2mm_irq;
 	sc_out<bool> mm2s_irq;
-	xilinx_mcdma(sc_core::sc_module_name name, int num_channels = 16);
+	//
+	// irq_delay_unit is the time per count of the IRQ_DELAY fields,
+	// 125 cycles of the timer clock.
+	//
+	xilinx_mcdma(sc_core::sc_module_name name, int num_channels = 16,
+			sc_time irq_delay_unit = sc_time(1250, SC_NS));
+	~xilinx_mcdma();
 private:
+	/* Descriptors from cur towards tail, read with one access.  */
+	struct bd_cache {
+		uint64_t addr;
+		unsigned int len;
+		unsigned char data[MCDMA_BD_PREFETCH_SIZE];
+	};
+
+	/* A descriptor and its payload, fetched while holding the port.  */
+	struct mm2s_fetch {
+		uint64_t addr;
+		mm2s_bd bd;
+		/* Straight into memory, or NULL if in buf at buf_pos.  */
+		unsigned char *data;
+		unsigned int buf_pos;
+	};
+
+	struct mm2s_chan {
+		sc_event ev_run;
+		sc_event ev_grant;
+		bool waiting;
+		struct bd_cache bds;
+		struct mm2s_fetch fetch[MCDMA_MM2S_MAX_WEIGHT];
+		/* Bounce buffer for memory without DMI.  */
+		std::vector<unsigned char> buf;
+		/* Payload reloaded when DMI was lost after the fetch.  */
+		std::vector<unsigned char> reload;
+		/* Reused for every transaction on the stream.  */
+		genattr_extension genattr;
+		sc_event ev_irq_delay;
+	};
+
+	struct s2mm_chan {
+		struct bd_cache bds;
+		sc_event ev_irq_delay;
+	};
+
 	int num_channels;
-	sc_event ev_dma;
+	sc_time irq_delay_unit;
 	sc_event ev_update_irqs;
 
+	/* One worker per channel, arbitrating for the memory port.  */
+	struct mm2s_chan *mm2s;
+	int mm2s_owner;
+	struct s2mm_chan *s2mm;
+
+	tlm::tlm_dmi dmi;
+	bool dmi_valid;
+
 	regapi_block<uint32_t, R_S2MM_Channel_Observer_6 + 1 > rb;
 
 	void reset_thread(void);
-	void dma_thread(void);
+	void mm2s_thread(int ch);
+	bool mm2s_runnable(int ch);
+	unsigned int mm2s_fetch_bds(int ch);
+	void mm2s_complete_bd(int ch, struct mm2s_fetch *f);
+	unsigned int mm2s_weight(int ch);
+	void mm2s_port_acquire(int ch);
+	void mm2s_port_release(int ch);
 	void update_irqs(void);
+	void irq_complete(int cr, int sr, sc_event& ev_irq_delay);
+	void irq_delay_expired(int cr, int sr);
+	void irq_config(int cr, int sr, sc_event& ev_irq_delay);
 	uint64_t mm2s_cur(int ch);
 	uint64_t mm2s_tail(int ch);
 	uint64_t s2mm_cur(int ch);
@@ -78,14 +145,20 @@ private:
 	void mm2s_set_idle(int ch, bool idle);
 	void s2mm_set_idle(int ch, bool idle);
 	void push_stream(int ch, unsigned char *buf, int len, bool eop);
-	void dma_access(tlm::tlm_command cmd, unsigned char *buf, uint64_t addr, int len);
+	unsigned char *dmi_ptr(tlm::tlm_command cmd, uint64_t addr, int len);
+	void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end);
+	bool dma_access(tlm::tlm_command cmd, unsigned char *buf, uint64_t addr, int len);
 	void dma_load(unsigned char *buf, uint64_t addr, int len);
 	void dma_store(unsigned char *buf, uint64_t addr, int len);
 
-	void mm2s_desc_load(mm2s_bd *bd, uint64_t addr);
-	void mm2s_desc_store(mm2s_bd *bd, uint64_t addr);
-	void s2mm_desc_load(s2mm_bd *bd, uint64_t addr);
-	void s2mm_desc_store(s2mm_bd *bd, uint64_t addr);
+	void desc_load(struct bd_cache *c, unsigned char *bd, int size,
+			uint64_t addr, uint64_t tail);
+	void desc_store(struct bd_cache *c, unsigned char *bd, int size,
+			uint64_t addr);
+	void mm2s_desc_load(int ch, mm2s_bd *bd, uint64_t addr);
+	void mm2s_desc_store(int ch, mm2s_bd *bd, uint64_t addr);
+	void s2mm_desc_load(int ch, s2mm_bd *bd, uint64_t addr);
+	void s2mm_desc_store(int ch, s2mm_bd *bd, uint64_t addr);
 	virtual void stream_b_transport(int id, tlm::tlm_generic_payload& trans, sc_time& delay);
 	virtual void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
 };
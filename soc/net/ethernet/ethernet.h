@@ -29,6 +29,8 @@
 #include <inttypes.h>
 
 #define ETH_ADDR_LEN	6
+#define ETH_HDR_LEN	(ETH_ADDR_LEN * 2 + 2)
+#define ETH_FCS_LEN	4
 
 /* Type/Protocols. */
 #define ETH_HDR_TYPE_IP		0x0800
@@ -0,0 +1,204 @@
+/*
+ * Pool of reference counted Ethernet frames.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * Frames are generic payloads owned by the pool (the TLM memory manager)
+ * with their data buffer and a genattr extension attached. They follow the
+ * TLM-2.0 reference counting rules:
+ *
+ *  - alloc() returns a frame with a reference held by the caller.
+ *  - A module that needs a frame after b_transport returns (e.g to queue
+ *    it) calls get(), which takes a reference on frames of a pool and only
+ *    copies other payloads into a new frame.
+ *  - Every reference is dropped with release(), the frame goes back to the
+ *    pool with the last one.
+ *
+ * Frames passed by reference are not modified by the receivers, a receiver
+ * that needs to change the data works on its own frame.
+ *
+ * The buffers are never shrunk, so after the first few frames the pool
+ * stops allocating.
+ */
+
+#ifndef SOC_NET_ETHERNET_FRAME_POOL_H__
+#define SOC_NET_ETHERNET_FRAME_POOL_H__
+
+#include <vector>
+
+#include "tlm.h"
+#include "tlm-extensions/genattr.h"
+#include "utils/bytecopy.h"
+
+class eth_frame_pool : public tlm::tlm_mm_interface
+{
+public:
+	// Initial size of the frame buffers, a jumbo frame and its FCS.
+	enum { FRAME_SIZE = 9216 + 4 };
+
+	eth_frame_pool() {}
+
+	~eth_frame_pool()
+	{
+		unsigned int i;
+
+		for (i = 0; i < frames.size(); i++) {
+			// The genattr is deleted with the payload.
+			delete frames[i];
+		}
+	}
+
+	// The pool shared by the Ethernet models.
+	static eth_frame_pool& shared()
+	{
+		static eth_frame_pool pool;
+
+		return pool;
+	}
+
+	//
+	// A write of len bytes (room for at least FRAME_SIZE) with the EOP
+	// set, the caller holds a reference.
+	//
+	tlm::tlm_generic_payload *alloc(unsigned int len)
+	{
+		frame *f;
+
+		if (free_frames.empty()) {
+			f = new frame();
+			f->set_mm(this);
+			f->set_extension(f->attr);
+			frames.push_back(f);
+		} else {
+			f = free_frames.back();
+			free_frames.pop_back();
+		}
+
+		f->setup(len);
+		f->acquire();
+		return f;
+	}
+
+	//
+	// Makes room for len bytes in a frame from alloc(), keeping its
+	// data. Returns the (possibly moved) data pointer, the data length
+	// is left untouched.
+	//
+	unsigned char *grow(tlm::tlm_generic_payload *gp, unsigned int len)
+	{
+		frame *f = static_cast<frame *>(gp);
+
+		if (f->buf.size() < len) {
+			f->buf.resize(len);
+			f->set_data_ptr(f->buf.data());
+		}
+		return f->buf.data();
+	}
+
+	//
+	// Returns trans with a reference taken if it's a frame of a pool,
+	// otherwise a copy of the data and genattr in a new frame.
+	//
+	tlm::tlm_generic_payload *get(tlm::tlm_generic_payload& trans)
+	{
+		tlm::tlm_generic_payload *gp;
+		genattr_extension *genattr;
+		unsigned int len = trans.get_data_length();
+
+		if (is_frame(trans)) {
+			trans.acquire();
+			return &trans;
+		}
+
+		gp = alloc(len);
+		bytecopy_be(gp->get_data_ptr(), trans.get_data_ptr(), len,
+				trans.get_byte_enable_ptr(),
+				trans.get_byte_enable_length());
+
+		trans.get_extension(genattr);
+		if (genattr) {
+			attr(gp)->copy_from(*genattr);
+		}
+		return gp;
+	}
+
+	// Whether the payload is a frame of a pool.
+	static bool is_frame(tlm::tlm_generic_payload& trans)
+	{
+		return trans.has_mm() &&
+			dynamic_cast<eth_frame_pool *>(trans.get_mm()) != NULL;
+	}
+
+	// The genattr of a frame, always attached.
+	static genattr_extension *attr(tlm::tlm_generic_payload *gp)
+	{
+		return static_cast<frame *>(gp)->attr;
+	}
+
+	// Called by the last release().
+	void free(tlm::tlm_generic_payload *gp)
+	{
+		frame *f = static_cast<frame *>(gp);
+
+		// Drops the extensions other modules handed to the payload.
+		f->reset();
+		free_frames.push_back(f);
+	}
+
+private:
+	class frame : public tlm::tlm_generic_payload
+	{
+	public:
+		std::vector<unsigned char> buf;
+		genattr_extension *attr;
+
+		frame() :
+			buf(FRAME_SIZE),
+			attr(new genattr_extension())
+		{}
+
+		void setup(unsigned int len)
+		{
+			if (buf.size() < len) {
+				buf.resize(len);
+			}
+
+			set_command(tlm::TLM_WRITE_COMMAND);
+			set_address(0);
+			set_data_ptr(buf.data());
+			set_data_length(len);
+			set_streaming_width(len);
+			set_byte_enable_ptr(NULL);
+			set_byte_enable_length(0);
+			set_dmi_allowed(false);
+			set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+			attr->copy_from(genattr_extension());
+			attr->set_eop(true);
+		}
+	};
+
+	std::vector<frame *> frames;
+	std::vector<frame *> free_frames;
+};
+
+#endif
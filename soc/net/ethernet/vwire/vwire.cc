@@ -0,0 +1,447 @@
+/*
+ * Virtual wire Ethernet backend.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "systemc.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "soc/net/ethernet/vwire/vwire.h"
+
+#define UNIX_PREFIX "unix:"
+#define UNIX_LISTEN_PREFIX "unix-listen:"
+#define PCAP_PREFIX "pcap:"
+
+// pcap with nanosecond timestamps.
+#define PCAP_MAGIC_NS		0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET	1
+
+#define SOCKET_BUF_SIZE		(4 * 1024 * 1024)
+// Until the listening peer is up.
+#define CONNECT_RETRY_US	(10 * 1000)
+
+static uint64_t sc_time_to_ps(const sc_time& t)
+{
+	return t / sc_time(1, SC_PS);
+}
+
+static bool has_prefix(const char *s, const char *prefix)
+{
+	return s && !strncmp(s, prefix, strlen(prefix));
+}
+
+static void *rx_trampoline(void *arg) {
+	eth_vwire *w = (eth_vwire *)(arg);
+
+	w->rx_main();
+	return NULL;
+}
+
+eth_vwire::eth_vwire(sc_module_name name, const char *descr, int fd) :
+	sc_module(name),
+	tx_socket("tx_socket"),
+	rx_socket("rx_socket"),
+	descr(descr),
+	pool(eth_frame_pool::shared()),
+	fd(fd),
+	pcap(NULL),
+	tx_num(0),
+	tx_dropped(0),
+	rx_slots(ETH_VWIRE_RX_SLOTS),
+	rx_head(0),
+	rx_tail(0),
+	rx_thread_started(false),
+	rx_event(NULL)
+{
+	tx_socket.register_b_transport(this, &eth_vwire::b_transport);
+
+	pthread_mutex_init(&rx_mutex, NULL);
+	pthread_cond_init(&rx_cond, NULL);
+
+	if (fd < 0 && has_prefix(descr, PCAP_PREFIX)) {
+		if (!pcap_open(descr + strlen(PCAP_PREFIX))) {
+			perror(descr);
+			SC_REPORT_FATAL("eth-vwire", "Failed to open the pcap file");
+		}
+	} else if (fd >= 0 || has_prefix(descr, UNIX_PREFIX) ||
+		   has_prefix(descr, UNIX_LISTEN_PREFIX)) {
+		// The connection is set up by the host thread, the
+		// simulation doesn't wait for the peer.
+		rx_event = new async_event("rx-ev");
+		pthread_create(&rx_thread_id, NULL, rx_trampoline, this);
+		rx_thread_started = true;
+	} else {
+		SC_REPORT_FATAL("eth-vwire", "Unknown backend descriptor");
+	}
+
+	SC_METHOD(tx_flush);
+	sensitive << tx_flush_ev;
+	dont_initialize();
+
+	SC_THREAD(rx_thread);
+}
+
+eth_vwire::~eth_vwire()
+{
+	if (rx_thread_started) {
+		pthread_cancel(rx_thread_id);
+		pthread_join(rx_thread_id, NULL);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	if (pcap) {
+		fclose(pcap);
+	}
+	delete rx_event;
+}
+
+// Wait for the peer on path (unix-listen:) or connect to the peer listening
+// on path (unix:), retrying until it is up.
+int eth_vwire::sk_open(void)
+{
+	struct sockaddr_un addr;
+	int bufsize = SOCKET_BUF_SIZE;
+	bool listening = has_prefix(descr, UNIX_LISTEN_PREFIX);
+	const char *path;
+	int sfd, nfd;
+
+	path = descr + strlen(listening ? UNIX_LISTEN_PREFIX : UNIX_PREFIX);
+
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof addr.sun_path - 1);
+
+	if (listening) {
+		sfd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+		if (sfd < 0) {
+			return -1;
+		}
+
+		// A stale socket from an earlier run.
+		unlink(addr.sun_path);
+		if (bind(sfd, (struct sockaddr *)&addr, sizeof addr) < 0 ||
+		    listen(sfd, 1) < 0) {
+			close(sfd);
+			return -1;
+		}
+
+		nfd = accept(sfd, NULL, NULL);
+		close(sfd);
+		sfd = nfd;
+		if (sfd < 0) {
+			return -1;
+		}
+	} else {
+		while (true) {
+			int err;
+
+			sfd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+			if (sfd < 0) {
+				return -1;
+			}
+
+			if (connect(sfd, (struct sockaddr *)&addr,
+				    sizeof addr) == 0) {
+				break;
+			}
+
+			err = errno;
+			close(sfd);
+			if (err != ENOENT && err != ECONNREFUSED) {
+				errno = err;
+				return -1;
+			}
+			usleep(CONNECT_RETRY_US);
+		}
+	}
+
+	// Best effort, room for bursts at line rate.
+	setsockopt(sfd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof bufsize);
+	setsockopt(sfd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof bufsize);
+	return sfd;
+}
+
+bool eth_vwire::pcap_open(const char *path)
+{
+	struct {
+		uint32_t magic;
+		uint16_t version_major;
+		uint16_t version_minor;
+		int32_t thiszone;
+		uint32_t sigfigs;
+		uint32_t snaplen;
+		uint32_t linktype;
+	} hdr = {
+		PCAP_MAGIC_NS, 2, 4, 0, 0,
+		ETH_VWIRE_FRAME_MAX, PCAP_LINKTYPE_ETHERNET
+	};
+
+	pcap = fopen(path, "wb");
+	if (!pcap) {
+		return false;
+	}
+	return fwrite(&hdr, sizeof hdr, 1, pcap) == 1;
+}
+
+void eth_vwire::pcap_write(tlm::tlm_generic_payload *gp, uint64_t timestamp)
+{
+	uint32_t len = gp->get_data_length();
+	uint64_t ns = timestamp / 1000;
+	uint32_t rec[4] = {
+		(uint32_t)(ns / 1000000000), (uint32_t)(ns % 1000000000),
+		len, len
+	};
+
+	fwrite(rec, sizeof rec, 1, pcap);
+	fwrite(gp->get_data_ptr(), len, 1, pcap);
+}
+
+void eth_vwire::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+{
+	if (trans.get_data_length() > ETH_VWIRE_FRAME_MAX) {
+		SC_REPORT_WARNING("eth-vwire", "Frame too large. Dropped\n");
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+		return;
+	}
+
+	if (tx_num == ETH_VWIRE_BATCH) {
+		tx_flush();
+	}
+
+	// Held by reference until the batch is sent.
+	tx_hdr[tx_num].timestamp = sc_time_to_ps(sc_time_stamp() + delay);
+	tx_frames[tx_num++] = pool.get(trans);
+
+	// The frames of this delta cycle go out together.
+	tx_flush_ev.notify(SC_ZERO_TIME);
+	trans.set_response_status(tlm::TLM_OK_RESPONSE);
+}
+
+void eth_vwire::tx_flush(void)
+{
+	struct mmsghdr msgs[ETH_VWIRE_BATCH];
+	struct iovec iov[ETH_VWIRE_BATCH][2];
+	unsigned int sent = 0;
+	unsigned int i;
+	int sfd;
+
+	if (pcap) {
+		for (i = 0; i < tx_num; i++) {
+			pcap_write(tx_frames[i], tx_hdr[i].timestamp);
+		}
+		sent = tx_num;
+	} else {
+		pthread_mutex_lock(&rx_mutex);
+		sfd = fd;
+		pthread_mutex_unlock(&rx_mutex);
+
+		memset(msgs, 0, sizeof(msgs[0]) * tx_num);
+		for (i = 0; i < tx_num; i++) {
+			iov[i][0].iov_base = &tx_hdr[i];
+			iov[i][0].iov_len = sizeof tx_hdr[i];
+			iov[i][1].iov_base = tx_frames[i]->get_data_ptr();
+			iov[i][1].iov_len = tx_frames[i]->get_data_length();
+			msgs[i].msg_hdr.msg_iov = iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		}
+
+		// Without a peer, or when the peer can't keep up, frames
+		// are lost as on a real wire.
+		while (sfd >= 0 && sent < tx_num) {
+			int r = sendmmsg(sfd, msgs + sent, tx_num - sent,
+					 MSG_DONTWAIT | MSG_NOSIGNAL);
+
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno != EAGAIN && errno != EWOULDBLOCK &&
+				    errno != EPIPE) {
+					perror("eth-vwire: sendmmsg");
+				}
+				break;
+			}
+			sent += r;
+		}
+	}
+
+	tx_dropped += tx_num - sent;
+	for (i = 0; i < tx_num; i++) {
+		tx_frames[i]->release();
+	}
+	tx_num = 0;
+}
+
+void eth_vwire::rx_main(void)
+{
+	struct mmsghdr msgs[ETH_VWIRE_BATCH];
+	struct iovec iov[ETH_VWIRE_BATCH][2];
+	int sfd = fd;
+
+	if (sfd < 0) {
+		sfd = sk_open();
+		if (sfd < 0) {
+			perror(descr);
+			return;
+		}
+
+		pthread_mutex_lock(&rx_mutex);
+		fd = sfd;
+		pthread_mutex_unlock(&rx_mutex);
+	}
+
+	while (true) {
+		unsigned int head;
+		unsigned int n;
+		unsigned int i;
+		bool eof = false;
+		int r;
+
+		// Wait for free slots.
+		pthread_mutex_lock(&rx_mutex);
+		while (rx_head - rx_tail == ETH_VWIRE_RX_SLOTS) {
+			pthread_cond_wait(&rx_cond, &rx_mutex);
+		}
+		head = rx_head;
+		n = ETH_VWIRE_RX_SLOTS - (rx_head - rx_tail);
+		pthread_mutex_unlock(&rx_mutex);
+
+		if (n > ETH_VWIRE_BATCH) {
+			n = ETH_VWIRE_BATCH;
+		}
+
+		memset(msgs, 0, sizeof(msgs[0]) * n);
+		for (i = 0; i < n; i++) {
+			struct rx_slot *s;
+
+			s = &rx_slots[(head + i) % ETH_VWIRE_RX_SLOTS];
+			iov[i][0].iov_base = &s->hdr;
+			iov[i][0].iov_len = sizeof s->hdr;
+			iov[i][1].iov_base = s->data;
+			iov[i][1].iov_len = sizeof s->data;
+			msgs[i].msg_hdr.msg_iov = iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		}
+
+		// Blocks for the first frame and takes what else is queued.
+		r = recvmmsg(sfd, msgs, n, MSG_WAITFORONE, NULL);
+		if (r < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("eth-vwire: recvmmsg");
+			break;
+		}
+
+		for (i = 0; i < (unsigned int) r; i++) {
+			struct rx_slot *s;
+			unsigned int len = msgs[i].msg_len;
+
+			s = &rx_slots[(head + i) % ETH_VWIRE_RX_SLOTS];
+			if (len == 0) {
+				// The peer went away.
+				eof = true;
+				r = i;
+				break;
+			}
+
+			// Runts and truncated frames are delivered as empty
+			// slots and skipped.
+			if (len < sizeof s->hdr ||
+			    (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+				s->len = 0;
+			} else {
+				s->len = len - sizeof s->hdr;
+			}
+		}
+
+		pthread_mutex_lock(&rx_mutex);
+		rx_head += r;
+		pthread_mutex_unlock(&rx_mutex);
+		rx_event->notify();
+
+		if (eof) {
+			break;
+		}
+	}
+}
+
+void eth_vwire::rx_thread(void)
+{
+	if (!rx_event) {
+		return;
+	}
+
+	while (true) {
+		unsigned int head;
+
+		pthread_mutex_lock(&rx_mutex);
+		head = rx_head;
+		pthread_mutex_unlock(&rx_mutex);
+
+		if (rx_tail == head) {
+			wait(*rx_event);
+			continue;
+		}
+
+		for (; rx_tail != head; ) {
+			struct rx_slot *s;
+
+			s = &rx_slots[rx_tail % ETH_VWIRE_RX_SLOTS];
+			if (s->len) {
+				sc_time ts((double) s->hdr.timestamp, SC_PS);
+				sc_time delay = SC_ZERO_TIME;
+				tlm::tlm_generic_payload *gp;
+
+				// A peer ahead of us in time has its frames
+				// delivered at their timestamp.
+				if (ts > sc_time_stamp()) {
+					wait(ts - sc_time_stamp());
+				}
+
+				gp = pool.alloc(s->len);
+				memcpy(gp->get_data_ptr(), s->data, s->len);
+				rx_socket->b_transport(*gp, delay);
+				gp->release();
+			}
+
+			pthread_mutex_lock(&rx_mutex);
+			rx_tail++;
+			pthread_cond_signal(&rx_cond);
+			pthread_mutex_unlock(&rx_mutex);
+		}
+	}
+}
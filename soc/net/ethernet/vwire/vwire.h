@@ -0,0 +1,115 @@
+/*
+ * Virtual wire Ethernet backend.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef SOC_NET_ETHERNET_VWIRE_H__
+#define SOC_NET_ETHERNET_VWIRE_H__
+
+#include <pthread.h>
+#include <stdio.h>
+#include <vector>
+
+#include "tlm-extensions/genattr.h"
+#include "utils/async_event.h"
+#include "soc/net/ethernet/frame-pool.h"
+
+// Frames sent or received with a single syscall.
+#define ETH_VWIRE_BATCH		32
+// Received frames waiting to be delivered to the simulation.
+#define ETH_VWIRE_RX_SLOTS	256
+#define ETH_VWIRE_FRAME_MAX	(9216 + 4)
+
+// Precedes every frame on the wire, in host byte order.
+struct eth_vwire_hdr {
+	// Simulation time (ps) at which the frame was sent.
+	uint64_t timestamp;
+};
+
+SC_MODULE(eth_vwire)
+{
+public:
+	SC_HAS_PROCESS(eth_vwire);
+
+	// Frames from the MAC (or PHY bridge), sent to the peer.
+	tlm_utils::simple_target_socket<eth_vwire> tx_socket;
+	// Frames from the peer.
+	tlm_utils::simple_initiator_socket<eth_vwire> rx_socket;
+
+	//
+	// descr is one of:
+	//   unix-listen:<path>  AF_UNIX SOCK_SEQPACKET to another simulation,
+	//                       waits for the peer to connect on path.
+	//   unix:<path>         Connects to the peer listening on path,
+	//                       retrying until it is up.
+	//   pcap:<file>         Sent frames are written to a pcap file.
+	// An already connected SOCK_SEQPACKET socket can be passed with fd
+	// instead (descr NULL).
+	//
+	eth_vwire(sc_core::sc_module_name name, const char *descr,
+		  int fd = -1);
+	~eth_vwire();
+
+private:
+	struct rx_slot {
+		struct eth_vwire_hdr hdr;
+		unsigned char data[ETH_VWIRE_FRAME_MAX];
+		unsigned int len;
+	};
+
+	const char *descr;
+	eth_frame_pool& pool;
+	int fd;
+	FILE *pcap;
+
+	// Frames sent during the current delta cycle.
+	tlm::tlm_generic_payload *tx_frames[ETH_VWIRE_BATCH];
+	struct eth_vwire_hdr tx_hdr[ETH_VWIRE_BATCH];
+	unsigned int tx_num;
+	sc_event tx_flush_ev;
+	uint64_t tx_dropped;
+
+	// Written by the host thread at rx_head, read by the simulation at
+	// rx_tail.
+	std::vector<struct rx_slot> rx_slots;
+	unsigned int rx_head;
+	unsigned int rx_tail;
+	pthread_mutex_t rx_mutex;
+	pthread_cond_t rx_cond;
+	pthread_t rx_thread_id;
+	bool rx_thread_started;
+	// Only with a socket, pcap files don't keep the simulation alive.
+	async_event *rx_event;
+
+	int sk_open(void);
+	bool pcap_open(const char *path);
+	void pcap_write(tlm::tlm_generic_payload *gp, uint64_t timestamp);
+
+	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
+	void tx_flush(void);
+	void rx_thread(void);
+
+public:
+	// Host thread, connects and receives frames.
+	void rx_main(void);
+};
+
+#endif
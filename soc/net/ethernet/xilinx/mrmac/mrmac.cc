@@ -50,7 +50,10 @@ xilinx_mrmac::xilinx_mrmac(sc_core::sc_module_name name, bool insert_rx_crc) :
 	reg_socket("reg_socket"),
 	rst("rst"),
 	rb("regs", mrmac_reginfo),
+	pool(eth_frame_pool::shared()),
 	rxfifo("rxfifo", 2),
+	txframe(NULL),
+	txbuf(NULL),
 	txpos(0)
 {
 	mac_tx_socket.register_b_transport(this, &xilinx_mrmac::mac_b_transport);
@@ -58,6 +61,7 @@ xilinx_mrmac::xilinx_mrmac(sc_core::sc_module_name name, bool insert_rx_crc) :
 	reg_socket.register_b_transport(this, &xilinx_mrmac::reg_b_transport);
 
 	memset(&stats, 0, sizeof(stats));
+	stats_latch_pending = false;
 
 	cfg.insert_rx_crc = insert_rx_crc;
 
@@ -72,29 +76,20 @@ void xilinx_mrmac::reset_thread() {
 		// Reset all the registers.  */
 		rb.reg_reset_all();
 		memset(&stats, 0, sizeof(stats));
+		stats_latch_pending = false;
 	}
 }
 
-void xilinx_mrmac::push_stream(unsigned char *buf, int len, bool eop)
+void xilinx_mrmac::push_stream(tlm::tlm_generic_payload *gp, int len)
 {
-        genattr_extension *genattr = new genattr_extension();
-        sc_time delay = SC_ZERO_TIME;
-        tlm::tlm_generic_payload tr;
+	sc_time delay = SC_ZERO_TIME;
 
-        tr.set_command(tlm::TLM_WRITE_COMMAND);
-        tr.set_address(0);
-        tr.set_data_ptr(buf);
-        tr.set_data_length(len);
-        tr.set_streaming_width(len);
-        tr.set_dmi_allowed(false);
-        tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+	// The PHY side takes a reference if it needs the frame later.
+	gp->set_data_length(len);
+	gp->set_streaming_width(len);
+	eth_frame_pool::attr(gp)->set_eop(true);
 
-        genattr->set_eop(eop);
-        tr.set_extension(genattr);
-
-        phy_tx_socket->b_transport(tr, delay);
-
-        tr.release_extension(genattr);
+	phy_tx_socket->b_transport(*gp, delay);
 }
 
 void xilinx_mrmac::stats_update_tx_hist(int len) {
@@ -161,64 +156,76 @@ void xilinx_mrmac::stats_update_rx_hist(int len) {
 	}
 }
 
-void xilinx_mrmac::tick(void) {
+void xilinx_mrmac::stats_latch(void) {
 	// Tx.
-	stats_update64(R_STAT_TX_TOTAL_PACKETS_0_LSB, stats.tx.total_packets);
-	stats_update64(R_STAT_TX_TOTAL_GOOD_PACKETS_0_LSB, stats.tx.total_good_packets);
-	stats_update64(R_STAT_TX_TOTAL_BYTES_0_LSB, stats.tx.total_bytes);
-	stats_update64(R_STAT_TX_TOTAL_GOOD_BYTES_0_LSB, stats.tx.total_good_bytes);
-
-	stats_update64(R_STAT_TX_PACKET_64_BYTES_0_LSB, stats.tx.packet_64);
-	stats_update64(R_STAT_TX_PACKET_65_127_BYTES_0_LSB, stats.tx.packet_65_127);
-	stats_update64(R_STAT_TX_PACKET_128_255_BYTES_0_LSB, stats.tx.packet_128_255);
-	stats_update64(R_STAT_TX_PACKET_256_511_BYTES_0_LSB, stats.tx.packet_256_511);
-	stats_update64(R_STAT_TX_PACKET_512_1023_BYTES_0_LSB, stats.tx.packet_512_1023);
-	stats_update64(R_STAT_TX_PACKET_1024_1518_BYTES_0_LSB, stats.tx.packet_1024_1518);
-	stats_update64(R_STAT_TX_PACKET_1519_1522_BYTES_0_LSB, stats.tx.packet_1519_1522);
-	stats_update64(R_STAT_TX_PACKET_1523_1548_BYTES_0_LSB, stats.tx.packet_1523_1548);
-	stats_update64(R_STAT_TX_PACKET_1549_2047_BYTES_0_LSB, stats.tx.packet_1549_2047);
-	stats_update64(R_STAT_TX_PACKET_2048_4095_BYTES_0_LSB, stats.tx.packet_2048_4095);
-	stats_update64(R_STAT_TX_PACKET_4096_8191_BYTES_0_LSB, stats.tx.packet_4096_8191);
-	stats_update64(R_STAT_TX_PACKET_8192_9215_BYTES_0_LSB, stats.tx.packet_8192_9215);
-	stats_update64(R_STAT_TX_PACKET_LARGE_0_LSB, stats.tx.packet_large);
-	stats_update64(R_STAT_TX_PACKET_SMALL_0_LSB, stats.tx.packet_small);
-
-	stats_update64(R_STAT_TX_BAD_FCS_0_LSB, stats.tx.bad_fcs);
-
-	stats_update64(R_STAT_TX_UNICAST_0_LSB, stats.tx.unicast);
-	stats_update64(R_STAT_TX_MULTICAST_0_LSB, stats.tx.multicast);
-	stats_update64(R_STAT_TX_BROADCAST_0_LSB, stats.tx.broadcast);
-	stats_update64(R_STAT_TX_VLAN_0_LSB, stats.tx.vlan);
-	stats_update64(R_STAT_TX_PAUSE_0_LSB, stats.tx.pause);
+	stats_update48(R_STAT_TX_TOTAL_PACKETS_0_LSB, stats_latched.tx.total_packets);
+	stats_update48(R_STAT_TX_TOTAL_GOOD_PACKETS_0_LSB, stats_latched.tx.total_good_packets);
+	stats_update64(R_STAT_TX_TOTAL_BYTES_0_LSB, stats_latched.tx.total_bytes);
+	stats_update64(R_STAT_TX_TOTAL_GOOD_BYTES_0_LSB, stats_latched.tx.total_good_bytes);
+
+	stats_update48(R_STAT_TX_PACKET_64_BYTES_0_LSB, stats_latched.tx.packet_64);
+	stats_update48(R_STAT_TX_PACKET_65_127_BYTES_0_LSB, stats_latched.tx.packet_65_127);
+	stats_update48(R_STAT_TX_PACKET_128_255_BYTES_0_LSB, stats_latched.tx.packet_128_255);
+	stats_update48(R_STAT_TX_PACKET_256_511_BYTES_0_LSB, stats_latched.tx.packet_256_511);
+	stats_update48(R_STAT_TX_PACKET_512_1023_BYTES_0_LSB, stats_latched.tx.packet_512_1023);
+	stats_update48(R_STAT_TX_PACKET_1024_1518_BYTES_0_LSB, stats_latched.tx.packet_1024_1518);
+	stats_update48(R_STAT_TX_PACKET_1519_1522_BYTES_0_LSB, stats_latched.tx.packet_1519_1522);
+	stats_update48(R_STAT_TX_PACKET_1523_1548_BYTES_0_LSB, stats_latched.tx.packet_1523_1548);
+	stats_update48(R_STAT_TX_PACKET_1549_2047_BYTES_0_LSB, stats_latched.tx.packet_1549_2047);
+	stats_update48(R_STAT_TX_PACKET_2048_4095_BYTES_0_LSB, stats_latched.tx.packet_2048_4095);
+	stats_update48(R_STAT_TX_PACKET_4096_8191_BYTES_0_LSB, stats_latched.tx.packet_4096_8191);
+	stats_update48(R_STAT_TX_PACKET_8192_9215_BYTES_0_LSB, stats_latched.tx.packet_8192_9215);
+	stats_update48(R_STAT_TX_PACKET_LARGE_0_LSB, stats_latched.tx.packet_large);
+	stats_update48(R_STAT_TX_PACKET_SMALL_0_LSB, stats_latched.tx.packet_small);
+
+	stats_update48(R_STAT_TX_BAD_FCS_0_LSB, stats_latched.tx.bad_fcs);
+
+	stats_update48(R_STAT_TX_UNICAST_0_LSB, stats_latched.tx.unicast);
+	stats_update48(R_STAT_TX_MULTICAST_0_LSB, stats_latched.tx.multicast);
+	stats_update48(R_STAT_TX_BROADCAST_0_LSB, stats_latched.tx.broadcast);
+	stats_update48(R_STAT_TX_VLAN_0_LSB, stats_latched.tx.vlan);
+	stats_update48(R_STAT_TX_PAUSE_0_LSB, stats_latched.tx.pause);
 
 	// Rx.
-	stats_update64(R_STAT_RX_TOTAL_PACKETS_0_LSB, stats.rx.total_packets);
-	stats_update64(R_STAT_RX_TOTAL_GOOD_PACKETS_0_LSB, stats.rx.total_good_packets);
-	stats_update64(R_STAT_RX_TOTAL_BYTES_0_LSB, stats.rx.total_bytes);
-	stats_update64(R_STAT_RX_TOTAL_GOOD_BYTES_0_LSB, stats.rx.total_good_bytes);
-
-	stats_update64(R_STAT_RX_PACKET_64_BYTES_0_LSB, stats.rx.packet_64);
-	stats_update64(R_STAT_RX_PACKET_65_127_BYTES_0_LSB, stats.rx.packet_65_127);
-	stats_update64(R_STAT_RX_PACKET_128_255_BYTES_0_LSB, stats.rx.packet_128_255);
-	stats_update64(R_STAT_RX_PACKET_256_511_BYTES_0_LSB, stats.rx.packet_256_511);
-	stats_update64(R_STAT_RX_PACKET_512_1023_BYTES_0_LSB, stats.rx.packet_512_1023);
-	stats_update64(R_STAT_RX_PACKET_1024_1518_BYTES_0_LSB, stats.rx.packet_1024_1518);
-	stats_update64(R_STAT_RX_PACKET_1519_1522_BYTES_0_LSB, stats.rx.packet_1519_1522);
-	stats_update64(R_STAT_RX_PACKET_1523_1548_BYTES_0_LSB, stats.rx.packet_1523_1548);
-	stats_update64(R_STAT_RX_PACKET_1549_2047_BYTES_0_LSB, stats.rx.packet_1549_2047);
-	stats_update64(R_STAT_RX_PACKET_2048_4095_BYTES_0_LSB, stats.rx.packet_2048_4095);
-	stats_update64(R_STAT_RX_PACKET_4096_8191_BYTES_0_LSB, stats.rx.packet_4096_8191);
-	stats_update64(R_STAT_RX_PACKET_8192_9215_BYTES_0_LSB, stats.rx.packet_8192_9215);
-	stats_update64(R_STAT_RX_PACKET_LARGE_0_LSB, stats.rx.packet_large);
-	stats_update64(R_STAT_RX_PACKET_SMALL_0_LSB, stats.rx.packet_small);
-
-	stats_update64(R_STAT_RX_BAD_FCS_0_LSB, stats.rx.bad_fcs);
-
-	stats_update64(R_STAT_RX_UNICAST_0_LSB, stats.rx.unicast);
-	stats_update64(R_STAT_RX_MULTICAST_0_LSB, stats.rx.multicast);
-	stats_update64(R_STAT_RX_BROADCAST_0_LSB, stats.rx.broadcast);
-	stats_update64(R_STAT_RX_VLAN_0_LSB, stats.rx.vlan);
-	stats_update64(R_STAT_RX_PAUSE_0_LSB, stats.rx.pause);
+	stats_update48(R_STAT_RX_TOTAL_PACKETS_0_LSB, stats_latched.rx.total_packets);
+	stats_update48(R_STAT_RX_TOTAL_GOOD_PACKETS_0_LSB, stats_latched.rx.total_good_packets);
+	stats_update64(R_STAT_RX_TOTAL_BYTES_0_LSB, stats_latched.rx.total_bytes);
+	stats_update64(R_STAT_RX_TOTAL_GOOD_BYTES_0_LSB, stats_latched.rx.total_good_bytes);
+
+	stats_update48(R_STAT_RX_PACKET_64_BYTES_0_LSB, stats_latched.rx.packet_64);
+	stats_update48(R_STAT_RX_PACKET_65_127_BYTES_0_LSB, stats_latched.rx.packet_65_127);
+	stats_update48(R_STAT_RX_PACKET_128_255_BYTES_0_LSB, stats_latched.rx.packet_128_255);
+	stats_update48(R_STAT_RX_PACKET_256_511_BYTES_0_LSB, stats_latched.rx.packet_256_511);
+	stats_update48(R_STAT_RX_PACKET_512_1023_BYTES_0_LSB, stats_latched.rx.packet_512_1023);
+	stats_update48(R_STAT_RX_PACKET_1024_1518_BYTES_0_LSB, stats_latched.rx.packet_1024_1518);
+	stats_update48(R_STAT_RX_PACKET_1519_1522_BYTES_0_LSB, stats_latched.rx.packet_1519_1522);
+	stats_update48(R_STAT_RX_PACKET_1523_1548_BYTES_0_LSB, stats_latched.rx.packet_1523_1548);
+	stats_update48(R_STAT_RX_PACKET_1549_2047_BYTES_0_LSB, stats_latched.rx.packet_1549_2047);
+	stats_update48(R_STAT_RX_PACKET_2048_4095_BYTES_0_LSB, stats_latched.rx.packet_2048_4095);
+	stats_update48(R_STAT_RX_PACKET_4096_8191_BYTES_0_LSB, stats_latched.rx.packet_4096_8191);
+	stats_update48(R_STAT_RX_PACKET_8192_9215_BYTES_0_LSB, stats_latched.rx.packet_8192_9215);
+	stats_update48(R_STAT_RX_PACKET_LARGE_0_LSB, stats_latched.rx.packet_large);
+	stats_update48(R_STAT_RX_PACKET_SMALL_0_LSB, stats_latched.rx.packet_small);
+
+	stats_update48(R_STAT_RX_BAD_FCS_0_LSB, stats_latched.rx.bad_fcs);
+	stats_update48(R_STAT_RX_UNDERSIZE_0_LSB, stats_latched.rx.undersize);
+
+	stats_update48(R_STAT_RX_UNICAST_0_LSB, stats_latched.rx.unicast);
+	stats_update48(R_STAT_RX_MULTICAST_0_LSB, stats_latched.rx.multicast);
+	stats_update48(R_STAT_RX_BROADCAST_0_LSB, stats_latched.rx.broadcast);
+	stats_update48(R_STAT_RX_VLAN_0_LSB, stats_latched.rx.vlan);
+	stats_update48(R_STAT_RX_PAUSE_0_LSB, stats_latched.rx.pause);
+
+	stats_latch_pending = false;
+}
+
+void xilinx_mrmac::tick(void) {
+	// Latch and clear the accumulators. The registers are written on
+	// the first read of the statistics, so that a tick doesn't cost
+	// more than a copy.
+	memcpy(&stats_latched, &stats, sizeof(stats));
+	memset(&stats, 0, sizeof(stats));
+	stats_latch_pending = true;
 }
 
 void xilinx_mrmac::mac_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
@@ -237,7 +244,12 @@ void xilinx_mrmac::mac_b_transport(tlm::tlm_generic_payload& trans, sc_time& del
 		eop = genattr->get_eop();
 	}
 
-	assert(len < (int)(sizeof (txbuf) - txpos));
+	assert(len < (int)(TXFRAME_MAX - txpos));
+	if (!txframe) {
+		txframe = pool.alloc(0);
+	}
+	// Room for the beat and an inserted FCS.
+	txbuf = pool.grow(txframe, txpos + len + 4);
 	memcpy(txbuf + txpos, data, len);
 	txpos += len;
 
@@ -290,8 +302,10 @@ void xilinx_mrmac::mac_b_transport(tlm::tlm_generic_payload& trans, sc_time& del
 		stats_add64(stats.tx.total_bytes, txpos);
 		stats_update_tx_hist(txpos);
 
-		push_stream(txbuf, txpos, true);
 		D(hexdump("assembled mac tx", txbuf, txpos));
+		push_stream(txframe, txpos);
+		txframe->release();
+		txframe = NULL;
 		txpos = 0;
 	}
 
@@ -318,6 +332,15 @@ void xilinx_mrmac::phy_rx_thread() {
 			goto done;
 		}
 
+		// Runts, too short to hold the header and the FCS, are dropped.
+		if (len < ETH_HDR_LEN + ETH_FCS_LEN) {
+			stats_add48(stats.rx.total_packets, 1);
+			stats_add64(stats.rx.total_bytes, len);
+			stats_update_rx_hist(len);
+			stats_add48(stats.rx.undersize, 1);
+			goto done;
+		}
+
 		if (!ARRAY_FIELD_EX(rb.regs, CONFIGURATION_RX_REG1_0, ctl_rx_ignore_fcs_0)) {
 			uint32_t crc = crc32(0, rxbuf, len - 4);
 			uint32_t pkt_crc;
@@ -364,31 +387,34 @@ void xilinx_mrmac::phy_rx_thread() {
 			mac_rx_socket->b_transport(*trans, delay);
 		}
 done:
-		delete trans->get_data_ptr();
-		delete trans;
+		trans->release();
 	}
 }
 
 void xilinx_mrmac::phy_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
-	tlm::tlm_generic_payload *gp = new tlm::tlm_generic_payload();
+	tlm::tlm_generic_payload *gp;
 	int len = trans.get_data_length();
-	unsigned char *buf = new unsigned char [len + 4];
-
-	gp->set_data_ptr(buf);
-
-	gp->deep_copy_from(trans);
 
 	if (cfg.insert_rx_crc) {
-		uint32_t crc = crc32(0, buf, len);
+		unsigned char *buf;
+		uint32_t crc;
+
+		// The FCS goes into our own copy of the frame.
+		gp = pool.alloc(len + sizeof(crc));
+		buf = gp->get_data_ptr();
+		memcpy(buf, trans.get_data_ptr(), len);
+		crc = crc32(0, buf, len);
 		memcpy(buf + len, &crc, sizeof(crc));
-		len += sizeof(crc);
-		gp->set_data_length(len);
+	} else {
+		// Queued by reference when it comes from a frame pool.
+		gp = pool.get(trans);
 	}
 
 	if (rxfifo.num_free()) {
 		rxfifo.write(gp);
 	} else {
 		// Packet-loss
+		gp->release();
 	}
 	trans.set_response_status(tlm::TLM_OK_RESPONSE);
 }
@@ -399,6 +425,12 @@ void xilinx_mrmac::reg_b_transport(tlm::tlm_generic_payload& trans, sc_time& del
 	int len = trans.get_data_length();
 	uint32_t v = 0;
 
+	if (stats_latch_pending && trans.is_read() &&
+	    addr < A_STAT_RX_PAUSE_0_MSB + 4 &&
+	    addr + len > A_STAT_TX_TOTAL_PACKETS_0_LSB) {
+		stats_latch();
+	}
+
 	rb.reg_b_transport(trans, delay);
 
 	memcpy(&v, data, len);
@@ -25,6 +25,7 @@
 
 #include "tlm-extensions/genattr.h"
 #include "utils/regapi.h"
+#include "soc/net/ethernet/frame-pool.h"
 #include "regs-mrmac.h"
 
 SC_MODULE(xilinx_mrmac)
@@ -93,6 +94,7 @@ private:
 			uint64_t packet_small;
 
 			uint64_t bad_fcs;
+			uint64_t undersize;
 
 			uint64_t unicast;
 			uint64_t multicast;
@@ -100,58 +102,70 @@ private:
 			uint64_t vlan;
 			uint64_t pause;
 		} rx;
-	} stats;
+	} stats, stats_latched;
+
+	// Set by a tick, until the latched values are written to the
+	// registers.
+	bool stats_latch_pending;
 
 	struct {
 		bool insert_rx_crc;
 	} cfg;
 
+	eth_frame_pool& pool;
 	sc_fifo<tlm::tlm_generic_payload*> rxfifo;
-	unsigned char txbuf[64 * 1024];
+
+	// The frame being assembled from the user-logic beats.
+	enum { TXFRAME_MAX = 64 * 1024 };
+	tlm::tlm_generic_payload *txframe;
+	unsigned char *txbuf;
 	unsigned int txpos;
 
-	void stats_add(uint64_t &c, uint64_t v, uint64_t max) {
+	// Plain increments, the counter width is applied when latching.
+	void stats_add48(uint64_t &c, uint64_t v) {
+		c += v;
+	}
+
+	void stats_add64(uint64_t &c, uint64_t v) {
+		c += v;
+	}
+
+	void stats_update_tx_hist(int len);
+	void stats_update_rx_hist(int len);
+
+	void stats_update(int reg, uint64_t v, uint64_t max) {
 		bool ext = ARRAY_FIELD_EX(rb.regs, MODE_REG_0, ctl_counter_extend_0);
 
-		if ((max - c) < v) {
+		if (v > max) {
 			if (ext) {
 				// TODO: set the extended signal
+				v &= max;
 			} else {
 				// Saturate.
-				return;
+				v = max;
 			}
 		}
 
-		c += v;
-		c &= max;
+		// Move latched values into user accessible registers.
+		rb.regs[reg] = v;
+		rb.regs[reg + 1] = v >> 32;
 	}
 
-	void stats_add48(uint64_t &c, uint64_t v) {
+	void stats_update48(int reg, uint64_t v) {
 		uint64_t uint48_max = (1ULL << 48) - 1;
 
-		stats_add(c, v, uint48_max);
-	}
-
-	void stats_add64(uint64_t &c, uint64_t v) {
-		stats_add(c, v, UINT64_MAX);
+		stats_update(reg, v, uint48_max);
 	}
 
-	void stats_update_tx_hist(int len);
-	void stats_update_rx_hist(int len);
-
-	void stats_update64(int reg, uint64_t &v) {
-		// Move accumulators into user accessible registers.
-		rb.regs[reg] = v;
-		rb.regs[reg + 1] = v >> 32;
-
-		// Reset accumulators to zero.
-		v = 0;
+	void stats_update64(int reg, uint64_t v) {
+		stats_update(reg, v, UINT64_MAX);
 	}
 
+	void stats_latch(void);
 	void tick(void);
 
 	void reset_thread();
-	void push_stream(unsigned char *buf, int len, bool eop);
+	void push_stream(tlm::tlm_generic_payload *gp, int len);
 	void mac_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
 	void phy_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
 	void phy_rx_thread();
@@ -759,6 +759,10 @@ public:
 		 * encrypted.  */
 		/* Set the encryption mode for port 0.  */
 		this->enc_encryption_mode[0].write(xilinx_hsc:: MACsec);
+		/* SecTAG with the SCI (SC), encrypted (E, C), PN 1.  */
+		this->enc_macsec_sectag_tci[0].write(0x0B);
+		this->enc_macsec_sectag_sci[0].write(0x0A0B0C0D0E0F0001LL);
+		this->enc_crypto_pkt_num[0].write(1);
 		sc_core::wait(SC_ZERO_TIME);
 		/* Send some datas on port 0.  */
 		trans.set_command(tlm::TLM_WRITE_COMMAND);
@@ -778,6 +782,10 @@ public:
 			       tlm::tlm_generic_payload& trans,
 			       sc_time& delay)
 	{
+		static const uint8_t expected_icv[] = {
+			0x5f, 0x2c, 0x34, 0x3a, 0x8a, 0xb0, 0xc2, 0x66,
+			0xc1, 0x89, 0x8d, 0xbc, 0xdb, 0xf3, 0x2d, 0x5e
+		};
 		genattr_extension *genattr;
 		tlm::tlm_command cmd = trans.get_command();
 		sc_dt::uint64 addr = trans.get_address();
@@ -798,6 +806,13 @@ public:
 		this->encrypted_data = new uint8_t[this->encrypted_data_size];
 		memcpy(this->encrypted_data, data, this->encrypted_data_size);
 
+		/* GCM-AES-128 ICV of the test packet with the SA key #0.  */
+		if (len < sizeof(expected_icv)
+		    || memcmp(data + len - sizeof(expected_icv), expected_icv,
+			      sizeof(expected_icv))) {
+			goto err;
+		}
+
 		/* Forward that packet to the decrypter.  */
 		this->encrypted_data_stream_generator[0]->b_transport(trans,
 								      delay);
@@ -0,0 +1,658 @@
+/*
+ * Xilinx MCDMA test-suite.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc.h"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "soc/dma/xilinx/mcdma/mcdma.h"
+#include "tests/test-modules/memory.h"
+
+#define RAM_SIZE	(64 * 1024)
+#define NR_CHANNELS	2
+
+// Registers of channel CH, the channels are 0x40 apart.
+#define CH_REG(A, CH)	((A) + (CH) * 0x40)
+
+// S2MM descriptor ring and the buffers the descriptors point to.
+#define BD_BASE		0x1000
+#define BD_STRIDE	0x40
+#define NR_BDS		32
+#define BUF_BASE	0x4000
+#define BUF_SIZE	0x100
+#define PKT_LEN		64
+
+// S2MM channel 2 ring, its buffers are moved to ALT_BUF_BASE.
+#define RA_BD_BASE	0x2000
+#define RA_NR_BDS	16
+#define RA_BUF_BASE	0x6000
+#define RA_ALT_BUF_BASE	0x7000
+
+// MM2S rings, one per channel, and their payloads.
+#define TX_BD_BASE	0x8000
+#define TX_NR_BDS	8
+#define TX_BUF_BASE	0xa000
+#define TX_PKT_LEN	32
+
+// BD control and status bits.
+#define BD_SOF		(1U << 31)
+#define BD_EOF		(1U << 30)
+#define BD_CMPLT	(1U << 31)
+#define BD_RX_SOF	(1U << 27)
+#define BD_RX_EOF	(1U << 26)
+
+// Time per count of the IRQ_DELAY fields.
+#define IRQ_DELAY_UNIT	sc_time(10, SC_NS)
+
+static uint8_t ram_buf[RAM_SIZE];
+
+SC_MODULE(Top)
+{
+	xilinx_mcdma dma;
+	memory mem;
+
+	tlm_utils::simple_initiator_socket<Top> reg_socket;
+	sc_vector<tlm_utils::simple_initiator_socket<Top> > s2mm_socket;
+	sc_vector<tlm_utils::simple_target_socket_tagged<Top> > mm2s_socket;
+
+	// Between the DMA and the memory, counts accesses and controls DMI.
+	tlm_utils::simple_target_socket<Top> bus_tgt_socket;
+	tlm_utils::simple_initiator_socket<Top> bus_init_socket;
+
+	sc_signal<bool> rst;
+	sc_signal<bool> s2mm_irq;
+	sc_signal<bool> mm2s_irq;
+
+	bool dmi_denied;
+	bool invalidate_on_tx;
+	unsigned int nr_tx_buf_reads;
+	unsigned int nr_ra_bd_reads;
+
+	// Channel of every MM2S packet, in the order they went out.
+	std::vector<int> tx_order;
+	sc_event ev_tx;
+
+	bool done;
+
+	SC_HAS_PROCESS(Top);
+
+	void reg_access(tlm::tlm_command cmd, uint64_t addr, uint32_t *val) {
+		sc_time delay = SC_ZERO_TIME;
+		tlm::tlm_generic_payload tr;
+
+		tr.set_command(cmd);
+		tr.set_address(addr);
+		tr.set_data_ptr(reinterpret_cast<unsigned char *>(val));
+		tr.set_data_length(sizeof *val);
+		tr.set_streaming_width(sizeof *val);
+		tr.set_dmi_allowed(false);
+		tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		reg_socket->b_transport(tr, delay);
+		assert(tr.get_response_status() == tlm::TLM_OK_RESPONSE);
+	}
+
+	void reg_write(uint64_t addr, uint32_t val) {
+		reg_access(tlm::TLM_WRITE_COMMAND, addr, &val);
+	}
+
+	uint32_t reg_read(uint64_t addr) {
+		uint32_t val;
+
+		reg_access(tlm::TLM_READ_COMMAND, addr, &val);
+		return val;
+	}
+
+	void send_stream(int ch, unsigned char *pkt, int len) {
+		sc_time delay = SC_ZERO_TIME;
+		tlm::tlm_generic_payload tr;
+
+		tr.set_command(tlm::TLM_WRITE_COMMAND);
+		tr.set_address(0);
+		tr.set_data_ptr(pkt);
+		tr.set_data_length(len);
+		tr.set_streaming_width(len);
+		tr.set_dmi_allowed(false);
+		tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		s2mm_socket[ch]->b_transport(tr, delay);
+		assert(tr.get_response_status() == tlm::TLM_OK_RESPONSE);
+
+		// Let the interrupt lines settle.
+		wait(SC_ZERO_TIME);
+	}
+
+	// One packet into S2MM channel 1.
+	void send_packet(void) {
+		unsigned char pkt[PKT_LEN];
+
+		memset(pkt, 0x5a, sizeof pkt);
+		send_stream(0, pkt, sizeof pkt);
+	}
+
+	void set_cr(unsigned int threshold, unsigned int delay) {
+		uint32_t cr = R_S2MM_CH1CR_RS_MASK | R_S2MM_CH1CR_IOC_IRQEN_MASK |
+				R_S2MM_CH1CR_DLY_IRQEN_MASK;
+
+		cr |= threshold << R_S2MM_CH1CR_IRQ_THRESHOLD_SHIFT;
+		cr |= delay << R_S2MM_CH1CR_IRQ_DELAY_SHIFT;
+		reg_write(A_S2MM_CH1CR, cr);
+	}
+
+	uint32_t sr(void) {
+		return reg_read(A_S2MM_CH1SR);
+	}
+
+	unsigned int sr_threshold(void) {
+		return (sr() & R_S2MM_CH1SR_IRQ_THRESHOLD_MASK) >>
+			R_S2MM_CH1SR_IRQ_THRESHOLD_SHIFT;
+	}
+
+	bool ioc(void) {
+		return sr() & R_S2MM_CH1SR_IOC_IRQ_MASK;
+	}
+
+	bool dly(void) {
+		return sr() & R_S2MM_CH1SR_DLY_IRQ_MASK;
+	}
+
+	void ack_irqs(void) {
+		reg_write(A_S2MM_CH1SR, R_S2MM_CH1SR_IOC_IRQ_MASK |
+				R_S2MM_CH1SR_DLY_IRQ_MASK);
+		wait(SC_ZERO_TIME);
+		assert(!s2mm_irq.read());
+	}
+
+	void setup(void) {
+		unsigned int i;
+
+		for (i = 0; i < NR_BDS; i++) {
+			s2mm_bd bd;
+
+			memset(&bd, 0, sizeof bd);
+			bd.next = BD_BASE + ((i + 1) % NR_BDS) * BD_STRIDE;
+			bd.buffer = BUF_BASE + i * BUF_SIZE;
+			bd.ctrl = BUF_SIZE;
+			memcpy(ram_buf + BD_BASE + i * BD_STRIDE, &bd, sizeof bd);
+		}
+
+		rst.write(true);
+		wait(1, SC_NS);
+		rst.write(false);
+		wait(1, SC_NS);
+
+		reg_write(A_S2MM_CCR, R_S2MM_CCR_RS_MASK);
+		reg_write(A_S2MM_CHEN, 1);
+		reg_write(A_S2MM_CH1CURDESC_LSB, BD_BASE);
+		reg_write(A_S2MM_CH1CURDESC_MSB, 0);
+		set_cr(1, 0);
+		reg_write(A_S2MM_CH1TAILDESC_LSB,
+				BD_BASE + (NR_BDS - 1) * BD_STRIDE);
+		reg_write(A_S2MM_CH1TAILDESC_MSB, 0);
+	}
+
+	// IOC is raised on the Nth packet, not before.
+	void check_threshold(void) {
+		unsigned int i;
+
+		set_cr(3, 0);
+		assert(sr_threshold() == 3);
+
+		for (i = 0; i < 2; i++) {
+			send_packet();
+			assert(!ioc());
+			assert(!s2mm_irq.read());
+			assert(sr_threshold() == 3 - (i + 1));
+		}
+
+		send_packet();
+		assert(ioc());
+		assert(s2mm_irq.read());
+		assert(sr_threshold() == 3);
+		ack_irqs();
+
+		printf("%s: threshold OK\n", name());
+	}
+
+	//
+	// A batch that doesn't reach the threshold raises DLY IRQ_DELAY units
+	// after its last packet, and the count starts over.
+	//
+	void check_delay(void) {
+		set_cr(3, 4);
+
+		send_packet();
+		wait(IRQ_DELAY_UNIT * 2);
+
+		// The timer restarts with every packet.
+		send_packet();
+		wait(IRQ_DELAY_UNIT * 4 - sc_time(1, SC_NS));
+		assert(!dly() && !ioc());
+		assert(!s2mm_irq.read());
+
+		wait(2, SC_NS);
+		assert(dly() && !ioc());
+		assert(s2mm_irq.read());
+		assert(sr_threshold() == 3);
+		ack_irqs();
+
+		// A full batch raises IOC and stops the timer.
+		send_packet();
+		send_packet();
+		send_packet();
+		assert(ioc());
+		ack_irqs();
+
+		wait(IRQ_DELAY_UNIT * 8);
+		assert(!dly());
+
+		printf("%s: delay OK\n", name());
+	}
+
+	// Writing CR reloads the count of the packets left.
+	void check_reload(void) {
+		set_cr(3, 0);
+
+		send_packet();
+		send_packet();
+		assert(sr_threshold() == 1);
+
+		set_cr(2, 0);
+		assert(sr_threshold() == 2);
+
+		send_packet();
+		assert(!ioc());
+		send_packet();
+		assert(ioc());
+		ack_irqs();
+
+		printf("%s: reload OK\n", name());
+	}
+
+	static uint8_t tx_data(int ch, unsigned int bd, unsigned int i) {
+		return ch << 7 | bd << 4 | (i & 0xf);
+	}
+
+	// Ring of single BD packets for MM2S channel CH.
+	void setup_tx_ring(int ch) {
+		unsigned int i, j;
+
+		for (i = 0; i < TX_NR_BDS; i++) {
+			uint64_t bd_addr = TX_BD_BASE + (ch * TX_NR_BDS + i) * BD_STRIDE;
+			uint64_t buf = TX_BUF_BASE + (ch * TX_NR_BDS + i) * TX_PKT_LEN;
+			mm2s_bd bd;
+
+			memset(&bd, 0, sizeof bd);
+			bd.next = TX_BD_BASE + (ch * TX_NR_BDS + (i + 1) % TX_NR_BDS) * BD_STRIDE;
+			bd.buffer = buf;
+			bd.ctrl = TX_PKT_LEN | BD_SOF | BD_EOF;
+			memcpy(ram_buf + bd_addr, &bd, sizeof bd);
+
+			for (j = 0; j < TX_PKT_LEN; j++) {
+				ram_buf[buf + j] = tx_data(ch, i, j);
+			}
+		}
+	}
+
+	mm2s_bd *tx_bd(int ch, unsigned int i) {
+		return reinterpret_cast<mm2s_bd *>(ram_buf + TX_BD_BASE +
+				(ch * TX_NR_BDS + i) * BD_STRIDE);
+	}
+
+	void tx_start(int ch, unsigned int cur, unsigned int tail) {
+		reg_write(CH_REG(A_MM2S_CH1CURDESC_LSB, ch),
+			  TX_BD_BASE + (ch * TX_NR_BDS + cur) * BD_STRIDE);
+		reg_write(CH_REG(A_MM2S_CH1CURDESC_MSB, ch), 0);
+		reg_write(CH_REG(A_MM2S_CH1CR, ch), R_MM2S_CH1CR_RS_MASK);
+		reg_write(CH_REG(A_MM2S_CH1TAILDESC_LSB, ch),
+			  TX_BD_BASE + (ch * TX_NR_BDS + tail) * BD_STRIDE);
+		reg_write(CH_REG(A_MM2S_CH1TAILDESC_MSB, ch), 0);
+	}
+
+	void wait_tx(unsigned int n) {
+		while (tx_order.size() < n) {
+			wait(ev_tx);
+		}
+	}
+
+	//
+	// In weighted round robin mode a grant of the memory port covers as
+	// many BDs as the weight of the channel. Channel 1 (weight 3) and
+	// channel 2 (weight 1) both have packets ready, the packets go out
+	// three from channel 1 for every one from channel 2.
+	//
+	void check_wrr(void) {
+		unsigned int i, run;
+		int ch;
+
+		setup_tx_ring(0);
+		setup_tx_ring(1);
+
+		reg_write(A_MM2S_CCR, R_MM2S_CCR_RS_MASK);
+		reg_write(A_MM2S_CHEN, 3);
+		reg_write(A_MM2S_CH_SCHD_TYPE, 2);
+		reg_write(A_MM2S_WRR_REG1, 3 | 1 << 4);
+
+		tx_order.clear();
+		tx_start(0, 0, 5);
+		tx_start(1, 0, 1);
+		wait_tx(8);
+
+		// Runs of three from channel 1 and one from channel 2.
+		for (i = 0; i < tx_order.size(); i += run) {
+			ch = tx_order[i];
+			for (run = 1; i + run < tx_order.size() &&
+				      tx_order[i + run] == ch; run++) {
+				;
+			}
+			assert(run == (ch == 0 ? 3U : 1U));
+		}
+
+		for (i = 0; i < 6; i++) {
+			assert(tx_bd(0, i)->status == (BD_CMPLT | TX_PKT_LEN));
+		}
+		for (i = 0; i < 2; i++) {
+			assert(tx_bd(1, i)->status == (BD_CMPLT | TX_PKT_LEN));
+		}
+
+		printf("%s: wrr OK\n", name());
+	}
+
+	//
+	// The DMI region goes away while a grant's packets are pushed on the
+	// stream. The payloads that haven't gone out yet are read through
+	// the bus instead of through the stale DMI pointer.
+	//
+	void check_dmi_invalidate(void) {
+		static const unsigned int bds[] = { 6, 7, 0 };
+		unsigned int i;
+
+		for (i = 0; i < 3; i++) {
+			tx_bd(0, bds[i])->status = 0;
+		}
+
+		tx_order.clear();
+		invalidate_on_tx = true;
+		tx_start(0, 6, 0);
+		wait_tx(3);
+
+		assert(dmi_denied);
+		assert(nr_tx_buf_reads == 2);
+		for (i = 0; i < 3; i++) {
+			assert(tx_bd(0, bds[i])->status == (BD_CMPLT | TX_PKT_LEN));
+		}
+
+		printf("%s: dmi invalidate OK\n", name());
+	}
+
+	uint64_t ra_bd_addr(unsigned int i) {
+		return RA_BD_BASE + i * BD_STRIDE;
+	}
+
+	s2mm_bd *ra_bd(unsigned int i) {
+		return reinterpret_cast<s2mm_bd *>(ram_buf + ra_bd_addr(i));
+	}
+
+	void ra_set_tail(unsigned int i) {
+		reg_write(CH_REG(A_S2MM_CH1TAILDESC_LSB, 1), ra_bd_addr(i));
+		reg_write(CH_REG(A_S2MM_CH1TAILDESC_MSB, 1), 0);
+	}
+
+	void ra_send(unsigned int n) {
+		unsigned char pkt[PKT_LEN];
+		unsigned int i;
+
+		for (i = 0; i < n; i++) {
+			memset(pkt, i, sizeof pkt);
+			send_stream(1, pkt, sizeof pkt);
+		}
+	}
+
+	//
+	// BDs are read ahead up to the tail, at most 512 bytes of them per
+	// access. When the tail moves past the BDs read so far, the BDs up
+	// to the new tail are read again, including the ones that changed.
+	// DMI is off from the previous check so the bus sees the reads.
+	//
+	void check_readahead(void) {
+		unsigned int i;
+
+		for (i = 0; i < RA_NR_BDS; i++) {
+			s2mm_bd bd;
+
+			memset(&bd, 0, sizeof bd);
+			bd.next = ra_bd_addr((i + 1) % RA_NR_BDS);
+			bd.buffer = RA_BUF_BASE + i * BUF_SIZE;
+			bd.ctrl = BUF_SIZE;
+			memcpy(ra_bd(i), &bd, sizeof bd);
+		}
+
+		reg_write(A_S2MM_CHEN, 3);
+		reg_write(CH_REG(A_S2MM_CH1CURDESC_LSB, 1), ra_bd_addr(0));
+		reg_write(CH_REG(A_S2MM_CH1CURDESC_MSB, 1), 0);
+		reg_write(CH_REG(A_S2MM_CH1CR, 1), R_S2MM_CH1CR_RS_MASK |
+			  1 << R_S2MM_CH1CR_IRQ_THRESHOLD_SHIFT);
+		ra_set_tail(3);
+
+		// BD 0 - 3 in one read.
+		nr_ra_bd_reads = 0;
+		ra_send(3);
+		assert(nr_ra_bd_reads == 1);
+
+		// The driver hands over BD 4 - 15 with new buffers.
+		for (i = 4; i < RA_NR_BDS; i++) {
+			ra_bd(i)->buffer = RA_ALT_BUF_BASE + (i - 4) * BUF_SIZE;
+		}
+		ra_set_tail(13);
+
+		// BD 3 - 10 in one read, then BD 11 - 13.
+		nr_ra_bd_reads = 0;
+		ra_send(9);
+		assert(nr_ra_bd_reads == 2);
+
+		for (i = 0; i < 12; i++) {
+			uint64_t buf = i < 4 ? RA_BUF_BASE + i * BUF_SIZE :
+					       RA_ALT_BUF_BASE + (i - 4) * BUF_SIZE;
+			unsigned int pkt = i < 3 ? i : i - 3;
+
+			assert(ra_bd(i)->status ==
+			       (BD_CMPLT | BD_RX_SOF | BD_RX_EOF | PKT_LEN));
+			assert(ram_buf[buf] == pkt);
+			assert(ram_buf[buf + PKT_LEN - 1] == pkt);
+		}
+		for (i = 4; i < 12; i++) {
+			assert(ram_buf[RA_BUF_BASE + i * BUF_SIZE] == 0);
+		}
+		assert(reg_read(CH_REG(A_S2MM_CH1CURDESC_LSB, 1)) == ra_bd_addr(12));
+
+		printf("%s: readahead OK\n", name());
+	}
+
+	//
+	// A packet larger than the buffers is scattered over BDs, SOF is set
+	// on the first one and EOF on the last one. The packet counts once
+	// towards the interrupt threshold.
+	//
+	void check_multi_bd(void) {
+		unsigned char pkt[BUF_SIZE * 2 + BUF_SIZE / 2];
+		uint32_t sr;
+		unsigned int i;
+
+		for (i = 0; i < sizeof pkt; i++) {
+			pkt[i] = i;
+		}
+
+		reg_write(CH_REG(A_S2MM_CH1CR, 1), R_S2MM_CH1CR_RS_MASK |
+			  4 << R_S2MM_CH1CR_IRQ_THRESHOLD_SHIFT);
+		ra_set_tail(15);
+		send_stream(1, pkt, sizeof pkt);
+
+		assert(ra_bd(12)->status == (BD_CMPLT | BD_RX_SOF | BUF_SIZE));
+		assert(ra_bd(13)->status == (BD_CMPLT | BUF_SIZE));
+		assert(ra_bd(14)->status == (BD_CMPLT | BD_RX_EOF | BUF_SIZE / 2));
+		assert(!memcmp(ram_buf + RA_ALT_BUF_BASE + 8 * BUF_SIZE, pkt,
+			       sizeof pkt));
+		assert(reg_read(CH_REG(A_S2MM_CH1CURDESC_LSB, 1)) == ra_bd_addr(15));
+
+		sr = reg_read(CH_REG(A_S2MM_CH1SR, 1));
+		assert(((sr & R_S2MM_CH1SR_IRQ_THRESHOLD_MASK) >>
+			R_S2MM_CH1SR_IRQ_THRESHOLD_SHIFT) == 3);
+
+		printf("%s: multi bd OK\n", name());
+	}
+
+	void run(void) {
+		setup();
+		check_threshold();
+		check_delay();
+		check_reload();
+		check_wrr();
+		check_dmi_invalidate();
+		check_readahead();
+		check_multi_bd();
+
+		done = true;
+		sc_stop();
+	}
+
+	void mm2s_b_transport(int ch, tlm::tlm_generic_payload& trans, sc_time& delay) {
+		unsigned char *data = trans.get_data_ptr();
+		genattr_extension *genattr;
+		unsigned int bd;
+		unsigned int i;
+
+		trans.get_extension(genattr);
+		assert(genattr && genattr->get_eop());
+		assert(trans.get_data_length() == TX_PKT_LEN);
+
+		// Channel and BD are in the data.
+		assert((data[0] >> 7) == ch);
+		bd = (data[0] >> 4) & 0x7;
+		for (i = 0; i < TX_PKT_LEN; i++) {
+			assert(data[i] == tx_data(ch, bd, i));
+		}
+
+		if (invalidate_on_tx) {
+			invalidate_on_tx = false;
+			dmi_denied = true;
+			nr_tx_buf_reads = 0;
+			bus_tgt_socket->invalidate_direct_mem_ptr(0, ~0ULL);
+		}
+
+		tx_order.push_back(ch);
+		ev_tx.notify();
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	void bus_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		uint64_t addr = trans.get_address();
+
+		if (trans.is_read()) {
+			if (addr >= TX_BUF_BASE &&
+			    addr < TX_BUF_BASE + NR_CHANNELS * TX_NR_BDS * TX_PKT_LEN) {
+				nr_tx_buf_reads++;
+			}
+			if (addr >= RA_BD_BASE &&
+			    addr < RA_BD_BASE + RA_NR_BDS * BD_STRIDE) {
+				nr_ra_bd_reads++;
+			}
+		}
+
+		bus_init_socket->b_transport(trans, delay);
+		if (dmi_denied) {
+			trans.set_dmi_allowed(false);
+		}
+	}
+
+	bool bus_get_direct_mem_ptr(tlm::tlm_generic_payload& trans,
+				    tlm::tlm_dmi& dmi_data) {
+		if (dmi_denied) {
+			return false;
+		}
+		return bus_init_socket->get_direct_mem_ptr(trans, dmi_data);
+	}
+
+	Top(sc_module_name name) :
+		dma("dma", NR_CHANNELS, IRQ_DELAY_UNIT),
+		mem("mem", sc_time(10, SC_NS), RAM_SIZE, ram_buf),
+		reg_socket("reg_socket"),
+		s2mm_socket("s2mm_socket", NR_CHANNELS),
+		mm2s_socket("mm2s_socket", NR_CHANNELS),
+		bus_tgt_socket("bus_tgt_socket"),
+		bus_init_socket("bus_init_socket"),
+		rst("rst"),
+		s2mm_irq("s2mm_irq"),
+		mm2s_irq("mm2s_irq"),
+		dmi_denied(false),
+		invalidate_on_tx(false),
+		nr_tx_buf_reads(0),
+		nr_ra_bd_reads(0),
+		done(false)
+	{
+		int ch;
+
+		SC_THREAD(run);
+
+		dma.rst(rst);
+		dma.s2mm_irq(s2mm_irq);
+		dma.mm2s_irq(mm2s_irq);
+
+		dma.init_socket.bind(bus_tgt_socket);
+		bus_init_socket.bind(mem.socket);
+		bus_tgt_socket.register_b_transport(this, &Top::bus_b_transport);
+		bus_tgt_socket.register_get_direct_mem_ptr(this,
+				&Top::bus_get_direct_mem_ptr);
+
+		reg_socket.bind(dma.target_socket);
+		for (ch = 0; ch < NR_CHANNELS; ch++) {
+			s2mm_socket[ch].bind(dma.s2mm_stream_socket[ch]);
+			dma.mm2s_stream_socket[ch].bind(mm2s_socket[ch]);
+			mm2s_socket[ch].register_b_transport(this,
+					&Top::mm2s_b_transport, ch);
+		}
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	Top top("top");
+
+	sc_start(1, SC_MS);
+
+	if (!top.done) {
+		printf("MCDMA checks did not complete\n");
+		return 1;
+	}
+	return 0;
+}
@@ -232,6 +232,41 @@ SC_MODULE(Top)
 		reg_write32(A_CONFIGURATION_RX_REG1_0, saved);
 	}
 
+	void check_rx_runt(void) {
+		uint64_t v64;
+		int len;
+
+		printf("%s\n", __func__);
+
+		reg_tick();
+
+		// Too short for the header and the FCS, never delivered.
+		for (len = 0; len < ETH_HDR_LEN + ETH_FCS_LEN; len++) {
+			memset(txbuf, 0xff, len);
+			tx(phy_rx_socket, len);
+			assert(stats.mac_rx - stats_prev.mac_rx == 0);
+		}
+
+		reg_tick();
+
+		v64 = reg_read64(A_STAT_RX_UNDERSIZE_0_LSB);
+		assert(v64 == ETH_HDR_LEN + ETH_FCS_LEN);
+		v64 = reg_read64(A_STAT_RX_TOTAL_GOOD_PACKETS_0_LSB);
+		assert(v64 == 0);
+
+		// The shortest frame that is accepted.
+		memset(txbuf, 0, ETH_HDR_LEN);
+		csum(ETH_HDR_LEN);
+		tx(phy_rx_socket, ETH_HDR_LEN + ETH_FCS_LEN);
+		assert(stats.mac_rx - stats_prev.mac_rx == 1);
+		stats_prev = stats;
+
+		reg_tick();
+
+		v64 = reg_read64(A_STAT_RX_UNDERSIZE_0_LSB);
+		assert(v64 == 0);
+	}
+
 	void check_tx_stats_hist(void) {
 		unsigned int seed = 0;
 		uint64_t v64;
@@ -441,6 +476,7 @@ SC_MODULE(Top)
 		check_tx_enabled();
 		check_tx_csum();
 		check_rx_csum();
+		check_rx_runt();
 		check_tx_stats_hist();
 		check_rx_stats_hist();
 
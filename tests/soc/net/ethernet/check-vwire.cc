@@ -0,0 +1,294 @@
+/*
+ * Virtual wire Ethernet backend, test-suite.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sys/socket.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc.h"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "soc/net/ethernet/vwire/vwire.h"
+
+#define NR_BURSTS	200
+#define BURST_LEN	10
+#define NR_FRAMES	(NR_BURSTS * BURST_LEN)
+#define NR_PCAP_FRAMES	50
+
+// Simulation stops once all the checks are done.
+static unsigned int nr_running;
+
+static void check_done(void)
+{
+	if (--nr_running == 0) {
+		sc_stop();
+	}
+}
+
+// Frame i is i % 1500 + 60 bytes long and filled with its sequence number.
+static unsigned int frame_len(unsigned int i)
+{
+	return i % 1500 + 60;
+}
+
+// Two virtual wires back to back.
+SC_MODULE(Top)
+{
+	eth_vwire a;
+	eth_vwire b;
+
+	tlm_utils::simple_initiator_socket<Top> a_tx_socket;
+	tlm_utils::simple_target_socket<Top> b_rx_socket;
+	tlm_utils::simple_target_socket<Top> a_rx_socket;
+	tlm_utils::simple_initiator_socket<Top> b_tx_socket;
+
+	unsigned char txbuf[2 * 1024];
+	unsigned int rx_count;
+	sc_event rx_done;
+
+	SC_HAS_PROCESS(Top);
+
+	void tx(tlm_utils::simple_initiator_socket<Top> &socket, unsigned int i) {
+		sc_time delay = SC_ZERO_TIME;
+		tlm::tlm_generic_payload tr;
+		unsigned int len = frame_len(i);
+
+		memset(txbuf, i & 0xff, len);
+		memcpy(txbuf, &i, sizeof i);
+
+		tr.set_command(tlm::TLM_WRITE_COMMAND);
+		tr.set_address(0);
+		tr.set_data_ptr(txbuf);
+		tr.set_data_length(len);
+		tr.set_streaming_width(len);
+		tr.set_dmi_allowed(false);
+		tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		socket->b_transport(tr, delay);
+		assert(tr.get_response_status() == tlm::TLM_OK_RESPONSE);
+	}
+
+	void check(void) {
+		unsigned int i, j;
+
+		for (i = 0; i < NR_BURSTS; i++) {
+			// Sent within one delta cycle, hence in one batch.
+			for (j = 0; j < BURST_LEN; j++) {
+				tx(a_tx_socket, i * BURST_LEN + j);
+			}
+
+			// Frames the socket can't take are dropped, so
+			// don't run ahead of the receiver.
+			while (rx_count < (i + 1) * BURST_LEN) {
+				wait(rx_done);
+			}
+			wait(1, SC_US);
+		}
+
+		// And one frame the other way around.
+		tx(b_tx_socket, 0);
+		while (rx_count < NR_FRAMES + 1) {
+			wait(rx_done);
+		}
+
+		printf("%s: %u frames received\n", name(), rx_count);
+		check_done();
+	}
+
+	void b_rx_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		unsigned char *data = trans.get_data_ptr();
+		unsigned int i;
+
+		// Delivered in order, not before they were sent.
+		memcpy(&i, data, sizeof i);
+		assert(i == rx_count);
+		assert(trans.get_data_length() == frame_len(i));
+		assert(data[frame_len(i) - 1] == (i & 0xff));
+		assert(sc_time_stamp() >= sc_time(i / BURST_LEN, SC_US));
+
+		rx_count++;
+		rx_done.notify();
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	void a_rx_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		assert(trans.get_data_length() == frame_len(0));
+
+		rx_count++;
+		rx_done.notify();
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	Top(sc_module_name name, const char *descr_a, int fd_a,
+		const char *descr_b, int fd_b) :
+		a("a", descr_a, fd_a),
+		b("b", descr_b, fd_b),
+		a_tx_socket("a_tx_socket"),
+		b_rx_socket("b_rx_socket"),
+		a_rx_socket("a_rx_socket"),
+		b_tx_socket("b_tx_socket"),
+		rx_count(0)
+	{
+		SC_THREAD(check);
+
+		a_tx_socket.bind(a.tx_socket);
+		a.rx_socket.bind(a_rx_socket);
+		b_tx_socket.bind(b.tx_socket);
+		b.rx_socket.bind(b_rx_socket);
+
+		a_rx_socket.register_b_transport(this, &Top::a_rx_b_transport);
+		b_rx_socket.register_b_transport(this, &Top::b_rx_b_transport);
+		nr_running++;
+	}
+};
+
+// Frames sent into a pcap file, frame i at i us.
+SC_MODULE(PcapTop)
+{
+	eth_vwire w;
+	tlm_utils::simple_initiator_socket<PcapTop> tx_socket;
+	tlm_utils::simple_target_socket<PcapTop> rx_socket;
+
+	unsigned char txbuf[2 * 1024];
+
+	SC_HAS_PROCESS(PcapTop);
+
+	void check(void) {
+		unsigned int i;
+
+		for (i = 0; i < NR_PCAP_FRAMES; i++) {
+			sc_time delay = SC_ZERO_TIME;
+			tlm::tlm_generic_payload tr;
+			unsigned int len = frame_len(i);
+
+			wait(sc_time(i, SC_US) - sc_time_stamp());
+
+			memset(txbuf, i & 0xff, len);
+			tr.set_command(tlm::TLM_WRITE_COMMAND);
+			tr.set_address(0);
+			tr.set_data_ptr(txbuf);
+			tr.set_data_length(len);
+			tr.set_streaming_width(len);
+			tr.set_dmi_allowed(false);
+			tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+			tx_socket->b_transport(tr, delay);
+			assert(tr.get_response_status() == tlm::TLM_OK_RESPONSE);
+		}
+
+		// Let the last batch go out.
+		wait(1, SC_US);
+		check_done();
+	}
+
+	void rx_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		// Nothing is received from a pcap file.
+		assert(0);
+	}
+
+	PcapTop(sc_module_name name, const char *descr) :
+		w("w", descr),
+		tx_socket("tx_socket"),
+		rx_socket("rx_socket")
+	{
+		SC_THREAD(check);
+
+		tx_socket.bind(w.tx_socket);
+		w.rx_socket.bind(rx_socket);
+		rx_socket.register_b_transport(this, &PcapTop::rx_b_transport);
+		nr_running++;
+	}
+};
+
+// Reads back the file written by PcapTop.
+static void check_pcap(const char *path)
+{
+	unsigned char buf[2 * 1024];
+	uint32_t hdr[6];
+	uint32_t rec[4];
+	unsigned int i, j;
+	FILE *f;
+
+	f = fopen(path, "rb");
+	assert(f);
+
+	assert(fread(hdr, sizeof hdr, 1, f) == 1);
+	// Nanosecond timestamps, Ethernet link type.
+	assert(hdr[0] == 0xa1b23c4d);
+	assert(hdr[5] == 1);
+
+	for (i = 0; i < NR_PCAP_FRAMES; i++) {
+		unsigned int len = frame_len(i);
+
+		assert(fread(rec, sizeof rec, 1, f) == 1);
+		assert(rec[0] == 0 && rec[1] == i * 1000);
+		assert(rec[2] == len && rec[3] == len);
+
+		assert(fread(buf, len, 1, f) == 1);
+		for (j = 0; j < len; j++) {
+			assert(buf[j] == (i & 0xff));
+		}
+	}
+	assert(fread(rec, 1, 1, f) == 0);
+	fclose(f);
+
+	printf("%u frames in %s\n", NR_PCAP_FRAMES, path);
+}
+
+int sc_main(int argc, char *argv[])
+{
+	std::string base = "check-vwire-" + std::to_string(getpid());
+	std::string sock = "unix:" + base + ".sock";
+	std::string sock_listen = "unix-listen:" + base + ".sock";
+	std::string pcap = base + ".pcap";
+	std::string pcap_descr = "pcap:" + pcap;
+	int sv[2];
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) < 0) {
+		perror("socketpair");
+		return 1;
+	}
+
+	Top top_fd("top_fd", NULL, sv[0], NULL, sv[1]);
+	Top top_unix("top_unix", sock_listen.c_str(), -1, sock.c_str(), -1);
+	PcapTop *top_pcap = new PcapTop("top_pcap", pcap_descr.c_str());
+
+	sc_start();
+
+	// Closes the pcap file.
+	delete top_pcap;
+	check_pcap(pcap.c_str());
+
+	unlink((base + ".sock").c_str());
+	unlink(pcap.c_str());
+	return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * XGMII bridges, test-suite.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc.h"
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm-bridges/tlm2xgmii-bridge.h"
+#include "tlm-bridges/xgmii2tlm-bridge.h"
+
+//
+// Frames of every len % 8, short and long ones. Frame i is handed to the
+// bridge at its time (in ns), frames with the same time go back to back and
+// some times fall on a clock edge (but not the first one, at 0).
+//
+static const struct {
+	unsigned int len;
+	unsigned int t;
+} frames[] = {
+	{ 60, 1 },
+	{ 61, 1 },
+	{ 62, 3 },
+	{ 63, 20000 },
+	{ 64, 20000 },
+	{ 65, 20000 },
+	{ 66, 40032 },
+	{ 67, 60017 },
+	{ 1514, 80000 },
+	{ 1515, 100001 },
+	{ 1516, 120000 },
+	{ 1517, 120000 },
+	{ 1518, 160064 },
+	{ 1519, 180005 },
+	{ 1520, 200000 },
+	{ 1521, 200000 },
+};
+
+#define NR_FRAMES (sizeof frames / sizeof frames[0])
+
+static unsigned char frame_data(unsigned int i, unsigned int pos)
+{
+	return (i * 7 + pos) & 0xff;
+}
+
+// A tlm2xgmii_bridge feeding an xgmii2tlm_bridge, clocked or in frame mode.
+SC_MODULE(Path)
+{
+	tlm2xgmii_bridge tx;
+	xgmii2tlm_bridge rx;
+
+	sc_signal<sc_bv<64> > xxd;
+	sc_signal<sc_bv<8> > xxc;
+
+	tlm_utils::simple_initiator_socket<Path> init_socket;
+	tlm_utils::simple_target_socket<Path> sink_socket;
+
+	unsigned char txbuf[2 * 1024];
+	vector<vector<unsigned char> > rx_data;
+	vector<sc_time> rx_time;
+
+	SC_HAS_PROCESS(Path);
+
+	void send(void) {
+		unsigned int i, j;
+
+		for (i = 0; i < NR_FRAMES; i++) {
+			sc_time t(frames[i].t, SC_NS);
+			sc_time delay = SC_ZERO_TIME;
+			tlm::tlm_generic_payload tr;
+
+			// A clocked bridge may still be busy with the
+			// previous frame.
+			if (t > sc_time_stamp()) {
+				wait(t - sc_time_stamp());
+			}
+
+			for (j = 0; j < frames[i].len; j++) {
+				txbuf[j] = frame_data(i, j);
+			}
+
+			tr.set_command(tlm::TLM_WRITE_COMMAND);
+			tr.set_address(0);
+			tr.set_data_ptr(txbuf);
+			tr.set_data_length(frames[i].len);
+			tr.set_streaming_width(frames[i].len);
+			tr.set_dmi_allowed(false);
+			tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+			init_socket->b_transport(tr, delay);
+			assert(tr.get_response_status() ==
+				tlm::TLM_OK_RESPONSE);
+		}
+	}
+
+	void sink_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		unsigned char *data = trans.get_data_ptr();
+
+		rx_data.push_back(vector<unsigned char>(data,
+					data + trans.get_data_length()));
+		rx_time.push_back(sc_time_stamp() + delay);
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	Path(sc_module_name name, sc_clock& clk,
+		enum tlm2xgmii_bridge::xgmii_mode mode, bool frame_mode) :
+		tx("tx", mode, frame_mode),
+		rx("rx", (enum xgmii2tlm_bridge::xgmii_mode) mode, frame_mode),
+		xxd("xxd"),
+		xxc("xxc"),
+		init_socket("init_socket"),
+		sink_socket("sink_socket")
+	{
+		SC_THREAD(send);
+
+		tx.clk(clk);
+		tx.xxd(xxd);
+		tx.xxc(xxc);
+		rx.clk(clk);
+		rx.xxd(xxd);
+		rx.xxc(xxc);
+
+		init_socket.bind(tx.tgt_socket);
+		if (frame_mode) {
+			tx.frame_init_socket.bind(rx.frame_tgt_socket);
+		}
+		rx.init_socket.bind(sink_socket);
+		sink_socket.register_b_transport(this, &Path::sink_b_transport);
+	}
+};
+
+static bool check(const char *name, Path& clocked, Path& frame)
+{
+	unsigned int i, j;
+
+	if (clocked.rx_data.size() != NR_FRAMES ||
+		frame.rx_data.size() != NR_FRAMES) {
+		printf("%s: %u clocked / %u frame mode of %u frames received\n",
+			name, (unsigned int) clocked.rx_data.size(),
+			(unsigned int) frame.rx_data.size(),
+			(unsigned int) NR_FRAMES);
+		return false;
+	}
+
+	for (i = 0; i < NR_FRAMES; i++) {
+		if (clocked.rx_data[i].size() != frames[i].len ||
+			frame.rx_data[i].size() != frames[i].len) {
+			printf("%s: frame %u is %u bytes clocked, %u in frame "
+				"mode, sent %u\n", name, i,
+				(unsigned int) clocked.rx_data[i].size(),
+				(unsigned int) frame.rx_data[i].size(),
+				frames[i].len);
+			return false;
+		}
+
+		for (j = 0; j < frames[i].len; j++) {
+			if (clocked.rx_data[i][j] != frame_data(i, j) ||
+				frame.rx_data[i][j] != frame_data(i, j)) {
+				printf("%s: frame %u differs at byte %u\n",
+					name, i, j);
+				return false;
+			}
+		}
+
+		if (clocked.rx_time[i] != frame.rx_time[i]) {
+			printf("%s: frame %u received at %s clocked, at %s in "
+				"frame mode\n", name, i,
+				clocked.rx_time[i].to_string().c_str(),
+				frame.rx_time[i].to_string().c_str());
+			return false;
+		}
+	}
+
+	printf("%s: %u frames, same data and timing in frame mode\n",
+		name, (unsigned int) NR_FRAMES);
+	return true;
+}
+
+int sc_main(int argc, char *argv[])
+{
+	sc_clock clk_10g("clk_10g", sc_time(6.4, SC_NS));
+	sc_clock clk_1g("clk_1g", sc_time(8, SC_NS));
+
+	Path p10g("p10g", clk_10g, tlm2xgmii_bridge::MODE_10G, false);
+	Path p10g_frame("p10g_frame", clk_10g,
+				tlm2xgmii_bridge::MODE_10G, true);
+	Path p1g("p1g", clk_1g, tlm2xgmii_bridge::MODE_1G, false);
+	Path p1g_frame("p1g_frame", clk_1g, tlm2xgmii_bridge::MODE_1G, true);
+	bool ok = true;
+
+	sc_start(1, SC_MS);
+
+	ok &= check("10G", p10g, p10g_frame);
+	ok &= check("1G", p1g, p1g_frame);
+
+	return ok ? 0 : 1;
+}
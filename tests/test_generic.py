@@ -81,10 +81,16 @@ hwb_pcie_tests = ['./rtl-bridges/pcie/{0}'.format(i) for i in hwb_pcie_testnames
 
 mrmac_tests = ['./soc/net/ethernet/check-mrmac']
 
+vwire_tests = ['./soc/net/ethernet/check-vwire']
+
+xgmii_tests = ['./soc/net/ethernet/check-xgmii']
+
 qdma_tests = ['./soc/pci/xilinx/check-qdma']
 
 hsc_tests = ['./soc/crypto/xilinx/check-hsc']
 
+mcdma_tests = ['./soc/dma/xilinx/check-mcdma']
+
 @pytest.mark.parametrize("filename", testnames_axi)
 def test_tg_axi_tests(filename):
 	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
@@ -244,6 +250,16 @@ def test_mrmac_tests(filename):
 	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
 	assert(subprocess.call([path_exe]) == 0)
 
+@pytest.mark.parametrize("filename", vwire_tests)
+def test_vwire_tests(filename):
+	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
+	assert(subprocess.call([path_exe]) == 0)
+
+@pytest.mark.parametrize("filename", xgmii_tests)
+def test_xgmii_tests(filename):
+	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
+	assert(subprocess.call([path_exe]) == 0)
+
 @pytest.mark.qdma
 @pytest.mark.parametrize("filename", qdma_tests)
 def test_qdma_tests(filename):
@@ -255,3 +271,8 @@ def test_qdma_tests(filename):
 def test_hsc_tests(filename):
 	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
 	assert(subprocess.call([path_exe]) == 0)
+
+@pytest.mark.parametrize("filename", mcdma_tests)
+def test_mcdma_tests(filename):
+	path_exe = os.path.normpath(os.path.dirname(__file__) + '/' + filename)
+	assert(subprocess.call([path_exe]) == 0)
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018 Xilinx Inc.
+ * Written by Edgar E. Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include "tlm-bridges/tlm2axi-bridge.h"
+#include "tlm-bridges/axi2tlm-bridge.h"
+#include "tlm-bridges/tlm2axilite-bridge.h"
+#include "tlm-bridges/axilite2tlm-bridge.h"
+#include "checkers/pc-axi.h"
+#include "checkers/pc-axilite.h"
+#include "test-modules/memory.h"
+#include "test-modules/signals-axi.h"
+#include "test-modules/signals-axilite.h"
+
+#define RAM_SIZE (64 * 1024)
+#define NR_REQS 200
+
+//
+// Idle time between the requests of a thread, some are a multiple of the
+// clock period (and the requests then start on a clock edge) and some are
+// not.
+//
+static const unsigned int gaps_ns[] = { 0, 3, 10, 25, 0, 137, 40, 1000, 5 };
+
+#define NR_GAPS (sizeof gaps_ns / sizeof gaps_ns[0])
+
+//
+// Issues the same reads and writes on every bus (one thread each) and
+// records when each of them completes.
+//
+SC_MODULE(Initiator)
+{
+public:
+	tlm_utils::simple_initiator_socket<Initiator> socket;
+
+	vector<sc_time> m_rdDone;
+	vector<sc_time> m_wrDone;
+
+	SC_HAS_PROCESS(Initiator);
+
+	Initiator(sc_module_name name, unsigned int maxLen) :
+		socket("socket"),
+		m_maxLen(maxLen)
+	{
+		SC_THREAD(run_wr);
+		SC_THREAD(run_rd);
+	}
+
+private:
+	unsigned int m_maxLen;
+
+	void run(tlm::tlm_command cmd, unsigned int offset,
+			vector<sc_time>& done)
+	{
+		tlm::tlm_generic_payload gp;
+		uint8_t data[256];
+		unsigned int i;
+
+		memset(data, 0x5a, sizeof data);
+
+		for (i = 0; i < NR_REQS; i++) {
+			unsigned int len = 4 << (i % 3);
+			sc_time delay(SC_ZERO_TIME);
+
+			if (len > m_maxLen) {
+				len = m_maxLen;
+			}
+
+			wait(sc_time(gaps_ns[(i + offset) % NR_GAPS], SC_NS));
+
+			gp.set_command(cmd);
+			gp.set_address((i * 64 + offset * 32) % RAM_SIZE);
+			gp.set_data_ptr(data);
+			gp.set_data_length(len);
+			gp.set_streaming_width(len);
+			gp.set_byte_enable_ptr(NULL);
+			gp.set_byte_enable_length(0);
+			gp.set_dmi_allowed(false);
+			gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+			socket->b_transport(gp, delay);
+			wait(delay);
+
+			assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+			done.push_back(sc_time_stamp());
+		}
+	}
+
+	void run_wr() { run(tlm::TLM_WRITE_COMMAND, 0, m_wrDone); }
+	void run_rd() { run(tlm::TLM_READ_COMMAND, 1, m_rdDone); }
+};
+
+//
+// TLM to AXI to TLM, with or without idle skipping in both bridges.
+//
+SC_MODULE(AXIPath)
+{
+public:
+	tlm2axi_bridge<32, 32> tlm2axi;
+	axi2tlm_bridge<32, 32> axi2tlm;
+	AXIProtocolChecker<32, 32> checker;
+	AXISignals<32, 32> signals;
+	Initiator init;
+	memory mem;
+
+	AXIPath(sc_module_name name, sc_clock& clk,
+			sc_signal<bool>& resetn, bool idleSkip) :
+		tlm2axi("tlm2axi"),
+		axi2tlm("axi2tlm"),
+		checker("checker", AXIPCConfig::all_enabled()),
+		signals("signals"),
+		init("init", 256),
+		mem("mem", sc_time(10, SC_NS), RAM_SIZE)
+	{
+		tlm2axi.clk(clk);
+		axi2tlm.clk(clk);
+		checker.clk(clk);
+
+		tlm2axi.resetn(resetn);
+		axi2tlm.resetn(resetn);
+		checker.resetn(resetn);
+
+		signals.connect(tlm2axi);
+		signals.connect(checker);
+		signals.connect(axi2tlm);
+
+		init.socket.bind(tlm2axi.tgt_socket);
+		axi2tlm.socket.bind(mem.socket);
+
+		tlm2axi.set_idle_skip(idleSkip);
+		axi2tlm.set_idle_skip(idleSkip);
+	}
+};
+
+//
+// TLM to AXI4Lite to TLM, with or without idle skipping in both bridges.
+//
+SC_MODULE(AXILitePath)
+{
+public:
+	tlm2axilite_bridge<32, 32> tlm2axilite;
+	axilite2tlm_bridge<32, 32> axilite2tlm;
+	AXILiteProtocolChecker<32, 32> checker;
+	AXILiteSignals<32, 32> signals;
+	Initiator init;
+	memory mem;
+
+	AXILitePath(sc_module_name name, sc_clock& clk,
+			sc_signal<bool>& resetn, bool idleSkip) :
+		tlm2axilite("tlm2axilite"),
+		axilite2tlm("axilite2tlm"),
+		checker("checker", AXILitePCConfig::all_enabled()),
+		signals("signals"),
+		init("init", 4),
+		mem("mem", sc_time(10, SC_NS), RAM_SIZE)
+	{
+		tlm2axilite.clk(clk);
+		axilite2tlm.clk(clk);
+		checker.clk(clk);
+
+		tlm2axilite.resetn(resetn);
+		axilite2tlm.resetn(resetn);
+		checker.resetn(resetn);
+
+		signals.connect(tlm2axilite);
+		signals.connect(checker);
+		signals.connect(axilite2tlm);
+
+		init.socket.bind(tlm2axilite.tgt_socket);
+		axilite2tlm.socket.bind(mem.socket);
+
+		tlm2axilite.set_idle_skip(idleSkip);
+		axilite2tlm.set_idle_skip(idleSkip);
+	}
+};
+
+static bool compare(const char *name, vector<sc_time>& clocked,
+			vector<sc_time>& skip)
+{
+	unsigned int i;
+
+	if (clocked.size() != NR_REQS || skip.size() != NR_REQS) {
+		printf("%s: %u / %u of %u requests done\n", name,
+			(unsigned int) clocked.size(),
+			(unsigned int) skip.size(), NR_REQS);
+		return false;
+	}
+
+	for (i = 0; i < NR_REQS; i++) {
+		if (clocked[i] != skip[i]) {
+			printf("%s: request %u done at %s with idle skipping, "
+				"at %s without\n", name, i,
+				skip[i].to_string().c_str(),
+				clocked[i].to_string().c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int sc_main(int argc, char *argv[])
+{
+	sc_clock clk("clk", sc_time(10, SC_NS));
+	sc_signal<bool> resetn("resetn", true);
+
+	AXIPath axi("axi", clk, resetn, false);
+	AXIPath axi_skip("axi_skip", clk, resetn, true);
+	AXILitePath axilite("axilite", clk, resetn, false);
+	AXILitePath axilite_skip("axilite_skip", clk, resetn, true);
+	bool ok = true;
+
+	sc_start(100, SC_MS);
+
+	ok &= compare("axi reads", axi.init.m_rdDone,
+			axi_skip.init.m_rdDone);
+	ok &= compare("axi writes", axi.init.m_wrDone,
+			axi_skip.init.m_wrDone);
+	ok &= compare("axilite reads", axilite.init.m_rdDone,
+			axilite_skip.init.m_rdDone);
+	ok &= compare("axilite writes", axilite.init.m_wrDone,
+			axilite_skip.init.m_wrDone);
+
+	if (!ok) {
+		return 1;
+	}
+
+	printf("Same timing with and without idle skipping\n");
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018 Xilinx Inc.
+ * Written by Edgar E. Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <list>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm-bridges/private/axi/txn-queue.h"
+
+//
+// Stands in for the axi2tlm-bridge Transaction.
+//
+class Txn
+{
+public:
+	Txn(uint32_t id, uint64_t addr, bool barrier = false) :
+		m_id(id),
+		m_addr(addr),
+		m_barrier(barrier),
+		m_beat(1),
+		m_seq(0),
+		m_page(0)
+	{}
+
+	uint32_t GetTransactionID() { return m_id; }
+	uint64_t GetAddress() { return m_addr; }
+	bool IsBarrier() { return m_barrier; }
+
+	uint32_t GetBeat() { return m_beat; }
+	void IncBeat() { m_beat++; }
+
+	void SetQueuePos(list<Txn*>::iterator pos, uint64_t seq)
+	{
+		m_pos = pos;
+		m_seq = seq;
+	}
+	list<Txn*>::iterator GetQueuePos() { return m_pos; }
+	uint64_t GetSeq() { return m_seq; }
+
+	void SetQueuePage(uint64_t page) { m_page = page; }
+	uint64_t GetQueuePage() { return m_page; }
+
+private:
+	uint32_t m_id;
+	uint64_t m_addr;
+	bool m_barrier;
+	uint32_t m_beat;
+	list<Txn*>::iterator m_pos;
+	uint64_t m_seq;
+	uint64_t m_page;
+};
+
+typedef AMBA::AXI::TransactionQueue<Txn, false> AXIQueue;
+typedef AMBA::AXI::TransactionQueue<Txn, true> ACEQueue;
+
+//
+// Transactions with the same ID are handed out in address order, other
+// IDs are independent.
+//
+static void test_same_id()
+{
+	AXIQueue q;
+	Txn a(1, 0x0000), b(2, 0x2000), c(1, 0x5000);
+
+	q.push_back(&a);
+	q.push_back(&b);
+	q.push_back(&c);
+
+	assert(q.GetFirstWithID(1) == &a);
+	assert(q.GetFirstWithID(2) == &b);
+	assert(q.GetFirstWithID(3) == NULL);
+
+	q.remove(&a);
+	assert(q.GetFirstWithID(1) == &c);
+	assert(q.front() == &b);
+
+	q.remove(&b);
+	assert(!q.InList(2));
+	assert(q.InList(1));
+
+	q.remove(&c);
+	assert(q.empty());
+	assert(!q.InList(1));
+}
+
+//
+// A transaction waits for the earlier ones to the same 4 KB page,
+// whatever their ID, and an abort can remove one from the middle.
+//
+static void test_page_hazard()
+{
+	AXIQueue q;
+	Txn a(1, 0x1000), b(2, 0x1ff0), c(3, 0x2000), d(4, 0x1800);
+
+	q.push_back(&a);
+	q.push_back(&b);
+	q.push_back(&c);
+	q.push_back(&d);
+
+	assert(!q.OverlappingAddress(&a));
+	assert(q.OverlappingAddress(&b));
+	assert(!q.OverlappingAddress(&c));
+	assert(q.OverlappingAddress(&d));
+
+	// Aborted
+	q.remove(&b);
+	assert(q.OverlappingAddress(&d));
+
+	q.remove(&a);
+	assert(!q.OverlappingAddress(&d));
+}
+
+//
+// Reads and writes are queued separately and are not ordered against
+// each other (a master needing that order waits for the response first).
+// Writes are still ordered against earlier writes.
+//
+static void test_read_write()
+{
+	AXIQueue rd, wr;
+	Txn r(1, 0x3000), w0(1, 0x3008), w1(2, 0x3010);
+
+	rd.push_back(&r);
+	wr.push_back(&w0);
+	wr.push_back(&w1);
+
+	assert(!rd.OverlappingAddress(&r));
+	assert(!wr.OverlappingAddress(&w0));
+	assert(wr.OverlappingAddress(&w1));
+
+	wr.remove(&w0);
+	assert(!wr.OverlappingAddress(&w1));
+	assert(!rd.OverlappingAddress(&r));
+}
+
+//
+// Transactions after an ACE barrier are held until it completes, the
+// barrier itself waits to reach the front of the queue.
+//
+static void test_barrier()
+{
+	ACEQueue q;
+	AXIQueue axi;
+	Txn a(1, 0x0000), bar(2, 0x0000, true), c(3, 0x3000);
+	Txn d(1, 0x0000), axibar(2, 0x0000, true), e(3, 0x3000);
+
+	q.push_back(&a);
+	q.push_back(&bar);
+	q.push_back(&c);
+
+	assert(!q.IsAfterBarrier(&a));
+	assert(q.IsAfterBarrier(&c));
+	assert(q.front() != &bar);
+
+	q.remove(&a);
+	assert(q.front() == &bar);
+	assert(q.IsAfterBarrier(&c));
+
+	q.remove(&bar);
+	assert(!q.IsAfterBarrier(&c));
+
+	// Not tracked without ACE
+	axi.push_back(&d);
+	axi.push_back(&axibar);
+	axi.push_back(&e);
+	assert(!axi.IsAfterBarrier(&e));
+}
+
+//
+// The write data queue tracks the transactions without data (AXI3
+// write data interleaving, first beats in address order).
+//
+static void test_data_queue()
+{
+	AXIQueue q(true);
+	Txn a(1, 0x0000), b(2, 0x1000), c(1, 0x2000);
+
+	q.push_back(&a);
+	q.push_back(&b);
+	q.push_back(&c);
+
+	assert(q.PreviousHaveData(1));
+	assert(!q.PreviousHaveData(2));
+
+	q.IncBeat(&a);
+	assert(q.PreviousHaveData(2));
+
+	q.IncBeat(&b);
+	q.remove(&a);
+	assert(q.PreviousHaveData(1));
+	assert(q.GetFirstWithID(1) == &c);
+
+	// All first beats received
+	q.IncBeat(&c);
+	q.remove(&b);
+	q.remove(&c);
+	assert(q.empty());
+}
+
+int sc_main(int argc, char *argv[])
+{
+	test_same_id();
+	test_page_hazard();
+	test_read_write();
+	test_barrier();
+	test_data_queue();
+
+	printf("axi-txn-queue-test: OK\n");
+	return 0;
+}
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm-bridges/amba-chi.h"
+
+using namespace AMBA::CHI;
+
+#include "tlm-bridges/private/ccix/portstate.h"
+#include "tlm-bridges/tlm2cxs-bridge.h"
+
+//
+// Provides the CXS ports and the types TxLink and RxLink use from the
+// bridge, with the TX side looped back into the RX side. The flits are
+// 128 bytes with at most 3 packets starting (ending) in each.
+//
+SC_MODULE(CXSLink)
+{
+	enum {
+		FLIT_WIDTH = 1024,
+		MAX_PKT_PER_FLIT = 3,
+
+		START_PTR_WIDTH = 3,
+		END_PTR_WIDTH = 5,
+
+		CNTL_WIDTH =
+			(3 * MAX_PKT_PER_FLIT) +
+			(MAX_PKT_PER_FLIT * START_PTR_WIDTH) +
+			(MAX_PKT_PER_FLIT * END_PTR_WIDTH),
+	};
+
+	typedef CXSCntl<CXSLink> CXSCntl_t;
+	typedef TLPHdr_comp TLPHdr_t;
+	typedef TLP<CXSLink> TLP_t;
+	typedef TLPAssembler<TLPHdr_t> TLPAssembler_t;
+	typedef TLPFactory<CXSLink> TLPFactory_t;
+
+	sc_in<bool > clk;
+	sc_in<bool > resetn;
+
+	sc_out<bool > txactivereq;
+	sc_in<bool >  txactiveack;
+	sc_in<bool >  txdeacthint;
+
+	sc_out<bool > txvalid;
+	sc_out<sc_bv<FLIT_WIDTH> > txdata;
+	sc_out<sc_bv<CNTL_WIDTH> > txcntl;
+	sc_in<bool > txcrdgnt;
+	sc_out<bool > txcrdrtn;
+
+	sc_in<bool >  rxactivereq;
+	sc_out<bool > rxactiveack;
+
+	sc_in<bool > rxvalid;
+	sc_in<sc_bv<FLIT_WIDTH> > rxdata;
+	sc_in<sc_bv<CNTL_WIDTH> > rxcntl;
+	sc_out<bool > rxcrdgnt;
+	sc_in<bool > rxcrdrtn;
+
+	sc_signal<bool > activereq;
+	sc_signal<bool > activeack;
+	sc_signal<bool > deacthint;
+
+	sc_signal<bool > valid;
+	sc_signal<sc_bv<FLIT_WIDTH> > data;
+	sc_signal<sc_bv<CNTL_WIDTH> > cntl;
+	sc_signal<bool > crdgnt;
+	sc_signal<bool > crdrtn;
+
+	TxLink<CXSLink> tx;
+	RxLink<CXSLink> rx;
+
+	CXSLink(sc_module_name name) :
+		sc_module(name),
+
+		clk("clk"),
+		resetn("resetn"),
+
+		txactivereq("txactivereq"),
+		txactiveack("txactiveack"),
+		txdeacthint("txdeacthint"),
+
+		txvalid("txvalid"),
+		txdata("txdata"),
+		txcntl("txcntl"),
+		txcrdgnt("txcrdgnt"),
+		txcrdrtn("txcrdrtn"),
+
+		rxactivereq("rxactivereq"),
+		rxactiveack("rxactiveack"),
+
+		rxvalid("rxvalid"),
+		rxdata("rxdata"),
+		rxcntl("rxcntl"),
+		rxcrdgnt("rxcrdgnt"),
+		rxcrdrtn("rxcrdrtn"),
+
+		activereq("activereq"),
+		activeack("activeack"),
+		deacthint("deacthint"),
+
+		valid("valid"),
+		data("data"),
+		cntl("cntl"),
+		crdgnt("crdgnt"),
+		crdrtn("crdrtn"),
+
+		tx("tx", this),
+		rx("rx", this)
+	{
+		txactivereq(activereq);
+		rxactivereq(activereq);
+		txactiveack(activeack);
+		rxactiveack(activeack);
+		txdeacthint(deacthint);
+
+		txvalid(valid);
+		rxvalid(valid);
+		txdata(data);
+		rxdata(data);
+		txcntl(cntl);
+		rxcntl(cntl);
+		txcrdgnt(crdgnt);
+		rxcrdgnt(crdgnt);
+		txcrdrtn(crdrtn);
+		rxcrdrtn(crdrtn);
+	}
+};
+
+typedef CXSLink::CXSCntl_t CXSCntl_t;
+typedef CXSLink::TLP_t TLP_t;
+typedef CXSLink::TLPFactory_t TLPFactory_t;
+
+//
+// Byte positions of the packets in a flit, the end is the position after
+// the last byte.
+//
+struct FlitLayout {
+	unsigned int numStart;
+	unsigned int start[CXSLink::MAX_PKT_PER_FLIT];
+	unsigned int numEnd;
+	unsigned int end[CXSLink::MAX_PKT_PER_FLIT];
+};
+
+//
+// Reads are 28 byte TLPs, the full write 92 bytes and the partial write 40
+// bytes (16 byte TLP header included).
+//
+static const FlitLayout expected[] = {
+	//
+	// Reads 0 - 3: three fit in the flit but the fourth has to wait for
+	// a free Start field.
+	//
+	{ 3, { 0, 32, 64 }, 3, { 28, 60, 92 } },
+	{ 1, { 0 }, 1, { 28 } },
+
+	//
+	// Read 4, read 5, full write 6 and read 7: the write continues into
+	// the next flit, where the first EndPtr is the write's.
+	//
+	{ 3, { 0, 32, 64 }, 2, { 28, 60 } },
+	{ 1, { 32 }, 2, { 28, 60 } },
+
+	//
+	// Partial write 8 and read 9: the read starts at the next 16 byte
+	// boundary.
+	//
+	{ 2, { 0, 48 }, 2, { 40, 76 } },
+};
+
+enum {
+	NUM_FLITS = sizeof(expected) / sizeof(expected[0]),
+
+	NUM_TLPS = 10,
+	FULL_WRITE = 6,
+	PTL_WRITE = 8,
+	PTL_WRITE_SZ = 8,
+
+	BASE_ADDR = 0x1000,
+};
+
+SC_MODULE(Top)
+{
+	sc_clock clk;
+	sc_signal<bool> resetn;
+
+	CXSLink link;
+
+	tlm::tlm_generic_payload gp[NUM_TLPS];
+	uint8_t buf[NUM_TLPS][CACHELINE_SZ];
+
+	vector<CXSCntl_t> flits;
+	unsigned int received;
+	sc_event rx_event;
+	bool done;
+
+	SC_HAS_PROCESS(Top);
+
+	void setup_gp(unsigned int i)
+	{
+		ccixattr_extension *attr = new ccixattr_extension();
+		unsigned int j;
+
+		for (j = 0; j < CACHELINE_SZ; j++) {
+			buf[i][j] = i * 16 + j;
+		}
+
+		gp[i].set_address(BASE_ADDR + i * CACHELINE_SZ);
+		gp[i].set_data_ptr(buf[i]);
+		gp[i].set_data_length(CACHELINE_SZ);
+		gp[i].set_streaming_width(CACHELINE_SZ);
+		gp[i].set_byte_enable_ptr(NULL);
+		gp[i].set_byte_enable_length(0);
+		gp[i].set_command(tlm::TLM_READ_COMMAND);
+		gp[i].set_extension(attr);
+
+		attr->SetMsgType(Msg::Type::Req);
+		attr->SetTxnID(i);
+		attr->SetReqOp(Msg::ReqOp::ReadNoSnp);
+
+		if (i == FULL_WRITE) {
+			gp[i].set_command(tlm::TLM_WRITE_COMMAND);
+			attr->SetReqOp(Msg::ReqOp::WriteNoSnpFull);
+		} else if (i == PTL_WRITE) {
+			gp[i].set_command(tlm::TLM_WRITE_COMMAND);
+			gp[i].set_data_length(PTL_WRITE_SZ);
+			gp[i].set_streaming_width(PTL_WRITE_SZ);
+			attr->SetReqOp(Msg::ReqOp::WriteNoSnpPtl);
+		}
+	}
+
+	void send(unsigned int i)
+	{
+		TLP_t *t = TLPFactory_t::Create(&gp[i]);
+
+		assert(t);
+
+		//
+		// Keep the TLPs in index order in the TX queue
+		//
+		wait(sc_time(i, SC_PS));
+
+		link.tx.Process(t);
+
+		assert(gp[i].get_response_status() == tlm::TLM_OK_RESPONSE);
+
+		delete t;
+	}
+
+	void send_tlps(unsigned int first, unsigned int last)
+	{
+		unsigned int i;
+
+		for (i = first; i <= last; i++) {
+			sc_spawn(sc_bind(&Top::send, this, i));
+		}
+
+		while (received <= last) {
+			wait(rx_event);
+		}
+	}
+
+	void run()
+	{
+		link.activereq.write(true);
+		link.activeack.write(true);
+
+		send_tlps(0, 3);
+		send_tlps(4, 7);
+		send_tlps(8, 9);
+
+		check_flits();
+
+		done = true;
+		sc_stop();
+	}
+
+	//
+	// The messages arrive in order with the content they were sent with
+	//
+	void rx_thread()
+	{
+		while (true) {
+			IMsg *msg = link.rx.GetNext();
+			tlm::tlm_generic_payload& rgp = msg->GetGP();
+			ccixattr_extension *attr = msg->GetCCIXAttr();
+			unsigned int i = received;
+
+			assert(i < NUM_TLPS);
+			assert(attr->GetMsgType() == Msg::Type::Req);
+			assert(attr->GetTxnID() == i);
+			assert(rgp.get_address() == gp[i].get_address());
+
+			if (gp[i].is_write()) {
+				unsigned int len = gp[i].get_data_length();
+
+				assert(rgp.is_write());
+				assert(rgp.get_data_length() == len);
+				assert(memcmp(rgp.get_data_ptr(),
+						buf[i], len) == 0);
+			}
+
+			delete msg;
+
+			received++;
+			rx_event.notify();
+		}
+	}
+
+	void monitor()
+	{
+		if (link.valid.read()) {
+			flits.push_back(
+				CXSCntl_t(link.cntl.read().to_uint64()));
+		}
+	}
+
+	void check_flits()
+	{
+		unsigned int i;
+		unsigned int j;
+
+		assert(flits.size() == NUM_FLITS);
+
+		for (i = 0; i < NUM_FLITS; i++) {
+			CXSCntl_t& c = flits[i];
+			const FlitLayout& l = expected[i];
+
+			assert(c.GetNumStartPtrs() == l.numStart);
+			assert(c.GetNumEndPtrs() == l.numEnd);
+
+			for (j = 0; j < l.numStart; j++) {
+				assert(c.GetStartByte(j) == l.start[j]);
+			}
+			for (j = 0; j < l.numEnd; j++) {
+				assert(c.GetEndByte(j) == l.end[j]);
+			}
+		}
+	}
+
+	Top(sc_module_name name) :
+		sc_module(name),
+		clk("clk", sc_time(10, SC_NS)),
+		resetn("resetn", true),
+		link("link"),
+		received(0),
+		done(false)
+	{
+		unsigned int i;
+
+		link.clk(clk);
+		link.resetn(resetn);
+
+		for (i = 0; i < NUM_TLPS; i++) {
+			setup_gp(i);
+		}
+
+		SC_THREAD(run);
+		SC_THREAD(rx_thread);
+
+		SC_METHOD(monitor);
+		sensitive << clk.posedge_event();
+		dont_initialize();
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	Top top("top");
+
+	sc_start(1, SC_MS);
+
+	assert(top.done);
+
+	printf("ccix-link-test: OK\n");
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm-modules/private/ccix/txnpool.h"
+
+using namespace CCIX;
+
+class Txn
+{
+public:
+	static void *operator new(size_t sz)
+	{
+		return TxnPool<Txn>::Alloc(sz);
+	}
+
+	static void operator delete(void *p, size_t sz)
+	{
+		TxnPool<Txn>::Free(p, sz);
+	}
+
+	virtual ~Txn() {}
+
+	uint64_t m_data[4];
+};
+
+class BigTxn : public Txn
+{
+public:
+	uint64_t m_more[4];
+};
+
+typedef TxnPool<Txn> Pool;
+
+//
+// Freed transactions are handed out again, live ones never twice.
+//
+static void test_reuse()
+{
+	Txn *a, *b, *c, *d;
+
+	Pool::AddUser();
+
+	a = new Txn();
+	b = new Txn();
+	assert(a != b);
+	assert(Pool::GetNumFree() == 0);
+
+	delete a;
+	assert(Pool::GetNumFree() == 1);
+
+	c = new Txn();
+	assert(c == a);
+	assert(Pool::GetNumFree() == 0);
+
+	d = new Txn();
+	assert(d != b && d != c);
+
+	delete b;
+	delete c;
+	delete d;
+	assert(Pool::GetNumFree() == 3);
+
+	Pool::RemoveUser();
+}
+
+//
+// Only objects of the pooled size are recycled, and no more than MaxFree.
+//
+static void test_size()
+{
+	vector<Txn*> txns;
+	unsigned int i;
+
+	Pool::AddUser();
+
+	delete new BigTxn();
+	assert(Pool::GetNumFree() == 0);
+
+	for (i = 0; i < Pool::MaxFree + 8; i++) {
+		txns.push_back(new Txn());
+	}
+	for (i = 0; i < txns.size(); i++) {
+		delete txns[i];
+	}
+	assert(Pool::GetNumFree() == Pool::MaxFree);
+
+	Pool::RemoveUser();
+}
+
+//
+// The free list is released with the last user and frees after that go
+// back to the heap.
+//
+static void test_release()
+{
+	Txn *a, *b;
+
+	assert(Pool::GetNumFree() == 0);
+
+	Pool::AddUser();
+	Pool::AddUser();
+
+	a = new Txn();
+	b = new Txn();
+	delete a;
+	assert(Pool::GetNumFree() == 1);
+
+	Pool::RemoveUser();
+	assert(Pool::GetNumFree() == 1);
+
+	Pool::RemoveUser();
+	assert(Pool::GetNumFree() == 0);
+
+	delete b;
+	assert(Pool::GetNumFree() == 0);
+}
+
+int sc_main(int argc, char *argv[])
+{
+	test_reuse();
+	test_size();
+	test_release();
+
+	printf("ccix-txnpool-test: OK\n");
+	return 0;
+}
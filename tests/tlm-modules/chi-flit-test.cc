@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm-bridges/amba-chi.h"
+#include "tlm-extensions/chiattr.h"
+#include "tlm-bridges/private/chi/pkts.h"
+
+using namespace AMBA::CHI;
+using namespace AMBA::CHI::BRIDGES;
+
+//
+// Builds a flit the way the sc_bv based packets used to, one field at the
+// time with range assignments starting at bit 0. The flits created by the
+// packets are compared against it, so the field order is written out here
+// again instead of taken from flit-layout.h.
+//
+template<int FLIT_WIDTH>
+class RefFlit
+{
+public:
+	RefFlit() :
+		m_pos(0)
+	{}
+
+	void Set(uint64_t val, unsigned int width)
+	{
+		if (width) {
+			unsigned int lastbit = m_pos + width - 1;
+
+			if (width < 64) {
+				val &= (UINT64_C(1) << width) - 1;
+			}
+			flit.range(lastbit, m_pos) = static_cast<sc_dt::uint64>(val);
+		}
+		m_pos += width;
+	}
+
+	void SetBytes(const uint8_t *buf, unsigned int len)
+	{
+		unsigned int i;
+
+		for (i = 0; i < len; i++) {
+			Set(buf[i], 8);
+		}
+	}
+
+	unsigned int GetPos() { return m_pos; }
+
+	sc_bv<FLIT_WIDTH> flit;
+private:
+	unsigned int m_pos;
+};
+
+//
+// Widths as used by the bridges, with the address and DataCheck fields
+// (and the byte enables of a 512 bit data channel) wider than 32 bits.
+//
+typedef ReqPkt<44, 7, 32> ReqPkt_t;
+typedef RspPkt<7> RspPkt_t;
+typedef SnpPkt<44 - 3, 7> SnpPkt_t;
+typedef DatPkt<512, 7, 32, 64, 8, Dat::Opcode_Width> DatPkt_t;
+
+//
+// A 128 bit data channel, a cache line is transferred in 4 flits.
+//
+typedef DatPkt<128, 7, 0, 16, 2, Dat::Opcode_Width> NarrowDatPkt_t;
+
+static chiattr_extension *get_chiattr(tlm::tlm_generic_payload& gp)
+{
+	chiattr_extension *chiattr;
+
+	gp.get_extension(chiattr);
+	assert(chiattr);
+
+	return chiattr;
+}
+
+static void test_req()
+{
+	tlm::tlm_generic_payload gp;
+	chiattr_extension *attr = new chiattr_extension();
+	RefFlit<ReqPkt_t::FLIT_WIDTH> ref;
+	uint8_t data[CACHELINE_SZ];
+	sc_bv<ReqPkt_t::FLIT_WIDTH> flit;
+	uint64_t addr = UINT64_C(0xabc12345678);
+
+	memset(data, 0, sizeof(data));
+
+	gp.set_address(addr);
+	gp.set_data_ptr(data);
+	gp.set_data_length(CACHELINE_SZ);
+	gp.set_extension(attr);
+
+	attr->SetQoS(0xa);
+	attr->SetTgtID(0x55);
+	attr->SetSrcID(0x2a);
+	attr->SetTxnID(0x9c);
+	attr->SetReturnNID_StashNID(0x33);
+	attr->SetStashNIDValid_Endian(true);
+	attr->SetReturnTxnID(0x27);
+	attr->SetOpcode(Req::ReadShared);
+	attr->SetNonSecure(true);
+	attr->SetLikelyShared(true);
+	attr->SetAllowRetry(false);
+	attr->SetOrder(0x2);
+	attr->SetPCrdType(0x5);
+	attr->SetAllocate(true);
+	attr->SetCacheable(true);
+	attr->SetDeviceMemory(false);
+	attr->SetEarlyWrAck(true);
+	attr->SetSnpAttr(true);
+	attr->SetLPID(0x15);
+	attr->SetExcl_SnoopMe(true);
+	attr->SetExpCompAck(true);
+	attr->SetTraceTag(true);
+	attr->SetRSVDC(0xdeadbeef);
+
+	ref.Set(0xa, ReqPkt_t::QoS_Width);
+	ref.Set(0x55, ReqPkt_t::TgtID_Width);
+	ref.Set(0x2a, ReqPkt_t::SrcID_Width);
+	ref.Set(0x9c, ReqPkt_t::TxnID_Width);
+	ref.Set(0x33, ReqPkt_t::ReturnNID_StashNID_Width);
+	ref.Set(1, ReqPkt_t::StashNIDValid_Endian_Width);
+	ref.Set(0x27, ReqPkt_t::ReturnTxnID_Width);
+	ref.Set(Req::ReadShared, ReqPkt_t::Opcode_Width);
+	ref.Set(6, ReqPkt_t::Size_Width);
+	ref.Set(addr, ReqPkt_t::Addr_Width);
+	ref.Set(1, ReqPkt_t::NS_Width);
+	ref.Set(1, ReqPkt_t::LikelyShared_Width);
+	ref.Set(0, ReqPkt_t::AllowRetry_Width);
+	ref.Set(0x2, ReqPkt_t::Order_Width);
+	ref.Set(0x5, ReqPkt_t::PCrdType_Width);
+	ref.Set(0xd, ReqPkt_t::MemAttr_Width);
+	ref.Set(1, ReqPkt_t::SnpAttr_Width);
+	ref.Set(0x15, ReqPkt_t::LPID_Width);
+	ref.Set(1, ReqPkt_t::ExclSnoopMe_Width);
+	ref.Set(1, ReqPkt_t::ExpCompAck_Width);
+	ref.Set(1, ReqPkt_t::TraceTag_Width);
+	ref.Set(0xdeadbeef, ReqPkt_t::RSVDC_Width);
+
+	assert(ref.GetPos() == ReqPkt_t::FLIT_WIDTH);
+
+	ReqPkt_t(&gp).CreateFlit(flit);
+	assert(flit == ref.flit);
+
+	//
+	// Parse it back, the address is wider than 32 bits.
+	//
+	ReqPkt_t req(flit);
+	tlm::tlm_generic_payload& rgp = req.GetGP();
+	chiattr_extension *r = get_chiattr(rgp);
+
+	assert(rgp.get_address() == addr);
+	assert(rgp.get_data_length() == CACHELINE_SZ);
+
+	assert(r->GetQoS() == 0xa);
+	assert(r->GetTgtID() == 0x55);
+	assert(r->GetSrcID() == 0x2a);
+	assert(r->GetTxnID() == 0x9c);
+	assert(r->GetReturnNID_StashNID() == 0x33);
+	assert(r->GetStashNIDValid_Endian() == true);
+	assert(r->GetReturnTxnID() == 0x27);
+	assert(r->GetOpcode() == Req::ReadShared);
+	assert(r->GetNonSecure() == true);
+	assert(r->GetLikelyShared() == true);
+	assert(r->GetAllowRetry() == false);
+	assert(r->GetOrder() == 0x2);
+	assert(r->GetPCrdType() == 0x5);
+	assert(r->GetAllocate() == true);
+	assert(r->GetCacheable() == true);
+	assert(r->GetDeviceMemory() == false);
+	assert(r->GetEarlyWrAck() == true);
+	assert(r->GetSnpAttr() == true);
+	assert(r->GetLPID() == 0x15);
+	assert(r->GetExcl_SnoopMe() == true);
+	assert(r->GetExpCompAck() == true);
+	assert(r->GetTraceTag() == true);
+	assert(r->GetRSVDC() == 0xdeadbeef);
+}
+
+static void test_rsp()
+{
+	tlm::tlm_generic_payload gp;
+	chiattr_extension *attr = new chiattr_extension();
+	RefFlit<RspPkt_t::FLIT_WIDTH> ref;
+	sc_bv<RspPkt_t::FLIT_WIDTH> flit;
+
+	gp.set_extension(attr);
+
+	attr->SetQoS(0x3);
+	attr->SetTgtID(0x41);
+	attr->SetSrcID(0x7f);
+	attr->SetTxnID(0xe1);
+	attr->SetOpcode(Rsp::CompDBIDResp);
+	attr->SetRespErr(0x2);
+	attr->SetResp(0x5);
+	attr->SetFwdState_DataPull(0x3);
+	attr->SetDBID(0x8b);
+	attr->SetPCrdType(0xc);
+	attr->SetTraceTag(true);
+
+	ref.Set(0x3, RspPkt_t::QoS_Width);
+	ref.Set(0x41, RspPkt_t::TgtID_Width);
+	ref.Set(0x7f, RspPkt_t::SrcID_Width);
+	ref.Set(0xe1, RspPkt_t::TxnID_Width);
+	ref.Set(Rsp::CompDBIDResp, RspPkt_t::Opcode_Width);
+	ref.Set(0x2, RspPkt_t::RespErr_Width);
+	ref.Set(0x5, RspPkt_t::Resp_Width);
+	ref.Set(0x3, RspPkt_t::FwdState_DataPull_Width);
+	ref.Set(0x8b, RspPkt_t::DBID_Width);
+	ref.Set(0xc, RspPkt_t::PCrdType_Width);
+	ref.Set(1, RspPkt_t::TraceTag_Width);
+
+	assert(ref.GetPos() == RspPkt_t::FLIT_WIDTH);
+
+	RspPkt_t(&gp).CreateFlit(flit);
+	assert(flit == ref.flit);
+
+	RspPkt_t rsp(flit);
+	chiattr_extension *r = get_chiattr(rsp.GetGP());
+
+	assert(r->GetQoS() == 0x3);
+	assert(r->GetTgtID() == 0x41);
+	assert(r->GetSrcID() == 0x7f);
+	assert(r->GetTxnID() == 0xe1);
+	assert(r->GetOpcode() == Rsp::CompDBIDResp);
+	assert(r->GetRespErr() == 0x2);
+	assert(r->GetResp() == 0x5);
+	assert(r->GetFwdState_DataPull() == 0x3);
+	assert(r->GetDBID() == 0x8b);
+	assert(r->GetPCrdType() == 0xc);
+	assert(r->GetTraceTag() == true);
+}
+
+static void test_snp()
+{
+	tlm::tlm_generic_payload gp;
+	chiattr_extension *attr = new chiattr_extension();
+	RefFlit<SnpPkt_t::FLIT_WIDTH> ref;
+	sc_bv<SnpPkt_t::FLIT_WIDTH> flit;
+	uint64_t addr = UINT64_C(0xf0e1d2c3b48);
+
+	gp.set_address(addr);
+	gp.set_extension(attr);
+
+	attr->SetQoS(0x9);
+	attr->SetSrcID(0x12);
+	attr->SetTxnID(0x6d);
+	attr->SetFwdNID(0x64);
+	attr->SetFwdTxnID(0xb2);
+	attr->SetOpcode(Snp::SnpUnique);
+	attr->SetNonSecure(false);
+	attr->SetDoNotGoToSD(true);
+	attr->SetRetToSrc(true);
+	attr->SetTraceTag(false);
+
+	ref.Set(0x9, SnpPkt_t::QoS_Width);
+	ref.Set(0x12, SnpPkt_t::SrcID_Width);
+	ref.Set(0x6d, SnpPkt_t::TxnID_Width);
+	ref.Set(0x64, SnpPkt_t::FwdNID_Width);
+	ref.Set(0xb2, SnpPkt_t::FwdTxnID_Width);
+	ref.Set(Snp::SnpUnique, SnpPkt_t::Opcode_Width);
+	ref.Set(addr >> 3, SnpPkt_t::Addr_Width);
+	ref.Set(0, SnpPkt_t::NS_Width);
+	ref.Set(1, SnpPkt_t::DoNotGoToSD_Width);
+	ref.Set(1, SnpPkt_t::RetToSrc_Width);
+	ref.Set(0, SnpPkt_t::TraceTag_Width);
+
+	assert(ref.GetPos() == SnpPkt_t::FLIT_WIDTH);
+
+	SnpPkt_t(&gp).CreateFlit(flit);
+	assert(flit == ref.flit);
+
+	SnpPkt_t snp(flit);
+	tlm::tlm_generic_payload& sgp = snp.GetGP();
+	chiattr_extension *r = get_chiattr(sgp);
+
+	assert(sgp.get_address() == addr);
+
+	assert(r->GetQoS() == 0x9);
+	assert(r->GetSrcID() == 0x12);
+	assert(r->GetTxnID() == 0x6d);
+	assert(r->GetFwdNID() == 0x64);
+	assert(r->GetFwdTxnID() == 0xb2);
+	assert(r->GetOpcode() == Snp::SnpUnique);
+	assert(r->GetNonSecure() == false);
+	assert(r->GetDoNotGoToSD() == true);
+	assert(r->GetRetToSrc() == true);
+	assert(r->GetTraceTag() == false);
+}
+
+static void set_dat_attr(chiattr_extension *attr)
+{
+	attr->SetQoS(0x6);
+	attr->SetTgtID(0x0b);
+	attr->SetSrcID(0x70);
+	attr->SetTxnID(0x3e);
+	attr->SetHomeNID(0x29);
+	attr->SetOpcode(Dat::CompData);
+	attr->SetRespErr(0x1);
+	attr->SetResp(0x6);
+	attr->SetFwdState_DataPull_DataSource(0x4);
+	attr->SetDBID(0xd7);
+	attr->SetCCID(0x2);
+	attr->SetTraceTag(true);
+	attr->SetRSVDC(0x89abcdef);
+	attr->SetPoison(0);
+}
+
+template<typename DAT>
+static void set_dat_ref(RefFlit<DAT::FLIT_WIDTH>& ref,
+			unsigned int dataID, uint64_t be,
+			const uint8_t *data, uint64_t datacheck)
+{
+	ref.Set(0x6, DAT::QoS_Width);
+	ref.Set(0x0b, DAT::TgtID_Width);
+	ref.Set(0x70, DAT::SrcID_Width);
+	ref.Set(0x3e, DAT::TxnID_Width);
+	ref.Set(0x29, DAT::HomeNID_Width);
+	ref.Set(Dat::CompData, DAT::Opcode_Width);
+	ref.Set(0x1, DAT::RespErr_Width);
+	ref.Set(0x6, DAT::Resp_Width);
+	ref.Set(0x4, DAT::FwdState_DataPull_DataSource_Width);
+	ref.Set(0xd7, DAT::DBID_Width);
+	ref.Set(0x2, DAT::CCID_Width);
+	ref.Set(dataID, DAT::DataID_Width);
+	ref.Set(1, DAT::TraceTag_Width);
+	ref.Set(0x89abcdef, DAT::RSVDC_Width);
+	ref.Set(be, DAT::BE_Width);
+	ref.SetBytes(data, DAT::Data_Width / 8);
+	ref.Set(datacheck, DAT::DataCheck_Width);
+	ref.Set(0, DAT::Poison_Width);
+
+	assert(ref.GetPos() == DAT::FLIT_WIDTH);
+}
+
+static void test_dat()
+{
+	tlm::tlm_generic_payload gp;
+	chiattr_extension *attr = new chiattr_extension();
+	RefFlit<DatPkt_t::FLIT_WIDTH> ref;
+	sc_bv<DatPkt_t::FLIT_WIDTH> flit;
+	uint8_t data[CACHELINE_SZ];
+	uint8_t be[CACHELINE_SZ];
+	uint64_t be_mask = 0;
+	uint64_t datacheck = UINT64_C(0x0123456789abcdef);
+	unsigned int i;
+
+	for (i = 0; i < CACHELINE_SZ; i++) {
+		data[i] = i * 3 + 1;
+
+		be[i] = (i % 3) ? TLM_BYTE_ENABLED : TLM_BYTE_DISABLED;
+		if (be[i] == TLM_BYTE_ENABLED) {
+			be_mask |= UINT64_C(1) << i;
+		}
+	}
+
+	gp.set_data_ptr(data);
+	gp.set_data_length(CACHELINE_SZ);
+	gp.set_byte_enable_ptr(be);
+	gp.set_byte_enable_length(CACHELINE_SZ);
+	gp.set_extension(attr);
+
+	set_dat_attr(attr);
+	attr->SetDataCheck(datacheck);
+
+	set_dat_ref<DatPkt_t>(ref, 0, be_mask, data, datacheck);
+
+	DatPkt_t(&gp).CreateFlit(flit);
+	assert(flit == ref.flit);
+
+	//
+	// Parse it back, the byte enables and the DataCheck field are 64 bits.
+	//
+	DatPkt_t dat(flit);
+	tlm::tlm_generic_payload& dgp = dat.GetGP();
+	chiattr_extension *r = get_chiattr(dgp);
+
+	assert(dgp.get_data_length() == CACHELINE_SZ);
+	assert(memcmp(dgp.get_data_ptr(), data, CACHELINE_SZ) == 0);
+	assert(dgp.get_byte_enable_length() == CACHELINE_SZ);
+	assert(memcmp(dgp.get_byte_enable_ptr(), be, CACHELINE_SZ) == 0);
+
+	assert(r->GetQoS() == 0x6);
+	assert(r->GetTgtID() == 0x0b);
+	assert(r->GetSrcID() == 0x70);
+	assert(r->GetTxnID() == 0x3e);
+	assert(r->GetHomeNID() == 0x29);
+	assert(r->GetOpcode() == Dat::CompData);
+	assert(r->GetRespErr() == 0x1);
+	assert(r->GetResp() == 0x6);
+	assert(r->GetFwdState_DataPull_DataSource() == 0x4);
+	assert(r->GetDBID() == 0xd7);
+	assert(r->GetCCID() == 0x2);
+	assert(r->GetDataID() == 0);
+	assert(r->GetTraceTag() == true);
+	assert(r->GetRSVDC() == 0x89abcdef);
+	assert(r->GetDataCheck() == datacheck);
+	assert(r->GetPoison() == 0);
+}
+
+//
+// Only the data of the transaction goes into the flit, nothing is written
+// into the field after the data (DataCheck).
+//
+static void test_dat_data_end()
+{
+	tlm::tlm_generic_payload gp;
+	chiattr_extension *attr = new chiattr_extension();
+	RefFlit<DatPkt_t::FLIT_WIDTH> ref;
+	sc_bv<DatPkt_t::FLIT_WIDTH> flit;
+	uint8_t data[CACHELINE_SZ + 1];
+	unsigned int pos;
+
+	memset(data, 0xff, sizeof(data));
+
+	gp.set_data_ptr(data);
+	gp.set_data_length(CACHELINE_SZ);
+	gp.set_extension(attr);
+
+	set_dat_attr(attr);
+	attr->SetDataCheck(0);
+
+	set_dat_ref<DatPkt_t>(ref, 0, ~UINT64_C(0), data, 0);
+
+	DatPkt_t(&gp).CreateFlit(flit);
+	assert(flit == ref.flit);
+
+	pos = DatPkt_t::FLIT_WIDTH - DatPkt_t::Poison_Width -
+		DatPkt_t::DataCheck_Width;
+	assert(flit.range(pos + 7, pos).to_uint() == 0);
+
+	DatPkt_t dat(flit);
+
+	assert(get_chiattr(dat.GetGP())->GetDataCheck() == 0);
+}
+
+//
+// A cache line over a 128 bit data channel, each flit carries the data and
+// byte enables at the offset already sent together with its DataID.
+//
+SC_MODULE(MultiFlit)
+{
+	sc_out<sc_bv<NarrowDatPkt_t::FLIT_WIDTH> > flit_out;
+	sc_signal<sc_bv<NarrowDatPkt_t::FLIT_WIDTH> > flit;
+
+	bool done;
+
+	SC_HAS_PROCESS(MultiFlit);
+
+	void run()
+	{
+		enum { BYTES_PER_FLIT = NarrowDatPkt_t::Data_Width / 8 };
+		tlm::tlm_generic_payload gp;
+		chiattr_extension *attr = new chiattr_extension();
+		uint8_t data[CACHELINE_SZ];
+		uint8_t be[CACHELINE_SZ];
+		unsigned int i;
+
+		for (i = 0; i < CACHELINE_SZ; i++) {
+			data[i] = 0xff - i;
+			be[i] = (i & 1) ? TLM_BYTE_ENABLED : TLM_BYTE_DISABLED;
+		}
+
+		gp.set_data_ptr(data);
+		gp.set_data_length(CACHELINE_SZ);
+		gp.set_byte_enable_ptr(be);
+		gp.set_byte_enable_length(CACHELINE_SZ);
+		gp.set_extension(attr);
+
+		set_dat_attr(attr);
+		attr->SetDataCheck(0xa55a);
+
+		NarrowDatPkt_t pkt(&gp);
+
+		for (i = 0; i < CACHELINE_SZ / BYTES_PER_FLIT; i++) {
+			RefFlit<NarrowDatPkt_t::FLIT_WIDTH> ref;
+			unsigned int offset = i * BYTES_PER_FLIT;
+			uint64_t be_mask = 0;
+			unsigned int j;
+
+			for (j = 0; j < BYTES_PER_FLIT; j++) {
+				if (be[offset + j] == TLM_BYTE_ENABLED) {
+					be_mask |= UINT64_C(1) << j;
+				}
+			}
+
+			set_dat_ref<NarrowDatPkt_t>(ref, i, be_mask,
+						&data[offset], 0xa55a);
+
+			assert(!pkt.Done());
+
+			pkt.CreateFlit(flit_out);
+			wait(SC_ZERO_TIME);
+
+			sc_bv<NarrowDatPkt_t::FLIT_WIDTH> tmp = flit.read();
+
+			assert(tmp == ref.flit);
+
+			NarrowDatPkt_t dat(tmp);
+			tlm::tlm_generic_payload& dgp = dat.GetGP();
+
+			assert(get_chiattr(dgp)->GetDataID() == i);
+			assert(dgp.get_data_length() == BYTES_PER_FLIT);
+			assert(memcmp(dgp.get_data_ptr(), &data[offset],
+					BYTES_PER_FLIT) == 0);
+			assert(memcmp(dgp.get_byte_enable_ptr(), &be[offset],
+					BYTES_PER_FLIT) == 0);
+		}
+
+		assert(pkt.Done());
+
+		done = true;
+	}
+
+	MultiFlit(sc_module_name name) :
+		sc_module(name),
+		flit_out("flit_out"),
+		flit("flit"),
+		done(false)
+	{
+		flit_out(flit);
+
+		SC_THREAD(run);
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	MultiFlit multi("multi");
+
+	test_req();
+	test_rsp();
+	test_snp();
+	test_dat();
+	test_dat_data_end();
+
+	sc_start();
+
+	assert(multi.done);
+
+	printf("chi-flit-test: OK\n");
+
+	return 0;
+}
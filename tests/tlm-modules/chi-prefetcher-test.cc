@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include "tlm-modules/private/chi/prefetcher.h"
+#include "tlm-modules/cache-chi.h"
+#include "tlm-modules/iconnect-chi.h"
+#include "tlm-modules/sn-chi.h"
+#include "tests/test-modules/memory.h"
+
+using namespace AMBA::CHI;
+
+typedef RN::Prefetcher Prefetcher;
+
+static vector<uint64_t> GetCandidates(Prefetcher& pf)
+{
+	vector<uint64_t> addrs;
+	Prefetcher::Candidate c;
+
+	while (pf.GetCandidate(c)) {
+		addrs.push_back(c.GetAddress());
+	}
+
+	return addrs;
+}
+
+//
+// Nothing is generated while disabled
+//
+static void test_disabled()
+{
+	Prefetcher pf;
+
+	pf.Train(0, 0x1000, true);
+	pf.Train(0, 0x1040, true);
+	pf.Train(0, 0x1080, true);
+
+	assert(!pf.HasCandidates());
+}
+
+//
+// A next line stream is detected after ConfidenceThreshold misses and
+// 'degree' lines are prefetched 'distance' lines ahead.
+//
+static void test_next_line()
+{
+	Prefetcher pf;
+	vector<uint64_t> addrs;
+
+	pf.SetEnabled(true);
+	pf.SetDegree(2);
+	pf.SetDistance(1);
+
+	pf.Train(0, 0x1000, true);
+	assert(!pf.HasCandidates());
+
+	pf.Train(0, 0x1040, true);
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 2);
+	assert(addrs[0] == 0x1080);
+	assert(addrs[1] == 0x10c0);
+
+	pf.SetDistance(4);
+	pf.Train(0, 0x1080, true);
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 2);
+	assert(addrs[0] == 0x1180);
+	assert(addrs[1] == 0x11c0);
+}
+
+//
+// A stride stream retrains from next line to the stride.
+//
+static void test_stride()
+{
+	Prefetcher pf;
+	vector<uint64_t> addrs;
+
+	pf.SetEnabled(true);
+	pf.SetDegree(1);
+
+	pf.Train(0, 0x2000, true);
+	pf.Train(0, 0x2100, true);
+	assert(!pf.HasCandidates());
+
+	pf.Train(0, 0x2200, true);
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 1);
+	assert(addrs[0] == 0x2300);
+}
+
+//
+// Candidates never cross the page.
+//
+static void test_page_boundary()
+{
+	Prefetcher pf;
+	vector<uint64_t> addrs;
+
+	pf.SetEnabled(true);
+	pf.SetDegree(2);
+
+	pf.Train(1, 0x1f40, true);
+	pf.Train(1, 0x1f80, true);
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 1);
+	assert(addrs[0] == 0x1fc0);
+
+	pf.Train(1, 0x1fc0, true);
+	assert(!pf.HasCandidates());
+}
+
+//
+// A demand hit on a prefetched line counts as useful and keeps the
+// stream going, lines already prefetched are not generated again.
+//
+static void test_hit()
+{
+	Prefetcher pf;
+	vector<uint64_t> addrs;
+
+	pf.SetEnabled(true);
+	pf.SetDegree(2);
+
+	pf.Train(0, 0x1000, true);
+	pf.Train(0, 0x1040, true);
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 2);
+
+	pf.Issued(addrs[0], true);
+	pf.Issued(addrs[1], true);
+	assert(pf.GetIssued() == 2);
+	assert(pf.GetUseful() == 0);
+
+	// Hits on lines that were not prefetched are ignored
+	pf.Train(0, 0x1040, false);
+	assert(pf.GetUseful() == 0);
+	assert(!pf.HasCandidates());
+
+	pf.Train(0, 0x1080, false);
+	assert(pf.GetUseful() == 1);
+	assert(pf.GetAccuracy() == 50);
+
+	addrs = GetCandidates(pf);
+	assert(addrs.size() == 1);
+	assert(addrs[0] == 0x1100);
+
+	// Only the first hit is useful
+	pf.Train(0, 0x1080, false);
+	assert(pf.GetUseful() == 1);
+}
+
+//
+// PrefetchTgt requests don't allocate in the cache and are not tracked.
+//
+static void test_prefetch_tgt()
+{
+	Prefetcher pf;
+
+	pf.SetEnabled(true);
+	pf.SetOpcode(Req::PrefetchTgt);
+	assert(pf.GetOpcode() == Req::PrefetchTgt);
+
+	pf.Train(0, 0x1000, true);
+	pf.Train(0, 0x1040, true);
+	assert(GetCandidates(pf).size() == 2);
+
+	pf.Issued(0x1080, false);
+	pf.Train(0, 0x1080, false);
+	assert(pf.GetIssued() == 1);
+	assert(pf.GetUseful() == 0);
+}
+
+//
+// The degree is lowered after an epoch of unused prefetches.
+//
+static void test_throttle()
+{
+	Prefetcher pf;
+	uint64_t addr = 0x100000;
+	unsigned int i;
+
+	pf.SetEnabled(true);
+	pf.SetDegree(4);
+
+	for (i = 0; i < Prefetcher::MaxTracked + Prefetcher::EpochSz; i++) {
+		pf.Issued(addr, true);
+		addr += CACHELINE_SZ;
+	}
+	assert(pf.GetDegree() == 3);
+
+	pf.SetThrottle(false);
+	assert(pf.GetDegree() == 4);
+}
+
+#define RAM_SIZE (64 * 1024)
+
+static uint8_t ram_buf[RAM_SIZE];
+
+//
+// Counts the reads the slave node makes to memory.
+//
+SC_MODULE(ReadCounter)
+{
+	tlm_utils::simple_target_socket<ReadCounter> tgt_socket;
+	tlm_utils::simple_initiator_socket<ReadCounter> init_socket;
+
+	unsigned int reads;
+
+	SC_HAS_PROCESS(ReadCounter);
+
+	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+	{
+		if (trans.is_read()) {
+			reads++;
+		}
+		init_socket->b_transport(trans, delay);
+	}
+
+	ReadCounter(sc_module_name name) :
+		sc_module(name),
+		tgt_socket("tgt_socket"),
+		init_socket("init_socket"),
+		reads(0)
+	{
+		tgt_socket.register_b_transport(this, &ReadCounter::b_transport);
+	}
+};
+
+//
+// A cache_chi on an interconnect with a single RN-F port and a slave node.
+// Two demand misses train the prefetcher, the lines it prefetches are then
+// read without going to memory.
+//
+SC_MODULE(CacheSystem)
+{
+	cache_chi<0, 16 * CACHELINE_SZ> cache;
+	iconnect_chi<20, 10, 1> icn;
+	SlaveNode_F<10> sn;
+	ReadCounter counter;
+	memory mem;
+
+	tlm_utils::simple_initiator_socket<CacheSystem> init_socket;
+
+	bool done;
+
+	SC_HAS_PROCESS(CacheSystem);
+
+	void read_line(uint64_t addr)
+	{
+		uint8_t data[CACHELINE_SZ];
+		sc_time delay = SC_ZERO_TIME;
+		tlm::tlm_generic_payload tr;
+
+		tr.set_command(tlm::TLM_READ_COMMAND);
+		tr.set_address(addr);
+		tr.set_data_ptr(data);
+		tr.set_data_length(CACHELINE_SZ);
+		tr.set_streaming_width(CACHELINE_SZ);
+		tr.set_byte_enable_ptr(NULL);
+		tr.set_dmi_allowed(false);
+		tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		init_socket->b_transport(tr, delay);
+		assert(tr.get_response_status() == tlm::TLM_OK_RESPONSE);
+		assert(memcmp(data, ram_buf + addr, CACHELINE_SZ) == 0);
+	}
+
+	void run()
+	{
+		RN::Prefetcher& pf = cache.GetPrefetcher();
+		unsigned int reads;
+
+		cache.EnablePrefetch(true);
+		cache.SetPrefetchDegree(2);
+		cache.SetPrefetchDistance(1);
+
+		read_line(0 * CACHELINE_SZ);
+		read_line(1 * CACHELINE_SZ);
+
+		// Lines 2 and 3 are prefetched in the background
+		wait(100, SC_US);
+		assert(pf.GetIssued() == 2);
+		assert(pf.GetUseful() == 0);
+		assert(counter.reads == 4);
+
+		reads = counter.reads;
+		read_line(2 * CACHELINE_SZ);
+		assert(counter.reads == reads);
+		assert(pf.GetUseful() == 1);
+
+		wait(100, SC_US);
+
+		reads = counter.reads;
+		read_line(3 * CACHELINE_SZ);
+		assert(counter.reads == reads);
+		assert(pf.GetUseful() == 2);
+
+		done = true;
+		sc_stop();
+	}
+
+	CacheSystem(sc_module_name name) :
+		sc_module(name),
+		cache("cache"),
+		icn("icn"),
+		sn("sn"),
+		counter("counter"),
+		mem("mem", SC_ZERO_TIME, RAM_SIZE, ram_buf),
+		init_socket("init_socket"),
+		done(false)
+	{
+		unsigned int i;
+
+		for (i = 0; i < RAM_SIZE; i++) {
+			ram_buf[i] = i * 7;
+		}
+
+		init_socket.bind(cache.target_socket);
+
+		cache.txreq_init_socket.bind(icn.port_RN_F[0]->rxreq_tgt_socket);
+		cache.txrsp_init_socket.bind(icn.port_RN_F[0]->rxrsp_tgt_socket);
+		cache.txdat_init_socket.bind(icn.port_RN_F[0]->rxdat_tgt_socket);
+		icn.port_RN_F[0]->txrsp_init_socket.bind(cache.rxrsp_tgt_socket);
+		icn.port_RN_F[0]->txdat_init_socket.bind(cache.rxdat_tgt_socket);
+		icn.port_RN_F[0]->txsnp_init_socket.bind(cache.rxsnp_tgt_socket);
+
+		icn.port_SN->txreq_init_socket.bind(sn.rxreq_tgt_socket);
+		icn.port_SN->txdat_init_socket.bind(sn.rxdat_tgt_socket);
+		sn.txrsp_init_socket.bind(icn.port_SN->rxrsp_tgt_socket);
+		sn.txdat_init_socket.bind(icn.port_SN->rxdat_tgt_socket);
+
+		sn.init_socket.bind(counter.tgt_socket);
+		counter.init_socket.bind(mem.socket);
+
+		SC_THREAD(run);
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	CacheSystem sys("sys");
+
+	test_disabled();
+	test_next_line();
+	test_stride();
+	test_page_boundary();
+	test_hit();
+	test_prefetch_tgt();
+	test_throttle();
+
+	sc_start(1, SC_MS);
+	if (!sys.done) {
+		printf("chi-prefetcher-test: cache_chi prefetch did not "
+			"complete\n");
+		return 1;
+	}
+
+	printf("chi-prefetcher-test: OK\n");
+	return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm-modules/private/chi/txnids.h"
+
+using namespace AMBA::CHI;
+
+SC_MODULE(Top)
+{
+	TxnIDs ids;
+	TxnIDs ids_wide;
+	TxnIDs ids_narrow;
+
+	bool done;
+
+	SC_HAS_PROCESS(Top);
+
+	//
+	// IDs are handed out in order starting after the last allocated one,
+	// returned IDs are only reused once the search wraps around.
+	//
+	void test_next_fit()
+	{
+		unsigned int i;
+
+		assert(ids.GetNumIDs() == TxnIDs::NumIDs);
+
+		for (i = 0; i < 4; i++) {
+			assert(ids.GetID() == i);
+		}
+
+		ids.ReturnID(1);
+		assert(ids.GetID() == 4);
+
+		for (i = 5; i < TxnIDs::NumIDs; i++) {
+			assert(ids.GetID() == i);
+		}
+
+		// Wraps around to the returned ID
+		assert(ids.GetID() == 1);
+
+		ids.ReturnID(200);
+		ids.ReturnID(3);
+		assert(ids.GetID() == 3);
+		assert(ids.GetID() == 200);
+
+		printf("%s: next fit OK\n", name());
+	}
+
+	//
+	// With all IDs in use GetID waits until one is returned.
+	//
+	void test_exhaustion()
+	{
+		sc_time start = sc_time_stamp();
+
+		assert(ids.GetID() == 42);
+		assert(sc_time_stamp() - start == sc_time(10, SC_NS));
+
+		printf("%s: exhaustion OK\n", name());
+	}
+
+	void return_id()
+	{
+		wait(10, SC_NS);
+		ids.ReturnID(42);
+	}
+
+	//
+	// TxnIDs wider than 8 bits, the search crosses bitmap words.
+	//
+	void test_wide()
+	{
+		vector<bool> used(1 << 10, false);
+		unsigned int i;
+
+		assert(ids_wide.GetNumIDs() == 1 << 10);
+
+		for (i = 0; i < ids_wide.GetNumIDs(); i++) {
+			uint16_t id = ids_wide.GetID();
+
+			assert(id < ids_wide.GetNumIDs());
+			assert(!used[id]);
+			used[id] = true;
+		}
+
+		ids_wide.ReturnID(700);
+		ids_wide.ReturnID(300);
+		assert(ids_wide.GetID() == 300);
+		assert(ids_wide.GetID() == 700);
+
+		ids_wide.ReturnID(1023);
+		ids_wide.ReturnID(64);
+		assert(ids_wide.GetID() == 1023);
+		assert(ids_wide.GetID() == 64);
+
+		printf("%s: wide OK\n", name());
+	}
+
+	//
+	// Widths below 6 bits don't hand out the unused bits of the word.
+	//
+	void test_narrow()
+	{
+		unsigned int i;
+
+		assert(ids_narrow.GetNumIDs() == 8);
+
+		for (i = 0; i < 8; i++) {
+			assert(ids_narrow.GetID() == i);
+		}
+
+		ids_narrow.ReturnID(5);
+		assert(ids_narrow.GetID() == 5);
+
+		// The search wraps at 8 and not at the end of the word
+		ids_narrow.ReturnID(2);
+		assert(ids_narrow.GetID() == 2);
+
+		printf("%s: narrow OK\n", name());
+	}
+
+	void run()
+	{
+		test_next_fit();
+		test_exhaustion();
+		test_wide();
+		test_narrow();
+
+		done = true;
+		sc_stop();
+	}
+
+	Top(sc_module_name name) :
+		sc_module(name),
+		ids(),
+		ids_wide(10),
+		ids_narrow(3),
+		done(false)
+	{
+		SC_THREAD(run);
+		SC_THREAD(return_id);
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	Top top("top");
+
+	sc_start(1, SC_MS);
+
+	if (!top.done) {
+		printf("chi-txnids-test: did not complete\n");
+		return 1;
+	}
+
+	printf("chi-txnids-test: OK\n");
+	return 0;
+}
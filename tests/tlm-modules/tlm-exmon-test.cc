@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
 
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 
@@ -159,6 +160,31 @@ public:
 		exmon.init_socket.bind(ram.socket);
 	}
 
+	//
+	// The transfers above do 6 exclusive reads and 5 exclusive writes,
+	// the writes to 4 and 8 fail.
+	//
+	bool check_stats()
+	{
+		if (exmon.get_num_exclusive_reads() != 6 ||
+			exmon.get_num_exclusive_pass() != 3 ||
+			exmon.get_num_exclusive_fail() != 2 ||
+			exmon.get_exclusive_pass_rate() != 60) {
+			printf("%s: unexpected exclusive stats, %d reads, "
+				"%d pass, %d fail\n", name(),
+				(int) exmon.get_num_exclusive_reads(),
+				(int) exmon.get_num_exclusive_pass(),
+				(int) exmon.get_num_exclusive_fail());
+			return false;
+		}
+
+		exmon.reset_stats();
+		assert(exmon.get_num_exclusive_reads() == 0);
+		assert(exmon.get_exclusive_pass_rate() == 0);
+
+		return true;
+	}
+
 private:
 	TLMTrafficGenerator tg;
 	tlm_exclusive_monitor exmon;
@@ -187,5 +213,6 @@ int sc_main(int argc, char *argv[])
 	if (trace_fp) {
 		sc_close_vcd_trace_file(trace_fp);
 	}
-	return 0;
+
+	return top.dut.check_stats() ? 0 : 1;
 }
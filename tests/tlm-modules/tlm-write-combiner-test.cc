@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include "tlm-modules/tlm-write-combiner.h"
+#include "traffic-generators/tg-tlm.h"
+#include "traffic-generators/traffic-desc.h"
+#include "test-modules/memory.h"
+#include "test-modules/utils.h"
+
+using namespace utils;
+
+// Bufferable and modifiable
+#define GENATTR_NORMAL(id) \
+GenAttr(0, false, false, false, 0, id, false, false, true, true)
+
+// Non-modifiable
+#define GENATTR_DEVICE \
+GenAttr(0, false, false, false, 0, 0, false, false, true, false)
+
+DataTransferVec transactions = {
+	//
+	// Contiguous writes (merged), the read flushes the combined write
+	//
+        Write(0, DATA(0x0, 0x1, 0x2, 0x3)),
+        Write(4, DATA(0x4, 0x5, 0x6, 0x7)),
+        Write(8, DATA(0x8, 0x9, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf), 8),
+        Read(0, 16),
+		Expect(DATA(
+			0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7,
+			0x8, 0x9, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf), 16),
+
+	//
+	// Non contiguous writes
+	//
+        Write(32, DATA(0x1, 0x1, 0x1, 0x1)),
+        Write(40, DATA(0x2, 0x2, 0x2, 0x2)),
+        Write(36, DATA(0x3, 0x3, 0x3, 0x3)),
+        Read(32, 12),
+		Expect(DATA(
+			0x1, 0x1, 0x1, 0x1, 0x3, 0x3, 0x3, 0x3,
+			0x2, 0x2, 0x2, 0x2), 12),
+
+	//
+	// Writes with byte enables
+	//
+        Write(64, DATA(0x5, 0x5, 0x5, 0x5)),
+        Write(68, DATA(0x6, 0x6, 0x6, 0x6)),
+		ByteEnable(DATA(0xff, 0x0, 0xff, 0x0), 4),
+        Write(72, DATA(0x7, 0x7, 0x7, 0x7)),
+        Read(64, 12),
+		Expect(DATA(
+			0x5, 0x5, 0x5, 0x5, 0x6, 0x0, 0x6, 0x0,
+			0x7, 0x7, 0x7, 0x7), 12),
+
+	//
+	// Writes crossing the 4 KB boundary when merged
+	//
+        Write(4088, DATA(0x8, 0x8, 0x8, 0x8)),
+        Write(4092, DATA(0x9, 0x9, 0x9, 0x9)),
+        Write(4096, DATA(0xa, 0xa, 0xa, 0xa)),
+        Read(4088, 12),
+		Expect(DATA(
+			0x8, 0x8, 0x8, 0x8, 0x9, 0x9, 0x9, 0x9,
+			0xa, 0xa, 0xa, 0xa), 12),
+
+	//
+	// Writes with attributes
+	//
+        Write(128, DATA(0xb, 0xb, 0xb, 0xb)),
+		GENATTR_NORMAL(1),
+        Write(132, DATA(0xc, 0xc, 0xc, 0xc)),
+		GENATTR_NORMAL(1),
+        Write(136, DATA(0xd, 0xd, 0xd, 0xd)),
+		GENATTR_NORMAL(2),
+        Write(140, DATA(0xe, 0xe, 0xe, 0xe)),
+		GENATTR_DEVICE,
+        Write(144, DATA(0xf, 0xf, 0xf, 0xf)),
+		GENATTR_NORMAL(2),
+        Read(128, 20),
+		Expect(DATA(
+			0xb, 0xb, 0xb, 0xb, 0xc, 0xc, 0xc, 0xc,
+			0xd, 0xd, 0xd, 0xd, 0xe, 0xe, 0xe, 0xe,
+			0xf, 0xf, 0xf, 0xf), 20),
+
+	//
+	// Partial combined write, only flushed by the timeout
+	//
+        Write(256, DATA(0x10, 0x10, 0x10, 0x10)),
+        Write(260, DATA(0x11, 0x11, 0x11, 0x11)),
+};
+
+//
+// Writes merged and combined writes issued by the transactions above,
+// before the timeout flushes the last combined write.
+//
+#define NUM_WRITES	18
+#define NUM_FLUSHES	10
+
+static sc_event tg_done_event;
+static bool checked;
+
+static void DoneCallback(TLMTrafficGenerator *gen, int threadId)
+{
+	tg_done_event.notify();
+}
+
+SC_MODULE(Dut)
+{
+public:
+	enum { RamSize = 256 * 1024 };
+
+	SC_HAS_PROCESS(Dut);
+
+	Dut(sc_module_name name, DataTransferVec &transfers) :
+		tg("tg"),
+		write_combiner("write_combiner", 64),
+		ram("ram", sc_time(1, SC_NS), RamSize, ram_buf),
+		xfers(merge(transfers))
+	{
+		tg.enableDebug();
+		tg.addTransfers(xfers, 0, DoneCallback);
+
+		memset(ram_buf, 0, sizeof ram_buf);
+
+		SC_THREAD(check);
+
+		// tg -> write_combiner -> ram
+		tg.socket.bind(write_combiner.target_socket);
+		write_combiner.init_socket.bind(ram.socket);
+	}
+
+private:
+	TLMTrafficGenerator tg;
+	tlm_write_combiner write_combiner;
+	uint8_t ram_buf[RamSize];
+	memory ram;
+	TrafficDesc xfers;
+
+	void check()
+	{
+		unsigned int i;
+
+		wait(tg_done_event);
+
+		assert(write_combiner.get_num_writes() == NUM_WRITES);
+		assert(write_combiner.get_num_flushes() == NUM_FLUSHES);
+
+		// Still held back by the write combiner
+		for (i = 256; i < 264; i++) {
+			assert(ram_buf[i] == 0);
+		}
+
+		wait(write_combiner.get_flush_timeout() * 2);
+
+		assert(write_combiner.get_num_flushes() == NUM_FLUSHES + 1);
+		for (i = 256; i < 260; i++) {
+			assert(ram_buf[i] == 0x10);
+		}
+		for (i = 260; i < 264; i++) {
+			assert(ram_buf[i] == 0x11);
+		}
+
+		printf("write combiner: %d writes, %d combined writes\n",
+			(int) write_combiner.get_num_writes(),
+			(int) write_combiner.get_num_flushes());
+		checked = true;
+	}
+};
+
+SC_MODULE(Top)
+{
+	Dut dut;
+
+	Top(sc_module_name name,
+	    DataTransferVec &transfers_dut) :
+		dut("dut", transfers_dut)
+	{ }
+};
+
+int sc_main(int argc, char *argv[])
+{
+	Top top("Top", transactions);
+
+	sc_trace_file *trace_fp = sc_create_vcd_trace_file(argv[0]);
+	sc_start(100, SC_MS);
+	sc_stop();
+
+	if (trace_fp) {
+		sc_close_vcd_trace_file(trace_fp);
+	}
+	return checked ? 0 : 1;
+}
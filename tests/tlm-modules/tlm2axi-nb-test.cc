@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018 Xilinx Inc.
+ * Written by Edgar E. Iglesias
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include "tlm-bridges/tlm2axi-bridge.h"
+#include "tlm-bridges/axi2tlm-bridge.h"
+#include "checkers/pc-axi.h"
+#include "test-modules/memory.h"
+#include "test-modules/signals-axi.h"
+
+#define RAM_SIZE (16 * 1024)
+
+//
+// Requests issued back to back through nb_transport. The unaligned, 4 KB
+// crossing and too long (more than 256 beats) ones need to be split by the
+// aligner of the bridge.
+//
+static const struct {
+	uint64_t addr;
+	unsigned int len;
+} reqs[] = {
+	{ 0x100, 4 },
+	{ 0x200, 64 },
+	{ 0x303, 13 },
+	{ 0xff8, 16 },
+	{ 0x2000, 2048 },
+	{ 0x3001, 3 },
+};
+
+#define NR_REQS (sizeof reqs / sizeof reqs[0])
+
+static uint8_t ram_buf[RAM_SIZE];
+static bool done;
+
+SC_MODULE(NBInitiator)
+{
+public:
+	tlm_utils::simple_initiator_socket<NBInitiator> socket;
+
+	SC_HAS_PROCESS(NBInitiator);
+
+	NBInitiator(sc_module_name name) :
+		socket("socket"),
+		m_endReq(false),
+		m_numResp(0)
+	{
+		socket.register_nb_transport_bw(this,
+					&NBInitiator::nb_transport_bw);
+		SC_THREAD(run);
+	}
+
+private:
+	tlm::tlm_generic_payload m_gp[NR_REQS];
+	vector<uint8_t> m_data[NR_REQS];
+
+	bool m_endReq;
+	sc_event m_endReqEvent;
+	unsigned int m_numResp;
+	sc_event m_respEvent;
+
+	static uint8_t pattern(unsigned int i, unsigned int pos, bool inv)
+	{
+		uint8_t v = (i * 31 + pos) & 0xff;
+
+		return inv ? ~v : v;
+	}
+
+	void issue(unsigned int i, tlm::tlm_command cmd)
+	{
+		tlm::tlm_generic_payload& gp = m_gp[i];
+		tlm::tlm_phase phase = tlm::BEGIN_REQ;
+		sc_time delay(SC_ZERO_TIME);
+		tlm::tlm_sync_enum status;
+
+		gp.set_command(cmd);
+		gp.set_address(reqs[i].addr);
+		gp.set_data_ptr(m_data[i].data());
+		gp.set_data_length(reqs[i].len);
+		gp.set_streaming_width(reqs[i].len);
+		gp.set_byte_enable_ptr(NULL);
+		gp.set_byte_enable_length(0);
+		gp.set_dmi_allowed(false);
+		gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		m_endReq = false;
+		status = socket->nb_transport_fw(gp, phase, delay);
+		assert(status == tlm::TLM_ACCEPTED);
+
+		// The next request can only be sent after END_REQ
+		while (!m_endReq) {
+			wait(m_endReqEvent);
+		}
+	}
+
+	void wait_resp(unsigned int n)
+	{
+		while (m_numResp < n) {
+			wait(m_respEvent);
+		}
+	}
+
+	void run()
+	{
+		unsigned int i, j;
+
+		for (i = 0; i < NR_REQS; i++) {
+			m_data[i].resize(reqs[i].len);
+			for (j = 0; j < reqs[i].len; j++) {
+				m_data[i][j] = pattern(i, j, false);
+			}
+			issue(i, tlm::TLM_WRITE_COMMAND);
+		}
+		wait_resp(NR_REQS);
+
+		for (i = 0; i < NR_REQS; i++) {
+			assert(m_gp[i].get_response_status() ==
+				tlm::TLM_OK_RESPONSE);
+			for (j = 0; j < reqs[i].len; j++) {
+				assert(ram_buf[reqs[i].addr + j] ==
+					pattern(i, j, false));
+			}
+		}
+
+		// Read back after modifying the memory directly
+		for (i = 0; i < NR_REQS; i++) {
+			for (j = 0; j < reqs[i].len; j++) {
+				ram_buf[reqs[i].addr + j] = pattern(i, j, true);
+			}
+			memset(m_data[i].data(), 0, reqs[i].len);
+			issue(i, tlm::TLM_READ_COMMAND);
+		}
+		wait_resp(2 * NR_REQS);
+
+		for (i = 0; i < NR_REQS; i++) {
+			assert(m_gp[i].get_response_status() ==
+				tlm::TLM_OK_RESPONSE);
+			for (j = 0; j < reqs[i].len; j++) {
+				assert(m_data[i][j] == pattern(i, j, true));
+			}
+		}
+
+		printf("%u nb_transport requests done\n", m_numResp);
+		done = true;
+		sc_stop();
+	}
+
+	tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload& trans,
+					tlm::tlm_phase& phase,
+					sc_time& delay)
+	{
+		if (phase == tlm::END_REQ) {
+			m_endReq = true;
+			m_endReqEvent.notify();
+			return tlm::TLM_ACCEPTED;
+		}
+
+		assert(phase == tlm::BEGIN_RESP);
+
+		m_numResp++;
+		m_respEvent.notify();
+
+		return tlm::TLM_COMPLETED;
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	tlm2axi_bridge<32, 32> tlm2axi_bridge("tlm2axi_bridge");
+	axi2tlm_bridge<32, 32> axi2tlm_bridge("axi2tlm_bridge");
+	AXIProtocolChecker<32, 32> checker("checker", AXIPCConfig::all_enabled());
+	AXISignals<32, 32> signals("axi_signals");
+
+	NBInitiator init("init");
+	sc_clock clk("clk", sc_time(10, SC_NS));
+	sc_signal<bool> resetn("resetn", true);
+	memory mem("mem", sc_time(10, SC_NS), RAM_SIZE, ram_buf);
+
+	tlm2axi_bridge.clk(clk);
+	axi2tlm_bridge.clk(clk);
+	checker.clk(clk);
+
+	tlm2axi_bridge.resetn(resetn);
+	axi2tlm_bridge.resetn(resetn);
+	checker.resetn(resetn);
+
+	signals.connect(tlm2axi_bridge);
+	signals.connect(checker);
+	signals.connect(axi2tlm_bridge);
+
+	init.socket.bind(tlm2axi_bridge.tgt_socket);
+	axi2tlm_bridge.socket.bind(mem.socket);
+
+	sc_start(100, SC_MS);
+
+	if (!done) {
+		printf("nb_transport requests did not complete\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,504 @@
+/*
+ * Tests the completion handling of the TLM to PCIe TLP bridge.
+ *
+ * Copyright (c) 2022 AMD Inc.
+ *
+ * Written by Francisco Iglesias <francisco.iglesias@amd.com>.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <deque>
+#include <vector>
+
+#include <stdio.h>
+#include <assert.h>
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include "systemc"
+using namespace sc_core;
+using namespace std;
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+#include "tlm-bridges/tlm2tlp-bridge.h"
+
+typedef vector<uint8_t> TLPBytes;
+
+enum {
+	HOST_MEM_SZ = 8 * 1024,
+
+	//
+	// Memory reads issued on the TLM side, A and B use the same tag
+	// (and the same slot of the outstanding TLPs) but have different
+	// requestor IDs
+	//
+	RD_A = 0,
+	RD_B = 1,
+	RD_C = 2,
+	NUM_READS = 3,
+};
+
+struct ReadReq {
+	uint32_t masterID;
+	uint32_t tag;
+	uint64_t addr;
+	unsigned int len;
+};
+
+static const ReadReq reads[NUM_READS] = {
+	{ 1, 3, 0x3000, 8 },	// RD_A
+	{ 2, 3, 0x3100, 4 },	// RD_B
+	{ 1, 4, 0x3200, 4 },	// RD_C
+};
+
+//
+// Reads a DW from (big endian) TLP data
+//
+static uint32_t get_dw(const TLPBytes& t, unsigned int i)
+{
+	assert((i + 1) * 4 <= t.size());
+
+	return t[i * 4] << 24 | t[i * 4 + 1] << 16 |
+		t[i * 4 + 2] << 8 | t[i * 4 + 3];
+}
+
+static void push_dw(TLPBytes& t, uint32_t v)
+{
+	t.push_back(v >> 24);
+	t.push_back(v >> 16);
+	t.push_back(v >> 8);
+	t.push_back(v);
+}
+
+static uint32_t field(uint32_t dw, unsigned int shift, unsigned int width)
+{
+	return (dw >> shift) & ((1 << width) - 1);
+}
+
+static uint8_t read_data(uint64_t addr, unsigned int i)
+{
+	return (addr >> 4) + i;
+}
+
+static uint8_t host_data(unsigned int i)
+{
+	return (i * 7 + 3) & 0xFF;
+}
+
+SC_MODULE(Top)
+{
+	tlm2tlp_bridge brdg;
+
+	tlm_utils::simple_initiator_socket<Top> cfg_init_socket;
+	tlm_utils::simple_initiator_socket<Top> mem_init_socket;
+	tlm_utils::simple_initiator_socket<Top> io_init_socket;
+	tlm_utils::simple_initiator_socket<Top> msg_init_socket;
+
+	//
+	// The endpoint, receives the TLPs from the bridge and sends
+	// TLPs to the bridge
+	//
+	tlm_utils::simple_target_socket<Top> ep_tgt_socket;
+	tlm_utils::simple_initiator_socket<Top> ep_init_socket;
+
+	//
+	// Host memory for the DMA requests
+	//
+	tlm_utils::simple_target_socket<Top> host_tgt_socket;
+
+	deque<TLPBytes> tlps;
+	sc_event tlp_event;
+
+	uint8_t host_mem[HOST_MEM_SZ];
+	unsigned int num_dma;
+
+	unsigned int reads_done;
+	unsigned int read_order[NUM_READS];
+	sc_event read_event;
+
+	bool done;
+
+	SC_HAS_PROCESS(Top);
+
+	Top(sc_module_name name) :
+		sc_module(name),
+		brdg("tlm2tlp-bridge"),
+		cfg_init_socket("cfg-init-socket"),
+		mem_init_socket("mem-init-socket"),
+		io_init_socket("io-init-socket"),
+		msg_init_socket("msg-init-socket"),
+		ep_tgt_socket("ep-tgt-socket"),
+		ep_init_socket("ep-init-socket"),
+		host_tgt_socket("host-tgt-socket"),
+		num_dma(0),
+		reads_done(0),
+		done(false)
+	{
+		unsigned int i;
+
+		cfg_init_socket.bind(brdg.cfg_tgt_socket);
+		mem_init_socket.bind(brdg.mem_tgt_socket);
+		io_init_socket.bind(brdg.io_tgt_socket);
+		msg_init_socket.bind(brdg.msg_tgt_socket);
+
+		brdg.init_socket.bind(ep_tgt_socket);
+		ep_init_socket.bind(brdg.tgt_socket);
+
+		brdg.dma_init_socket.bind(host_tgt_socket);
+
+		ep_tgt_socket.register_b_transport(this, &Top::ep_b_transport);
+		host_tgt_socket.register_b_transport(this,
+						&Top::host_b_transport);
+
+		for (i = 0; i < HOST_MEM_SZ; i++) {
+			host_mem[i] = host_data(i);
+		}
+
+		SC_THREAD(run);
+	}
+
+	void ep_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+	{
+		uint8_t *d = trans.get_data_ptr();
+
+		tlps.push_back(TLPBytes(d, d + trans.get_data_length()));
+		tlp_event.notify();
+
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	void host_b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+	{
+		uint64_t addr = trans.get_address();
+		unsigned int len = trans.get_data_length();
+		genattr_extension *genattr;
+
+		trans.get_extension(genattr);
+		assert(genattr);
+		assert(genattr->get_master_id() == 0x0105);
+		assert(genattr->get_transaction_id() == 0x5A);
+
+		assert(trans.is_read());
+		assert(addr + len <= HOST_MEM_SZ);
+
+		memcpy(trans.get_data_ptr(), &host_mem[addr], len);
+		num_dma++;
+
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	TLPBytes next_tlp()
+	{
+		TLPBytes t;
+
+		while (tlps.empty()) {
+			wait(tlp_event);
+		}
+
+		t = tlps.front();
+		tlps.pop_front();
+
+		return t;
+	}
+
+	void ep_send(TLPBytes& t)
+	{
+		tlm::tlm_generic_payload gp;
+		sc_time delay(SC_ZERO_TIME);
+
+		gp.set_command(tlm::TLM_WRITE_COMMAND);
+		gp.set_address(0);
+		gp.set_data_ptr(t.data());
+		gp.set_data_length(t.size());
+		gp.set_streaming_width(t.size());
+		gp.set_byte_enable_ptr(NULL);
+		gp.set_byte_enable_length(0);
+
+		ep_init_socket->b_transport(gp, delay);
+
+		assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+	}
+
+	void setup_gp(tlm::tlm_generic_payload& gp, tlm::tlm_command cmd,
+			uint64_t addr, uint8_t *data, unsigned int len,
+			uint32_t masterID, uint32_t tag)
+	{
+		genattr_extension *genattr = new genattr_extension();
+
+		genattr->set_master_id(masterID);
+		genattr->set_transaction_id(tag);
+
+		gp.set_command(cmd);
+		gp.set_address(addr);
+		gp.set_data_ptr(data);
+		gp.set_data_length(len);
+		gp.set_streaming_width(len);
+		gp.set_byte_enable_ptr(NULL);
+		gp.set_byte_enable_length(0);
+		gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+		gp.set_extension(genattr);
+	}
+
+	//
+	// A memory write is transmitted with the header followed by the
+	// data
+	//
+	void test_mem_write()
+	{
+		tlm::tlm_generic_payload gp;
+		sc_time delay(SC_ZERO_TIME);
+		uint8_t data[16];
+		unsigned int i;
+		TLPBytes t;
+
+		for (i = 0; i < sizeof(data); i++) {
+			data[i] = 0xA0 + i;
+		}
+
+		setup_gp(gp, tlm::TLM_WRITE_COMMAND, 0x2000, data,
+				sizeof(data), 1, 7);
+
+		mem_init_socket->b_transport(gp, delay);
+		assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+
+		t = next_tlp();
+		assert(t.size() == TLPHdr_3DW_Sz + sizeof(data));
+
+		assert(field(get_dw(t, 0), 29, 3) == FMT_3DW_WithData);
+		assert(field(get_dw(t, 0), 24, 5) == Type_MRdWr);
+		assert(field(get_dw(t, 0), 0, 10) == sizeof(data) / 4);
+
+		assert(field(get_dw(t, 1), 16, 16) == 1);
+		assert(field(get_dw(t, 1), 8, 8) == 7);
+		assert(field(get_dw(t, 1), 4, 4) == 0xF);
+		assert(field(get_dw(t, 1), 0, 4) == 0xF);
+
+		assert(get_dw(t, 2) == 0x2000);
+
+		for (i = 0; i < sizeof(data); i++) {
+			assert(t[TLPHdr_3DW_Sz + i] == data[i]);
+		}
+	}
+
+	void mem_read(unsigned int idx)
+	{
+		const ReadReq& r = reads[idx];
+		tlm::tlm_generic_payload gp;
+		sc_time delay(SC_ZERO_TIME);
+		uint8_t data[8] = { 0 };
+		unsigned int i;
+
+		//
+		// Keep the requests in index order
+		//
+		wait(sc_time(idx, SC_PS));
+
+		setup_gp(gp, tlm::TLM_READ_COMMAND, r.addr, data, r.len,
+				r.masterID, r.tag);
+
+		mem_init_socket->b_transport(gp, delay);
+		assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+
+		for (i = 0; i < r.len; i++) {
+			assert(data[i] == read_data(r.addr, i));
+		}
+
+		read_order[reads_done++] = idx;
+		read_event.notify();
+	}
+
+	//
+	// Checks the memory read TLP of req and completes it
+	//
+	void complete_read(const TLPBytes& t, const ReadReq& r)
+	{
+		uint32_t dlen = r.len / 4;
+		TLPBytes cpl;
+		unsigned int i;
+
+		assert(t.size() == TLPHdr_3DW_Sz);
+		assert(field(get_dw(t, 0), 29, 3) == FMT_3DW_NoData);
+		assert(field(get_dw(t, 0), 0, 10) == dlen);
+		assert(field(get_dw(t, 1), 16, 16) == r.masterID);
+		assert(field(get_dw(t, 1), 8, 8) == r.tag);
+		assert(get_dw(t, 2) == r.addr);
+
+		push_dw(cpl, FMT_3DW_WithData << 29 | Type_Cpl << 24 | dlen);
+		push_dw(cpl, Cpl_SC << 13 | r.len);
+		push_dw(cpl, r.masterID << 16 | r.tag << 8 | (r.addr & 0x7F));
+
+		for (i = 0; i < r.len; i++) {
+			cpl.push_back(read_data(r.addr, i));
+		}
+
+		ep_send(cpl);
+	}
+
+	void wait_reads(unsigned int n)
+	{
+		while (reads_done < n) {
+			wait(read_event);
+		}
+	}
+
+	//
+	// Outstanding requests are matched with their completions by tag
+	// (and requestor ID), a request using the tag of an outstanding
+	// request waits until that one has completed
+	//
+	void test_tags()
+	{
+		TLPBytes t_a;
+		TLPBytes t_c;
+		unsigned int i;
+
+		for (i = 0; i < NUM_READS; i++) {
+			sc_spawn(sc_bind(&Top::mem_read, this, i));
+		}
+
+		t_a = next_tlp();
+		t_c = next_tlp();
+
+		//
+		// RD_B is not transmitted while RD_A is outstanding
+		//
+		wait(sc_time(100, SC_NS));
+		assert(tlps.empty());
+
+		//
+		// Complete out of order
+		//
+		complete_read(t_c, reads[RD_C]);
+		wait_reads(1);
+		assert(read_order[0] == RD_C);
+		assert(tlps.empty());
+
+		complete_read(t_a, reads[RD_A]);
+		wait_reads(2);
+		assert(read_order[1] == RD_A);
+
+		complete_read(next_tlp(), reads[RD_B]);
+		wait_reads(3);
+		assert(read_order[2] == RD_B);
+	}
+
+	//
+	// Sends a memory read TLP using a 10-bit tag (T9 and T8 set) and
+	// checks the completions generated for it, the data is split at
+	// Max_Payload_Size aligned boundaries
+	//
+	void test_dma_read(uint64_t addr, unsigned int len, unsigned int mps,
+				unsigned int num_cpl)
+	{
+		uint32_t dlen = len / 4;
+		unsigned int pos = 0;
+		unsigned int i;
+		TLPBytes rd;
+
+		brdg.set_max_payload_size(mps);
+		num_dma = 0;
+
+		push_dw(rd, FMT_3DW_NoData << 29 | Type_MRdWr << 24 |
+				1 << 23 | 1 << 19 |
+				(dlen == MAX_DW_LEN ? 0 : dlen));
+		push_dw(rd, 0x0105 << 16 | 0x5A << 8 | 0xF << 4 | 0xF);
+		push_dw(rd, addr);
+
+		//
+		// Returns when all completions have been transmitted
+		//
+		ep_send(rd);
+
+		assert(num_dma == num_cpl);
+		assert(tlps.size() == num_cpl);
+
+		for (i = 0; i < num_cpl; i++) {
+			TLPBytes cpl = next_tlp();
+			uint32_t cur = addr + pos;
+			unsigned int cpl_len = mps - (cur & (mps - 1));
+			unsigned int byteCount = len - pos;
+			unsigned int j;
+
+			if (cpl_len > byteCount) {
+				cpl_len = byteCount;
+			}
+
+			assert(cpl.size() == TLPHdr_Cpl_Sz + cpl_len);
+
+			assert(field(get_dw(cpl, 0), 29, 3) == FMT_3DW_WithData);
+			assert(field(get_dw(cpl, 0), 24, 5) == Type_Cpl);
+			assert(field(get_dw(cpl, 0), 23, 1) == 1); // T9
+			assert(field(get_dw(cpl, 0), 19, 1) == 1); // T8
+			assert(field(get_dw(cpl, 0), 0, 10) ==
+				(cpl_len == SZ_4K ? 0 : cpl_len / 4));
+
+			assert(field(get_dw(cpl, 1), 13, 3) == Cpl_SC);
+			assert(field(get_dw(cpl, 1), 0, 12) ==
+				(byteCount == SZ_4K ? 0 : byteCount));
+
+			assert(field(get_dw(cpl, 2), 16, 16) == 0x0105);
+			assert(field(get_dw(cpl, 2), 8, 8) == 0x5A);
+			assert(field(get_dw(cpl, 2), 0, 7) == (cur & 0x7F));
+
+			for (j = 0; j < cpl_len; j++) {
+				assert(cpl[TLPHdr_Cpl_Sz + j] == host_data(cur + j));
+			}
+
+			pos += cpl_len;
+		}
+		assert(pos == len);
+	}
+
+	void run()
+	{
+		test_mem_write();
+		test_tags();
+
+		//
+		// 512 bytes starting 64 bytes into a 128 byte MPS block
+		//
+		test_dma_read(0x1040, 512, 128, 5);
+
+		//
+		// No split, the byte count and length of a 4 KB completion
+		// are 0
+		//
+		test_dma_read(0x0, SZ_4K, SZ_4K, 1);
+
+		done = true;
+		sc_stop();
+	}
+};
+
+int sc_main(int argc, char *argv[])
+{
+	Top top("Top");
+
+	sc_start(1, SC_MS);
+
+	assert(top.done);
+
+	printf("tlm2tlp-test: OK\n");
+
+	return 0;
+}
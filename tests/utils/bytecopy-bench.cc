@@ -0,0 +1,212 @@
+/*
+ * Microbenchmark for the byte enable / streaming width copy helpers in
+ * utils/bytecopy.h. Each pattern is first checked against a byte by byte
+ * reference copy and then timed (GB/s of payload data) for both.
+ *
+ * Copyright (c) 2019 Xilinx Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "utils/bytecopy.h"
+
+using namespace std;
+
+#define BUF_SZ (64 * 1024)
+
+enum Op { OP_BE, OP_FROM_SW, OP_TO_SW };
+
+struct Pattern {
+	const char *name;
+	Op op;
+	unsigned int len;
+	unsigned int sw;
+	vector<uint8_t> be;
+	unsigned int be_pos;
+};
+
+//
+// Byte by byte reference, as the modules did it before
+//
+static void ref_copy(const Pattern& p, uint8_t *dst, const uint8_t *src)
+{
+	unsigned int be_len = p.be.size();
+	unsigned int sw = p.sw ? p.sw : p.len;
+	unsigned int i;
+
+	for (i = 0; i < p.len; i++) {
+		if (be_len && p.be[(i + p.be_pos) % be_len] != 0xFF) {
+			continue;
+		}
+
+		switch (p.op) {
+		case OP_BE:
+			dst[i] = src[i];
+			break;
+		case OP_FROM_SW:
+			dst[i] = src[i % sw];
+			break;
+		case OP_TO_SW:
+			dst[i % sw] = src[i];
+			break;
+		}
+	}
+}
+
+static void lib_copy(const Pattern& p, uint8_t *dst, const uint8_t *src)
+{
+	const uint8_t *be = p.be.size() ? p.be.data() : NULL;
+
+	switch (p.op) {
+	case OP_BE:
+		bytecopy_be(dst, src, p.len, be, p.be.size(), p.be_pos);
+		break;
+	case OP_FROM_SW:
+		bytecopy_from_sw(dst, src, p.len, p.sw, be, p.be.size());
+		break;
+	case OP_TO_SW:
+		bytecopy_to_sw(dst, src, p.len, p.sw, be, p.be.size());
+		break;
+	}
+}
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench(const Pattern& p, uint8_t *dst, const uint8_t *src,
+			void (*copy)(const Pattern&, uint8_t *, const uint8_t *))
+{
+	unsigned int iter = (256 * 1024 * 1024) / p.len;
+	double start;
+	unsigned int i;
+
+	start = now();
+	for (i = 0; i < iter; i++) {
+		copy(p, dst, src);
+		// Keep the compiler from dropping the copies
+		__asm__ __volatile__("" : : "r"(dst) : "memory");
+	}
+
+	return ((double) iter * p.len) / (now() - start) / 1e9;
+}
+
+static vector<uint8_t> be_pattern(unsigned int len, const uint8_t *v,
+					unsigned int v_len)
+{
+	vector<uint8_t> be(len);
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		be[i] = v[i % v_len];
+	}
+	return be;
+}
+
+int main(int argc, char *argv[])
+{
+	static const uint8_t en[] = { 0xFF };
+	static const uint8_t alt4[] = { 0xFF, 0xFF, 0x00, 0x00 };
+	static const uint8_t alt1[] = { 0xFF, 0x00 };
+	vector<uint8_t> rnd(4096);
+	vector<Pattern> patterns;
+	vector<uint8_t> src(BUF_SZ);
+	vector<uint8_t> dst_ref(BUF_SZ);
+	vector<uint8_t> dst(BUF_SZ);
+	bool quick = argc > 1 && !strcmp(argv[1], "-q");
+	int ret = 0;
+	unsigned int i;
+
+	srand(0);
+	for (i = 0; i < rnd.size(); i++) {
+		rnd[i] = (rand() & 1) ? 0xFF : 0x00;
+	}
+	for (i = 0; i < src.size(); i++) {
+		src[i] = rand();
+	}
+
+	patterns.push_back({ "be all enabled 4K", OP_BE, 4096, 0,
+				be_pattern(4096, en, 1), 0 });
+	patterns.push_back({ "be 2 on 2 off (be_len 4) 4K", OP_BE, 4096, 0,
+				be_pattern(4, alt4, 4), 0 });
+	patterns.push_back({ "be every other byte 4K", OP_BE, 4096, 0,
+				be_pattern(4096, alt1, 2), 0 });
+	patterns.push_back({ "be random 4K", OP_BE, 4096, 0, rnd, 0 });
+	patterns.push_back({ "be random (be_len 12) 64", OP_BE, 64, 0,
+				be_pattern(12, rnd.data(), 12), 0 });
+	patterns.push_back({ "be random (be_len 12, pos 5) 64", OP_BE, 64, 0,
+				be_pattern(12, rnd.data(), 12), 5 });
+	patterns.push_back({ "be random (be_len 64, pos 17) 40", OP_BE, 40,
+				0, be_pattern(64, rnd.data(), 64), 17 });
+	patterns.push_back({ "be 2 on 2 off (pos 3) 4K", OP_BE,
+				4096, 0, be_pattern(4, alt4, 4), 3 });
+	patterns.push_back({ "sw 4 read 4K", OP_FROM_SW, 4096, 4, {}, 0 });
+	patterns.push_back({ "sw 64 read 4K", OP_FROM_SW, 4096, 64, {}, 0 });
+	patterns.push_back({ "sw 4 write 4K", OP_TO_SW, 4096, 4, {}, 0 });
+	patterns.push_back({ "sw 64 write 4K, be random", OP_TO_SW, 4096, 64,
+				rnd, 0 });
+
+	if (!quick) {
+		printf("%-32s %12s %12s\n", "pattern", "bytewise",
+			"bytecopy");
+	}
+
+	for (i = 0; i < patterns.size(); i++) {
+		const Pattern& p = patterns[i];
+		double ref_gbs, lib_gbs;
+
+		memset(dst_ref.data(), 0x5A, BUF_SZ);
+		memset(dst.data(), 0x5A, BUF_SZ);
+		ref_copy(p, dst_ref.data(), src.data());
+		lib_copy(p, dst.data(), src.data());
+
+		if (memcmp(dst_ref.data(), dst.data(), BUF_SZ)) {
+			printf("%-32s MISMATCH\n", p.name);
+			ret = 1;
+			continue;
+		}
+
+		//
+		// Only the mismatches are reported with -q
+		//
+		if (quick) {
+			continue;
+		}
+
+		ref_gbs = bench(p, dst.data(), src.data(), ref_copy);
+		lib_gbs = bench(p, dst.data(), src.data(), lib_copy);
+
+		printf("%-32s %9.2f GB/s %7.2f GB/s\n", p.name,
+			ref_gbs, lib_gbs);
+	}
+
+	return ret;
+}
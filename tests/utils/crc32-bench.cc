@@ -0,0 +1,143 @@
+/*
+ * Microbenchmark for the CRC32 in utils/crc32.h. Each frame size is first
+ * checked against the byte by byte table loop and then timed (GB/s) for
+ * the byte by byte loop, the slicing-by-8 tables and crc32(), which picks
+ * the fastest engine for the host.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "utils/crc32.h"
+
+using namespace std;
+
+#define BUF_SZ (16 * 1024)
+
+typedef uint32_t (*crc_fn)(const uint8_t *buf, unsigned int len);
+
+static uint32_t ref_crc(const uint8_t *buf, unsigned int len)
+{
+	return crc32_bytewise(UINT32_MAX, buf, len) ^ UINT32_MAX;
+}
+
+static uint32_t sb8_crc(const uint8_t *buf, unsigned int len)
+{
+	return crc32_sb8(UINT32_MAX, buf, len) ^ UINT32_MAX;
+}
+
+static uint32_t lib_crc(const uint8_t *buf, unsigned int len)
+{
+	return crc32(0, buf, len);
+}
+
+// The frame fed in 64 byte beats, as a streaming MAC would
+static uint32_t ctx_crc(const uint8_t *buf, unsigned int len)
+{
+	struct crc32_ctx ctx;
+	unsigned int i;
+
+	crc32_init(&ctx);
+	for (i = 0; i < len; i += 64) {
+		crc32_update(&ctx, buf + i, (len - i) < 64 ? (len - i) : 64);
+	}
+	return crc32_final(&ctx);
+}
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench(const uint8_t *buf, unsigned int len, crc_fn fn)
+{
+	unsigned int iter = (256 * 1024 * 1024) / len;
+	volatile uint32_t sink;
+	double start;
+	unsigned int i;
+
+	start = now();
+	for (i = 0; i < iter; i++) {
+		sink = fn(buf, len);
+	}
+	(void) sink;
+
+	return ((double) iter * len) / (now() - start) / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	static const unsigned int sizes[] = { 60, 64, 127, 1514, 1518, 9000 };
+	static const crc_fn fns[] = { ref_crc, sb8_crc, lib_crc, ctx_crc };
+	vector<uint8_t> buf(BUF_SZ);
+	bool quick = argc > 1 && !strcmp(argv[1], "-q");
+	int ret = 0;
+	unsigned int i, j, off;
+
+	srand(0);
+	for (i = 0; i < buf.size(); i++) {
+		buf[i] = rand();
+	}
+
+	// Every length and alignment up to 1K against the reference
+	for (off = 0; off < 16; off++) {
+		for (i = 0; i < 1024; i++) {
+			uint32_t ref = ref_crc(buf.data() + off, i);
+
+			for (j = 1; j < sizeof(fns) / sizeof(fns[0]); j++) {
+				if (fns[j](buf.data() + off, i) != ref) {
+					printf("MISMATCH len %u off %u engine %u\n",
+						i, off, j);
+					ret = 1;
+				}
+			}
+		}
+	}
+	if (ret) {
+		return ret;
+	}
+
+	printf("%-8s %12s %12s %12s %12s\n", "size", "bytewise", "slice-by-8",
+		"crc32", "crc32_ctx");
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		printf("%-8u", sizes[i]);
+		for (j = 0; j < sizeof(fns) / sizeof(fns[0]); j++) {
+			double gbs = quick ? 0 : bench(buf.data(), sizes[i],
+							fns[j]);
+
+			printf(" %7.2f GB/s", gbs);
+		}
+		printf("\n");
+	}
+
+	return ret;
+}
@@ -26,9 +26,11 @@
 #ifndef TLM_BRIDGES_AMBA_H__
 #define TLM_BRIDGES_AMBA_H__
 
+#include <assert.h>
+#include <string.h>
 #include "tlm.h"
 #include "tlm-extensions/genattr.h"
-#include <assert.h>
+#include "utils/bitops.h"
 
 enum {
 	AXI_OKAY = 0,
@@ -219,20 +221,129 @@ inline uint32_t to_uint(sc_in<bool>& port)
 	return port.read();
 }
 
+//
+// Beat packing helpers. The data (and strobes) of a beat are moved between
+// the sc_bv signal value and a native byte buffer (byte n holding bits
+// [8n+7:8n]) through the words of the sc_bv instead of through per byte
+// range / shift operations on the sc_bv.
+//
+template<int N>
+static inline void axi_bv_to_bytes(const sc_bv<N>& bv, uint8_t *buf)
+{
+	const unsigned int digit_sz = sizeof(sc_dt::sc_digit);
+	const unsigned int nbytes = (N + 7) / 8;
+	unsigned int i;
+
+	for (i = 0; i < nbytes; i += digit_sz) {
+		sc_dt::sc_digit w = bv.get_word(i / digit_sz);
+		unsigned int k;
+
+		for (k = 0; k < digit_sz && (i + k) < nbytes; k++) {
+			buf[i + k] = w >> (k * 8);
+		}
+	}
+}
+
+template<int N>
+static inline void axi_bytes_to_bv(sc_bv<N>& bv, const uint8_t *buf)
+{
+	const unsigned int digit_sz = sizeof(sc_dt::sc_digit);
+	const unsigned int nbytes = (N + 7) / 8;
+	unsigned int i;
+
+	for (i = 0; i < nbytes; i += digit_sz) {
+		sc_dt::sc_digit w = 0;
+		unsigned int k;
+
+		for (k = 0; k < digit_sz && (i + k) < nbytes; k++) {
+			w |= static_cast<sc_dt::sc_digit>(buf[i + k]) << (k * 8);
+		}
+		bv.set_word(i / digit_sz, w);
+	}
+	bv.clean_tail();
+}
+
+//
+// Expands the N strobe bits into N TLM byte enables.
+//
+template<int N>
+static inline void axi_strb_to_be(const sc_bv<N>& strb, uint8_t *be)
+{
+	uint8_t mask[(N + 7) / 8];
+	unsigned int b;
+
+	axi_bv_to_bytes(strb, mask);
+
+	for (b = 0; b < sizeof(mask); b++) {
+		uint64_t v = bitops_mask8_to_be8(mask[b]);
+		unsigned int i = b * 8;
+		unsigned int len = (N - i) < 8 ? (N - i) : 8;
+
+		memcpy(be + i, &v, len);
+	}
+}
+
+//
+// Packs N TLM byte enables into N strobe bits.
+//
+template<int N>
+static inline void axi_be_to_strb(sc_bv<N>& strb, const uint8_t *be)
+{
+	uint8_t mask[(N + 7) / 8];
+	unsigned int b;
+
+	for (b = 0; b < sizeof(mask); b++) {
+		unsigned int i = b * 8;
+		unsigned int len = (N - i) < 8 ? (N - i) : 8;
+		uint64_t v = 0;
+		uint8_t m;
+
+		memcpy(&v, be + i, len);
+		m = bitops_be8_to_mask8(v);
+
+		// Only 0xff (enabled) and 0x0 bytes can be gathered
+		if (bitops_mask8_to_be8(m) != v) {
+			unsigned int k;
+
+			m = 0;
+			for (k = 0; k < len; k++) {
+				if (be[i + k] == TLM_BYTE_ENABLED) {
+					m |= 1 << k;
+				}
+			}
+		}
+		mask[b] = m;
+	}
+
+	axi_bytes_to_bv(strb, mask);
+}
+
 class axi_common
 {
 public:
 	template<typename T>
 	axi_common(T *mod) :
 		clk(mod->clk),
-		resetn(mod->resetn)
+		resetn(mod->resetn),
+		m_idle_skip(false)
 	{}
 
 	axi_common(sc_in<bool>& _clk, sc_in<bool>& _resetn) :
 		clk(_clk),
-		resetn(_resetn)
+		resetn(_resetn),
+		m_idle_skip(false)
 	{}
 
+	//
+	// Idle skipping (off by default). Channel threads waiting for a
+	// signal to be sampled high sleep until the signal gets asserted
+	// instead of waking up on every clock edge, and then continue on the
+	// following clock edge. The signal is sampled on the same clock edges
+	// as without idle skipping.
+	//
+	void set_idle_skip(bool en) { m_idle_skip = en; }
+	bool get_idle_skip() { return m_idle_skip; }
+
 	void wait_for_reset_release()
 	{
 		do {
@@ -242,9 +353,28 @@ public:
 
 	bool reset_asserted() { return resetn.read() == false; }
 
+	//
+	// With idle skipping enabled, sleep while sig is deasserted. Returns
+	// true if sig got asserted together with a clock edge (or reset got
+	// asserted), the caller must then not wait for the next clock edge.
+	//
+	bool wait_idle(sc_in<bool>& sig)
+	{
+		if (!m_idle_skip || sig.read() || reset_asserted()) {
+			return false;
+		}
+
+		sc_core::wait(sig.posedge_event() | resetn.negedge_event());
+
+		return clk.posedge() || reset_asserted();
+	}
+
 	void wait_abort_on_reset(sc_in<bool>& sig)
 	{
 		do {
+			if (wait_idle(sig)) {
+				continue;
+			}
 			sc_core::wait(clk.posedge_event() | resetn.negedge_event());
 		} while (sig.read() == false && resetn.read() == true);
 	}
@@ -280,6 +410,7 @@ public:
 private:
 	sc_in<bool>& clk;
 	sc_in<bool>& resetn;
+	bool m_idle_skip;
 };
 
 #endif
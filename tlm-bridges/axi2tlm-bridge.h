@@ -33,11 +33,15 @@
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 
 #include <list>
+#include <deque>
+#include <vector>
+#include <unordered_map>
 
 #include "tlm-bridges/amba.h"
 #include "tlm-bridges/amba-ace.h"
 #include "tlm-extensions/genattr.h"
 #include "tlm-bridges/private/ace/snoop-channels.h"
+#include "tlm-bridges/private/axi/txn-queue.h"
 
 /*
   MAX DATA_WIDTH = 1024 bits / 128 bytes
@@ -214,6 +218,8 @@ public:
 
 		m_snp_chnls(NULL),
 
+		wrDataList(true),
+
 		m_maxReadTransactions(16),
 		m_maxWriteTransactions(16),
 		m_numReadTransactions(0),
@@ -248,17 +254,50 @@ public:
 
 	~axi2tlm_bridge()
 	{
+		for (typename std::vector<Transaction*>::iterator it =
+			m_txPool.begin(); it != m_txPool.end(); it++) {
+			delete (*it);
+		}
+
 		delete m_snp_chnls;
 	}
 
 	ACESnoopChannels_S__& GetACESnoopChannels() { return *m_snp_chnls; };
 private:
 
+	//
+	// Transactions are kept in a free list by the bridge and reused
+	// (see AllocTransaction / FreeTransaction). The data and byte enable
+	// buffers are allocated once, sized for the max burst length, and
+	// the generic payload and genattr are reinitialized in Init.
+	//
 	class Transaction :
 		public ace_tx_helpers
 	{
 	public:
-		Transaction(tlm::tlm_command cmd,
+		Transaction(uint32_t maxDataLen) :
+			m_gp(new tlm::tlm_generic_payload()),
+			m_genattr(new genattr_extension()),
+			m_data(new uint8_t[maxDataLen]),
+			m_be(new uint8_t[maxDataLen]),
+			m_maxDataLen(maxDataLen),
+			m_burstType(0),
+			m_burstLen(0),
+			m_alignedAddress(0),
+			m_beat(1),
+			m_dataIdx(0),
+			m_delay(SC_ZERO_TIME),
+			m_abortScheduled(false),
+			m_TLMOngoing(false)
+		{
+			m_gp->set_extension(m_genattr);
+
+			if (ACE_MODE) {
+				setup_ace_helpers(m_gp);
+			}
+		}
+
+		void Init(tlm::tlm_command cmd,
 				uint64_t address,
 				uint32_t burstLen,
 				uint8_t  numberBytes,
@@ -269,20 +308,18 @@ private:
 				uint8_t  AxCache,
 				uint8_t  AxQoS,
 				uint8_t  AxRegion,
-				bool with_be = false) :
-			m_gp(new tlm::tlm_generic_payload()),
-			m_genattr(new genattr_extension()),
-			m_burstType(burstType),
-			m_burstLen(burstLen),
-			m_alignedAddress(Align(address, numberBytes)),
-			m_beat(1),
-			m_dataIdx(0),
-			m_delay(SC_ZERO_TIME),
-			m_abortScheduled(false),
-			m_TLMOngoing(false)
+				bool with_be = false)
 		{
 			uint32_t dataLen;
-			uint8_t *data;
+
+			m_burstType = burstType;
+			m_burstLen = burstLen;
+			m_alignedAddress = Align(address, numberBytes);
+			m_beat = 1;
+			m_dataIdx = 0;
+			m_delay = SC_ZERO_TIME;
+			m_abortScheduled = false;
+			m_TLMOngoing = false;
 
 			if (burstType == AXI_BURST_FIXED) {
 				dataLen = burstLen * DATA_BUS_BYTES;
@@ -293,11 +330,25 @@ private:
 							burstLen);
 			}
 
-			data = new uint8_t[dataLen];
-
 			assert(numberBytes > 0);
 			assert(dataLen > 0);
 
+			//
+			// Only happens on bursts exceeding the max burst
+			// length (reported in Validate)
+			//
+			if (dataLen > m_maxDataLen) {
+				delete[] m_data;
+				delete[] m_be;
+
+				m_data = new uint8_t[dataLen];
+				m_be = new uint8_t[dataLen];
+				m_maxDataLen = dataLen;
+			}
+
+			ClearExtensions();
+			*m_genattr = genattr_extension();
+
 			if (IsNonSecure(AxProt)) {
 				m_genattr->set_non_secure();
 			}
@@ -322,12 +373,10 @@ private:
 				m_gp->set_address(address);
 			}
 			m_gp->set_data_length(dataLen);
-			m_gp->set_data_ptr(reinterpret_cast<unsigned char*>(data));
+			m_gp->set_data_ptr(reinterpret_cast<unsigned char*>(m_data));
 
 			if (with_be) {
-				uint8_t *be = new uint8_t[dataLen];
-
-				m_gp->set_byte_enable_ptr(reinterpret_cast<unsigned char*>(be));
+				m_gp->set_byte_enable_ptr(reinterpret_cast<unsigned char*>(m_be));
 				m_gp->set_byte_enable_length(dataLen);
 			} else  {
 				m_gp->set_byte_enable_ptr(NULL);
@@ -347,21 +396,33 @@ private:
 
 			m_gp->set_dmi_allowed(false);
 			m_gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+		}
 
-			m_gp->set_extension(m_genattr);
+		//
+		// Extensions attached downstream during the previous use of the
+		// payload are not ours, drop them (auto extensions are freed by
+		// reset) and keep only the genattr.
+		//
+		void ClearExtensions()
+		{
+			unsigned int i;
 
-			if (ACE_MODE) {
-				setup_ace_helpers(m_gp);
+			m_gp->reset();
+
+			for (i = 0; i < tlm::max_num_extensions(); i++) {
+				tlm::tlm_extension_base *ext;
+
+				ext = m_gp->get_extension(i);
+				if (ext && ext != m_genattr) {
+					m_gp->clear_extension(i);
+				}
 			}
 		}
 
 		~Transaction()
 		{
-			delete[] m_gp->get_data_ptr();
-
-			if (m_gp->get_byte_enable_ptr()) {
-				delete[] m_gp->get_byte_enable_ptr();
-			}
+			delete[] m_data;
+			delete[] m_be;
 
 			delete m_gp; // Also deletes m_genattr
 		}
@@ -395,6 +456,10 @@ private:
 		{
 			unsigned char *gp_data = m_gp->get_data_ptr();
 			unsigned char *be = m_gp->get_byte_enable_ptr();
+			uint8_t beat[DATA_BUS_BYTES];
+			uint8_t beat_be[DATA_BUS_BYTES];
+			unsigned int remaining;
+			unsigned int len;
 			unsigned int i = 0;
 
 			if (m_beat == 1) {
@@ -407,22 +472,24 @@ private:
 				i = address - Align(address, DATA_BUS_BYTES);
 			}
 
+			assert(m_dataIdx <= m_gp->get_data_length());
+			remaining = m_gp->get_data_length() - m_dataIdx;
+			len = DATA_BUS_BYTES - i;
+			len = len <= remaining ? len : remaining;
+
 			//
-			// Fill in data or mark the byte as TLM_DISABLED
+			// Extract the beat and expand the strobes into byte
+			// enables (TLM_BYTE_ENABLED / TLM_BYTE_DISABLED)
+			// through native buffers. Data of disabled bytes is
+			// don't care.
 			//
-			for (; i < DATA_BUS_BYTES && m_dataIdx < m_gp->get_data_length(); i++) {
-				if (wstrb.read().bit(i)) {
-					int firstbit = i * 8;
-					int lastbit = firstbit + 8 - 1;
-
-					assert(m_dataIdx < m_gp->get_data_length());
-					be[m_dataIdx] = TLM_BYTE_ENABLED;
-					gp_data[m_dataIdx++] =
-						wdata.read().range(lastbit, firstbit).to_uint();
-				} else {
-					be[m_dataIdx++] = TLM_BYTE_DISABLED;
-				}
-			}
+			axi_bv_to_bytes(wdata.read(), beat);
+			axi_strb_to_be(wstrb.read(), beat_be);
+
+			memcpy(&gp_data[m_dataIdx], &beat[i], len);
+			memcpy(&be[m_dataIdx], &beat_be[i], len);
+
+			m_dataIdx += len;
 		}
 
 		template<typename T>
@@ -434,19 +501,15 @@ private:
 			uint64_t alignedAddress;
 			unsigned int lower_byte_lane;
 			unsigned int upper_byte_lane;
-			unsigned int i;
+			uint8_t beat[DATA_BUS_BYTES];
+			unsigned int len;
 
 			alignedAddress = Align(address, numberBytes);
 
 			if (m_burstType == AXI_BURST_FIXED) {
 				// Set everything
-				for (i = 0; i < DATA_BUS_BYTES; i++) {
-					int firstbit = i*8;
-					int lastbit = firstbit + 8-1;
-
-					data.range(lastbit, firstbit) =
-						gp_data[m_dataIdx++];
-				}
+				memcpy(beat, &gp_data[m_dataIdx], DATA_BUS_BYTES);
+				m_dataIdx += DATA_BUS_BYTES;
 			} else {
 				if (m_beat == 1) {
 					lower_byte_lane = address -
@@ -464,17 +527,26 @@ private:
 								(numberBytes-1);
 				}
 
-				// Set data
-				for (i = 0; i < DATA_BUS_BYTES; i++) {
-					if (i >= lower_byte_lane && i <= upper_byte_lane) {
-						int firstbit = i*8;
-						int lastbit = firstbit + 8-1;
+				if (upper_byte_lane >= DATA_BUS_BYTES) {
+					upper_byte_lane = DATA_BUS_BYTES - 1;
+				}
 
-						data.range(lastbit, firstbit) =
-							gp_data[m_dataIdx++];
-					}
+				//
+				// Set data, the lanes outside of the active
+				// ones keep their current values
+				//
+				axi_bv_to_bytes(data, beat);
+
+				if (lower_byte_lane <= upper_byte_lane) {
+					len = upper_byte_lane - lower_byte_lane + 1;
+
+					memcpy(&beat[lower_byte_lane],
+						&gp_data[m_dataIdx], len);
+					m_dataIdx += len;
 				}
 			}
+
+			axi_bytes_to_bv(data, beat);
 		}
 
 		tlm::tlm_generic_payload* GetTLMGenericPayload()
@@ -515,7 +587,7 @@ private:
 			unsigned char *be = m_gp->get_byte_enable_ptr();
 			unsigned int i;
 
-			// If all bytes are enabled delete byte_enable
+			// If all bytes are enabled drop byte_enable
 			for (i = 0; i < be_len; i++) {
 				if (be[i] != TLM_BYTE_ENABLED) {
 					break;
@@ -523,11 +595,9 @@ private:
 			}
 
 			if (i == be_len) {
-				// All are enabled
+				// All are enabled (m_be is kept for reuse)
 				m_gp->set_byte_enable_ptr(NULL);
 				m_gp->set_byte_enable_length(0);
-
-				delete[] be;
 			}
 		}
 
@@ -603,6 +673,29 @@ private:
 
 		uint64_t GetAddress() { return m_gp->get_address(); }
 
+		//
+		// Position in the TransactionQueue the transaction is
+		// currently in (a transaction is in at most one queue).
+		//
+		void SetQueuePos(typename std::list<Transaction*>::iterator pos,
+					uint64_t seq)
+		{
+			m_queuePos = pos;
+			m_seq = seq;
+		}
+		typename std::list<Transaction*>::iterator GetQueuePos()
+		{
+			return m_queuePos;
+		}
+		uint64_t GetSeq() { return m_seq; }
+
+		//
+		// 4 KB page the transaction was queued under, the gp
+		// address is updated while the transaction is processed.
+		//
+		void SetQueuePage(uint64_t page) { m_queuePage = page; }
+		uint64_t GetQueuePage() { return m_queuePage; }
+
 		bool hasData()
 		{
 			if (ACE_MODE) {
@@ -642,6 +735,9 @@ private:
 	private:
 		tlm::tlm_generic_payload *m_gp;
 		genattr_extension *m_genattr;
+		uint8_t *m_data;
+		uint8_t *m_be;
+		uint32_t m_maxDataLen;
 		uint8_t m_burstType;
 		uint32_t m_burstLen;
 		uint64_t m_alignedAddress;
@@ -651,93 +747,42 @@ private:
 
 		bool m_abortScheduled;
 		bool m_TLMOngoing;
-	};
 
-	Transaction *GetFirstWithID(std::list<Transaction*> *list,
-					uint32_t transactionID)
-	{
-		for (typename std::list<Transaction*>::iterator it = list->begin();
-			it != list->end(); it++) {
-			Transaction *t = (*it);
+		typename std::list<Transaction*>::iterator m_queuePos;
+		uint64_t m_seq;
+		uint64_t m_queuePage;
+	};
 
-			if (t && t->GetTransactionID() == transactionID) {
-				return t;
-			}
-		}
-		return NULL;
-	}
+	typedef AMBA::AXI::TransactionQueue<Transaction,
+				ACE_MODE != ACE_MODE_OFF> TransactionQueue;
 
-	bool InList(std::list<Transaction*>& l, uint32_t id)
+	Transaction *AllocTransaction()
 	{
-		for (typename std::list<Transaction*>::iterator it = l.begin();
-			it != l.end(); it++) {
-			if ((*it)->GetTransactionID() == id) {
-				return true;
-			}
-		}
-		return false;
-	}
-
-	bool PreviousHaveData(std::list<Transaction*>& l, uint32_t id)
-	{
-		//
-		// For AXI3:
-		//
-		// For a slave that supports write data interleaving, the order in
-		// which it receives the first data item of each transaction must be
-		// the same as the order in which it receives the addresses for the
-		// transactions.
-		//
-
-		for (typename std::list<Transaction*>::iterator it = l.begin();
-			it != l.end(); it++) {
+		Transaction *t;
 
-			Transaction *t = (*it);
-
-			if (t->GetTransactionID() == id) {
-				break;
-			}
-
-			if (t->GetBeat() == 1) {
-				//
-				// Transaction has no yet received data and was
-				// received before than current wid
-				//
-				return false;
-			}
+		if (m_txPool.empty()) {
+			return new Transaction(m_maxBurstLength * DATA_BUS_BYTES);
 		}
 
-		return true;
+		t = m_txPool.back();
+		m_txPool.pop_back();
+
+		return t;
 	}
 
-	bool OverlappingAddress(std::list<Transaction*>* list, Transaction* tr)
+	void FreeTransaction(Transaction *t)
 	{
-		for (typename std::list<Transaction*>::iterator it = list->begin();
-			*it != tr; it++) {
-			uint64_t address1 = (*it)->GetTLMGenericPayload()->get_address();
-			uint64_t address2 = tr->GetTLMGenericPayload()->get_address();
-
-			if ((address1 >> 12) == (address2 >> 12)) {
-				return true;
-			}
-		}
-		return false;
+		m_txPool.push_back(t);
 	}
 
-	bool is_after_barrier(std::list<Transaction*> *list, Transaction *tr)
+	void ClearFifo(sc_fifo<Transaction*>& fifo)
 	{
-		for (typename std::list<Transaction*>::iterator it = list->begin();
-			*it != tr; it++) {
-			Transaction *t = (*it);
-
-			if (t->IsBarrier()) {
-				return true;
-			}
+		while (fifo.num_available() > 0) {
+			FreeTransaction(fifo.read());
 		}
-		return false;
 	}
 
-	bool WaitForTransactions(std::list<Transaction*> *list, Transaction *tr)
+	bool WaitForTransactions(TransactionQueue *list, Transaction *tr)
 	{
 		if (ACE_MODE) {
 			if (tr->IsBarrier()) {
@@ -758,7 +803,7 @@ private:
 				// (section C8.4.1 [1])
 				//
 
-				if (is_after_barrier(list, tr)) {
+				if (list->IsAfterBarrier(tr)) {
 
 					if (!tr->IsWriteBack() &&
 						!tr->IsWriteClean() &&
@@ -772,10 +817,10 @@ private:
 		//
 		// Issue transactions with overlapping addresses in order [1]
 		//
-		return OverlappingAddress(list, tr);
+		return list->OverlappingAddress(tr);
 	}
 
-	void RunTLMTransaction(std::list<Transaction*> *list,
+	void RunTLMTransaction(TransactionQueue *list,
 				uint32_t transactionID,
 				sc_fifo<Transaction*> *fifo)
 	{
@@ -784,7 +829,7 @@ private:
 		//
 		// Issue transactions with the same ID in order
 		//
-		while ((tr = GetFirstWithID(list, transactionID))) {
+		while ((tr = list->GetFirstWithID(transactionID))) {
 			sc_time delay(SC_ZERO_TIME);
 			tlm::tlm_generic_payload *m_gp = tr->GetTLMGenericPayload();
 
@@ -810,7 +855,7 @@ private:
 				break;
 			} else if (tr->AbortScheduled()) {
 				list->remove(tr);
-				delete tr;
+				FreeTransaction(tr);
 				continue;
 			}
 
@@ -842,7 +887,7 @@ private:
 
 		if (reset_asserted() && tr) {
 			list->remove(tr);
-			delete tr;
+			FreeTransaction(tr);
 			wait_for_reset_release();
 		}
 	}
@@ -879,9 +924,24 @@ private:
 	void read_address_phase()
 	{
 		while (true) {
-			arready.write(assert_arready());
+			bool ready = assert_arready();
+			bool at_edge = false;
 
-			wait(clk.posedge_event() | resetn.negedge_event());
+			arready.write(ready);
+
+			//
+			// Only sleep while arready is driven high, it then
+			// stays high on the edge where arvalid gets sampled
+			// (only this thread lowers it).
+			//
+			if (ready) {
+				at_edge = wait_idle(arvalid);
+			}
+
+			if (!at_edge) {
+				wait(clk.posedge_event() |
+					resetn.negedge_event());
+			}
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
@@ -892,18 +952,19 @@ private:
 				bool procesingTransId;
 
 				// Sample read address and control lines
-				Transaction *rt =
-					new Transaction(tlm::TLM_READ_COMMAND,
-							araddr.read().to_uint64(),
-							to_uint(arlen) + 1,
-							1 << arsize.read().to_uint(),
-							arburst.read().to_uint(),
-							to_uint(arid),
-							to_uint(arprot),
-							to_uint(arlock),
-							arcache.read().to_uint(),
-							arqos.read().to_uint(),
-							arregion.read().to_uint());
+				Transaction *rt = AllocTransaction();
+
+				rt->Init(tlm::TLM_READ_COMMAND,
+					araddr.read().to_uint64(),
+					to_uint(arlen) + 1,
+					1 << arsize.read().to_uint(),
+					arburst.read().to_uint(),
+					to_uint(arid),
+					to_uint(arprot),
+					to_uint(arlock),
+					arcache.read().to_uint(),
+					arqos.read().to_uint(),
+					arregion.read().to_uint());
 
 				if (ACE_MODE) {
 					rt->SetAxSnoop(arsnoop.read().to_uint());
@@ -936,7 +997,7 @@ private:
 
 				Validate(rt);
 
-				procesingTransId = InList(rtList, rt->GetTransactionID());
+				procesingTransId = rtList.InList(rt->GetTransactionID());
 
 				rtList.push_back(rt);
 
@@ -993,7 +1054,7 @@ private:
 						rt->GetAddress(),
 						rt->GetDataLen()) == false) {
 
-					delete rt;
+					FreeTransaction(rt);
 					wait_for_reset_release();
 					continue;
 				}
@@ -1044,7 +1105,7 @@ private:
 				m_snp_chnls->GetOverlapList().remove(rt->GetTLMGenericPayload());
 			}
 
-			delete rt;
+			FreeTransaction(rt);
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
@@ -1082,9 +1143,24 @@ private:
 	void write_address_phase()
 	{
 		while (true) {
-			awready.write(assert_awready());
+			bool ready = assert_awready();
+			bool at_edge = false;
+
+			awready.write(ready);
 
-			wait(clk.posedge_event() | resetn.negedge_event());
+			//
+			// Only sleep while awready is driven high, it then
+			// stays high on the edge where awvalid gets sampled
+			// (only this thread lowers it).
+			//
+			if (ready) {
+				at_edge = wait_idle(awvalid);
+			}
+
+			if (!at_edge) {
+				wait(clk.posedge_event() |
+					resetn.negedge_event());
+			}
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
@@ -1093,18 +1169,20 @@ private:
 
 			if (awvalid.read() && awready.read()) {
 				// Sample write address and control lines
-				Transaction *wt = new Transaction(tlm::TLM_WRITE_COMMAND,
-								awaddr.read().to_uint64(),
-								to_uint(awlen) + 1,
-								1 << awsize.read().to_uint(),
-								awburst.read().to_uint(),
-								to_uint(awid),
-								to_uint(arprot),
-								to_uint(awlock),
-								awcache.read().to_uint(),
-								awqos.read().to_uint(),
-								awregion.read().to_uint(),
-								true);
+				Transaction *wt = AllocTransaction();
+
+				wt->Init(tlm::TLM_WRITE_COMMAND,
+					awaddr.read().to_uint64(),
+					to_uint(awlen) + 1,
+					1 << awsize.read().to_uint(),
+					awburst.read().to_uint(),
+					to_uint(awid),
+					to_uint(arprot),
+					to_uint(awlock),
+					awcache.read().to_uint(),
+					awqos.read().to_uint(),
+					awregion.read().to_uint(),
+					true);
 
 				if (ACE_MODE) {
 					wt->SetAxSnoop(awsnoop.read().to_uint());
@@ -1144,7 +1222,7 @@ private:
 		}
 	}
 
-	Transaction *next_from(std::list<Transaction*>& l)
+	Transaction *next_from(TransactionQueue& l)
 	{
 		if (l.empty()) {
 			return NULL;
@@ -1156,7 +1234,7 @@ private:
 	{
 		bool procesingTransId;
 
-		procesingTransId = InList(wtList, wt->GetTransactionID());
+		procesingTransId = wtList.InList(wt->GetTransactionID());
 
 		wtList.push_back(wt);
 
@@ -1202,7 +1280,7 @@ private:
 			} else {
 				uint32_t id = to_uint(wid);
 
-				wt = GetFirstWithID(&wrDataList, id);
+				wt = wrDataList.GetFirstWithID(id);
 
 				if(!wt) {
 					SC_REPORT_ERROR("axi2tlm-bridge",
@@ -1210,7 +1288,7 @@ private:
 						"transaction ID");
 				}
 
-				if (!PreviousHaveData(wrDataList, id)) {
+				if (!wrDataList.PreviousHaveData(id)) {
 					SC_REPORT_ERROR("axi2tlm-bridge",
 						"The first data item of each "
 						"transaction is not in the same "
@@ -1221,7 +1299,7 @@ private:
 
 			wt->FillData(wdata, wstrb);
 
-			wt->IncBeat();
+			wrDataList.IncBeat(wt);
 
 			if (wt->Done()) {
 				wrDataList.remove(wt);
@@ -1238,7 +1316,7 @@ private:
 				//
 				// Start a thread handling this transaction ID if needed
 				//
-				procesingTransId = InList(wtList, wt->GetTransactionID());
+				procesingTransId = wtList.InList(wt->GetTransactionID());
 
 				wtList.push_back(wt);
 
@@ -1311,7 +1389,7 @@ private:
 				m_snp_chnls->GetOverlapList().remove(wt->GetTLMGenericPayload());
 			}
 
-			delete wt;
+			FreeTransaction(wt);
 
 			if (reset_asserted()) {
 				//
@@ -1326,20 +1404,21 @@ private:
 		}
 	}
 
-	void TLMListClear(std::list<Transaction*>& l)
+	void TLMListClear(TransactionQueue& l)
 	{
 		// Schedule abort on transactions that are ongoing and abort
 		// all others
-		for (typename std::list<Transaction*>::iterator it = l.begin();
+		for (typename TransactionQueue::iterator it = l.begin();
 			it != l.end();) {
 			Transaction *t = (*it);
 
+			it++;
+
 			if (t->TLMOngoing()) {
 				t->SetAbortScheduled();
-				it++;
 			} else {
-				it = l.erase(it);
-				delete t;
+				l.remove(t);
+				FreeTransaction(t);
 			}
 		}
 	}
@@ -1353,14 +1432,14 @@ private:
 			// Reset got asserted, abort all transactions
 			//
 
-			axi2tlm_clear_fifo(rdDataFifo);
+			ClearFifo(rdDataFifo);
 
-			axi2tlm_clear_fifo(wrRespFifo);
+			ClearFifo(wrRespFifo);
 
-			for (typename std::list<Transaction*>::iterator it = wrDataList.begin();
+			for (typename TransactionQueue::iterator it = wrDataList.begin();
 				it != wrDataList.end(); it++) {
 				Transaction *t = (*it);
-				delete t;
+				FreeTransaction(t);
 			}
 			wrDataList.clear();
 
@@ -1494,7 +1573,7 @@ private:
 	sc_fifo<Transaction*> wrRespFifo;
 
 	sc_event		m_awEvent;
-	std::list<Transaction*> wrDataList;
+	TransactionQueue wrDataList;
 
 	unsigned int m_maxReadTransactions;
 	unsigned int m_maxWriteTransactions;
@@ -1508,8 +1587,11 @@ private:
 	unsigned int m_maxBurstLength;
 
 	// Used for checking overlapping addresses
-	std::list<Transaction*> rtList;
-	std::list<Transaction*> wtList;
+	TransactionQueue rtList;
+	TransactionQueue wtList;
+
+	// Free Transactions
+	std::vector<Transaction*> m_txPool;
 
 	static const uint32_t DATA_BUS_BYTES = DATA_WIDTH/8;
 
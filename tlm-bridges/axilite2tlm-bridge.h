@@ -364,13 +364,25 @@ private:
 	void read_address_phase()
 	{
 		while (true) {
-			if (m_numReadTransactions < m_maxReadTransactions) {
-				arready.write(true);
-			} else {
-				arready.write(false);
+			bool ready =
+				m_numReadTransactions < m_maxReadTransactions;
+			bool at_edge = false;
+
+			arready.write(ready);
+
+			//
+			// Only sleep while arready is driven high, it then
+			// stays high on the edge where arvalid gets sampled
+			// (only this thread lowers it).
+			//
+			if (ready) {
+				at_edge = wait_idle(arvalid);
 			}
 
-			wait(clk.posedge_event() | resetn.negedge_event());
+			if (!at_edge) {
+				wait(clk.posedge_event() |
+					resetn.negedge_event());
+			}
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
@@ -440,13 +452,25 @@ private:
 	void write_address_phase()
 	{
 		while (true) {
-			if (m_numWriteTransactions < m_maxWriteTransactions) {
-				awready.write(true);
-			} else {
-				awready.write(false);
+			bool ready =
+				m_numWriteTransactions < m_maxWriteTransactions;
+			bool at_edge = false;
+
+			awready.write(ready);
+
+			//
+			// Only sleep while awready is driven high, it then
+			// stays high on the edge where awvalid gets sampled
+			// (only this thread lowers it).
+			//
+			if (ready) {
+				at_edge = wait_idle(awvalid);
 			}
 
-			wait(clk.posedge_event() | resetn.negedge_event());
+			if (!at_edge) {
+				wait(clk.posedge_event() |
+					resetn.negedge_event());
+			}
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
@@ -127,7 +127,10 @@ private:
 
 		while (true) {
 
-			wait(clk.posedge_event() | resetn.negedge_event());
+			if (!wait_idle(tvalid)) {
+				wait(clk.posedge_event() |
+					resetn.negedge_event());
+			}
 
 			if (reset_asserted()) {
 				wait_for_reset_release();
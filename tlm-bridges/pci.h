@@ -78,6 +78,11 @@ namespace TLP {
 		SZ_1K = 1024,
 		SZ_4K = SZ_1K * 4,
 		MAX_DW_LEN = 1024,
+
+		//
+		// 10-Bit Tag space, [1] Section 2.2.6.2
+		//
+		NUM_TAGS = 1024,
 	};
 
 }; // namespace TLP
@@ -0,0 +1,250 @@
+/*
+ * AXI slave bridge transaction queue.
+ *
+ * Copyright (c) 2018 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TLM_BRIDGES_PRIV_AXI_TXN_QUEUE_H__
+#define TLM_BRIDGES_PRIV_AXI_TXN_QUEUE_H__
+
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <assert.h>
+#include <stdint.h>
+
+namespace AMBA {
+namespace AXI {
+
+//
+// Outstanding transactions in address order, indexed on transaction
+// ID. Queues of transactions waiting for their TLM transaction to be
+// issued are also indexed on address page (for the overlapping
+// address checks) and on barriers, the write data queue instead
+// tracks transactions still waiting for their first data beat. This
+// makes the ordering and hazard checks O(1) instead of scanning the
+// whole list.
+//
+// T records its position in the queue (SetQueuePos / SetQueuePage) and
+// provides the transaction ID, address, beat and barrier accessors.
+// Barriers are only tracked with BARRIERS set (ACE).
+//
+template<typename T, bool BARRIERS>
+class TransactionQueue
+{
+public:
+	typedef typename std::list<T*>::iterator iterator;
+
+	TransactionQueue(bool dataQueue = false) :
+		m_dataQueue(dataQueue),
+		m_seq(0)
+	{}
+
+	bool empty() { return m_list.empty(); }
+	T *front() { return m_list.front(); }
+
+	iterator begin() { return m_list.begin(); }
+	iterator end() { return m_list.end(); }
+
+	void push_back(T *t)
+	{
+		t->SetQueuePos(m_list.insert(m_list.end(), t), m_seq++);
+
+		m_byID[t->GetTransactionID()].push_back(t);
+
+		if (m_dataQueue) {
+			if (t->GetBeat() == 1) {
+				m_noData.push_back(t);
+			}
+			return;
+		}
+
+		t->SetQueuePage(GetPage(t));
+		m_byPage[t->GetQueuePage()].push_back(t);
+
+		if (BARRIERS && t->IsBarrier()) {
+			m_barriers.push_back(t);
+		}
+	}
+
+	void remove(T *t)
+	{
+		m_list.erase(t->GetQueuePos());
+
+		EraseKey(m_byID, t->GetTransactionID(), t);
+
+		if (m_dataQueue) {
+			if (t->GetBeat() == 1) {
+				Erase(m_noData, t);
+			}
+			return;
+		}
+
+		EraseKey(m_byPage, t->GetQueuePage(), t);
+
+		if (BARRIERS && t->IsBarrier()) {
+			Erase(m_barriers, t);
+		}
+	}
+
+	void clear()
+	{
+		m_list.clear();
+		m_byID.clear();
+		m_byPage.clear();
+		m_barriers.clear();
+		m_noData.clear();
+	}
+
+	//
+	// Must be used instead of Transaction::IncBeat for
+	// transactions in the queue.
+	//
+	void IncBeat(T *t)
+	{
+		if (m_dataQueue && t->GetBeat() == 1) {
+			Erase(m_noData, t);
+		}
+		t->IncBeat();
+	}
+
+	T *GetFirstWithID(uint32_t id)
+	{
+		typename IDMap::iterator it = m_byID.find(id);
+
+		if (it == m_byID.end()) {
+			return NULL;
+		}
+		return it->second.front();
+	}
+
+	bool InList(uint32_t id)
+	{
+		return m_byID.find(id) != m_byID.end();
+	}
+
+	//
+	// For AXI3:
+	//
+	// For a slave that supports write data interleaving, the
+	// order in which it receives the first data item of each
+	// transaction must be the same as the order in which it
+	// receives the addresses for the transactions.
+	//
+	// Returns true if all transactions queued before the first
+	// transaction with the ID have received data.
+	//
+	bool PreviousHaveData(uint32_t id)
+	{
+		T *t = GetFirstWithID(id);
+
+		assert(m_dataQueue);
+
+		if (m_noData.empty()) {
+			return true;
+		}
+
+		return t && m_noData.front()->GetSeq() >= t->GetSeq();
+	}
+
+	//
+	// True if a transaction queued before 't' is to the same
+	// 4 KB page.
+	//
+	bool OverlappingAddress(T *t)
+	{
+		assert(!m_dataQueue);
+		return m_byPage[t->GetQueuePage()].front() != t;
+	}
+
+	bool IsAfterBarrier(T *t)
+	{
+		if (m_barriers.empty()) {
+			return false;
+		}
+		return m_barriers.front()->GetSeq() < t->GetSeq();
+	}
+
+private:
+	typedef std::unordered_map<uint32_t,
+			std::deque<T*> > IDMap;
+	typedef std::unordered_map<uint64_t,
+			std::deque<T*> > PageMap;
+
+	uint64_t GetPage(T *t)
+	{
+		return t->GetAddress() >> 12;
+	}
+
+	//
+	// Transactions are normally removed from the front, the
+	// search is only done on aborts.
+	//
+	static void Erase(std::deque<T*>& q, T *t)
+	{
+		typename std::deque<T*>::iterator it;
+
+		if (q.empty()) {
+			return;
+		}
+
+		if (q.front() == t) {
+			q.pop_front();
+			return;
+		}
+
+		for (it = q.begin(); it != q.end(); it++) {
+			if ((*it) == t) {
+				q.erase(it);
+				break;
+			}
+		}
+	}
+
+	template<typename MAP, typename KEY>
+	static void EraseKey(MAP& m, KEY key, T *t)
+	{
+		typename MAP::iterator it = m.find(key);
+
+		if (it == m.end()) {
+			return;
+		}
+
+		Erase(it->second, t);
+		if (it->second.empty()) {
+			m.erase(it);
+		}
+	}
+
+	bool m_dataQueue;
+	std::list<T*> m_list;
+	IDMap m_byID;
+	PageMap m_byPage;
+	std::deque<T*> m_barriers;
+	std::deque<T*> m_noData;
+	uint64_t m_seq;
+};
+
+}; // namespace AXI
+}; // namespace AMBA
+
+#endif /* TLM_BRIDGES_PRIV_AXI_TXN_QUEUE_H__ */
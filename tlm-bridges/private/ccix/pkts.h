@@ -352,9 +352,10 @@ protected:
 		}
 
 		//
-		// The data that comes after the byte enables is 4 byte
-		// aligned
+		// Step over the last byte enable byte, the data that comes
+		// after the byte enables is 4 byte aligned
 		//
+		m_pos++;
 		for (; m_pos % 4; m_pos++);
 
 		//
@@ -1318,6 +1319,44 @@ private:
 	}
 };
 
+//
+// CXS data flit <-> byte array (byte n holding bits [8n+7:8n] of the flit).
+// The flit is converted through the words of the sc_bv.
+//
+template<int N>
+static inline void cxs_flit_to_bytes(const sc_bv<N>& flit, uint8_t *buf)
+{
+	const unsigned int digit_sz = sizeof(sc_dt::sc_digit);
+	const unsigned int nbytes = N / 8;
+	unsigned int i;
+
+	for (i = 0; i < nbytes; i += digit_sz) {
+		sc_dt::sc_digit w = flit.get_word(i / digit_sz);
+		unsigned int n = (nbytes - i) < digit_sz ?
+					(nbytes - i) : digit_sz;
+
+		memcpy(buf + i, &w, n);
+	}
+}
+
+template<int N>
+static inline void cxs_bytes_to_flit(sc_bv<N>& flit, const uint8_t *buf)
+{
+	const unsigned int digit_sz = sizeof(sc_dt::sc_digit);
+	const unsigned int nbytes = N / 8;
+	unsigned int i;
+
+	for (i = 0; i < nbytes; i += digit_sz) {
+		sc_dt::sc_digit w = 0;
+		unsigned int n = (nbytes - i) < digit_sz ?
+					(nbytes - i) : digit_sz;
+
+		memcpy(&w, buf + i, n);
+		flit.set_word(i / digit_sz, w);
+	}
+	flit.clean_tail();
+}
+
 template<typename T>
 class CXSCntl
 {
@@ -1353,116 +1392,127 @@ public:
 		Align_32 = 32,
 	};
 
-	CXSCntl(uint64_t cntl = 0)
+	CXSCntl(uint64_t cntl = 0) :
+		m_numStartPtrs(0),
+		m_numEndPtrs(0)
 	{
 		ParseCntl(cntl);
 	}
 
 	void AddStartPtr(unsigned int flit_pos)
 	{
-		unsigned int startPtr = flit_pos / Align_128;
+		assert(m_numStartPtrs < NumStartBits);
 
-		m_startPtrs.push_back(startPtr);
+		m_startPtrs[m_numStartPtrs++] = flit_pos / Align_128;
 	}
 
 	void AddEndPtr(unsigned int flit_pos)
 	{
-		unsigned int endPtr = flit_pos / Align_32;
+		assert(m_numEndPtrs < NumEndBits);
 
-		m_endPtrs.push_back(endPtr);
+		m_endPtrs[m_numEndPtrs++] = flit_pos / Align_32;
 	}
 
 	uint64_t to_uint64()
 	{
-		uint64_t cntl = 0;
+		uint64_t cntl;
+		unsigned int i;
 
 		//
-		// Add StartBits and StartPtrs
+		// StartBits and EndBits are used from bit 0 and up (in the
+		// order the packets are placed in the flit)
 		//
-		for (unsigned int i = 0; i < m_startPtrs.size(); i++) {
+		cntl = bitops_mask64(0, m_numStartPtrs);
+		cntl |= bitops_mask64(EndBits_Shift, m_numEndPtrs);
+
+		//
+		// StartPtrs and EndPtrs
+		//
+		for (i = 0; i < m_numStartPtrs; i++) {
 			unsigned int ptr_shift =
 					NumStartBits + i * StartPtr_Width;
+			uint64_t ptr = m_startPtrs[i] & StartPtr_Mask;
 
-			//
-			// Startbit
-			//
-			cntl |= 1 << i;
-
-			//
-			// StartPtr
-			//
-			cntl |= ((m_startPtrs[i] & StartPtr_Mask) << ptr_shift);
+			cntl |= ptr << ptr_shift;
 		}
 
-		//
-		// Add EndBits and EndPtrs
-		//
-		for (unsigned int i = 0; i < m_endPtrs.size(); i++) {
+		for (i = 0; i < m_numEndPtrs; i++) {
 			unsigned int ptr_shift =
 					EndPtrs_Shift + i * EndPtr_Width;
+			uint64_t ptr = m_endPtrs[i] & EndPtr_Mask;
 
-			//
-			// EndBit
-			//
-			cntl |= 1 << (EndBits_Shift + i);
-
-			//
-			// StartPtr
-			//
-			cntl |= ((m_endPtrs[i] & EndPtr_Mask) << ptr_shift);
+			cntl |= ptr << ptr_shift;
 		}
 
 		return cntl;
 	}
 
-	std::vector<unsigned int>& GetStartPtrs()
+	unsigned int GetNumStartPtrs() { return m_numStartPtrs; }
+	unsigned int GetNumEndPtrs() { return m_numEndPtrs; }
+
+	unsigned int GetStartPtr(unsigned int i)
+	{
+		assert(i < m_numStartPtrs);
+		return m_startPtrs[i];
+	}
+
+	unsigned int GetEndPtr(unsigned int i)
+	{
+		assert(i < m_numEndPtrs);
+		return m_endPtrs[i];
+	}
+
+	//
+	// Byte positions in the flit, the EndPtr byte position is the
+	// position after the last byte of the packet
+	//
+	unsigned int GetStartByte(unsigned int i)
 	{
-		return m_startPtrs;
+		return GetStartPtr(i) * (Align_128 / 8);
 	}
 
-	std::vector<unsigned int>& GetEndPtrs()
+	unsigned int GetEndByte(unsigned int i)
 	{
-		return m_endPtrs;
+		return (GetEndPtr(i) + 1) * (Align_32 / 8);
 	}
 
 private:
 	void ParseCntl(uint64_t cntl)
 	{
+		uint64_t startBits = cntl & bitops_mask64(0, NumStartBits);
+		uint64_t endBits = (cntl >> EndBits_Shift) &
+					bitops_mask64(0, NumEndBits);
+
 		//
-		// Parse StartBits and StartPtrs
+		// Only the set StartBits and EndBits are visited
 		//
-		for (int i = 0; i < NumStartBits; i++) {
-			if ((cntl >> i) & 1) {
-				unsigned int ptr_shift = NumStartBits +
-							(i * StartPtr_Width);
-				unsigned int ptr;
+		while (startBits) {
+			unsigned int i = __builtin_ctzll(startBits);
+			unsigned int ptr_shift = NumStartBits +
+						(i * StartPtr_Width);
 
-				ptr = (cntl >> ptr_shift) & StartPtr_Mask;
+			m_startPtrs[m_numStartPtrs++] =
+				(cntl >> ptr_shift) & StartPtr_Mask;
 
-				m_startPtrs.push_back(ptr);
-			}
+			startBits &= startBits - 1;
 		}
 
-		//
-		// Parse EndBits and EndPtrs
-		//
-		for (int i = 0; i < NumEndBits; i++) {
-			unsigned int endBit_Shift = EndBits_Shift + i;
-
-			if ((cntl >> endBit_Shift) & 1) {
-				unsigned int ptr_shift = EndPtrs_Shift +
-							(i * EndPtr_Width);
-				unsigned int ptr;
+		while (endBits) {
+			unsigned int i = __builtin_ctzll(endBits);
+			unsigned int ptr_shift = EndPtrs_Shift +
+						(i * EndPtr_Width);
 
-				ptr = (cntl >> ptr_shift) & EndPtr_Mask;
+			m_endPtrs[m_numEndPtrs++] =
+				(cntl >> ptr_shift) & EndPtr_Mask;
 
-				m_endPtrs.push_back(ptr);
-			}
+			endBits &= endBits - 1;
 		}
 	}
 
-	std::vector<unsigned int> m_startPtrs;
-	std::vector<unsigned int> m_endPtrs;
+	unsigned int m_startPtrs[NumStartBits];
+	unsigned int m_endPtrs[NumEndBits];
+	unsigned int m_numStartPtrs;
+	unsigned int m_numEndPtrs;
 };
 
 template<typename T>
@@ -1486,6 +1536,8 @@ public:
 		assert(m_gp);
 		assert(m_attr);
 
+		m_tlp.reserve(TLPHdr_t::TLPHdr_Size + msg->size() * 4);
+
 		PushBack_TLP_hdr(msg->size());
 
 		PushBack(*msg);
@@ -1507,40 +1559,7 @@ public:
 	{
 		sc_bv<FLIT_WIDTH> tmpFlit = flit.read();
 
-		//
-		// Start of new TLPs be 16 byte aligned (128 bit), see 4.2 [1]
-		//
-		if (m_pos == 0) {
-			for (; flit_pos < tmpFlit.length() && flit_pos % 128;
-				flit_pos += 8) {
-				unsigned int firstbit = flit_pos;
-				unsigned int lastbit = firstbit + 8 - 1;
-
-				tmpFlit.range(lastbit, firstbit) = 0;
-			}
-		}
-
-		//
-		// Fill the flit data and cntl
-		//
-		for (; flit_pos < tmpFlit.length() && !Done(); flit_pos += 8) {
-			unsigned int firstbit = flit_pos;
-			unsigned int lastbit = firstbit + 8 - 1;
-
-			bool mark_end = Mark_EndPtr();
-
-			assert(m_pos < m_tlp.size());
-
-			if (m_pos == 0) {
-				cntl.AddStartPtr(flit_pos);
-			}
-
-			tmpFlit.range(lastbit, firstbit) = get_tlp_byte();
-
-			if (mark_end) {
-				cntl.AddEndPtr(flit_pos);
-			}
-		}
+		CreateFlit(tmpFlit, flit_pos, cntl);
 
 		flit = tmpFlit;
 	}
@@ -1549,44 +1568,60 @@ public:
 				int flit_pos,
 				CXSCntl_t& cntl)
 	{
-		sc_bv<FLIT_WIDTH> tmpFlit = flit;
+		uint8_t buf[FLIT_WIDTH / 8];
 
-		//
-		// Start of new TLPs be 16 byte aligned (128 bit), see 4.2 [1]
-		//
-		if (m_pos == 0) {
-			for (; flit_pos < tmpFlit.length() && flit_pos % 128;
-				flit_pos += 8) {
-				unsigned int firstbit = flit_pos;
-				unsigned int lastbit = firstbit + 8 - 1;
+		cxs_flit_to_bytes(flit, buf);
 
-				tmpFlit.range(lastbit, firstbit) = 0;
-			}
-		}
+		FillFlit(buf, flit_pos / 8, sizeof(buf), cntl);
 
-		//
-		// Fill the flit data and cntl
-		//
-		for (; flit_pos < tmpFlit.length() && !Done(); flit_pos += 8) {
-			unsigned int firstbit = flit_pos;
-			unsigned int lastbit = firstbit + 8 - 1;
+		cxs_bytes_to_flit(flit, buf);
+	}
 
-			bool mark_end = Mark_EndPtr();
+	//
+	// Places the (remaining) TLP bytes into the flit byte array starting
+	// at byte position pos and returns the position after the last byte
+	// placed.
+	//
+	unsigned int FillFlit(uint8_t *flit, unsigned int pos,
+				unsigned int flit_len, CXSCntl_t& cntl)
+	{
+		unsigned int len;
 
-			assert(m_pos < m_tlp.size());
+		if (m_pos == 0) {
+			//
+			// Start of new TLPs be 16 byte aligned (128 bit),
+			// see 4.2 [1]
+			//
+			for (; pos < flit_len && pos % 16; pos++) {
+				flit[pos] = 0;
+			}
 
-			if (m_pos == 0) {
-				cntl.AddStartPtr(flit_pos);
+			if (pos == flit_len) {
+				return pos;
 			}
 
-			tmpFlit.range(lastbit, firstbit) = get_tlp_byte();
+			cntl.AddStartPtr(pos * 8);
+		}
 
-			if (mark_end) {
-				cntl.AddEndPtr(flit_pos);
-			}
+		len = m_tlp.size() - m_pos;
+		if (len > flit_len - pos) {
+			len = flit_len - pos;
 		}
 
-		flit = tmpFlit;
+		memcpy(&flit[pos], &m_tlp[m_pos], len);
+
+		m_pos += len;
+		pos += len;
+
+		if (m_pos == m_tlp.size()) {
+			//
+			// End Ptr is set on the last 4 bytes
+			//
+			cntl.AddEndPtr((pos - 4) * 8);
+			m_tlpDone = true;
+		}
+
+		return pos;
 	}
 
 	uint8_t get_tlp_byte()
@@ -1616,14 +1651,6 @@ public:
 		return v;
 	}
 
-	bool Mark_EndPtr()
-	{
-		//
-		// End Ptr is set on the last 4 bytes
-		//
-		return m_pos == (m_tlp.size() - 4);
-	}
-
 	bool Done() { return m_tlpDone; }
 
 	void NotifyDone()
@@ -1684,7 +1711,7 @@ template<typename TLPHdr_t>
 class TLPAssembler
 {
 public:
-	TLPAssembler(unsigned int startPtr) :
+	TLPAssembler(unsigned int startPtr = 0) :
 		m_startPtr(startPtr),
 		m_endPtr(0),
 		m_hasEndPtr(false),
@@ -1730,13 +1757,24 @@ public:
 	}
 
 	void ExtractCCIXMessages(std::list<IMsg*>& m_ccixMsgs)
+	{
+		ExtractCCIXMessages(m_data.data(), m_data.size(), m_ccixMsgs);
+	}
+
+	//
+	// Extracts the CCIX messages of the TLP in data (len bytes). The
+	// messages copy out what they need so data can be reused directly
+	// after.
+	//
+	void ExtractCCIXMessages(uint8_t *data, unsigned int len,
+					std::list<IMsg*>& m_ccixMsgs)
 	{
 		unsigned int pos = 0;
 
-		ExtractTLPHeader(pos);
+		ExtractTLPHeader(data, pos);
 
-		while (pos < m_data.size()) {
-			IMsg *msg = ExtractCCIXMessage(pos);
+		while (pos < len) {
+			IMsg *msg = ExtractCCIXMessage(data, len, pos);
 
 			if (msg) {
 				if (msg->IsReqChain()) {
@@ -1769,9 +1807,9 @@ public:
 	}
 
 private:
-	void ExtractTLPHeader(unsigned int& pos)
+	void ExtractTLPHeader(uint8_t *data, unsigned int& pos)
 	{
-		TLPHdr_t hdr(m_data.data());
+		TLPHdr_t hdr(data);
 
 		m_defTgtID = hdr.get_tgtID();
 		m_defSrcID = hdr.get_srcID();
@@ -1780,12 +1818,13 @@ private:
 		pos += TLPHdr_t::TLPHdr_Size;
 	}
 
-	IMsg *ExtractCCIXMessage(unsigned int& pos)
+	IMsg *ExtractCCIXMessage(uint8_t *data, unsigned int len,
+					unsigned int& pos)
 	{
-		uint8_t *msg = m_data.data() + pos;
+		uint8_t *msg = data + pos;
 		uint32_t msghdr;
 
-		assert((m_data.size() - pos) >= 4);
+		assert((len - pos) >= 4);
 
 		msghdr = toMsgHdr(msg);
 
@@ -28,6 +28,7 @@
 #define TLM_BRIDGES_PRIV_CCIX_RXLINK_H__
 
 #include <list>
+#include <vector>
 
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
@@ -43,6 +44,10 @@ namespace CCIX {
 // represented with a generic payload (with an attached CCIX attributes
 // extension). The class also handles CXS RX link credits.
 //
+// TLPs contained in a flit are extracted directly from the received flit
+// data. Only a TLP continuing into the next flit is collected, into a
+// reassembly buffer that is reused for all TLPs.
+//
 template<typename BRIDGE_T>
 class RxLink :
 	public sc_core::sc_module
@@ -55,7 +60,14 @@ public:
 		MAX_CREDITS = 15,
 
 		FLIT_WIDTH = BRIDGE_T::FLIT_WIDTH,
-		CNTL_WIDTH = BRIDGE_T::CNTL_WIDTH
+		CNTL_WIDTH = BRIDGE_T::CNTL_WIDTH,
+
+		FLIT_BYTES = FLIT_WIDTH / 8,
+
+		//
+		// Initial size of the reassembly buffer (it grows if needed)
+		//
+		TLP_BUF_SZ = 1024,
 	};
 
 	SC_HAS_PROCESS(RxLink);
@@ -77,6 +89,9 @@ public:
 
 		m_credits(MAX_CREDITS)
 	{
+		m_tlpPending = false;
+		m_tlpBuf.reserve(TLP_BUF_SZ);
+
 		SC_THREAD(rx_thread);
 		SC_THREAD(reset_thread);
 	}
@@ -132,8 +147,7 @@ private:
 			// Receive packet
 			//
 			if (rxvalid.read()) {
-				processRxCntl();
-				processRxData();
+				processRxFlit();
 
 				m_credits++;
 			} else if (rxcrdrtn.read()) {
@@ -154,131 +168,66 @@ private:
 		}
 	}
 
-	enum {
-		NumStartBits = BRIDGE_T::MAX_PKT_PER_FLIT,
-		NumEndErrorBits = BRIDGE_T::MAX_PKT_PER_FLIT,
-		NumEndBits = BRIDGE_T::MAX_PKT_PER_FLIT,
-
-		StartPtr_Width = BRIDGE_T::START_PTR_WIDTH,
-		EndPtr_Width = BRIDGE_T::END_PTR_WIDTH,
-
-		StartPtr_Mask = (1 << StartPtr_Width) - 1,
-		EndPtr_Mask = (1 << EndPtr_Width) - 1,
-
-		//
-		// Endbits bit position
-		//
-		EndBits_Shift = NumStartBits +
-				(NumStartBits * StartPtr_Width),
-
-		//
-		// EndPtrs bit position
-		//
-		EndPtrs_Shift = EndBits_Shift +
-				NumEndBits +
-				NumEndErrorBits,
-	};
+	void ExtractTLP(uint8_t *data, unsigned int len)
+	{
+		m_tlpAs.ExtractCCIXMessages(data, len, m_ccixMsgs);
+		m_msgEvent.notify();
+	}
 
-	void processRxCntl()
+	void processRxFlit()
 	{
 		CXSCntl_t cntl(rxcntl.read().to_uint64());
+		unsigned int numEnd = cntl.GetNumEndPtrs();
+		unsigned int end = 0;
+		unsigned int i;
 
-		std::vector<unsigned int>::iterator ptr_it;
-		typename std::list<TLPAssembler_t*>::iterator tlpas_it;
-
-		//
-		// Parse all StartPtrs
-		//
-		ptr_it = cntl.GetStartPtrs().begin();
-
-		for (; ptr_it != cntl.GetStartPtrs().end(); ptr_it++) {
-
-			unsigned int ptr = (*ptr_it);
-			unsigned int flit_start_pos;
-
-			flit_start_pos = ptr * CXSCntl_t::Align_128;
-
-			//
-			// Create a new assembler for each StartBit / StartPtr
-			//
-			m_assemblers.push_back(new TLPAssembler_t(flit_start_pos));
-		}
+		cxs_flit_to_bytes(rxdata.read(), m_flit);
 
 		//
-		// Parse all EndPtrs
+		// A TLP continuing from the previous flit owns the first
+		// EndPtr
 		//
-		tlpas_it = m_assemblers.begin();
-		ptr_it = cntl.GetEndPtrs().begin();
-
-		for (;ptr_it != cntl.GetEndPtrs().end(); ptr_it++, tlpas_it++) {
+		if (m_tlpPending) {
+			if (numEnd == 0) {
+				m_tlpBuf.insert(m_tlpBuf.end(),
+						m_flit, m_flit + FLIT_BYTES);
+				return;
+			}
 
-			unsigned int ptr = (*ptr_it);
-			unsigned int flit_end_pos = ptr * CXSCntl_t::Align_32;
+			m_tlpBuf.insert(m_tlpBuf.end(), m_flit,
+					m_flit + cntl.GetEndByte(end++));
 
-			TLPAssembler_t *tlpAs;
+			ExtractTLP(m_tlpBuf.data(), m_tlpBuf.size());
 
-			//
-			// There must be an assembler for each end bit
-			//
-			assert(tlpas_it != m_assemblers.end());
-
-			//
-			// Assign the EndPtr on the corresponding assembler
-			//
-			tlpAs = (*tlpas_it);
-			tlpAs->SetEndPtr(flit_end_pos);
+			m_tlpBuf.clear();
+			m_tlpPending = false;
 		}
-	}
 
-	//
-	// Assemble TLP data
-	//
-	void processRxData()
-	{
-		sc_bv<FLIT_WIDTH> flit = rxdata.read();
-		int flit_pos;
-
-		//
-		// Process 4 bytes (32 bits) at a time
-		//
-		for (flit_pos = 0; flit_pos < flit.length(); flit_pos +=32) {
-			if (!m_assemblers.empty()) {
-				TLPAssembler_t *tlpAs = m_assemblers.front();
+		for (i = 0; i < cntl.GetNumStartPtrs(); i++) {
+			unsigned int startByte = cntl.GetStartByte(i);
 
-				if (flit_pos >= tlpAs->GetStartPtr()) {
-					unsigned int firstbit = flit_pos;
-					unsigned int lastbit =
-							firstbit + 32 - 1;
-					uint32_t val;
+			if (end < numEnd) {
+				unsigned int endByte = cntl.GetEndByte(end++);
 
-					val = flit.range(lastbit, firstbit).to_uint();
+				assert(endByte > startByte);
 
-					//
-					// Collect byte or u32?
-					//
-					tlpAs->PushBack(val);
-
-					if (tlpAs->Done(flit_pos)) {
-						m_assemblers.remove(tlpAs);
-
-						tlpAs->ExtractCCIXMessages(m_ccixMsgs);
-
-						delete tlpAs;
+				//
+				// Contained in the flit
+				//
+				ExtractTLP(&m_flit[startByte],
+						endByte - startByte);
+			} else {
+				//
+				// Continues in the next flit
+				//
+				assert(!m_tlpPending);
 
-						m_msgEvent.notify();
-					}
-				}
+				m_tlpBuf.insert(m_tlpBuf.end(),
+						&m_flit[startByte],
+						m_flit + FLIT_BYTES);
+				m_tlpPending = true;
 			}
 		}
-
-		if (!m_assemblers.empty()) {
-			//
-			// For next flit collect data from the beginning
-			//
-			m_assemblers.front()->SetStartPtr(0);
-
-			assert(m_assemblers.size() == 1);
-		}
 	}
 
 	LinkState GetLinkState(bool req, bool ack)
@@ -317,15 +266,20 @@ private:
 		while (true) {
 			wait(resetn.negedge_event());
 
-			ClearList(m_assemblers);
+			m_tlpBuf.clear();
+			m_tlpPending = false;
+
 			ClearList(m_ccixMsgs);
 		}
 	}
 
 	//
-	// TLP Assemblers
+	// TLP extraction and reassembly
 	//
-	std::list<TLPAssembler_t*> m_assemblers;
+	TLPAssembler_t m_tlpAs;
+	uint8_t m_flit[FLIT_BYTES];
+	std::vector<uint8_t> m_tlpBuf;
+	bool m_tlpPending;
 
 	//
 	// Extracted CCIX messages
@@ -27,7 +27,7 @@
 #ifndef TLM_BRIDGES_PRIV_CCIX_TXLINK_H__
 #define TLM_BRIDGES_PRIV_CCIX_TXLINK_H__
 
-#include <list>
+#include <deque>
 
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
@@ -41,6 +41,11 @@ namespace CCIX {
 // This class converts and tranmits (CCIX) TLP packets as CXS data flits on the
 // CXS signals. The class also handles CXS TX link credits.
 //
+// The flit is built in a byte array and written to the signal once. Queued
+// TLPs are packed back to back into the flit (each starting 16 byte aligned)
+// as long as there are Start and End fields left in the CXS control
+// (MAX_PKT_PER_FLIT), see 4.2 [1].
+//
 template<typename BRIDGE_T>
 class TxLink :
 	public sc_core::sc_module
@@ -51,7 +56,10 @@ public:
 
 	enum {
 		FLIT_WIDTH = BRIDGE_T::FLIT_WIDTH,
-		CNTL_WIDTH = BRIDGE_T::CNTL_WIDTH
+		CNTL_WIDTH = BRIDGE_T::CNTL_WIDTH,
+		MAX_PKT_PER_FLIT = BRIDGE_T::MAX_PKT_PER_FLIT,
+
+		FLIT_BYTES = FLIT_WIDTH / 8,
 	};
 
 	SC_HAS_PROCESS(TxLink);
@@ -80,7 +88,7 @@ public:
 
 	void Process(TLP_t *t)
 	{
-		m_tlpList.push_back(t);
+		m_tlpQueue.push_back(t);
 
 		wait(t->DoneEvent());
 	}
@@ -119,13 +127,14 @@ private:
 			}
 
 			//
-			// If the flit is done: signal event and remove it from
-			// the list.
+			// Signal and remove the TLPs that were completed with
+			// the previous flit.
 			//
-			if (!m_tlpList.empty() && m_tlpList.front()->Done()) {
-				TLP_t *t = m_tlpList.front();
+			while (!m_tlpQueue.empty() &&
+				m_tlpQueue.front()->Done()) {
+				TLP_t *t = m_tlpQueue.front();
 
-				m_tlpList.pop_front();
+				m_tlpQueue.pop_front();
 
 				t->NotifyDone();
 			}
@@ -133,11 +142,10 @@ private:
 			//
 			// Setup next flit if there is one
 			//
-			if (m_credits && !m_tlpList.empty()) {
-				TLP_t *t = m_tlpList.front();
+			if (m_credits && !m_tlpQueue.empty()) {
 				CXSCntl_t cntl;
 
-				t->CreateFlit(txdata, 0, cntl);
+				CreateFlit(cntl);
 
 				txcntl.write(cntl.to_uint64());
 
@@ -153,6 +161,48 @@ private:
 		}
 	}
 
+	//
+	// Fill the flit with the TLP in progress followed by as many of the
+	// queued TLPs that fit.
+	//
+	void CreateFlit(CXSCntl_t& cntl)
+	{
+		typename std::deque<TLP_t*>::iterator it;
+		unsigned int pos = 0;
+
+		for (it = m_tlpQueue.begin(); it != m_tlpQueue.end(); it++) {
+			TLP_t *t = (*it);
+
+			if (pos == FLIT_BYTES) {
+				break;
+			}
+
+			//
+			// A new TLP needs a free Start field, and an End field
+			// in case it also ends in this flit.
+			//
+			if (it != m_tlpQueue.begin() &&
+				(cntl.GetNumStartPtrs() == MAX_PKT_PER_FLIT ||
+				cntl.GetNumEndPtrs() == MAX_PKT_PER_FLIT)) {
+				break;
+			}
+
+			pos = t->FillFlit(m_flit, pos, FLIT_BYTES, cntl);
+
+			if (!t->Done()) {
+				break;
+			}
+		}
+
+		//
+		// Zero the unused part of the flit
+		//
+		memset(&m_flit[pos], 0, FLIT_BYTES - pos);
+
+		cxs_bytes_to_flit(m_txdata, m_flit);
+		txdata.write(m_txdata);
+	}
+
 	LinkState GetLinkState(bool req, bool ack)
 	{
 		if (req && ack) {
@@ -170,13 +220,12 @@ private:
 		return GetLinkState(txactivereq.read(), txactiveack.read());
 	}
 
-	void ClearList(std::list<TLP_t*>& l)
+	void ClearQueue(std::deque<TLP_t*>& q)
 	{
-		for (typename std::list<TLP_t*>::iterator it = l.begin();
-			it != l.end();) {
-			TLP_t *t = (*it);
+		while (!q.empty()) {
+			TLP_t *t = q.front();
 
-			it = l.erase(it);
+			q.pop_front();
 
 			t->NotifyDone();
 		}
@@ -187,7 +236,7 @@ private:
 		while (true) {
 			wait(resetn.negedge_event());
 
-			ClearList(m_tlpList);
+			ClearQueue(m_tlpQueue);
 		}
 	}
 
@@ -205,7 +254,10 @@ private:
 	sc_out<bool >& txcrdrtn;
 
 	unsigned int m_credits;
-	std::list<TLP_t*> m_tlpList;
+	std::deque<TLP_t*> m_tlpQueue;
+
+	uint8_t m_flit[FLIT_BYTES];
+	sc_bv<FLIT_WIDTH> m_txdata;
 };
 
 }; // namespace CCIX
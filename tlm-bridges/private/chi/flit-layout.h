@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * Field layout of the CHI flits (section 12 [1]). The fields of each flit
+ * type are listed once, in flit order starting at bit 0, and the lists are
+ * used by both the CHI bridges (pkts.h) and the CHI checkers
+ * (flits-chi.h) for the flit width and for packing and unpacking.
+ *
+ * In a list F(Name) is a field of at most 64 bits and B(Name) a field that
+ * is moved as bytes (the data). The width of a field is taken from the
+ * Name_Width enum of the flit class the list is used with, a field of width
+ * 0 (e.g an unused RSVDC) takes no space.
+ *
+ * References:
+ *
+ * [1] AMBA 5 CHI Architecture Specification, ARM IHI 0050C, ID050218
+ *
+ */
+
+#ifndef TLM_BRIDGES_PRIV_CHI_FLIT_LAYOUT_H__
+#define TLM_BRIDGES_PRIV_CHI_FLIT_LAYOUT_H__
+
+#include "tlm-bridges/private/chi/flit-words.h"
+
+#define CHI_REQ_FLIT_LAYOUT(F, B)					\
+	F(QoS)								\
+	F(TgtID)							\
+	F(SrcID)							\
+	F(TxnID)							\
+	F(ReturnNID_StashNID)						\
+	F(StashNIDValid_Endian)						\
+	F(ReturnTxnID)							\
+	F(Opcode)							\
+	F(Size)								\
+	F(Addr)								\
+	F(NS)								\
+	F(LikelyShared)							\
+	F(AllowRetry)							\
+	F(Order)							\
+	F(PCrdType)							\
+	F(MemAttr)							\
+	F(SnpAttr)							\
+	F(LPID)								\
+	F(ExclSnoopMe)							\
+	F(ExpCompAck)							\
+	F(TraceTag)							\
+	F(RSVDC)
+
+#define CHI_RSP_FLIT_LAYOUT(F, B)					\
+	F(QoS)								\
+	F(TgtID)							\
+	F(SrcID)							\
+	F(TxnID)							\
+	F(Opcode)							\
+	F(RespErr)							\
+	F(Resp)								\
+	F(FwdState_DataPull)						\
+	F(DBID)								\
+	F(PCrdType)							\
+	F(TraceTag)
+
+#define CHI_SNP_FLIT_LAYOUT(F, B)					\
+	F(QoS)								\
+	F(SrcID)							\
+	F(TxnID)							\
+	F(FwdNID)							\
+	F(FwdTxnID)							\
+	F(Opcode)							\
+	F(Addr)								\
+	F(NS)								\
+	F(DoNotGoToSD)							\
+	F(RetToSrc)							\
+	F(TraceTag)
+
+#define CHI_DAT_FLIT_LAYOUT(F, B)					\
+	F(QoS)								\
+	F(TgtID)							\
+	F(SrcID)							\
+	F(TxnID)							\
+	F(HomeNID)							\
+	F(Opcode)							\
+	F(RespErr)							\
+	F(Resp)								\
+	F(FwdState_DataPull_DataSource)					\
+	F(DBID)								\
+	F(CCID)								\
+	F(DataID)							\
+	F(TraceTag)							\
+	F(RSVDC)							\
+	F(BE)								\
+	B(Data)								\
+	F(DataCheck)							\
+	F(Poison)
+
+//
+// Sum of the field widths of a layout, for the FLIT_WIDTH enums:
+//
+//   FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_REQ_FLIT_LAYOUT),
+//
+#define CHI_FLIT_WIDTH_ADD(name) name ## _Width +
+#define CHI_FLIT_WIDTH(LAYOUT) \
+	(LAYOUT(CHI_FLIT_WIDTH_ADD, CHI_FLIT_WIDTH_ADD) 0)
+
+#define CHI_FLIT_FIELD_DECL(name) uint64_t name;
+#define CHI_FLIT_BYTES_DECL(name) uint8_t *name;
+
+#define CHI_FLIT_FIELD_PUSH(name) w.Push(name, FLIT::name ## _Width);
+#define CHI_FLIT_BYTES_PUSH(name) w.PushBytes(name, FLIT::name ## _Width / 8);
+
+#define CHI_FLIT_FIELD_POP(name) name = w.Pop(FLIT::name ## _Width);
+#define CHI_FLIT_BYTES_POP(name) w.PopBytes(name, FLIT::name ## _Width / 8);
+
+//
+// Declares a struct template holding the fields of a layout with Pack /
+// Unpack to / from the flit words. FLIT is the flit class providing the
+// widths. Byte fields point to a buffer of Name_Width / 8 bytes.
+//
+#define CHI_FLIT_FIELDS(name, LAYOUT)					\
+template<typename FLIT>							\
+struct name								\
+{									\
+	LAYOUT(CHI_FLIT_FIELD_DECL, CHI_FLIT_BYTES_DECL)		\
+									\
+	void Pack(FlitWords<FLIT::FLIT_WIDTH>& w) const			\
+	{								\
+		LAYOUT(CHI_FLIT_FIELD_PUSH, CHI_FLIT_BYTES_PUSH)	\
+	}								\
+									\
+	void Unpack(FlitWords<FLIT::FLIT_WIDTH>& w)			\
+	{								\
+		LAYOUT(CHI_FLIT_FIELD_POP, CHI_FLIT_BYTES_POP)		\
+	}								\
+};
+
+namespace AMBA {
+namespace CHI {
+
+CHI_FLIT_FIELDS(ReqFlitFields, CHI_REQ_FLIT_LAYOUT)
+CHI_FLIT_FIELDS(RspFlitFields, CHI_RSP_FLIT_LAYOUT)
+CHI_FLIT_FIELDS(SnpFlitFields, CHI_SNP_FLIT_LAYOUT)
+CHI_FLIT_FIELDS(DatFlitFields, CHI_DAT_FLIT_LAYOUT)
+
+} /* namespace CHI */
+} /* namespace AMBA */
+
+#endif /* TLM_BRIDGES_PRIV_CHI_FLIT_LAYOUT_H__ */
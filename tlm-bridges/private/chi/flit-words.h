@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * Flits (section 12 [1]) held in native 64 bit words while being packed or
+ * unpacked. The fields of a flit are laid out back to back starting at bit
+ * 0, in the order they are pushed (popped), and are moved with shifts and
+ * masks on the words. The sc_bv of the flit signal is only touched when
+ * converting the complete flit (ToBV / FromBV), a word at the time.
+ *
+ * The CHI bridges (pkts.h) and the CHI checkers (flits-chi.h) both go
+ * through this class, with the field order described in flit-layout.h.
+ *
+ * References:
+ *
+ * [1] AMBA 5 CHI Architecture Specification, ARM IHI 0050C, ID050218
+ *
+ */
+
+#ifndef TLM_BRIDGES_PRIV_CHI_FLIT_WORDS_H__
+#define TLM_BRIDGES_PRIV_CHI_FLIT_WORDS_H__
+
+#include <string.h>
+#include <assert.h>
+
+#include "tlm.h"
+#include "utils/bitops.h"
+
+namespace AMBA {
+namespace CHI {
+
+template<int FLIT_WIDTH>
+class FlitWords
+{
+public:
+	enum {
+		NumWords = (FLIT_WIDTH + 63) / 64,
+
+		DigitBits = sizeof(sc_dt::sc_digit) * 8,
+		NumDigits = (FLIT_WIDTH + DigitBits - 1) / DigitBits,
+		DigitsPerWord = 64 / DigitBits,
+	};
+
+	FlitWords() :
+		m_pos(0)
+	{
+		memset(m_w, 0, sizeof(m_w));
+	}
+
+	FlitWords(const sc_bv<FLIT_WIDTH>& flit) :
+		m_pos(0)
+	{
+		FromBV(flit);
+	}
+
+	void FromBV(const sc_bv<FLIT_WIDTH>& flit)
+	{
+		unsigned int i;
+
+		memset(m_w, 0, sizeof(m_w));
+
+		for (i = 0; i < NumDigits; i++) {
+			uint64_t d = flit.get_word(i);
+
+			m_w[i / DigitsPerWord] |=
+				d << ((i % DigitsPerWord) * DigitBits);
+		}
+		m_pos = 0;
+	}
+
+	void ToBV(sc_bv<FLIT_WIDTH>& flit) const
+	{
+		unsigned int i;
+
+		for (i = 0; i < NumDigits; i++) {
+			uint64_t w = m_w[i / DigitsPerWord];
+
+			flit.set_word(i,
+				w >> ((i % DigitsPerWord) * DigitBits));
+		}
+		flit.clean_tail();
+	}
+
+	//
+	// Sequential access, fields are pushed (popped) starting at bit 0.
+	// A field is at most 64 bits wide.
+	//
+	void Push(uint64_t val, unsigned int width)
+	{
+		Put(m_pos, val, width);
+		m_pos += width;
+	}
+
+	uint64_t Pop(unsigned int width)
+	{
+		uint64_t val = Get(m_pos, width);
+
+		m_pos += width;
+		return val;
+	}
+
+	//
+	// Byte n of buf is placed in bits [8n+7:8n] of the field, 8 bytes
+	// at the time.
+	//
+	void PushBytes(const uint8_t *buf, unsigned int len)
+	{
+		unsigned int i;
+
+		for (i = 0; i < len; i += 8) {
+			unsigned int n = (len - i) < 8 ? (len - i) : 8;
+			uint64_t v = 0;
+
+			memcpy(&v, buf + i, n);
+			Push(v, n * 8);
+		}
+	}
+
+	void PopBytes(uint8_t *buf, unsigned int len)
+	{
+		unsigned int i;
+
+		for (i = 0; i < len; i += 8) {
+			unsigned int n = (len - i) < 8 ? (len - i) : 8;
+			uint64_t v = Pop(n * 8);
+
+			memcpy(buf + i, &v, n);
+		}
+	}
+
+	//
+	// Byte enables are carried as one bit per byte in the flit
+	// (at most 64), expand them into len TLM byte enables.
+	//
+	static void MaskToByteEnable(uint64_t mask, uint8_t *be,
+					unsigned int len)
+	{
+		unsigned int i;
+
+		for (i = 0; i < len; i += 8) {
+			unsigned int n = (len - i) < 8 ? (len - i) : 8;
+			uint64_t v = bitops_mask8_to_be8(mask >> i);
+
+			memcpy(be + i, &v, n);
+		}
+	}
+
+	void Skip(unsigned int width) { m_pos += width; }
+
+	unsigned int GetPos() { return m_pos; }
+
+	//
+	// Random access, fields of width 0 are allowed (and take no space)
+	//
+	uint64_t Get(unsigned int pos, unsigned int width) const
+	{
+		unsigned int w = pos / 64;
+		unsigned int off = pos % 64;
+		uint64_t val;
+
+		assert(width <= 64 && pos + width <= FLIT_WIDTH);
+
+		if (width == 0) {
+			return 0;
+		}
+
+		val = m_w[w] >> off;
+		if (off + width > 64) {
+			val |= m_w[w + 1] << (64 - off);
+		}
+
+		return val & Mask(width);
+	}
+
+	void Put(unsigned int pos, uint64_t val, unsigned int width)
+	{
+		unsigned int w = pos / 64;
+		unsigned int off = pos % 64;
+		uint64_t mask = Mask(width);
+
+		assert(width <= 64 && pos + width <= FLIT_WIDTH);
+
+		if (width == 0) {
+			return;
+		}
+
+		val &= mask;
+
+		m_w[w] = (m_w[w] & ~(mask << off)) | (val << off);
+		if (off + width > 64) {
+			unsigned int shift = 64 - off;
+
+			m_w[w + 1] = (m_w[w + 1] & ~(mask >> shift)) |
+					(val >> shift);
+		}
+	}
+
+private:
+	static uint64_t Mask(unsigned int width)
+	{
+		return width < 64 ? (UINT64_C(1) << width) - 1 : ~UINT64_C(0);
+	}
+
+	uint64_t m_w[NumWords];
+	unsigned int m_pos;
+};
+
+} /* namespace CHI */
+} /* namespace AMBA */
+
+#endif /* TLM_BRIDGES_PRIV_CHI_FLIT_WORDS_H__ */
@@ -30,6 +30,7 @@
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 #include "tlm-bridges/amba-chi.h"
+#include "tlm-bridges/private/chi/flit-layout.h"
 #include "tlm-extensions/chiattr.h"
 
 namespace AMBA {
@@ -76,40 +77,18 @@ public:
 		TraceTag_Width 	= Req::TraceTag_Width,
 		RSVDC_Width 	= RSVDC_WIDTH,
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			ReturnNID_StashNID_Width +
-			StashNIDValid_Endian_Width+
-			ReturnTxnID_Width +
-			Opcode_Width +
-			Size_Width +
-			Addr_Width +
-			NS_Width +
-			LikelyShared_Width +
-			AllowRetry_Width +
-			Order_Width +
-			PCrdType_Width +
-			MemAttr_Width +
-			SnpAttr_Width +
-			LPID_Width +
-			ExclSnoopMe_Width +
-			ExpCompAck_Width +
-			TraceTag_Width +
-			RSVDC_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_REQ_FLIT_LAYOUT),
 	};
 
 	ReqPkt(sc_bv<FLIT_WIDTH>& flit) :
 		m_gp(new tlm::tlm_generic_payload()),
 		m_chiattr(new chiattr_extension()),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(true)
 	{
-		ParseFlit(flit);
+		FlitWords<FLIT_WIDTH> words(flit);
+
+		ParseFlit(words);
 
 		m_gp->set_extension(m_chiattr);
 	}
@@ -118,7 +97,6 @@ public:
 		m_gp(gp),
 		m_chiattr(NULL),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(false)
 	{
 		assert(m_gp);
@@ -151,54 +129,48 @@ public:
 
 	void CreateFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
-		sc_bv<FLIT_WIDTH> tmp;
+		FlitWords<FLIT_WIDTH> tmp;
 
 		if (m_chiattr) {
-			assert(m_pos == 0);
-
-			Set(tmp, m_chiattr->GetQoS(), QoS_Width);
-			Set(tmp, m_chiattr->GetTgtID(), TgtID_Width);
-			Set(tmp, m_chiattr->GetSrcID(), SrcID_Width);
-			Set(tmp, m_chiattr->GetTxnID(), TxnID_Width);
+			ReqFlitFields<ReqPkt> f = ReqFlitFields<ReqPkt>();
 
-			Set(tmp, m_chiattr->GetReturnNID_StashNID(),
-					ReturnNID_StashNID_Width);
-
-			Set(tmp, m_chiattr->GetStashNIDValid_Endian(),
-					StashNIDValid_Endian_Width);
+			f.QoS = m_chiattr->GetQoS();
+			f.TgtID = m_chiattr->GetTgtID();
+			f.SrcID = m_chiattr->GetSrcID();
+			f.TxnID = m_chiattr->GetTxnID();
+			f.ReturnNID_StashNID = m_chiattr->GetReturnNID_StashNID();
+			f.StashNIDValid_Endian =
+				m_chiattr->GetStashNIDValid_Endian();
 
 			//
 			// For stash transactions ReturnTxnID contains
 			// { [7:6]: 0b00, StashLPIDValid[5], StashLPID[4:0] }
 			//
-			Set(tmp, m_chiattr->GetReturnTxnID(),
-					ReturnTxnID_Width);
-
-			Set(tmp, m_chiattr->GetOpcode(), Opcode_Width);
-			Set(tmp, GetSize(), Size_Width);
-			Set(tmp, m_gp->get_address(), Addr_Width);
-			Set(tmp, m_chiattr->GetNonSecure(), NS_Width);
-			Set(tmp, m_chiattr->GetLikelyShared(),
-					LikelyShared_Width);
-			Set(tmp, m_chiattr->GetAllowRetry(), AllowRetry_Width);
-			Set(tmp, m_chiattr->GetOrder(), Order_Width);
-			Set(tmp, m_chiattr->GetPCrdType(), PCrdType_Width);
-			Set(tmp, GetMemAttr(), MemAttr_Width);
-			Set(tmp, m_chiattr->GetSnpAttr(), SnpAttr_Width);
-			Set(tmp, m_chiattr->GetLPID(), LPID_Width);
-
-			Set(tmp, m_chiattr->GetExcl_SnoopMe(),
-					ExclSnoopMe_Width);
-
-			Set(tmp, m_chiattr->GetExpCompAck(), ExpCompAck_Width);
-			Set(tmp, m_chiattr->GetTraceTag(), TraceTag_Width);
+			f.ReturnTxnID = m_chiattr->GetReturnTxnID();
+
+			f.Opcode = m_chiattr->GetOpcode();
+			f.Size = GetSize();
+			f.Addr = m_gp->get_address();
+			f.NS = m_chiattr->GetNonSecure();
+			f.LikelyShared = m_chiattr->GetLikelyShared();
+			f.AllowRetry = m_chiattr->GetAllowRetry();
+			f.Order = m_chiattr->GetOrder();
+			f.PCrdType = m_chiattr->GetPCrdType();
+			f.MemAttr = GetMemAttr();
+			f.SnpAttr = m_chiattr->GetSnpAttr();
+			f.LPID = m_chiattr->GetLPID();
+			f.ExclSnoopMe = m_chiattr->GetExcl_SnoopMe();
+			f.ExpCompAck = m_chiattr->GetExpCompAck();
+			f.TraceTag = m_chiattr->GetTraceTag();
 
 			if (RSVDC_WIDTH) {
-				Set(tmp, m_chiattr->GetRSVDC(), RSVDC_WIDTH);
+				f.RSVDC = m_chiattr->GetRSVDC();
 			}
+
+			f.Pack(tmp);
 		}
 
-		flit = tmp;
+		tmp.ToBV(flit);
 	}
 
 	bool Done() { return m_flitDone; }
@@ -217,51 +189,15 @@ public:
 	sc_event& DoneEvent() { return m_done; }
 private:
 
-	template<typename T>
-	void Set(sc_bv<FLIT_WIDTH>& flit, T val, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		T mask = (static_cast<T>(1) << width) - 1;
-
-		flit.range(lastbit, firstbit) = val & mask;
-
-		m_pos += width;
-	}
-
-	void Set(sc_bv<FLIT_WIDTH>& flit, bool val, unsigned int width)
-	{
-		flit.bit(m_pos) = val;
-		m_pos += width;
-	}
-
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		unsigned int size;
+		ReqFlitFields<ReqPkt> f;
 
 		assert(m_gp);
 		assert(m_chiattr);
 
+		f.Unpack(flit);
+
 		m_gp->set_command(tlm::TLM_IGNORE_COMMAND);
 		m_gp->set_data_ptr(&m_dummy_data[0]);
 		m_gp->set_byte_enable_ptr(NULL);
@@ -269,51 +205,41 @@ private:
 		m_gp->set_dmi_allowed(false);
 		m_gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-		m_chiattr->SetQoS(Extract<uint8_t>(flit, QoS_Width));
-		m_chiattr->SetTgtID(Extract<uint16_t>(flit, TgtID_Width));
-		m_chiattr->SetSrcID(Extract<uint16_t>(flit, SrcID_Width));
-		m_chiattr->SetTxnID(Extract<uint8_t>(flit, TxnID_Width));
-
-		m_chiattr->SetReturnNID_StashNID(
-			Extract<uint16_t>(flit, ReturnNID_StashNID_Width));
-
-		m_chiattr->SetStashNIDValid_Endian(ExtractBool(flit));
+		m_chiattr->SetQoS(f.QoS);
+		m_chiattr->SetTgtID(f.TgtID);
+		m_chiattr->SetSrcID(f.SrcID);
+		m_chiattr->SetTxnID(f.TxnID);
+		m_chiattr->SetReturnNID_StashNID(f.ReturnNID_StashNID);
+		m_chiattr->SetStashNIDValid_Endian(f.StashNIDValid_Endian);
 
 		//
 		// For stash transactions ReturnTxnID contains
 		// { [7:6]: 0b00, StashLPIDValid[5], StashLPID[4:0] }
 		//
-		m_chiattr->SetReturnTxnID(
-			Extract<uint8_t>(flit, ReturnTxnID_Width));
-
-		m_chiattr->SetOpcode(Extract<uint8_t>(flit, Opcode_Width));
+		m_chiattr->SetReturnTxnID(f.ReturnTxnID);
 
-		size = Extract<uint8_t>(flit, Size_Width);
+		m_chiattr->SetOpcode(f.Opcode);
 
-		m_gp->set_data_length(1 << size);
-		m_gp->set_streaming_width(1 << size);
-		m_gp->set_address(Extract<uint64_t>(flit, Addr_Width));
+		m_gp->set_data_length(1 << f.Size);
+		m_gp->set_streaming_width(1 << f.Size);
+		m_gp->set_address(f.Addr);
 
-		m_chiattr->SetNonSecure(ExtractBool(flit));
-		m_chiattr->SetLikelyShared(ExtractBool(flit));
-		m_chiattr->SetAllowRetry(ExtractBool(flit));
-		m_chiattr->SetOrder(Extract<uint8_t>(flit, Order_Width));
-		m_chiattr->SetPCrdType(Extract<uint8_t>(flit, PCrdType_Width));
+		m_chiattr->SetNonSecure(f.NS);
+		m_chiattr->SetLikelyShared(f.LikelyShared);
+		m_chiattr->SetAllowRetry(f.AllowRetry);
+		m_chiattr->SetOrder(f.Order);
+		m_chiattr->SetPCrdType(f.PCrdType);
 
-		ExtractMemAttr(Extract<uint8_t>(flit, MemAttr_Width));
+		ExtractMemAttr(f.MemAttr);
 
-		m_chiattr->SetSnpAttr(ExtractBool(flit));
-
-		m_chiattr->SetLPID(Extract<uint16_t>(flit, LPID_Width));
-
-		m_chiattr->SetExcl_SnoopMe(ExtractBool(flit));
-
-		m_chiattr->SetExpCompAck(ExtractBool(flit));
-		m_chiattr->SetTraceTag(ExtractBool(flit));
+		m_chiattr->SetSnpAttr(f.SnpAttr);
+		m_chiattr->SetLPID(f.LPID);
+		m_chiattr->SetExcl_SnoopMe(f.ExclSnoopMe);
+		m_chiattr->SetExpCompAck(f.ExpCompAck);
+		m_chiattr->SetTraceTag(f.TraceTag);
 
 		if (RSVDC_WIDTH) {
-			m_chiattr->SetRSVDC(
-				Extract<uint32_t>(flit, RSVDC_WIDTH));
+			m_chiattr->SetRSVDC(f.RSVDC);
 		}
 	}
 
@@ -392,7 +318,6 @@ private:
 	chiattr_extension *m_chiattr;
 	bool m_flitDone;
 	sc_event m_done;
-	unsigned int m_pos;
 	bool m_delete;
 	uint8_t m_dummy_data[MAX_DATA_SZ];
 };
@@ -419,29 +344,18 @@ public:
 		PCrdType_Width 	= Rsp::PCrdType_Width,
 		TraceTag_Width 	= Rsp::TraceTag_Width,
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			Opcode_Width +
-			RespErr_Width +
-			Resp_Width +
-			FwdState_DataPull_Width +
-			DBID_Width +
-			PCrdType_Width +
-			TraceTag_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_RSP_FLIT_LAYOUT),
 	};
 
 	RspPkt(sc_bv<FLIT_WIDTH>& flit) :
 		m_gp(new tlm::tlm_generic_payload()),
 		m_chiattr(new chiattr_extension()),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(true)
 	{
-		ParseFlit(flit);
+		FlitWords<FLIT_WIDTH> words(flit);
+
+		ParseFlit(words);
 
 		m_gp->set_extension(m_chiattr);
 	}
@@ -450,7 +364,6 @@ public:
 		m_gp(gp),
 		m_chiattr(NULL),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(false)
 	{
 		m_gp->get_extension(m_chiattr);
@@ -481,28 +394,27 @@ public:
 
 	void CreateFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
-		sc_bv<FLIT_WIDTH> tmp;
+		FlitWords<FLIT_WIDTH> tmp;
 
 		if (m_chiattr) {
-			assert(m_pos == 0);
-
-			Set(tmp, m_chiattr->GetQoS(), QoS_Width);
-			Set(tmp, m_chiattr->GetTgtID(), TgtID_Width);
-			Set(tmp, m_chiattr->GetSrcID(), SrcID_Width);
-			Set(tmp, m_chiattr->GetTxnID(), TxnID_Width);
-			Set(tmp, m_chiattr->GetOpcode(), Opcode_Width);
-			Set(tmp, m_chiattr->GetRespErr(), RespErr_Width);
-			Set(tmp, m_chiattr->GetResp(), Resp_Width);
-
-			Set(tmp, m_chiattr->GetFwdState_DataPull(),
-					FwdState_DataPull_Width);
-
-			Set(tmp, m_chiattr->GetDBID(), DBID_Width);
-			Set(tmp, m_chiattr->GetPCrdType(), PCrdType_Width);
-			Set(tmp, m_chiattr->GetTraceTag(), TraceTag_Width);
+			RspFlitFields<RspPkt> f = RspFlitFields<RspPkt>();
+
+			f.QoS = m_chiattr->GetQoS();
+			f.TgtID = m_chiattr->GetTgtID();
+			f.SrcID = m_chiattr->GetSrcID();
+			f.TxnID = m_chiattr->GetTxnID();
+			f.Opcode = m_chiattr->GetOpcode();
+			f.RespErr = m_chiattr->GetRespErr();
+			f.Resp = m_chiattr->GetResp();
+			f.FwdState_DataPull = m_chiattr->GetFwdState_DataPull();
+			f.DBID = m_chiattr->GetDBID();
+			f.PCrdType = m_chiattr->GetPCrdType();
+			f.TraceTag = m_chiattr->GetTraceTag();
+
+			f.Pack(tmp);
 		}
 
-		flit = tmp;
+		tmp.ToBV(flit);
 	}
 
 	bool Done() { return m_flitDone; }
@@ -521,49 +433,15 @@ public:
 	sc_event& DoneEvent() { return m_done; }
 private:
 
-	template<typename T>
-	void Set(sc_bv<FLIT_WIDTH>& flit, T val, unsigned int width)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		T mask = (static_cast<T>(1) << width) - 1;
-
-		flit.range(lastbit, firstbit) = val & mask;
-
-		m_pos += width;
-	}
+		RspFlitFields<RspPkt> f;
 
-	void Set(sc_bv<FLIT_WIDTH>& flit, bool val, unsigned int width)
-	{
-		flit.bit(m_pos) = val;
-		m_pos += width;
-	}
-
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
 		assert(m_gp);
 		assert(m_chiattr);
 
+		f.Unpack(flit);
+
 		m_gp->set_command(tlm::TLM_IGNORE_COMMAND);
 		m_gp->set_data_ptr(&m_dummy_data[0]);
 		m_gp->set_data_length(MAX_DATA_SZ);
@@ -572,21 +450,17 @@ private:
 		m_gp->set_dmi_allowed(false);
 		m_gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-		m_chiattr->SetQoS(Extract<uint8_t>(flit, QoS_Width));
-		m_chiattr->SetTgtID(Extract<uint16_t>(flit, TgtID_Width));
-		m_chiattr->SetSrcID(Extract<uint16_t>(flit, SrcID_Width));
-		m_chiattr->SetTxnID(Extract<uint8_t>(flit, TxnID_Width));
-		m_chiattr->SetOpcode(Extract<uint8_t>(flit, Opcode_Width));
-
-		m_chiattr->SetRespErr(Extract<uint8_t>(flit, RespErr_Width));
-		m_chiattr->SetResp(Extract<uint8_t>(flit, Resp_Width));
-
-		m_chiattr->SetFwdState_DataPull(
-			Extract<uint8_t>(flit, FwdState_DataPull_Width));
-
-		m_chiattr->SetDBID(Extract<uint8_t>(flit, DBID_Width));
-		m_chiattr->SetPCrdType(Extract<uint8_t>(flit,  PCrdType_Width));
-		m_chiattr->SetTraceTag(ExtractBool(flit));
+		m_chiattr->SetQoS(f.QoS);
+		m_chiattr->SetTgtID(f.TgtID);
+		m_chiattr->SetSrcID(f.SrcID);
+		m_chiattr->SetTxnID(f.TxnID);
+		m_chiattr->SetOpcode(f.Opcode);
+		m_chiattr->SetRespErr(f.RespErr);
+		m_chiattr->SetResp(f.Resp);
+		m_chiattr->SetFwdState_DataPull(f.FwdState_DataPull);
+		m_chiattr->SetDBID(f.DBID);
+		m_chiattr->SetPCrdType(f.PCrdType);
+		m_chiattr->SetTraceTag(f.TraceTag);
 	}
 
 	void SetTLMOKResp()
@@ -606,7 +480,6 @@ private:
 	chiattr_extension *m_chiattr;
 	bool m_flitDone;
 	sc_event m_done;
-	unsigned int m_pos;
 	bool m_delete;
 	uint8_t m_dummy_data[MAX_DATA_SZ];
 };
@@ -635,19 +508,7 @@ public:
 		RetToSrc_Width 	= Snp::RetToSrc_Width,
 		TraceTag_Width 	= Snp::TraceTag_Width,
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			SrcID_Width +
-			TxnID_Width +
-			FwdNID_Width +
-			FwdTxnID_Width +
-			Opcode_Width +
-			Addr_Width +
-			NS_Width +
-			DoNotGoToSD_Width +
-			RetToSrc_Width +
-			TraceTag_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_SNP_FLIT_LAYOUT),
 
 	};
 
@@ -655,10 +516,11 @@ public:
 		m_gp(new tlm::tlm_generic_payload()),
 		m_chiattr(new chiattr_extension()),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(true)
 	{
-		ParseFlit(flit);
+		FlitWords<FLIT_WIDTH> words(flit);
+
+		ParseFlit(words);
 
 		m_gp->set_extension(m_chiattr);
 	}
@@ -667,7 +529,6 @@ public:
 		m_gp(gp),
 		m_chiattr(NULL),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(false)
 	{
 		m_gp->get_extension(m_chiattr);
@@ -698,28 +559,30 @@ public:
 
 	void CreateFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
-		sc_bv<FLIT_WIDTH> tmp;
+		FlitWords<FLIT_WIDTH> tmp;
 
 		if (m_chiattr) {
-			assert(m_pos == 0);
+			SnpFlitFields<SnpPkt> f = SnpFlitFields<SnpPkt>();
 
-			Set(tmp, m_chiattr->GetQoS(), QoS_Width);
-			Set(tmp, m_chiattr->GetSrcID(), SrcID_Width);
-			Set(tmp, m_chiattr->GetTxnID(), TxnID_Width);
-			Set(tmp, m_chiattr->GetFwdNID(), FwdNID_Width);
-			Set(tmp, m_chiattr->GetFwdTxnID(), FwdTxnID_Width);
-			Set(tmp, m_chiattr->GetOpcode(), Opcode_Width);
-			Set(tmp, m_gp->get_address() >> 3, Addr_Width);
-			Set(tmp, m_chiattr->GetNonSecure(), NS_Width);
+			f.QoS = m_chiattr->GetQoS();
+			f.SrcID = m_chiattr->GetSrcID();
+			f.TxnID = m_chiattr->GetTxnID();
+			f.FwdNID = m_chiattr->GetFwdNID();
+			f.FwdTxnID = m_chiattr->GetFwdTxnID();
+			f.Opcode = m_chiattr->GetOpcode();
+			f.Addr = m_gp->get_address() >> 3;
+			f.NS = m_chiattr->GetNonSecure();
 
 			// Bit is also DoNotDataPull
-			Set(tmp, m_chiattr->GetDoNotGoToSD(), DoNotGoToSD_Width);
+			f.DoNotGoToSD = m_chiattr->GetDoNotGoToSD();
 
-			Set(tmp, m_chiattr->GetRetToSrc(), RetToSrc_Width);
-			Set(tmp, m_chiattr->GetTraceTag(), TraceTag_Width);
+			f.RetToSrc = m_chiattr->GetRetToSrc();
+			f.TraceTag = m_chiattr->GetTraceTag();
+
+			f.Pack(tmp);
 		}
 
-		flit = tmp;
+		tmp.ToBV(flit);
 	}
 
 	bool Done() { return m_flitDone; }
@@ -738,49 +601,15 @@ public:
 	sc_event& DoneEvent() { return m_done; }
 private:
 
-	template<typename T>
-	void Set(sc_bv<FLIT_WIDTH>& flit, T val, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		T mask = (static_cast<T>(1) << width) - 1;
-
-		flit.range(lastbit, firstbit) = val & mask;
-
-		m_pos += width;
-	}
-
-	void Set(sc_bv<FLIT_WIDTH>& flit, bool val, unsigned int width)
-	{
-		flit.bit(m_pos) = val;
-		m_pos += width;
-	}
-
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (static_cast<T>(1) << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
-		return flit.bit(m_pos++) == 1;
-	}
+		SnpFlitFields<SnpPkt> f;
 
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
 		assert(m_gp);
 		assert(m_chiattr);
 
+		f.Unpack(flit);
+
 		m_gp->set_command(tlm::TLM_IGNORE_COMMAND);
 		m_gp->set_data_ptr(&m_dummy_data[0]);
 		m_gp->set_data_length(MAX_DATA_SZ);
@@ -789,20 +618,20 @@ private:
 		m_gp->set_dmi_allowed(false);
 		m_gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-		m_chiattr->SetQoS(Extract<uint8_t>(flit, QoS_Width));
-		m_chiattr->SetSrcID(Extract<uint16_t>(flit, SrcID_Width));
-		m_chiattr->SetTxnID(Extract<uint8_t>(flit, TxnID_Width));
-		m_chiattr->SetFwdNID(Extract<uint16_t>(flit, FwdNID_Width));
-		m_chiattr->SetFwdTxnID(Extract<uint16_t>(flit, FwdTxnID_Width));
-		m_chiattr->SetOpcode(Extract<uint8_t>(flit, Opcode_Width));
-		m_gp->set_address(Extract<uint64_t>(flit, Addr_Width) << 3);
-		m_chiattr->SetNonSecure(ExtractBool(flit));
+		m_chiattr->SetQoS(f.QoS);
+		m_chiattr->SetSrcID(f.SrcID);
+		m_chiattr->SetTxnID(f.TxnID);
+		m_chiattr->SetFwdNID(f.FwdNID);
+		m_chiattr->SetFwdTxnID(f.FwdTxnID);
+		m_chiattr->SetOpcode(f.Opcode);
+		m_gp->set_address(f.Addr << 3);
+		m_chiattr->SetNonSecure(f.NS);
 
 		// Bit is also DoNotDataPull
-		m_chiattr->SetDoNotGoToSD(ExtractBool(flit));
+		m_chiattr->SetDoNotGoToSD(f.DoNotGoToSD);
 
-		m_chiattr->SetRetToSrc(ExtractBool(flit));
-		m_chiattr->SetTraceTag(ExtractBool(flit));
+		m_chiattr->SetRetToSrc(f.RetToSrc);
+		m_chiattr->SetTraceTag(f.TraceTag);
 	}
 
 	void SetTLMOKResp()
@@ -822,7 +651,6 @@ private:
 	chiattr_extension *m_chiattr;
 	bool m_flitDone;
 	sc_event m_done;
-	unsigned int m_pos;
 	bool m_delete;
 	uint8_t m_dummy_data[MAX_DATA_SZ];
 };
@@ -860,26 +688,7 @@ public:
 		DataCheck_Width = DATACHECK_WIDTH,
 		Poison_Width 	= POISON_WIDTH,
 
-		// Sum of above
-		FLIT_WIDTH =
-			QoS_Width +
-			TgtID_Width +
-			SrcID_Width +
-			TxnID_Width +
-			HomeNID_Width +
-			Opcode_Width +
-			RespErr_Width +
-			Resp_Width +
-			FwdState_DataPull_DataSource_Width +
-			DBID_Width +
-			CCID_Width +
-			DataID_Width +
-			TraceTag_Width +
-			RSVDC_Width +
-			BE_Width +
-			Data_Width +
-			DataCheck_Width +
-			Poison_Width,
+		FLIT_WIDTH = CHI_FLIT_WIDTH(CHI_DAT_FLIT_LAYOUT),
 	};
 
 	DatPkt(sc_bv<FLIT_WIDTH>& flit) :
@@ -887,10 +696,11 @@ public:
 		m_gp(new tlm::tlm_generic_payload()),
 		m_chiattr(new chiattr_extension()),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(true)
 	{
-		ParseFlit(flit);
+		FlitWords<FLIT_WIDTH> words(flit);
+
+		ParseFlit(words);
 
 		m_gp->set_extension(m_chiattr);
 	}
@@ -900,7 +710,6 @@ public:
 		m_gp(gp),
 		m_chiattr(NULL),
 		m_flitDone(false),
-		m_pos(0),
 		m_delete(false)
 	{
 		m_gp->get_extension(m_chiattr);
@@ -944,47 +753,48 @@ public:
 
 	void CreateFlit(sc_bv<FLIT_WIDTH>& flit)
 	{
-		sc_bv<FLIT_WIDTH> tmp;
+		FlitWords<FLIT_WIDTH> tmp;
 
 		if (m_chiattr) {
-			uint8_t dataID = m_sent / (Data_Width/8);
-
-			assert(m_pos == 0);
-
-			Set(tmp, m_chiattr->GetQoS(), QoS_Width);
-			Set(tmp, m_chiattr->GetTgtID(), TgtID_Width);
-			Set(tmp, m_chiattr->GetSrcID(), SrcID_Width);
-			Set(tmp, m_chiattr->GetTxnID(), TxnID_Width);
-			Set(tmp, m_chiattr->GetHomeNID(), HomeNID_Width);
-			Set(tmp, m_chiattr->GetOpcode(), Opcode_Width);
-			Set(tmp, m_chiattr->GetRespErr(), RespErr_Width);
-			Set(tmp, m_chiattr->GetResp(), Resp_Width);
-
-			Set(tmp, m_chiattr->GetFwdState_DataPull_DataSource(),
-					FwdState_DataPull_DataSource_Width);
-
-			Set(tmp, m_chiattr->GetDBID(), DBID_Width);
-			Set(tmp, m_chiattr->GetCCID(), CCID_Width);
-			Set(tmp, dataID, DataID_Width);
-			Set(tmp, m_chiattr->GetTraceTag(), TraceTag_Width);
+			DatFlitFields<DatPkt> f = DatFlitFields<DatPkt>();
+			uint8_t data[Data_Width / 8];
+
+			f.QoS = m_chiattr->GetQoS();
+			f.TgtID = m_chiattr->GetTgtID();
+			f.SrcID = m_chiattr->GetSrcID();
+			f.TxnID = m_chiattr->GetTxnID();
+			f.HomeNID = m_chiattr->GetHomeNID();
+			f.Opcode = m_chiattr->GetOpcode();
+			f.RespErr = m_chiattr->GetRespErr();
+			f.Resp = m_chiattr->GetResp();
+			f.FwdState_DataPull_DataSource =
+				m_chiattr->GetFwdState_DataPull_DataSource();
+			f.DBID = m_chiattr->GetDBID();
+			f.CCID = m_chiattr->GetCCID();
+			f.DataID = m_sent / (Data_Width/8);
+			f.TraceTag = m_chiattr->GetTraceTag();
 
 			if (RSVDC_WIDTH) {
-				Set(tmp, m_chiattr->GetRSVDC(), RSVDC_Width);
+				f.RSVDC = m_chiattr->GetRSVDC();
 			}
 
-			SetByteEnable(tmp);
-			SetData(tmp);
+			f.BE = GetByteEnable();
+
+			GetData(data);
+			f.Data = data;
 
 			if (DATACHECK_WIDTH) {
-				Set(tmp, m_chiattr->GetDataCheck(), DataCheck_Width);
+				f.DataCheck = m_chiattr->GetDataCheck();
 			}
 
 			if (POISON_WIDTH) {
-				Set(tmp, m_chiattr->GetPoison(), Poison_Width);
+				f.Poison = m_chiattr->GetPoison();
 			}
+
+			f.Pack(tmp);
 		}
 
-		flit = tmp;
+		tmp.ToBV(flit);
 	}
 
 	bool Done()
@@ -1006,175 +816,112 @@ public:
 	sc_event& DoneEvent() { return m_done; }
 private:
 
-	template<typename T>
-	void Set(sc_bv<FLIT_WIDTH>& flit, T val, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		T mask = (static_cast<T>(1) << width) - 1;
-
-		flit.range(lastbit, firstbit) = val & mask;
-
-		m_pos += width;
-	}
-
-	void Set(sc_bv<FLIT_WIDTH>& flit, bool val, unsigned int width)
-	{
-		flit.bit(m_pos) = val;
-		m_pos += width;
-	}
-
-	void SetByteEnable(sc_bv<FLIT_WIDTH>& flit)
+	uint64_t GetByteEnable()
 	{
 		unsigned char *be = m_gp->get_byte_enable_ptr();
-		int be_len = m_gp->get_byte_enable_length();
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + BE_Width - 1;
+		unsigned int be_len = m_gp->get_byte_enable_length();
+		uint64_t mask = 0;
 		unsigned int i;
-		unsigned int offset = m_sent;
-		unsigned int bepos = 0;
 
 		if (be && be_len) {
-			for (i = firstbit; i <= lastbit; i++, bepos++) {
-				uint8_t b = be[(bepos + offset) % be_len];
+			for (i = 0; i < BE_Width; i++) {
+				uint8_t b = be[(i + m_sent) % be_len];
+
 				if (b == TLM_BYTE_ENABLED) {
-					flit[i] = true;
+					mask |= UINT64_C(1) << i;
 				}
 			}
 		} else {
 			unsigned int len = m_gp->get_data_length();
 
 			/* All lanes active up to datalength.  */
-			for (i = firstbit; i <= lastbit; i++) {
-				if (len > 0) {
-					flit[i] = true;
-					len--;
-				} else {
-					flit[i] = false;
-				}
+			if (len > BE_Width) {
+				len = BE_Width;
+			}
+			if (len) {
+				mask = ~UINT64_C(0) >> (64 - len);
 			}
 		}
 
-		m_pos += BE_Width;
+		return mask;
 	}
 
-	void SetData(sc_bv<FLIT_WIDTH>& flit)
+	//
+	// The data of the flit, the lanes after the end of the transaction
+	// are zero.
+	//
+	void GetData(uint8_t *buf)
 	{
 		unsigned char *data = m_gp->get_data_ptr();
 		unsigned int len = m_gp->get_data_length();
-		unsigned int firstbit = m_pos;
 		unsigned int bus_width_bytes = DATA_WIDTH/8;
-		unsigned int i;
+
+		if (m_sent < len) {
+			data += m_sent;
+			len -= m_sent;
+		} else {
+			len = 0;
+		}
 
 		// Only write up to DATA_WIDTH size
 		if (len > bus_width_bytes) {
 			len = bus_width_bytes;
 		}
 
-		for (i = 0; i <= len; i++, firstbit += 8) {
-			unsigned int lastbit = firstbit + 8 - 1;
-
-			flit.range(lastbit, firstbit) = data[i];
-		}
-
-		m_pos += DATA_WIDTH;
+		memcpy(buf, data, len);
+		memset(buf + len, 0, bus_width_bytes - len);
 	}
 
-	template<typename T>
-	T Extract(sc_bv<FLIT_WIDTH>& flit, unsigned int width)
-	{
-		unsigned int firstbit = m_pos;
-		unsigned int lastbit = firstbit + width - 1;
-		uint64_t mask = (1 << width) - 1;
-		uint64_t val;
-
-		val = flit.range(lastbit, firstbit).to_uint64();
-
-		m_pos += width;
-
-		return (T)(val & mask);
-	}
-
-	bool ExtractBool(sc_bv<FLIT_WIDTH>& flit)
-	{
-		return flit.bit(m_pos++) == 1;
-	}
-
-	void ExtractByteEnable(sc_bv<FLIT_WIDTH>& flit)
-	{
-		unsigned int be_len = BE_Width;
-		uint8_t *be = new uint8_t[be_len];
-		unsigned int i;
-
-		m_gp->set_byte_enable_ptr(be);
-		m_gp->set_byte_enable_length(be_len);
-
-		for (i = 0; i < be_len; i++) {
-			if (ExtractBool(flit)) {
-				be[i] = TLM_BYTE_ENABLED;
-			} else {
-				be[i] = TLM_BYTE_DISABLED;
-			}
-		}
-	}
-
-	void ExtractData(sc_bv<FLIT_WIDTH>& flit)
+	void ParseFlit(FlitWords<FLIT_WIDTH>& flit)
 	{
+		DatFlitFields<DatPkt> f;
 		unsigned int dataLen = Data_Width / 8;
 		uint8_t *data = new uint8_t[dataLen];
-		unsigned int i;
+		uint8_t *be = new uint8_t[BE_Width];
 
-		m_gp->set_data_ptr(data);
-		m_gp->set_data_length(dataLen);
-		m_gp->set_streaming_width(dataLen);
-
-		for (i = 0; i < dataLen; i++) {
-			data[i] = Extract<uint8_t>(flit, 8);
-		}
-	}
-
-	void ParseFlit(sc_bv<FLIT_WIDTH>& flit)
-	{
 		assert(m_gp);
 		assert(m_chiattr);
 
+		f.Data = data;
+		f.Unpack(flit);
+
 		m_gp->set_command(tlm::TLM_WRITE_COMMAND);
 		m_gp->set_dmi_allowed(false);
 		m_gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-		m_chiattr->SetQoS(Extract<uint8_t>(flit, QoS_Width));
-		m_chiattr->SetTgtID(Extract<uint16_t>(flit, TgtID_Width));
-		m_chiattr->SetSrcID(Extract<uint16_t>(flit, SrcID_Width));
-		m_chiattr->SetTxnID(Extract<uint8_t>(flit, TxnID_Width));
-		m_chiattr->SetHomeNID(Extract<uint16_t>(flit, HomeNID_Width));
-		m_chiattr->SetOpcode(Extract<uint8_t>(flit, Opcode_Width));
-		m_chiattr->SetRespErr(Extract<uint8_t>(flit, RespErr_Width));
-		m_chiattr->SetResp(Extract<uint8_t>(flit, Resp_Width));
-
+		m_chiattr->SetQoS(f.QoS);
+		m_chiattr->SetTgtID(f.TgtID);
+		m_chiattr->SetSrcID(f.SrcID);
+		m_chiattr->SetTxnID(f.TxnID);
+		m_chiattr->SetHomeNID(f.HomeNID);
+		m_chiattr->SetOpcode(f.Opcode);
+		m_chiattr->SetRespErr(f.RespErr);
+		m_chiattr->SetResp(f.Resp);
 		m_chiattr->SetFwdState_DataPull_DataSource(
-			Extract<uint8_t>(flit,
-					 FwdState_DataPull_DataSource_Width));
-
-		m_chiattr->SetDBID(Extract<uint8_t>(flit, DBID_Width));
-		m_chiattr->SetCCID(Extract<uint8_t>(flit, CCID_Width));
-		m_chiattr->SetDataID(Extract<uint8_t>(flit, DataID_Width));
-		m_chiattr->SetTraceTag(ExtractBool(flit));
+				f.FwdState_DataPull_DataSource);
+		m_chiattr->SetDBID(f.DBID);
+		m_chiattr->SetCCID(f.CCID);
+		m_chiattr->SetDataID(f.DataID);
+		m_chiattr->SetTraceTag(f.TraceTag);
 
 		if (RSVDC_WIDTH) {
-			m_chiattr->SetRSVDC(Extract<uint8_t>(flit, RSVDC_Width));
+			m_chiattr->SetRSVDC(f.RSVDC);
 		}
 
-		ExtractByteEnable(flit);
-		ExtractData(flit);
+		FlitWords<FLIT_WIDTH>::MaskToByteEnable(f.BE, be, BE_Width);
+		m_gp->set_byte_enable_ptr(be);
+		m_gp->set_byte_enable_length(BE_Width);
+
+		m_gp->set_data_ptr(data);
+		m_gp->set_data_length(dataLen);
+		m_gp->set_streaming_width(dataLen);
 
 		if (DATACHECK_WIDTH) {
-			m_chiattr->SetDataCheck(
-				Extract<uint64_t>(flit, DataCheck_Width));
+			m_chiattr->SetDataCheck(f.DataCheck);
 		}
 
 		if (POISON_WIDTH) {
-			m_chiattr->SetPoison(
-				Extract<uint8_t>(flit, Poison_Width));
+			m_chiattr->SetPoison(f.Poison);
 		}
 	}
 
@@ -1194,7 +941,6 @@ private:
 	chiattr_extension *m_chiattr;
 	bool m_flitDone;
 	sc_event m_done;
-	unsigned int m_pos;
 	bool m_delete;
 };
 
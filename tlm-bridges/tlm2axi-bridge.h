@@ -30,13 +30,17 @@
 
 #include <vector>
 #include <list>
+#include <deque>
 #include <sstream>
 
+#include "tlm_utils/peq_with_cb_and_phase.h"
+
 #include "tlm-bridges/amba.h"
 #include "tlm-bridges/amba-ace.h"
 #include "tlm-modules/tlm-aligner.h"
 #include "tlm-extensions/genattr.h"
 #include "tlm-bridges/private/ace/snoop-channels.h"
+#include "utils/bytecopy.h"
 
 #define TLM2AXI_BRIDGE_MSG "tlm2axi-bridge"
 
@@ -149,6 +153,13 @@ public:
 		aligner(NULL),
 		proxy_init_socket(NULL),
 		proxy_target_socket(NULL),
+		m_nbPeq(this, &tlm2axi_bridge::nb_peq_cb),
+		m_nbMaxReads(16),
+		m_nbMaxWrites(16),
+		m_nbNumReads(0),
+		m_nbNumWrites(0),
+		m_nbReq(NULL),
+		m_nbResp(NULL),
 		dummy("axi_dummy")
 	{
 		if (ACE_MODE == ACE_MODE_ACE) {
@@ -179,6 +190,8 @@ public:
 			tgt_socket.register_b_transport(this, &tlm2axi_bridge::b_transport);
 		}
 
+		tgt_socket.register_nb_transport_fw(this, &tlm2axi_bridge::nb_transport_fw);
+
 		SC_THREAD(read_address_phase);
 		SC_THREAD(write_address_phase);
 		SC_THREAD(read_resp_phase);
@@ -186,9 +199,17 @@ public:
 		SC_THREAD(write_resp_phase);
 
 		SC_THREAD(reset);
+
+		SC_METHOD(nb_accept_req);
+		sensitive << rdTransFifo.data_read_event();
+		sensitive << wrTransFifo.data_read_event();
+		dont_initialize();
 	}
 
 	~tlm2axi_bridge() {
+		for (unsigned int i = 0; i < m_nbSlots.size(); i++) {
+			delete m_nbSlots[i];
+		}
 		delete proxy_init_socket;
 		delete proxy_target_socket;
 		delete aligner;
@@ -270,20 +291,46 @@ public:
 
 	ACESnoopChannels_M__& GetACESnoopChannels() { return *m_snp_chnls; };
 
+	//
+	// Max number of outstanding read and write transactions issued
+	// through nb_transport_fw. Set these before the end of elaboration,
+	// they also size the pool of aligner workers.
+	//
+	void SetMaxOutstandingReads(unsigned int n) { m_nbMaxReads = n; }
+	void SetMaxOutstandingWrites(unsigned int n) { m_nbMaxWrites = n; }
+
 private:
 	class Transaction :
 		public ace_tx_helpers
 	{
 	public:
-		Transaction(tlm::tlm_generic_payload& gp) :
-			m_gp(gp),
+		Transaction(tlm::tlm_generic_payload& gp)
+		{
+			Init(gp);
+		}
+
+		//
+		// Transactions issued through nb_transport are reused and
+		// initialized for each generic payload.
+		//
+		Transaction() :
+			m_gp(NULL),
 			m_burstType(AXI_BURST_INCR),
 			m_beat(1),
 			m_numBeats(0)
+		{}
+
+		void Init(tlm::tlm_generic_payload& gp)
 		{
 			genattr_extension *genattr;
 
-			m_gp.get_extension(genattr);
+			m_gp = &gp;
+			m_genattr = genattr_extension();
+			m_burstType = AXI_BURST_INCR;
+			m_beat = 1;
+			m_numBeats = 0;
+
+			m_gp->get_extension(genattr);
 			if (genattr) {
 				m_genattr.copy_from(*genattr);
 			}
@@ -292,14 +339,14 @@ private:
 			SetupNumBeats();
 
 			if (ACE_MODE) {
-				setup_ace_helpers(&m_gp);
+				setup_ace_helpers(m_gp);
 			}
 		}
 
 		void SetupBurstType()
 		{
-			unsigned int streaming_width = m_gp.get_streaming_width();
-			unsigned int datalen = m_gp.get_data_length();
+			unsigned int streaming_width = m_gp->get_streaming_width();
+			unsigned int datalen = m_gp->get_data_length();
 
 			if (streaming_width == datalen &&
 				m_genattr.get_wrap()) {
@@ -331,8 +378,8 @@ private:
 
 		void SetupNumBeats()
 		{
-			uint64_t address = m_gp.get_address();
-			unsigned int dataLen = m_gp.get_data_length();
+			uint64_t address = m_gp->get_address();
+			unsigned int dataLen = m_gp->get_data_length();
 			uint32_t burst_width = GetBurstWidth();
 			uint64_t alignedAddress;
 			unsigned int alignment;
@@ -364,11 +411,11 @@ private:
 
 		uint8_t GetBurstType() { return m_burstType; }
 
-		tlm::tlm_generic_payload& GetGP() { return m_gp; }
+		tlm::tlm_generic_payload& GetGP() { return *m_gp; }
 
 		uint32_t GetAxID() { return m_genattr.get_transaction_id(); }
 
-		uint64_t GetAddress() { return m_gp.get_address(); }
+		uint64_t GetAddress() { return m_gp->get_address(); }
 
 		uint8_t GetAxProt()
 		{
@@ -451,7 +498,7 @@ private:
 					return true;
 				}
 			}
-			return m_gp.is_read();
+			return m_gp->is_read();
 		}
 
 		bool IsWrite()
@@ -461,11 +508,11 @@ private:
 					return true;
 				}
 			}
-			return m_gp.is_write();
+			return m_gp->is_write();
 		}
 
 	private:
-		tlm::tlm_generic_payload& m_gp;
+		tlm::tlm_generic_payload *m_gp;
 		genattr_extension m_genattr;
 		sc_event m_done;
 		uint8_t m_burstType;
@@ -631,6 +678,258 @@ private:
 		}
 	}
 
+	//
+	// AT (base protocol) front-end. Requests received through
+	// nb_transport_fw are handed to the same signal wiggling machinery as
+	// b_transport, allowing a single initiator to keep several AXI
+	// transactions in flight. A request is accepted (END_REQ) when the
+	// outstanding read or write window has room and is completed with
+	// BEGIN_RESP when the AXI transaction is done. With the aligner
+	// enabled each accepted request is instead issued through the
+	// aligner by one of a pool of worker threads, so that unaligned,
+	// 4 KB crossing and too long requests are split as for b_transport.
+	// The pool is sized to the outstanding window and created at
+	// elaboration.
+	//
+	class NBSlot
+	{
+	public:
+		NBSlot() :
+			counted(false)
+		{}
+
+		Transaction tr;
+		bool counted;
+	};
+
+	virtual tlm::tlm_sync_enum nb_transport_fw(
+					tlm::tlm_generic_payload& trans,
+					tlm::tlm_phase& phase,
+					sc_time& delay)
+	{
+		if (phase == tlm::BEGIN_REQ) {
+			m_nbPeq.notify(trans, phase, delay);
+			return tlm::TLM_ACCEPTED;
+		} else if (phase == tlm::END_RESP) {
+			m_nbPeq.notify(trans, phase, delay);
+			return tlm::TLM_COMPLETED;
+		}
+
+		SC_REPORT_ERROR(TLM2AXI_BRIDGE_MSG,
+				"Unexpected phase in nb_transport_fw");
+		return tlm::TLM_COMPLETED;
+	}
+
+	void nb_peq_cb(tlm::tlm_generic_payload& trans,
+			const tlm::tlm_phase& phase)
+	{
+		if (phase == tlm::BEGIN_REQ) {
+			if (m_nbReq) {
+				SC_REPORT_ERROR(TLM2AXI_BRIDGE_MSG,
+					"BEGIN_REQ received before END_REQ");
+			}
+
+			m_nbReq = nb_alloc_slot();
+			m_nbReq->tr.Init(trans);
+
+			nb_accept_req();
+		} else {
+			if (!m_nbResp || &m_nbResp->tr.GetGP() != &trans) {
+				SC_REPORT_ERROR(TLM2AXI_BRIDGE_MSG,
+					"Unexpected END_RESP");
+			}
+
+			nb_free_slot(m_nbResp);
+			m_nbResp = NULL;
+
+			nb_send_resp();
+		}
+	}
+
+	bool nb_window_full(Transaction& tr)
+	{
+		if (tr.IsRead()) {
+			return m_nbNumReads >= m_nbMaxReads ||
+				rdTransFifo.num_free() == 0;
+		}
+		return m_nbNumWrites >= m_nbMaxWrites ||
+			wrTransFifo.num_free() == 0;
+	}
+
+	void nb_count(NBSlot *slot)
+	{
+		slot->counted = true;
+
+		if (slot->tr.IsRead()) {
+			m_nbNumReads++;
+		} else {
+			m_nbNumWrites++;
+		}
+	}
+
+	//
+	// Also run as a method when the transaction fifos are read from
+	// (the window might have been full due to b_transport requests).
+	//
+	void nb_accept_req()
+	{
+		tlm::tlm_phase phase = tlm::END_REQ;
+		sc_time delay(SC_ZERO_TIME);
+		NBSlot *slot = m_nbReq;
+
+		if (!slot || nb_window_full(slot->tr)) {
+			return;
+		}
+
+		m_nbReq = NULL;
+
+		tgt_socket->nb_transport_bw(slot->tr.GetGP(), phase, delay);
+
+		if (resetn.read() && aligner) {
+			nb_count(slot);
+
+			m_nbAlignQueue.push_back(slot);
+			m_nbAlignEvent.notify();
+		} else if (resetn.read() && Validate(slot->tr)) {
+			nb_count(slot);
+
+			// Hand it over to the signal wiggling machinery.
+			if (slot->tr.IsRead()) {
+				rdTransFifo.nb_write(&slot->tr);
+			} else {
+				wrTransFifo.nb_write(&slot->tr);
+			}
+		} else {
+			slot->tr.GetGP().set_response_status(
+				tlm::TLM_GENERIC_ERROR_RESPONSE);
+
+			m_nbRespQueue.push_back(slot);
+			nb_send_resp();
+		}
+	}
+
+	//
+	// Aligner worker, issues queued requests through the aligner as if
+	// they were received by b_transport. The slot's transaction is only
+	// used for the window accounting (its done method never triggers),
+	// the response is sent from here.
+	//
+	void nb_align()
+	{
+		while (true) {
+			sc_time delay(SC_ZERO_TIME);
+			NBSlot *slot;
+
+			while (m_nbAlignQueue.empty()) {
+				wait(m_nbAlignEvent);
+			}
+
+			slot = m_nbAlignQueue.front();
+			m_nbAlignQueue.pop_front();
+
+			b_transport_proxy(slot->tr.GetGP(), delay);
+
+			m_nbRespQueue.push_back(slot);
+			nb_send_resp();
+		}
+	}
+
+	//
+	// One worker per request of the outstanding window. If the window
+	// is grown after elaboration requests queue up for the workers.
+	//
+	void nb_spawn_align_workers()
+	{
+		unsigned int i;
+
+		if (!aligner) {
+			return;
+		}
+
+		for (i = 0; i < m_nbMaxReads + m_nbMaxWrites; i++) {
+			sc_spawn(sc_bind(&tlm2axi_bridge::nb_align, this),
+				sc_gen_unique_name("nb_align"));
+		}
+	}
+
+	//
+	// Runs when the AXI transaction of the slot is done (or aborted)
+	//
+	void nb_done(NBSlot *slot)
+	{
+		m_nbRespQueue.push_back(slot);
+		nb_send_resp();
+	}
+
+	//
+	// Responses are sent one at a time (the initiator must signal
+	// END_RESP before the next BEGIN_RESP).
+	//
+	void nb_send_resp()
+	{
+		while (!m_nbResp && !m_nbRespQueue.empty()) {
+			NBSlot *slot = m_nbRespQueue.front();
+			tlm::tlm_phase phase = tlm::BEGIN_RESP;
+			sc_time delay(SC_ZERO_TIME);
+			tlm::tlm_sync_enum status;
+
+			m_nbRespQueue.pop_front();
+
+			status = tgt_socket->nb_transport_bw(slot->tr.GetGP(),
+								phase, delay);
+			if (status == tlm::TLM_ACCEPTED) {
+				// Wait for END_RESP
+				m_nbResp = slot;
+			} else {
+				// TLM_UPDATED (END_RESP) or TLM_COMPLETED
+				nb_free_slot(slot);
+			}
+		}
+
+		nb_accept_req();
+	}
+
+	NBSlot *nb_alloc_slot()
+	{
+		sc_spawn_options opts;
+		NBSlot *slot;
+
+		if (!m_nbFree.empty()) {
+			slot = m_nbFree.back();
+			m_nbFree.pop_back();
+			return slot;
+		}
+
+		slot = new NBSlot();
+		m_nbSlots.push_back(slot);
+
+		//
+		// One method per slot, triggered by the done event of the
+		// slot's transaction.
+		//
+		opts.spawn_method();
+		opts.dont_initialize();
+		opts.set_sensitivity(&slot->tr.DoneEvent());
+
+		sc_spawn(sc_bind(&tlm2axi_bridge::nb_done, this, slot),
+			sc_gen_unique_name("nb_done"), &opts);
+
+		return slot;
+	}
+
+	void nb_free_slot(NBSlot *slot)
+	{
+		if (slot->counted) {
+			if (slot->tr.IsRead()) {
+				m_nbNumReads--;
+			} else {
+				m_nbNumWrites--;
+			}
+			slot->counted = false;
+		}
+		m_nbFree.push_back(slot);
+	}
+
 	bool read_address_phase(Transaction *rt)
 	{
 		int axsize = map_size_to_axsize_assert(rt->GetBurstWidth());
@@ -794,7 +1093,6 @@ private:
 			unsigned char *be = NULL;
 			unsigned int len = 0;
 			unsigned int be_len = 0;
-			uint64_t data64 = 0;
 			unsigned int bitoffset = 0;
 			unsigned int pos = 0;
 			unsigned int addr_pos = 0;
@@ -803,16 +1101,18 @@ private:
 			while (len || tr == NULL) {
 				rready.write(true);
 
-				wait(clk.posedge_event() | resetn.negedge_event());
+				if (!wait_idle(rvalid)) {
+					wait(clk.posedge_event() |
+						resetn.negedge_event());
+				}
 
 				if (reset_asserted()) {
 					break;
 				}
 
 				if (rvalid.read()) {
-					sc_bv<128> data128 = 0;
+					uint8_t beat[DATA_BUS_BYTES];
 					unsigned int readlen;
-					unsigned int w;
 					uint64_t addr;
 
 					if (tr == NULL) {
@@ -864,37 +1164,25 @@ private:
 						readlen = readlen > t ? t : readlen;
 					}
 
-					for (w = 0; w < readlen; w += sizeof data64) {
-						unsigned int copylen = readlen - w;
-
-						copylen = copylen <= sizeof data64 ? copylen : sizeof data64;
-						data128 = rdata.read() >> (w * 8 + bitoffset);
-						data64 = data128.to_uint64();
-
-						assert(copylen <= len);
-						if (be && be_len) {
-							uint64_t val = data64;
-							unsigned int i;
-
-							for (i = 0; i < copylen; i++) {
-								if (be[(pos + i)% be_len] == TLM_BYTE_ENABLED) {
-									data[pos + i] = val & 0xff;
-								}
-								val >>= 8;
-							}
-						} else {
-							memcpy(data + pos, &data64, copylen);
-						}
+					//
+					// Extract the beat through the native
+					// words of rdata
+					//
+					axi_bv_to_bytes(rdata.read(), beat);
 
-						D(printf("Read addr=%x data64=%lx len=%d readlen=%d pos=%d w=%d sw=%d ofset=%d, copylen=%d\n",
-							addr, data64, len, readlen, pos, w, streaming_width,
-							(w * 8 + bitoffset), copylen));
-						if (tr->GetBurstType() != AXI_BURST_FIXED) {
-							addr_pos += copylen;
-						}
-						pos += copylen;
-						len -= copylen;
+					assert(readlen <= len);
+					bytecopy_be(data + pos,
+						beat + bitoffset / 8,
+						readlen, be, be_len, pos);
+
+					D(printf("Read addr=%lx len=%d readlen=%d pos=%d sw=%d ofset=%d\n",
+						addr, len, readlen, pos, streaming_width,
+						bitoffset));
+					if (tr->GetBurstType() != AXI_BURST_FIXED) {
+						addr_pos += readlen;
 					}
+					pos += readlen;
+					len -= readlen;
 
 					if (rlast.read() && len) {
 						SC_REPORT_ERROR(TLM2AXI_BRIDGE_MSG,
@@ -1200,6 +1488,7 @@ private:
 	void before_end_of_elaboration()
 	{
 		bind_dummy();
+		nb_spawn_align_workers();
 	}
 
 	ACESnoopChannels_M__ *m_snp_chnls;
@@ -1219,6 +1508,21 @@ private:
 	tlm_aligner *aligner;
 	tlm_utils::simple_initiator_socket<tlm2axi_bridge> *proxy_init_socket;
 	tlm_utils::simple_target_socket<tlm2axi_bridge> *proxy_target_socket;
+
+	// nb_transport front-end
+	tlm_utils::peq_with_cb_and_phase<tlm2axi_bridge> m_nbPeq;
+	unsigned int m_nbMaxReads;
+	unsigned int m_nbMaxWrites;
+	unsigned int m_nbNumReads;
+	unsigned int m_nbNumWrites;
+	NBSlot *m_nbReq;
+	NBSlot *m_nbResp;
+	std::deque<NBSlot*> m_nbRespQueue;
+	std::deque<NBSlot*> m_nbAlignQueue;
+	sc_event m_nbAlignEvent;
+	std::vector<NBSlot*> m_nbSlots;
+	std::vector<NBSlot*> m_nbFree;
+
 	axi_dummy dummy;
 };
 
@@ -1250,9 +1554,10 @@ int tlm2axi_bridge<ADDR_WIDTH,
 	unsigned char *be = trans.get_byte_enable_ptr();
 	int be_len = trans.get_byte_enable_length();
 	unsigned int bitoffset;
-	sc_bv<DATA_WIDTH/8> strb = 0;
-	sc_bv<DATA_WIDTH> data128 = 0;
-	uint64_t t64;
+	sc_bv<DATA_WIDTH/8> strb;
+	sc_bv<DATA_WIDTH> data128;
+	uint8_t beat[DATA_BUS_BYTES];
+	uint8_t beat_be[DATA_BUS_BYTES];
 	unsigned int i;
 	unsigned int maxlen, wlen;
 
@@ -1283,31 +1588,27 @@ int tlm2axi_bridge<ADDR_WIDTH,
 
 	D(printf("WBEAT: pos=%d wlen=%d bitoffset=%d\n", offset, wlen, bitoffset));
 
+	//
+	// Assemble the beat (data and strobes) in native buffers placed
+	// at the lanes of the address and pack them into the signal
+	// values through the native words.
+	//
+	memset(beat, 0, sizeof(beat));
+	memset(beat_be, TLM_BYTE_DISABLED, sizeof(beat_be));
+
+	memcpy(beat + bitoffset / 8, data, wlen);
+
 	if (be && be_len) {
-		strb = 0;
 		for (i = 0; i < wlen; i++) {
-			uint8_t b = be[(i + offset) % be_len];
-			if (b == TLM_BYTE_ENABLED) {
-				strb[i] = true;
-			}
+			beat_be[bitoffset / 8 + i] = be[(i + offset) % be_len];
 		}
 	} else {
 		/* All lanes active.  */
-		for (i = 0; i < wlen; i++) {
-			strb[i] = true;
-		}
+		memset(beat_be + bitoffset / 8, TLM_BYTE_ENABLED, wlen);
 	}
-	strb.lrotate(bitoffset / 8);
-
-	for (i = 0; i < wlen; i += sizeof(t64)) {
-		unsigned int copylen = wlen - i;
 
-		t64 = 0;
-		copylen = copylen < sizeof(t64) ? copylen : sizeof(t64);
-		memcpy(&t64, data + i, copylen);
-		data128.range(copylen * 8 - 1 + i * 8 + bitoffset,
-			i * 8 + bitoffset) = t64;
-	}
+	axi_bytes_to_bv(data128, beat);
+	axi_be_to_strb(strb, beat_be);
 
 	if (m_version == V_AXI3) {
 		wid.write(tr->GetAxID());
@@ -33,6 +33,7 @@
 #include "tlm-bridges/amba.h"
 #include "tlm-modules/tlm-aligner.h"
 #include "tlm-extensions/genattr.h"
+#include "utils/bytecopy.h"
 
 #define TLM2AXILITE_BRIDGE_MSG "tlm2axilite-bridge"
 
@@ -360,7 +361,7 @@ private:
 			unsigned char *be = NULL;
 			unsigned int len = 0;
 			unsigned int be_len = 0;
-			uint64_t data64 = 0;
+			uint8_t beat[DATA_WIDTH / 8];
 			unsigned int bitoffset = 0;
 			unsigned int pos = 0;
 			unsigned int streaming_width = 0;
@@ -368,16 +369,17 @@ private:
 			while (len || tr == NULL) {
 				rready.write(true);
 
-				wait(clk.posedge_event() | resetn.negedge_event());
+				if (!wait_idle(rvalid)) {
+					wait(clk.posedge_event() |
+						resetn.negedge_event());
+				}
 
 				if (reset_asserted()) {
 					break;
 				}
 
 				if (rvalid.read()) {
-					sc_bv<128> data128 = 0;
 					unsigned int readlen;
-					unsigned int w;
 					uint64_t addr;
 
 					tr = rdResponses.read();
@@ -395,35 +397,22 @@ private:
 					readlen = (DATA_WIDTH - bitoffset) / 8;
 					readlen = readlen <= len ? readlen : len;
 
-					for (w = 0; w < readlen; w += sizeof data64) {
-						unsigned int copylen = readlen - w;
-
-						copylen = copylen <= sizeof data64 ? copylen : sizeof data64;
-
-						data128 = rdata.read() >> (w * 8 + bitoffset);
-						data64 = data128.to_uint64();
-
-						assert(copylen <= len);
-						if (be && be_len) {
-							uint64_t val = data64;
-							unsigned int i;
-
-							for (i = 0; i < copylen; i++) {
-								if (be[(pos + i)% be_len] == TLM_BYTE_ENABLED) {
-									data[pos + i] = val & 0xff;
-								}
-								val >>= 8;
-							}
-						} else {
-							memcpy(data + pos, &data64, copylen);
-						}
-
-						D(printf("Read addr=%x data64=%lx len=%d readlen=%d pos=%d w=%d sw=%d ofset=%d, copylen=%d\n",
-							addr, data64, len, readlen, pos, w, streaming_width,
-							(w * 8 + bitoffset), copylen));
-						pos += copylen;
-						len -= copylen;
-					}
+					//
+					// Extract the beat through the native
+					// words of rdata
+					//
+					axi_bv_to_bytes(rdata.read(), beat);
+
+					assert(readlen <= len);
+					bytecopy_be(data + pos,
+						beat + bitoffset / 8,
+						readlen, be, be_len, pos);
+
+					D(printf("Read addr=%lx len=%d readlen=%d pos=%d sw=%d ofset=%d\n",
+						addr, len, readlen, pos, streaming_width,
+						bitoffset));
+					pos += readlen;
+					len -= readlen;
 				}
 			}
 			rready.write(false);
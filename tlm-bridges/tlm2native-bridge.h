@@ -27,6 +27,8 @@
 
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 
+#include "utils/bytecopy.h"
+
 class tlm2native_bridge
 : public sc_core::sc_module
 {
@@ -90,29 +92,12 @@ void tlm2native_bridge::b_transport(tlm::tlm_generic_payload& trans,
 		return;
 	}
 
-	if (be_len || streaming_width) {
-		// Slow path.
-		unsigned int pos;
-
-		for (pos = 0; pos < len; pos++) {
-			bool do_access = true;
-
-			if (be_len) {
-				do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-			}
-			if (do_access) {
-				if (trans.is_read()) {
-					ptr[pos] = mem[addr + (pos % streaming_width)];
-				} else {
-					mem[addr + (pos % streaming_width)] = ptr[pos];
-				}
-			}
-		}
-	} else {
-		if (trans.get_command() == tlm::TLM_READ_COMMAND)
-			memcpy(ptr, &mem[addr], len);
-		else if (cmd == tlm::TLM_WRITE_COMMAND)
-			memcpy(&mem[addr], ptr, len);
+	if (cmd == tlm::TLM_READ_COMMAND) {
+		bytecopy_from_sw(ptr, &mem[addr], len, streaming_width,
+				be, be_len);
+	} else if (cmd == tlm::TLM_WRITE_COMMAND) {
+		bytecopy_to_sw(&mem[addr], ptr, len, streaming_width,
+				be, be_len);
 	}
 
 	delay += latency;
@@ -32,8 +32,11 @@
 
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 
-#include <list>
+#include <algorithm>
+#include <deque>
+#include <vector>
 #include <sstream>
+#include <string.h>
 
 #include "tlm-bridges/pci.h"
 #include "tlm-extensions/genattr.h"
@@ -108,11 +111,19 @@ public:
 
 		// Used when creating from raw TLP data
 		TLPHdr_Base() :
+			m_hdr_len(0),
+			m_swap_dw(0),
+			m_tlp_data(nullptr),
+			m_tlp_dw_len(0),
 			m_gp(nullptr),
 			m_done(false)
 		{}
 
 		TLPHdr_Base(tlm::tlm_generic_payload *gp) :
+			m_hdr_len(0),
+			m_swap_dw(0),
+			m_tlp_data(nullptr),
+			m_tlp_dw_len(0),
 			m_gp(gp),
 			m_done(false)
 		{}
@@ -143,16 +154,14 @@ public:
 
 		virtual uint32_t GetTxID() { return 0; }
 
+		//
+		// Reads a DW from the data of a received TLP
+		//
 		uint32_t GetTLPData(unsigned int DW_pos)
 		{
-			unsigned int data_offset =
-				(get_fmt() == FMT_3DW_WithData) ? 3 : 4;
+			assert(m_tlp_data && DW_pos < m_tlp_dw_len);
 
-			data_offset += DW_pos;
-
-			assert(data_offset < m_hdr.size());
-
-			return m_hdr[data_offset];
+			return ToDW(&m_tlp_data[DW_pos * 4]);
 		}
 
 
@@ -206,22 +215,104 @@ public:
 			return val;
 		}
 
+		//
+		// Converts the DWs into TLP (big endian) byte order, DWs
+		// already in TLP byte order (m_swap_dw and onwards) are kept
+		//
 		void ByteSwap()
 		{
-			uint8_t *d = m_tlp.get_data_ptr();
-			unsigned int len = m_tlp.get_data_length();
+			uint32_t *buf = GetTLPBuf();
 
-			assert((len % 4) == 0);
-			for (unsigned int i = 0; i < len; i += 4) {
-				uint32_t *d_u32 = reinterpret_cast<uint32_t*>(&d[i]);
-				d_u32[0] = byteswap(d_u32[0]);
+			for (unsigned int i = 0; i < m_swap_dw; i++) {
+				buf[i] = byteswap(buf[i]);
 			}
 		}
 
 		sc_event& DMADoneEvent() { return m_dma_done_event; }
 
 	protected:
-		std::vector<uint32_t> m_hdr;
+		enum { TLP_HDR_MAX_DW = TLPHdr_4DW_Sz / 4 };
+
+		void PushDW(uint32_t val)
+		{
+			assert(m_hdr_len < TLP_HDR_MAX_DW);
+			assert(m_data.empty());
+			m_hdr[m_hdr_len++] = val;
+		}
+
+		//
+		// The data is placed after room for the header so that the
+		// TLP can be transmitted from a single buffer
+		//
+		void PushDataDW(uint32_t val)
+		{
+			if (m_data.empty()) {
+				m_data.resize(m_hdr_len);
+			}
+			m_data.push_back(val);
+		}
+
+		//
+		// The TLP as transmitted, the header only or the header
+		// followed by the data
+		//
+		uint32_t *GetTLPBuf()
+		{
+			return m_data.empty() ? m_hdr : m_data.data();
+		}
+
+		unsigned int GetTLPBufLen()
+		{
+			return m_data.empty() ? m_hdr_len : m_data.size();
+		}
+
+		// Reads a DW from raw (big endian) TLP data
+		uint32_t ToDW(uint8_t *d)
+		{
+			return d[0] << 24 | d[1] << 16 | d[2] << 8 | d[3];
+		}
+
+		void SetupTLPGP(tlm::tlm_command cmd)
+		{
+			//
+			// command should perhaps always be TLM_WRITE_COMMAND???
+			//
+			// (Check TLM spec if read means data can be
+			// manipulated)
+			//
+			if (!m_data.empty()) {
+				memcpy(m_data.data(), m_hdr, m_hdr_len * 4);
+			}
+
+			m_tlp.set_command(cmd);
+			m_tlp.set_address(0); // unused
+
+			m_tlp.set_data_ptr(reinterpret_cast<uint8_t*>(GetTLPBuf()));
+			m_tlp.set_data_length(GetTLPBufLen() * 4);
+			m_tlp.set_byte_enable_ptr(nullptr);
+			m_tlp.set_byte_enable_length(0);
+			m_tlp.set_streaming_width(GetTLPBufLen() * 4);
+			m_tlp.set_dmi_allowed(false);
+			m_tlp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+			m_swap_dw = GetTLPBufLen();
+		}
+
+		//
+		// The header is stored inline, the data of TLPs created for
+		// transmission is stored in m_data
+		//
+		uint32_t m_hdr[TLP_HDR_MAX_DW];
+		unsigned int m_hdr_len;
+		unsigned int m_swap_dw;
+		std::vector<uint32_t> m_data;
+
+		//
+		// Data of a received TLP, used in place
+		//
+		uint8_t *m_tlp_data;
+		uint32_t m_tlp_dw_len;
+
 		tlm::tlm_generic_payload m_tlp;
 		tlm::tlm_generic_payload *m_gp;  // stored gp
 		bool m_done;
@@ -275,7 +366,7 @@ public:
 			uint32_t dlen;
 
 			// Bits [31:0]
-			m_hdr.push_back(set_fmt(fmt) |
+			PushDW(set_fmt(fmt) |
 					set_type(Type_CfgRdWr_type0) |
 
 					set_t9(0) |
@@ -321,7 +412,7 @@ public:
 					 firstDWBE |= 1 << (start_be_bit + i);
 				}
 			}
-			m_hdr.push_back(
+			PushDW(
 				set_requestorID(masterID) |
 				set_tag(txID) |
 				set_lastDWBE(0) |
@@ -330,7 +421,7 @@ public:
 			//
 			// Bits [95:64]
 			//
-			m_hdr.push_back(set_busNumber(get_ECAMAddr_bus(addr)) |
+			PushDW(set_busNumber(get_ECAMAddr_bus(addr)) |
 					set_deviceNumber(get_ECAMAddr_dev(addr)) |
 					set_funcNumber(get_ECAMAddr_fn(addr)) |
 					set_rsvd1(0) |
@@ -357,26 +448,10 @@ public:
 				if (dlen > 3) {
 					val |= d[3];
 				}
-				m_hdr.push_back(val);
+				PushDataDW(val);
 			}
 
-			//
-			// Setup m_tlp
-			//
-			// command should perhaps always be TLM_WRITE_COMMAND???
-			//
-			// (Check TLM spec if read means data can be manipulated)
-			//
-			m_tlp.set_command(gp->get_command());
-			m_tlp.set_address(0); // unused
-
-			m_tlp.set_data_ptr(reinterpret_cast<uint8_t*>(m_hdr.data()));
-			m_tlp.set_data_length(m_hdr.size() * 4);
-			m_tlp.set_byte_enable_ptr(nullptr);
-			m_tlp.set_byte_enable_length(0);
-			m_tlp.set_streaming_width(m_hdr.size() * 4);
-			m_tlp.set_dmi_allowed(false);
-			m_tlp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+			SetupTLPGP(gp->get_command());
 		}
 
 		//
@@ -425,9 +500,7 @@ public:
 		// bits, otherwise it generates a 4 DW header
 		//
 		TLP_Mem(tlm::tlm_generic_payload *gp) :
-			TLPHdr_Base(gp),
-			m_tlp_data(nullptr),
-			m_tlp_dw_len(0)
+			TLPHdr_Base(gp)
 		{
 			uint64_t addr = gp->get_address();
 			uint32_t fmt = gp->is_write() ?
@@ -460,7 +533,7 @@ public:
 			}
 
 			// Bits [31:0]
-			m_hdr.push_back(set_fmt(fmt) |
+			PushDW(set_fmt(fmt) |
 					set_type(Type_MRdWr) |
 
 					set_t9(0) |
@@ -518,7 +591,7 @@ public:
 				}
 			}
 
-			m_hdr.push_back(
+			PushDW(
 				set_requestorID(masterID) |
 				set_tag(txID) |
 				set_lastDWBE(lastDWBE) |
@@ -532,10 +605,10 @@ public:
 				//
 				// Upper 32 bits of the addr
 				//
-				m_hdr.push_back(addr >> 32);
+				PushDW(addr >> 32);
 			}
 			addr = get_addr_32_2(addr & 0xFFFFFFFF);
-			m_hdr.push_back(set_4DWHdr_addr_31_2(addr) |
+			PushDW(set_4DWHdr_addr_31_2(addr) |
 					set_4DWHdr_ph(0));
 
 			//
@@ -561,7 +634,7 @@ public:
 					if (len > 3) {
 						val |= d[pos++];
 					}
-					m_hdr.push_back(val);
+					PushDataDW(val);
 				}
 
 				//
@@ -571,56 +644,40 @@ public:
 				gp->set_response_status(tlm::TLM_OK_RESPONSE);
 			}
 
-			//
-			// Setup m_tlp
-			//
-			// command should perhaps always be TLM_WRITE_COMMAND???
-			//
-			// (Check TLM spec if read means data can be manipulated)
-			//
-			m_tlp.set_command(gp->get_command());
-			m_tlp.set_address(0); // unused
-
-			m_tlp.set_data_ptr(reinterpret_cast<uint8_t*>(m_hdr.data()));
-			m_tlp.set_data_length(m_hdr.size() * 4);
-			m_tlp.set_byte_enable_ptr(nullptr);
-			m_tlp.set_byte_enable_length(0);
-			m_tlp.set_streaming_width(m_hdr.size() * 4);
-			m_tlp.set_dmi_allowed(false);
-			m_tlp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+			SetupTLPGP(gp->get_command());
 		}
 
 		TLP_Mem(uint8_t *hdr,  unsigned int b_len) :
-			TLPHdr_Base(nullptr),
-			m_tlp_data(nullptr),
-			m_tlp_dw_len(0)
+			TLPHdr_Base(nullptr)
+		{
+			Init(hdr, b_len);
+		}
+
+		//
+		// Setup from a received TLP. The data of a write is used in
+		// place, the received TLP must be kept until the DMA is done.
+		//
+		void Init(uint8_t *hdr, unsigned int b_len)
 		{
 			unsigned int i = 0;
 			uint32_t fmt;
 
+			m_hdr_len = 0;
+			m_done = false;
+			m_tlp_data = nullptr;
+			m_tlp_dw_len = 0;
+
 			assert(b_len >= TLPHdr_3DW_Sz);
 
 			for (; i < TLPHdr_3DW_Sz; i+=4) {
-				uint32_t val = hdr[i] << 24 |
-						hdr[i+1] << 16 |
-						hdr[i+2] << 8 |
-						hdr[i+3];
-
-				m_hdr.push_back(val);
+				PushDW(ToDW(&hdr[i]));
 			}
 
 			fmt = get_fmt();
 			if (fmt == FMT_4DW_NoData || fmt == FMT_4DW_WithData) {
-				uint32_t val;
-
 				assert(b_len >= TLPHdr_4DW_Sz);
 
-				val = hdr[i] << 24 |
-					hdr[i+1] << 16 |
-					hdr[i+2] << 8 |
-					hdr[i+3];
-
-				m_hdr.push_back(val);
+				PushDW(ToDW(&hdr[i]));
 
 				i+=4;
 			}
@@ -629,26 +686,10 @@ public:
 
 			if (fmt == FMT_4DW_WithData ||
 				fmt == FMT_3DW_WithData) {
-				uint32_t data_u32_idx = i / 4;
-				uint32_t *data_u32;
-				uint8_t *data;
 
 				assert(b_len >= (i + m_tlp_dw_len * 4));
 
-				//
-				// Copy the data
-				//
-				data = &hdr[i];
-				for (uint32_t j = 0; j < (m_tlp_dw_len * 4); j+=4) {
-					uint32_t *val = reinterpret_cast<uint32_t*>(&data[j]);
-					m_hdr.push_back(val[0]);
-				}
-
-				//
-				// Store the data location
-				//
-				data_u32 = &(m_hdr.data()[data_u32_idx]);
-			        m_tlp_data = reinterpret_cast<uint8_t*>(data_u32);
+				m_tlp_data = &hdr[i];
 			}
 		}
 
@@ -696,9 +737,6 @@ public:
 
 			return addr;
 		}
-
-		uint8_t *m_tlp_data;
-		uint32_t m_tlp_dw_len;
 	};
 
 	class TLP_Cpl: public TLPHdr_Base
@@ -746,7 +784,7 @@ public:
 				dlen++;
 			}
 
-			m_hdr.push_back(set_fmt(fmt) |
+			PushDW(set_fmt(fmt) |
 					set_type(Type_Cpl) |
 
 					set_t9(0) |
@@ -776,7 +814,7 @@ public:
 			// (upper layer is responsible of creating
 			// correctly sized Cpl responses).
 			//
-			m_hdr.push_back(set_completerID(0) |
+			PushDW(set_completerID(0) |
 					set_cplStatus(cpl_status) |
 					set_bcm(0) |
 					set_byteCount(gp->get_data_length() == SZ_4K ?
@@ -800,7 +838,7 @@ public:
 				}
 			}
 
-			m_hdr.push_back(set_requestorID(masterID) |
+			PushDW(set_requestorID(masterID) |
 					set_tag(txID) |
 					set_lowerAddress(lowerAddr));
 
@@ -829,28 +867,79 @@ public:
 					}
 					pos += 4;
 
-					m_hdr.push_back(val);
+					PushDataDW(val);
 				}
 			}
 			m_done = true;
 
+			SetupTLPGP(gp->get_command());
+		}
+
+		//
+		// Used for the DMA read completions, see Init()
+		//
+		TLP_Cpl() :
+			TLPHdr_Base(nullptr)
+		{}
+
+		//
+		// CplD for (a part of) the DMA read request req. The len
+		// bytes of data at addr are placed directly in the TLP by the
+		// caller through GetPayload(). byteCount is the number of
+		// bytes remaining of the request, including this completion
+		// (2.2.9 [1]). The data storage is reused across calls.
+		//
+		void Init(TLP_Mem *req, uint64_t addr, unsigned int len,
+				unsigned int byteCount)
+		{
+			uint32_t dlen = (len + 3) / 4;
+
+			assert(dlen && dlen <= MAX_DW_LEN);
+
+			m_hdr_len = 0;
+			m_data.clear();
+
+			PushDW(set_fmt(FMT_3DW_WithData) |
+					set_type(Type_Cpl) |
+
+					set_t9(req->get_t9()) |
+					set_tc(0) |
+					set_t8(req->get_t8()) |
+					set_attr2(0) |
+					set_ln(0) |
+					set_th(0) |
+
+					set_td(0) |
+					set_ep(0) |
+					set_attr_1_0(0) |
+					set_at(0) |
+
+					set_length(dlen == MAX_DW_LEN ? 0 : dlen));
+
+			PushDW(set_completerID(0) |
+					set_cplStatus(Cpl_SC) |
+					set_bcm(0) |
+					set_byteCount(byteCount == SZ_4K ?
+							0 : byteCount));
+
+			PushDW(set_requestorID(req->get_requestorID()) |
+					set_tag(req->get_tag()) |
+					set_lowerAddress(addr & 0x7F));
+
 			//
-			// Setup m_tlp
+			// Room for the data, the padding in the last DW is
+			// zeroed
 			//
-			// command should perhaps always be TLM_WRITE_COMMAND???
+			m_data.resize(m_hdr_len + dlen);
+
+			m_done = true;
+
+			SetupTLPGP(tlm::TLM_READ_COMMAND);
+
 			//
-			// (Check TLM spec if read means data can be manipulated)
+			// The payload is already in TLP byte order
 			//
-			m_tlp.set_command(gp->get_command());
-			m_tlp.set_address(0); // unused
-
-			m_tlp.set_data_ptr(reinterpret_cast<uint8_t*>(m_hdr.data()));
-			m_tlp.set_data_length(m_hdr.size() * 4);
-			m_tlp.set_byte_enable_ptr(nullptr);
-			m_tlp.set_byte_enable_length(0);
-			m_tlp.set_streaming_width(m_hdr.size() * 4);
-			m_tlp.set_dmi_allowed(false);
-			m_tlp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+			m_swap_dw = TLPHdr_Cpl_Sz / 4;
 		}
 
 		TLP_Cpl(uint8_t *hdr, unsigned int len)
@@ -860,26 +949,24 @@ public:
 			assert(len >= TLPHdr_Cpl_Sz);
 
 			for (; i < TLPHdr_Cpl_Sz; i+=4) {
-				uint32_t val = hdr[i] << 24 |
-					hdr[i+1] << 16 |
-					hdr[i+2] << 8 |
-					hdr[i+3];
-
-				m_hdr.push_back(val);
+				PushDW(ToDW(&hdr[i]));
 			}
 
-			//
-			// Need to fix this and grab all data
-			//
 			if (get_fmt() == FMT_3DW_WithData) {
-				uint32_t val = hdr[i] << 24 |
-					hdr[i+1] << 16 |
-					hdr[i+2] << 8 |
-					hdr[i+3];
-				m_hdr.push_back(val);
+				unsigned int dw_len = get_length() ?
+							get_length() :
+							MAX_DW_LEN;
+
+				m_tlp_data = &hdr[i];
+				m_tlp_dw_len = std::min(dw_len, (len - i) / 4);
 			}
 		}
 
+		uint8_t *GetPayload()
+		{
+			return reinterpret_cast<uint8_t*>(&m_data[m_hdr_len]);
+		}
+
 		uint32_t GetTxID()
 		{
 			return get_requestorID() << 16 | get_t9() << 9 |
@@ -915,8 +1002,11 @@ public:
 		m_rx_event("rx-event"),
 		m_tlp_done_event("tlp-done-event"),
 
-		m_dma_event("dma-event")
+		m_dma_event("dma-event"),
+		m_max_payload_size(SZ_4K)
 	{
+		memset(m_outstanding, 0, sizeof(m_outstanding));
+
 		cfg_tgt_socket.register_b_transport(this,
 				&tlm2tlp_bridge::cfg_b_transport);
 		mem_tgt_socket.register_b_transport(this,
@@ -935,16 +1025,56 @@ public:
 		SC_THREAD(dma_thread);
 	}
 
+	~tlm2tlp_bridge()
+	{
+		for (unsigned int i = 0; i < m_dma_tlp_pool.size(); i++) {
+			delete m_dma_tlp_pool[i];
+		}
+	}
+
+	//
+	// Max_Payload_Size of the completions generated for DMA reads, larger
+	// reads are split at Max_Payload_Size aligned boundaries (2.3.1.1
+	// [1]). Defaults to 4 KB (no splitting).
+	//
+	void set_max_payload_size(unsigned int mps)
+	{
+		assert(mps >= 128 && mps <= SZ_4K && (mps & (mps - 1)) == 0);
+		m_max_payload_size = mps;
+	}
+
+	//
+	// Request waiting for its completion. The header of the TLP is byte
+	// swapped when transmitted so the fields needed for processing the
+	// completion are kept here.
+	//
+	struct OutstandingTLP {
+		TLPHdr_Base *tlp;
+		uint32_t txID;
+		bool expectsData;
+	};
+
+	OutstandingTLP& GetOutstanding(uint32_t txID)
+	{
+		return m_outstanding[txID & (NUM_TAGS - 1)];
+	}
+
 	void transmitTLP(TLPHdr_Base *tlp, sc_time& delay)
 	{
+		uint32_t txID = tlp->GetTxID();
+		OutstandingTLP& slot = GetOutstanding(txID);
+
 		//
-		// Multiple oustanding TLPs not supported
+		// Multiple oustanding TLPs are supported as long as the
+		// tags differ
 		//
-		while (!m_tlps.empty()) {
+		while (slot.tlp) {
 			wait(m_tlp_done_event);
 		}
 
-		m_tlps.push_back(tlp);
+		slot.tlp = tlp;
+		slot.txID = txID;
+		slot.expectsData = tlp->ExpectsData();
 
 		tlp->ByteSwap();
 		init_socket->b_transport(*tlp->GetTLPGP(), delay);
@@ -959,7 +1089,7 @@ public:
 			wait(m_rx_event);
 		}
 
-		m_tlps.remove(tlp);
+		slot.tlp = nullptr;
 		m_tlp_done_event.notify();
 	}
 
@@ -971,10 +1101,8 @@ public:
 		transmitTLP(reinterpret_cast<TLPHdr_Base*>(&tlp), delay);
 	}
 
-	void transmitCplD(tlm::tlm_generic_payload& trans, sc_time& delay)
+	void transmitCpl(TLP_Cpl& tlp, sc_time& delay)
 	{
-		TLP_Cpl tlp(&trans);
-
 		tlp.ByteSwap();
 		init_socket->b_transport(*tlp.GetTLPGP(), delay);
 
@@ -1008,16 +1136,12 @@ public:
 			"Message transactions are currently not supported");
 	}
 
-	TLPHdr_Base *LookupRequestTLP(std::list<TLPHdr_Base*>& l, uint32_t txID)
+	OutstandingTLP *LookupRequestTLP(uint32_t txID)
 	{
-		for (typename std::list<TLPHdr_Base*>::iterator it = l.begin();
-				it != l.end(); it++) {
+		OutstandingTLP& o = GetOutstanding(txID);
 
-			TLPHdr_Base *t = (*it);
-
-			if (t->GetTxID() == txID) {
-				return t;
-			}
+		if (o.tlp && o.txID == txID) {
+			return &o;
 		}
 		return nullptr;
 	}
@@ -1034,17 +1158,18 @@ public:
 		case Type_Cpl:
 		{
 			TLP_Cpl cpl(trans.get_data_ptr(), trans.get_data_length());
-			TLPHdr_Base *tlp = LookupRequestTLP(m_tlps, cpl.GetTxID());
+			OutstandingTLP *o = LookupRequestTLP(cpl.GetTxID());
 
-			if (tlp) {
-				bool resp_ok = (tlp->ExpectsData() && cpl.IsCplD()) ||
-					(!tlp->ExpectsData() && !cpl.IsCplD());
+			if (o) {
+				TLPHdr_Base *tlp = o->tlp;
+				bool resp_ok = (o->expectsData && cpl.IsCplD()) ||
+					(!o->expectsData && !cpl.IsCplD());
 
 				tlp->SetDone();
 
 				if (resp_ok) {
 					// Only on ok resp, no need to copy on error
-					if (tlp->ExpectsData() && cpl.IsCplD()) {
+					if (o->expectsData && cpl.IsCplD()) {
 						tlp->CopyData(&cpl);
 					}
 
@@ -1067,7 +1192,7 @@ public:
 		}
 		case Type_MRdWr:
 		{
-			TLP_Mem *tlp = new TLP_Mem(trans.get_data_ptr(),
+			TLP_Mem *tlp = AllocDMATLP(trans.get_data_ptr(),
 							trans.get_data_length());
 
 			m_dma_tlps.push_back(tlp);
@@ -1075,6 +1200,8 @@ public:
 
 			wait(tlp->DMADoneEvent());
 
+			FreeDMATLP(tlp);
+
 			break;
 		}
 		default:
@@ -1085,68 +1212,106 @@ public:
 		trans.set_response_status(tlm::TLM_OK_RESPONSE);
 	}
 
-	genattr_extension *get_genattr(TLP_Mem *t)
+	//
+	// TLPs received for DMA are kept in a pool and reused
+	//
+	TLP_Mem *AllocDMATLP(uint8_t *data, unsigned int len)
 	{
-		genattr_extension *genattr = new genattr_extension();
+		TLP_Mem *tlp;
+
+		if (m_dma_tlp_pool.empty()) {
+			return new TLP_Mem(data, len);
+		}
+
+		tlp = m_dma_tlp_pool.back();
+		m_dma_tlp_pool.pop_back();
 
-		genattr->set_master_id(t->get_requestorID());
-		genattr->set_transaction_id(t->get_tag());
+		tlp->Init(data, len);
 
-		return genattr;
+		return tlp;
 	}
 
-	void ProcessReadDMA(TLP_Mem *t)
+	void FreeDMATLP(TLP_Mem *tlp)
 	{
-		genattr_extension *genattr = get_genattr(t);
-		unsigned int dlen = t->GetTLPDWLength() * 4;
-		sc_time delay(SC_ZERO_TIME);
-		tlm::tlm_generic_payload gp;
-		uint8_t data[SZ_4K];
+		m_dma_tlp_pool.push_back(tlp);
+	}
 
-		gp.set_command(tlm::TLM_READ_COMMAND);
-		gp.set_address(t->GetAddress());
+	void setup_dma_gp(tlm::tlm_generic_payload& gp, TLP_Mem *t,
+				tlm::tlm_command cmd, uint64_t addr,
+				uint8_t *data, unsigned int len)
+	{
+		m_dma_genattr.set_master_id(t->get_requestorID());
+		m_dma_genattr.set_transaction_id(t->get_tag());
+
+		gp.set_command(cmd);
+		gp.set_address(addr);
 		gp.set_data_ptr(data);
-		gp.set_data_length(dlen);
-		gp.set_streaming_width(dlen);
+		gp.set_data_length(len);
+		gp.set_streaming_width(len);
 		gp.set_byte_enable_ptr(nullptr);
 		gp.set_byte_enable_length(0);
 		gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-		gp.set_extension(genattr);
+		gp.set_extension(&m_dma_genattr);
+	}
 
-		dma_init_socket->b_transport(gp, delay);
-		wait(delay);
-		delay = SC_ZERO_TIME;
-		assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+	void ProcessReadDMA(TLP_Mem *t)
+	{
+		unsigned int dlen = t->GetTLPDWLength() * 4;
+		uint64_t addr = t->GetAddress();
+		sc_time delay(SC_ZERO_TIME);
+		unsigned int pos = 0;
+		TLP_Cpl cpl;
 
 		//
-		// transmit the DMA read completion
+		// One completion per Max_Payload_Size aligned chunk, the
+		// data is read directly into the completion
 		//
-		transmitCplD(gp, delay);
+		while (pos < dlen) {
+			unsigned int mps = m_max_payload_size;
+			unsigned int len = mps - ((addr + pos) & (mps - 1));
+			tlm::tlm_generic_payload gp;
+
+			if (len > (dlen - pos)) {
+				len = dlen - pos;
+			}
+
+			cpl.Init(t, addr + pos, len, dlen - pos);
+
+			setup_dma_gp(gp, t, tlm::TLM_READ_COMMAND, addr + pos,
+					cpl.GetPayload(), len);
+
+			dma_init_socket->b_transport(gp, delay);
+			wait(delay);
+			delay = SC_ZERO_TIME;
+			assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+
+			gp.clear_extension(&m_dma_genattr);
+
+			//
+			// transmit the DMA read completion
+			//
+			transmitCpl(cpl, delay);
+
+			pos += len;
+		}
 	}
 
 	void ProcessWriteDMA(TLP_Mem *t)
 	{
-		genattr_extension *genattr = get_genattr(t);
 		unsigned int dlen = t->GetTLPDWLength() * 4;
 	        sc_time delay(SC_ZERO_TIME);
 		tlm::tlm_generic_payload gp;
 
-		gp.set_command(tlm::TLM_WRITE_COMMAND);
-		gp.set_address(t->GetAddress());
-		gp.set_data_ptr(t->GetTLPData());
-		gp.set_data_length(dlen);
-		gp.set_streaming_width(dlen);
-		gp.set_byte_enable_ptr(nullptr);
-		gp.set_byte_enable_length(0);
-		gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-
-		gp.set_extension(genattr);
+		setup_dma_gp(gp, t, tlm::TLM_WRITE_COMMAND, t->GetAddress(),
+				t->GetTLPData(), dlen);
 
 		dma_init_socket->b_transport(gp, delay);
 		wait(delay);
 		delay = SC_ZERO_TIME;
 		assert(gp.get_response_status() == tlm::TLM_OK_RESPONSE);
+
+		gp.clear_extension(&m_dma_genattr);
 		//
 		// Writes are posted
 		//
@@ -1162,7 +1327,7 @@ public:
 			}
 
 			tlp = m_dma_tlps.front();
-			m_dma_tlps.remove(tlp);
+			m_dma_tlps.pop_front();
 
 			if (tlp->IsMemRd()) {
 				ProcessReadDMA(tlp);
@@ -1171,16 +1336,23 @@ public:
 			}
 
 			tlp->DMADoneEvent().notify();
-			delete tlp;
 		}
 	}
 
-	std::list<TLPHdr_Base*> m_tlps;
-	std::list<TLP_Mem*> m_dma_tlps;
+	//
+	// Requests waiting for completion, indexed by tag
+	//
+	OutstandingTLP m_outstanding[NUM_TAGS];
+
+	std::deque<TLP_Mem*> m_dma_tlps;
+	std::vector<TLP_Mem*> m_dma_tlp_pool;
+	genattr_extension m_dma_genattr;
 
 	sc_event m_rx_event;
 	sc_event m_tlp_done_event;
 	sc_event m_dma_event;
+
+	unsigned int m_max_payload_size;
 };
 
 #undef GEN_FIELD_FUNCS
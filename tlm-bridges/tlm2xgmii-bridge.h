@@ -27,6 +27,7 @@
 
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 #include <stdio.h>
+#include "soc/net/ethernet/frame-pool.h"
 
 #define D(x)
 
@@ -36,21 +37,45 @@ class tlm2xgmii_bridge
 public:
 	tlm_utils::simple_target_socket<tlm2xgmii_bridge> tgt_socket;
 
+	//
+	// In frame mode, frames are handed whole to frame_init_socket
+	// (typically bound to the frame_tgt_socket of an xgmii2tlm_bridge)
+	// with the time they would have taken on the wire annotated, and
+	// xxd/xxc are left idle.
+	//
+	tlm_utils::simple_initiator_socket_optional<tlm2xgmii_bridge>
+							frame_init_socket;
+
 	enum xgmii_mode {
 		MODE_10G = 0,
 		MODE_1G = 1,
 	} mode;
 
 	tlm2xgmii_bridge(sc_core::sc_module_name name,
-				enum xgmii_mode mode = MODE_10G);
+				enum xgmii_mode mode = MODE_10G,
+				bool frame_mode = false);
 
 	sc_in<bool> clk;
 	sc_out<sc_bv<64> > xxd;
 	sc_out<sc_bv<8> > xxc;
 private:
 	SC_HAS_PROCESS(tlm2xgmii_bridge);
+	eth_frame_pool& pool;
 	sc_fifo<tlm::tlm_generic_payload*> rxfifo;
 
+	bool frame_mode;
+	sc_time clk_period;
+	// A rising edge of clk, the other ones are clk_period apart.
+	sc_time clk_posedge;
+	// Edge the trailing idle word of the last frame is written on.
+	sc_time link_free;
+
+	unsigned int wire_bytes(unsigned int len);
+	sc_time next_posedge(const sc_time& t);
+	void end_of_elaboration();
+	void b_transport_frame(tlm::tlm_generic_payload& trans,
+					sc_time& delay);
+
 	void push_data_buf(const char *name, unsigned char *buf,
 				int len, uint64_t ctrl);
 
@@ -59,28 +84,118 @@ private:
 		while(true) {
 			tlm::tlm_generic_payload *gp = rxfifo.read();
 			process_packet(gp->get_data_ptr(), gp->get_data_length());
-
-			delete gp->get_data_ptr();
-			delete gp;
+			gp->release();
 		}
 	}
 	virtual void b_transport(tlm::tlm_generic_payload& trans,
 					sc_time& delay);
 };
 
-tlm2xgmii_bridge::tlm2xgmii_bridge(sc_module_name name, enum xgmii_mode mode)
+tlm2xgmii_bridge::tlm2xgmii_bridge(sc_module_name name, enum xgmii_mode mode,
+					bool frame_mode)
 	: sc_module(name),
 	tgt_socket("tgt_socket"),
+	frame_init_socket("frame_init_socket"),
 	mode(mode),
 	clk("clk"),
 	xxd("xxd"),
 	xxc("xxc"),
-	rxfifo("rxfifo", 1)
+	pool(eth_frame_pool::shared()),
+	rxfifo("rxfifo", 1),
+	frame_mode(frame_mode),
+	clk_period(SC_ZERO_TIME),
+	clk_posedge(SC_ZERO_TIME),
+	link_free(SC_ZERO_TIME)
 {
-	SC_THREAD(process_thread);
+	if (!frame_mode) {
+		SC_THREAD(process_thread);
+	}
 	tgt_socket.register_b_transport(this, &tlm2xgmii_bridge::b_transport);
 }
 
+void tlm2xgmii_bridge::end_of_elaboration()
+{
+	sc_clock *c = dynamic_cast<sc_clock *>(clk.get_interface());
+
+	if (!frame_mode) {
+		return;
+	}
+
+	if (frame_init_socket.size() == 0) {
+		SC_REPORT_ERROR(name(), "frame_init_socket not bound");
+	}
+
+	// The delays are derived from the clock the pins would run on.
+	if (c) {
+		clk_period = c->period();
+		clk_posedge = c->start_time();
+		if (!c->posedge_first()) {
+			clk_posedge += clk_period * (1 - c->duty_cycle());
+		}
+	} else {
+		SC_REPORT_WARNING(name(),
+			"clk is not an sc_clock, frames take no time");
+	}
+}
+
+// Bytes process_packet puts on the wire for a frame of len bytes, up to
+// and including the terminate.
+unsigned int tlm2xgmii_bridge::wire_bytes(unsigned int len)
+{
+	// Two idle words, the start/preamble word, the data and the tail
+	// with the FCS and terminate.
+	return 2 * 8 + 8 + (len & ~7) + len % 8 + 4 + 1;
+}
+
+// First rising edge of clk after t, where push_data_buf writes a word
+// handed over at t.
+sc_time tlm2xgmii_bridge::next_posedge(const sc_time& t)
+{
+	sc_time edge = clk_posedge;
+	uint64_t n;
+
+	if (clk_period == SC_ZERO_TIME) {
+		return t;
+	}
+
+	if (t >= edge) {
+		n = (t - edge).value() / clk_period.value() + 1;
+		edge += clk_period * (double) n;
+	}
+	return edge;
+}
+
+void tlm2xgmii_bridge::b_transport_frame(tlm::tlm_generic_payload& trans,
+					sc_time& delay)
+{
+	unsigned int lanes = mode == MODE_10G ? 8 : 1;
+	unsigned int len = trans.get_data_length();
+	unsigned int bytes = wire_bytes(len);
+	unsigned int term_words, words;
+	sc_time start = sc_time_stamp() + delay;
+	sc_time frame_delay;
+
+	// Frames don't overlap on the wire.
+	if (start < link_free) {
+		start = link_free;
+	}
+	start = next_posedge(start);
+
+	// Words (bytes in 1G mode) up to the terminate and in all, with the
+	// padding of the last word and the trailing idle word.
+	term_words = (bytes + lanes - 1) / lanes;
+	words = (((bytes + 7) & ~7U) + 8) / lanes;
+
+	// The receiver samples a word on the edge after the one it was
+	// written on and sees the frame with the terminate, in 1G mode that
+	// is before the end of the padded last word.
+	frame_delay = start + clk_period * term_words;
+	link_free = start + clk_period * (words - 1);
+	frame_delay -= sc_time_stamp();
+
+	frame_init_socket->b_transport(trans, frame_delay);
+}
+
 void tlm2xgmii_bridge::push_data_buf(const char *name, unsigned char *buf,
 					int len, uint64_t ctrl)
 {
@@ -161,12 +276,14 @@ void tlm2xgmii_bridge::process_packet(unsigned char *data, int len)
 void tlm2xgmii_bridge::b_transport(tlm::tlm_generic_payload& trans,
 					sc_time& delay)
 {
-	tlm::tlm_generic_payload *gp = new tlm::tlm_generic_payload();
-	unsigned char *buf = new unsigned char [trans.get_data_length()];
+	if (frame_mode) {
+		b_transport_frame(trans, delay);
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+		return;
+	}
 
-	gp->set_data_ptr(buf);
-	gp->deep_copy_from(trans);
-	rxfifo.write(gp);
+	// Queued by reference when it comes from a frame pool.
+	rxfifo.write(pool.get(trans));
 
 	trans.set_response_status(tlm::TLM_OK_RESPONSE);
 }
@@ -28,6 +28,7 @@
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 #include <stdio.h>
 #include "tlm-extensions/genattr.h"
+#include "soc/net/ethernet/frame-pool.h"
 
 #define D(x)
 
@@ -37,13 +38,19 @@ class xgmii2tlm_bridge
 public:
         tlm_utils::simple_initiator_socket<xgmii2tlm_bridge> init_socket;
 
+	// Whole frames from a tlm2xgmii_bridge in frame mode, xxd/xxc are
+	// not sampled.
+	tlm_utils::simple_target_socket_optional<xgmii2tlm_bridge>
+							frame_tgt_socket;
+
 	enum xgmii_mode {
 		MODE_10G = 0,
 		MODE_1G = 1,
 	} mode;
 
 	xgmii2tlm_bridge(sc_core::sc_module_name name,
-				enum xgmii_mode mode = MODE_10G);
+				enum xgmii_mode mode = MODE_10G,
+				bool frame_mode = false);
 	SC_HAS_PROCESS(xgmii2tlm_bridge);
 
 	sc_in<bool> clk;
@@ -51,28 +58,65 @@ public:
 	sc_in<sc_bv<8> > xxc;
 private:
 	// Max packet size.
-	unsigned char buf[8 * 1024];
+	enum { BUF_SIZE = 8 * 1024 };
+
+	// Idle and start/preamble words as sampled from xxd, lane 0 in the
+	// LSB.
+	static const uint64_t IDLE_WORD = 0x0707070707070707ULL;
+	static const uint64_t SOF_PREAMBLE_WORD = 0xd5555555555555fbULL;
+
+	// Packets are gathered straight into frames of the pool.
+	eth_frame_pool& pool;
+	tlm::tlm_generic_payload *frame;
+	unsigned char *buf;
 	unsigned int len;
 	bool sof_found;
 	bool preamble_55_found;
 	bool preamble_d5_found;
 	sc_time delay;
 
-	void process_byte(tlm::tlm_generic_payload &tr,
-				uint8_t data, bool ctrl);
+	void new_frame(void);
+	void process_byte(uint8_t data, bool ctrl);
+	bool process_word(uint64_t d64, uint8_t c8);
 	void reset(void);
 	void process(void);
+	void b_transport_frame(tlm::tlm_generic_payload& trans,
+					sc_time& delay);
 };
 
-xgmii2tlm_bridge::xgmii2tlm_bridge(sc_module_name name, enum xgmii_mode mode)
+xgmii2tlm_bridge::xgmii2tlm_bridge(sc_module_name name, enum xgmii_mode mode,
+					bool frame_mode)
 	: sc_module(name),
 	init_socket("init_socket"),
+	frame_tgt_socket("frame_tgt_socket"),
 	mode(mode),
 	clk("clk"),
 	xxd("xxd"),
-	xxc("xxc")
+	xxc("xxc"),
+	pool(eth_frame_pool::shared()),
+	frame(NULL),
+	buf(NULL)
+{
+	if (frame_mode) {
+		frame_tgt_socket.register_b_transport(this,
+				&xgmii2tlm_bridge::b_transport_frame);
+	} else {
+		SC_THREAD(process);
+	}
+}
+
+void xgmii2tlm_bridge::b_transport_frame(tlm::tlm_generic_payload& trans,
+					sc_time& delay)
 {
-        SC_THREAD(process);
+	// The sender annotated the time the frame took on the wire.
+	init_socket->b_transport(trans, delay);
+}
+
+void xgmii2tlm_bridge::new_frame(void)
+{
+	frame = pool.alloc(0);
+	eth_frame_pool::attr(frame)->set_posted(true);
+	buf = pool.grow(frame, BUF_SIZE);
 }
 
 void xgmii2tlm_bridge::reset(void)
@@ -85,8 +129,7 @@ void xgmii2tlm_bridge::reset(void)
 	delay = SC_ZERO_TIME;
 }
 
-void xgmii2tlm_bridge::process_byte(tlm::tlm_generic_payload &tr,
-					uint8_t data, bool ctrl)
+void xgmii2tlm_bridge::process_byte(uint8_t data, bool ctrl)
 {
 	D(printf("c=%x %2.2x len=%d\n", ctrl, data, len));
 
@@ -110,10 +153,13 @@ void xgmii2tlm_bridge::process_byte(tlm::tlm_generic_payload &tr,
 			// EOF, emit generic payload.
 			D(printf("phy-tx: proxy to QEMU %d\n",
 						len));
-			tr.set_data_length(len - 4);
-			tr.set_streaming_width(len - 4);
-			tr.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-			init_socket->b_transport(tr, delay);
+			frame->set_data_length(len - 4);
+			frame->set_streaming_width(len - 4);
+			init_socket->b_transport(*frame, delay);
+
+			// The receiver took a reference if it kept the frame.
+			frame->release();
+			new_frame();
 
 			// Start gathering a new packet.
 			reset();
@@ -132,7 +178,7 @@ void xgmii2tlm_bridge::process_byte(tlm::tlm_generic_payload &tr,
 				}
 			}
 		}
-		if (len == sizeof buf) {
+		if (len == BUF_SIZE) {
 			printf("XGMII overrun!\n");
 			reset();
 		}
@@ -140,21 +186,67 @@ void xgmii2tlm_bridge::process_byte(tlm::tlm_generic_payload &tr,
 
 }
 
+//
+// Handles the common 10G words at once, returns false if the word needs to
+// be decoded lane by lane.
+//
+bool xgmii2tlm_bridge::process_word(uint64_t d64, uint8_t c8)
+{
+	unsigned int n;
+
+	// All lanes carry packet data.
+	if (c8 == 0) {
+		if (!preamble_d5_found || len + 8 >= BUF_SIZE) {
+			return false;
+		}
+		memcpy(buf + len, &d64, 8);
+		len += 8;
+		return true;
+	}
+
+	// Idle, nothing to do with or without a packet in progress.
+	if (c8 == 0xff && d64 == IDLE_WORD) {
+		return true;
+	}
+
+	// Start on lane 0 and a complete preamble.
+	if (c8 == 0x01 && d64 == SOF_PREAMBLE_WORD) {
+		sof_found = true;
+		preamble_55_found = true;
+		preamble_d5_found = true;
+		len = 0;
+		return true;
+	}
+
+	// Data up to the first control lane (e.g the terminate), the rest
+	// of the word goes lane by lane.
+	if (preamble_d5_found) {
+		n = __builtin_ctz(c8);
+		if (n && len + n < BUF_SIZE) {
+			memcpy(buf + len, &d64, n);
+			len += n;
+			d64 >>= n * 8;
+			c8 >>= n;
+		} else {
+			n = 0;
+		}
+
+		for (; n < 8; n++) {
+			process_byte((uint8_t) d64, c8 & 1);
+			d64 >>= 8;
+			c8 >>= 1;
+		}
+		return true;
+	}
+
+	return false;
+}
+
 void xgmii2tlm_bridge::process(void) {
 	int lanes = mode == MODE_10G ? 8 : 1;
-	tlm::tlm_generic_payload tr;
-	genattr_extension *genattr;
 	int l;
 
-	genattr = new(genattr_extension);
-	genattr->set_eop(true);
-	genattr->set_posted(true);
-
-	tr.set_extension(genattr);
-	tr.set_command(tlm::TLM_WRITE_COMMAND);
-	tr.set_address(0);
-	tr.set_data_ptr(buf);
-	tr.set_dmi_allowed(false);
+	new_frame();
 
 	// Reset the packet gathering state.
 	reset();
@@ -166,10 +258,8 @@ void xgmii2tlm_bridge::process(void) {
 		d64 = xxd.read().to_uint64();
 		c8 = xxc.read().to_uint64();
 
-		// Fast path, all lanes carry packet data.
-		if (mode == MODE_10G && preamble_d5_found && c8 == 0) {
-			memcpy(buf + len, &d64, 8);
-			len += 8;
+		// Fast path, whole words.
+		if (mode == MODE_10G && process_word(d64, c8)) {
 			continue;
 		}
 
@@ -179,11 +269,9 @@ void xgmii2tlm_bridge::process(void) {
 
 			d8 = d64 >> l * 8;
 			c1 = c8 & (1 << l);
-			process_byte(tr, d8, c1);
+			process_byte(d8, c1);
 		}
 	}
-
-	tr.release_extension(genattr);
 }
 #undef D
 #endif
@@ -115,10 +115,10 @@ public:
 					  StashNIDValid_Endian,
 					  bool)
 
-	CHIATTR_PROP_GETSET_GEN(TxnID, uint8_t)
-	CHIATTR_PROP_GETSET_GEN(ReturnTxnID, uint8_t)
-	CHIATTR_PROP_GETSET_GEN(FwdTxnID, uint8_t)
-	CHIATTR_PROP_GETSET_GEN(DBID, uint8_t)
+	CHIATTR_PROP_GETSET_GEN(TxnID, uint16_t)
+	CHIATTR_PROP_GETSET_GEN(ReturnTxnID, uint16_t)
+	CHIATTR_PROP_GETSET_GEN(FwdTxnID, uint16_t)
+	CHIATTR_PROP_GETSET_GEN(DBID, uint16_t)
 	CHIATTR_PROP_GETSET_GEN(Opcode, uint8_t)
 
 	CHIATTR_PROP_GETSET_GEN(secure, bool);
@@ -216,7 +216,7 @@ private:
 	bool StashNIDValid_Endian;
 
 	// The transaction id.
-	uint8_t TxnID;
+	uint16_t TxnID;
 
 	//
 	// The transaction id a slave must use in TxnID field in a CompData,
@@ -232,14 +232,14 @@ private:
 	//
 	// [7:6]: 0b00
 	//
-	uint8_t ReturnTxnID;
+	uint16_t ReturnTxnID;
 
 	// Identifies the TxnID of the original request associated with the
 	// snoop transaction.
-	uint8_t FwdTxnID;
+	uint16_t FwdTxnID;
 
 	// The data buffer identifier.
-	uint8_t DBID;
+	uint16_t DBID;
 
 	// The transaction opcode.
 	uint8_t Opcode;
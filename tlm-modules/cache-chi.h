@@ -40,18 +40,23 @@
 #include "tlm-modules/private/chi/txnids.h"
 #include "tlm-modules/private/chi/cacheline.h"
 #include "tlm-modules/private/chi/txns-rn.h"
+#include "tlm-modules/private/chi/prefetcher.h"
 
 using namespace AMBA::CHI;
 
 template<
 	int NODE_ID,
 	int CACHE_SZ,
-	int ICN_ID = 20>
+	int ICN_ID = 20,
+	int TXNID_WIDTH = Req::TxnID_Width>
 class cache_chi :
 	public sc_core::sc_module
 {
 private:
-	enum { NUM_CACHELINES = CACHE_SZ / CACHELINE_SZ };
+	enum {
+		NUM_CACHELINES = CACHE_SZ / CACHELINE_SZ,
+		NUM_TXNIDS = 1 << TXNID_WIDTH,
+	};
 
 	typedef RN::CacheLine CacheLine;
 	typedef RN::ITxn<NODE_ID, ICN_ID> ITxn;
@@ -60,6 +65,8 @@ private:
 	typedef RN::WriteTxn<NODE_ID, ICN_ID> WriteTxn;
 	typedef RN::AtomicTxn<NODE_ID, ICN_ID> AtomicTxn;
 	typedef RN::DVMOpTxn<NODE_ID, ICN_ID> DVMOpTxn;
+	typedef RN::PrefetchTgtTxn<NODE_ID, ICN_ID> PrefetchTgtTxn;
+	typedef RN::Prefetcher Prefetcher;
 	typedef RN::SnpRespTxn<NODE_ID, ICN_ID> SnpRespTxn;
 
 	class ITransmitter
@@ -210,9 +217,19 @@ private:
 			m_ids(ids),
 			m_txn(txn),
 			m_randomize(false),
-			m_seed(0)
+			m_seed(0),
+			m_prefetchAttr(new chiattr_extension())
 		{
 			memset(m_receivedDVM, 0, sizeof(m_receivedDVM));
+
+			//
+			// Prefetched lines are cacheable and allocating
+			//
+			m_prefetchAttr->SetCacheable(true);
+			m_prefetchAttr->SetAllocate(true);
+
+			// Takes ownership of the ptr
+			m_prefetchGP.set_extension(m_prefetchAttr);
 		}
 
 		virtual ~ICache()
@@ -268,19 +285,8 @@ private:
 				len = max_len;
 			}
 
-			if (be_len) {
-				unsigned int i;
-
-				for (i = 0; i < len; i++, pos++) {
-					bool do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-
-					if (do_access) {
-						data[i] = lineData[line_offset + i];
-					}
-				}
-			} else {
-				memcpy(data, &lineData[line_offset], len);
-			}
+			bytecopy_be(data, &lineData[line_offset], len,
+					be, be_len, pos);
 
 			return len;
 		}
@@ -716,6 +722,92 @@ private:
 			m_txn[t.GetTxnID()] = NULL;
 		}
 
+		void PrefetchTgt(tlm::tlm_generic_payload& gp,
+					uint64_t addr)
+		{
+			PrefetchTgtTxn t(gp, get_tag(addr), m_ids);
+
+			//
+			// No response is expected so the txn is not
+			// registered in m_txn
+			//
+			m_txReqChannel.Process(t);
+		}
+
+		//
+		// Feed a demand access into the prefetch engine. Device
+		// memory and exclusive accesses are not used for training.
+		//
+		void TrainPrefetcher(tlm::tlm_generic_payload& gp,
+					uint64_t addr, bool miss)
+		{
+			chiattr_extension *attr;
+			bool nonSecure = true;
+			uint8_t lpid = 0;
+			uint8_t qos = 0;
+
+			if (!m_prefetcher.GetEnabled()) {
+				return;
+			}
+
+			gp.get_extension(attr);
+			if (attr) {
+				if (attr->GetDeviceMemory() || attr->GetExcl()) {
+					return;
+				}
+				nonSecure = attr->GetNonSecure();
+				lpid = attr->GetLPID();
+				qos = attr->GetQoS();
+			}
+
+			m_prefetcher.Train(lpid, align_address(addr), miss,
+						nonSecure, qos);
+		}
+
+		//
+		// Issue a prefetch for a candidate from the prefetch engine.
+		// Lines already in the cache are skipped and dirty lines are
+		// never written back to make room for a speculative fill.
+		//
+		void Prefetch(const Prefetcher::Candidate& c)
+		{
+			uint64_t addr = c.GetAddress();
+			bool nonSecure = c.GetNonSecure();
+			CacheLine *l = get_line(addr);
+
+			if (InCache(addr, nonSecure)) {
+				return;
+			}
+
+			m_prefetchAttr->SetNonSecure(nonSecure);
+			m_prefetchAttr->SetQoS(c.GetQoS());
+
+			switch (m_prefetcher.GetOpcode()) {
+			case Req::PrefetchTgt:
+				PrefetchTgt(m_prefetchGP, addr);
+				m_prefetcher.Issued(addr, false);
+				return;
+			case Req::ReadClean:
+				if (l->IsValid() && l->GetDirty()) {
+					return;
+				}
+				ReadClean(m_prefetchGP, addr);
+				break;
+			case Req::ReadShared:
+			default:
+				if (l->IsValid() && l->GetDirty()) {
+					return;
+				}
+				ReadShared(m_prefetchGP, addr);
+				break;
+			}
+
+			m_prefetcher.Issued(get_tag(addr),
+						InCache(addr, nonSecure));
+		}
+
+		Prefetcher& GetPrefetcher() { return m_prefetcher; }
+
 		//
 		// See 4.7.6 [1]
 		//
@@ -728,7 +820,7 @@ private:
 			CacheLine *l = get_line(gp.get_address());
 
 			if (chiattr->GetOpcode() == Snp::SnpDVMOp) {
-				uint8_t txnID = chiattr->GetTxnID();
+				uint16_t txnID = chiattr->GetTxnID();
 
 				//
 				// Check if the other packet to this DVM
@@ -1864,7 +1956,11 @@ private:
 		unsigned int m_seed;
 
 		LPExclusiveMonitor m_monitor;
-		bool m_receivedDVM[TxnIDs::NumIDs];
+		bool m_receivedDVM[NUM_TXNIDS];
+
+		Prefetcher m_prefetcher;
+		tlm::tlm_generic_payload m_prefetchGP;
+		chiattr_extension *m_prefetchAttr;
 	};
 
 	class CacheWriteBack : public ICache
@@ -1909,11 +2005,16 @@ private:
 			while (pos < len) {
 				if (this->InCache(addr, nonSecure, true)) {
 					unsigned int n = this->ReadLine(gp, pos);
+
+					this->TrainPrefetcher(gp, addr, false);
+
 					pos+=n;
 					addr+=n;
 				} else {
 					int randomInt = this->GetRandomInt(6);
 
+					this->TrainPrefetcher(gp, addr, true);
+
 					//
 					// Randomize between different reads if not
 					// exclusive. Exclusive loads always use
@@ -2311,6 +2412,31 @@ private:
 		gp.set_response_status(tlm::TLM_OK_RESPONSE);
 	}
 
+	//
+	// Prefetches are issued in between the demand accesses
+	//
+	void prefetch_thread()
+	{
+		Prefetcher& prefetcher = m_cache->GetPrefetcher();
+
+		while (true) {
+			Prefetcher::Candidate c;
+
+			if (!prefetcher.HasCandidates()) {
+				wait(m_prefetchEvent);
+				continue;
+			}
+
+			m_mutex.lock();
+
+			if (prefetcher.GetCandidate(c)) {
+				m_cache->Prefetch(c);
+			}
+
+			m_mutex.unlock();
+		}
+	}
+
 	virtual void b_transport(tlm::tlm_generic_payload& trans,
 				sc_time& delay)
 	{
@@ -2338,6 +2464,10 @@ private:
 		}
 
 		m_mutex.unlock();
+
+		if (m_cache->GetPrefetcher().HasCandidates()) {
+			m_prefetchEvent.notify();
+		}
 	}
 
 
@@ -2349,9 +2479,10 @@ private:
 
 	TxnIDs  m_ids;
 	ICache *m_cache;
-	ITxn   *m_txn[TxnIDs::NumIDs];
+	ITxn   *m_txn[NUM_TXNIDS];
 
 	sc_mutex m_mutex;
+	sc_event m_prefetchEvent;
 
 	std::vector<NonShareableRegion> m_regions;
 
@@ -2376,6 +2507,7 @@ public:
 		m_txRspChannel("TxRspChannel", txrsp_init_socket),
 		m_txDatChannel("TxDatChannel", txdat_init_socket),
 		m_transmitter(m_txRspChannel, m_txDatChannel),
+		m_ids(TXNID_WIDTH),
 
 		target_socket("target_socket"),
 
@@ -2407,6 +2539,8 @@ public:
 					&cache_chi::b_transport_rxdat);
 		rxsnp_tgt_socket.register_b_transport(this,
 					&cache_chi::b_transport_rxsnp);
+
+		SC_THREAD(prefetch_thread);
 	}
 
 	~cache_chi()
@@ -2423,6 +2557,38 @@ public:
 	{
 		AddNonShareableRegion(start, len);
 	}
+
+	//
+	// Prefetch engine configuration. Degree is the number of lines
+	// prefetched per trigger and distance how many strides ahead of
+	// the demand stream the first prefetch is placed. When throttling
+	// is enabled the degree is lowered (and raised back up to the
+	// configured degree) depending on the prefetch accuracy. The
+	// opcode is one of ReadShared, ReadClean or PrefetchTgt.
+	//
+	void EnablePrefetch(bool val) { m_cache->GetPrefetcher().SetEnabled(val); }
+
+	void SetPrefetchDegree(unsigned int degree)
+	{
+		m_cache->GetPrefetcher().SetDegree(degree);
+	}
+
+	void SetPrefetchDistance(unsigned int distance)
+	{
+		m_cache->GetPrefetcher().SetDistance(distance);
+	}
+
+	void SetPrefetchThrottle(bool val)
+	{
+		m_cache->GetPrefetcher().SetThrottle(val);
+	}
+
+	void SetPrefetchOpcode(uint8_t opcode)
+	{
+		m_cache->GetPrefetcher().SetOpcode(opcode);
+	}
+
+	RN::Prefetcher& GetPrefetcher() { return m_cache->GetPrefetcher(); }
 };
 
 #endif /* TLM_MODULES_CACHE_CHI_H__ */
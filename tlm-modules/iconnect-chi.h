@@ -55,14 +55,14 @@ private:
 	class SnpTxnTracker
 	{
 	public:
-		SnpTxnTracker(uint8_t txnID) :
+		SnpTxnTracker(uint16_t txnID) :
 			m_txnID(txnID),
 			m_resp(0),
 			m_done(false),
 			m_dataReceived(0)
 		{}
 
-		uint8_t GetTxnID() { return m_txnID; }
+		uint16_t GetTxnID() { return m_txnID; }
 
 		void ReceivedBytes(unsigned int n)
 		{
@@ -96,7 +96,7 @@ private:
 		}
 
 	private:
-		uint8_t m_txnID;
+		uint16_t m_txnID;
 		uint8_t m_resp;
 		bool m_done;
 		unsigned int m_dataReceived;
@@ -141,12 +141,12 @@ private:
 		}
 		chiattr_extension *GetCHIAttr() { return m_chiattr; }
 
-		uint8_t GetTxnID() { return m_chiattr->GetTxnID(); }
+		uint16_t GetTxnID() { return m_chiattr->GetTxnID(); }
 		uint16_t GetSrcID() { return m_chiattr->GetSrcID(); }
 		uint16_t GetTgtID() { return m_chiattr->GetTgtID(); }
 
-		uint8_t GetDBID() { return m_chiattr->GetDBID(); }
-		void SetDBID(uint8_t DBID)
+		uint16_t GetDBID() { return m_chiattr->GetDBID(); }
+		void SetDBID(uint16_t DBID)
 		{
 			m_chiattr->SetDBID(DBID);
 		}
@@ -218,7 +218,7 @@ private:
 		//
 		// Used when building SN requests
 		//
-		ReqTxn(ReqTxn *req, uint8_t opcode, uint8_t txnID) :
+		ReqTxn(ReqTxn *req, uint8_t opcode, uint16_t txnID) :
 			m_waitingForReadReceipt(false),
 			m_waitingForCompAck(false),
 			m_gotRetryAck(false),
@@ -608,7 +608,7 @@ private:
 		bool IsOrdered() { return m_chiattr->GetOrder() > 1; };
 		uint8_t GetOrder() { return m_chiattr->GetOrder(); }
 
-		void WaitForSnpTxn(uint8_t txnID)
+		void WaitForSnpTxn(uint16_t txnID)
 		{
 			SnpTxnTracker tracker(txnID);
 
@@ -674,7 +674,7 @@ private:
 			}
 		}
 
-		bool AllSnpDataReceived(uint8_t txnID)
+		bool AllSnpDataReceived(uint16_t txnID)
 		{
 			SnpTxnTracker *tracker = GetSnpTxnTracker(txnID);
 
@@ -933,7 +933,7 @@ private:
 			return len;
 		}
 
-		SnpTxnTracker *GetSnpTxnTracker(uint8_t txnID)
+		SnpTxnTracker *GetSnpTxnTracker(uint16_t txnID)
 		{
 			typename std::vector<SnpTxnTracker>::iterator it;
 
@@ -1161,7 +1161,7 @@ private:
 		//
 		// This is called for slave node DatMsgs.
 		//
-		DatMsg(ReqTxn *req, uint8_t opcode, uint8_t txnID)
+		DatMsg(ReqTxn *req, uint8_t opcode, uint16_t txnID)
 		{
 			tlm::tlm_generic_payload& gp = req->GetGP();
 			chiattr_extension *attr = req->GetCHIAttr();
@@ -1270,7 +1270,7 @@ private:
 		//
 		// SnpMsg Construction
 		//
-		SnpMsg(ReqTxn *req, uint8_t txnID, bool allowsSnpFwd)
+		SnpMsg(ReqTxn *req, uint16_t txnID, bool allowsSnpFwd)
 		{
 			tlm::tlm_generic_payload& gp = req->GetGP();
 			chiattr_extension *attr = req->GetCHIAttr();
@@ -2443,7 +2443,7 @@ private:
 						// aswell as other CopyBack
 						// that returned without
 						// passing dirty data
-						uint8_t txnID = dat.GetTxnID();
+						uint16_t txnID = dat.GetTxnID();
 
 						m_ids->ReturnID(txnID);
 						m_ongoingTxn[txnID] = NULL;
@@ -2486,7 +2486,7 @@ private:
 
 						m_port_SN[0]->Transmit(wrReq);
 					} else {
-						uint8_t txnID = dat.GetTxnID();
+						uint16_t txnID = dat.GetTxnID();
 
 						//
 						// Return the ID since new ones
@@ -2589,7 +2589,7 @@ private:
 				// time marking that both RetryAck & PCrdGrant
 				// have been received is enough.
 				//
-				uint8_t txnID = rsp.GetTxnID();
+				uint16_t txnID = rsp.GetTxnID();
 				ReqTxn *req = m_ongoingTxn[txnID];
 				chiattr_extension *attr = rsp.GetCHIAttr();
 
@@ -2607,7 +2607,7 @@ private:
 				}
 
 			} else if (rsp.IsCompDBIDResp() || rsp.IsDBIDResp()) {
-				uint8_t txnID = rsp.GetTxnID();
+				uint16_t txnID = rsp.GetTxnID();
 				ReqTxn *req = m_ongoingTxn[txnID];
 				DatMsg *dat = new DatMsg(req, Dat::NonCopyBackWrData,
 								rsp.GetDBID());
@@ -2655,7 +2655,7 @@ private:
 					}
 				}
 			} else if (rsp.IsComp()) {
-				uint8_t txnID = rsp.GetTxnID();
+				uint16_t txnID = rsp.GetTxnID();
 				ReqTxn *req = m_ongoingTxn[txnID];
 
 				req->SetCompSNReceived(true);
@@ -2696,7 +2696,7 @@ private:
 					}
 				}
 			} else if (rsp.IsReadReceipt()) {
-				uint8_t txnID = rsp.GetTxnID();
+				uint16_t txnID = rsp.GetTxnID();
 				ReqTxn *req = m_ongoingTxn[txnID];
 
 				assert(req);
@@ -2895,7 +2895,7 @@ private:
 				Port_RN_F *port = m_port_RN_F[i];
 
 				if (port->GetNodeID() != req->GetSrcID()) {
-					uint8_t txnID = m_ids->GetID();
+					uint16_t txnID = m_ids->GetID();
 					SnpMsg *dvmSnp0 = new SnpMsg(req, txnID, false);
 					SnpMsg *dvmSnp1 = new SnpMsg(req, txnID, true);
 
@@ -3430,6 +3430,14 @@ private:
 	};
 
 	RequestOrderer m_reqOrderer;
+
+	//
+	// The TxnIDs of the requests (up to TxnIDs::MaxWidth bits) are
+	// carried through untouched. The interconnect's own IDs (DBIDs
+	// handed out to the RN-Fs and the TxnIDs towards the SN and for
+	// snoops) are allocated with the Req::TxnID_Width bits of the pin
+	// level interfaces and index m_ongoingTxn.
+	//
 	TxnIDs m_ids;
 	ReqTxn *m_ongoingTxn[TxnIDs::NumIDs];
 
@@ -29,7 +29,12 @@
 #ifndef TLM_MODULES_PRIV_CCIX_CCIXPORT_H__
 #define TLM_MODULES_PRIV_CCIX_CCIXPORT_H__
 
+#include <list>
+#include <vector>
+#include <unordered_map>
+
 #include "tlm-modules/private/chi/txnids.h"
+#include "tlm-modules/private/ccix/txnpool.h"
 #include "tlm-extensions/ccixattr.h"
 #include "tlm-bridges/ccix.h"
 
@@ -64,6 +69,16 @@ private:
 		uint16_t GetSrcID() { return m_SrcID; }
 		uint16_t GetTxnID() { return m_TxnID; }
 
+		//
+		// Key used in the transaction tables
+		//
+		uint32_t GetKey() { return ToKey(m_SrcID, m_TxnID); }
+
+		static uint32_t ToKey(uint16_t SrcID, uint16_t TxnID)
+		{
+			return (static_cast<uint32_t>(SrcID) << 16) | TxnID;
+		}
+
                 friend bool operator==(const CCIXID& lhs, const CCIXID& rhs)
                 {
                         return lhs.m_SrcID == rhs.m_SrcID &&
@@ -228,8 +243,8 @@ private:
 		uint16_t GetSrcID() { return m_chiattr->GetSrcID(); }
 		uint16_t GetTgtID() { return m_chiattr->GetTgtID(); }
 
-		uint8_t GetDBID() { return m_chiattr->GetDBID(); }
-		void SetDBID(uint8_t DBID)
+		uint16_t GetDBID() { return m_chiattr->GetDBID(); }
+		void SetDBID(uint16_t DBID)
 		{
 			m_chiattr->SetDBID(DBID);
 		}
@@ -399,6 +414,16 @@ private:
 			AddData(req, dat);
 		}
 
+		static void *operator new(size_t sz)
+		{
+			return TxnPool<CCIXReq>::Alloc(sz);
+		}
+
+		static void operator delete(void *p, size_t sz)
+		{
+			TxnPool<CCIXReq>::Free(p, sz);
+		}
+
 		tlm::tlm_generic_payload* GetDatGP() { return &m_datGP; }
 
 		chiattr_extension *GetDatAttr(RspMsg& rsp)
@@ -1879,6 +1904,16 @@ private:
 			chi2ccix(agent, req, msg);
 		}
 
+		static void *operator new(size_t sz)
+		{
+			return TxnPool<CCIXSnpReq>::Alloc(sz);
+		}
+
+		static void operator delete(void *p, size_t sz)
+		{
+			TxnPool<CCIXSnpReq>::Free(p, sz);
+		}
+
 	private:
 		//
 		// Address was copied at ITxn construction
@@ -2844,6 +2879,9 @@ private:
 		uint8_t m_TgtID;
 	};
 
+	typedef std::unordered_map<uint32_t, CCIXReq*> CCIXReqMap;
+	typedef std::unordered_map<uint32_t, CCIXSnpReq*> CCIXSnpReqMap;
+
 	virtual void b_transport_rxlink(tlm::tlm_generic_payload& trans,
 					sc_time& delay)
 	{
@@ -2870,7 +2908,9 @@ private:
 
 		m_reqOrderer->ProcessReq(req);
 
-		m_ccix_HN.push_back(ccixReq);
+		m_ccix_HN[ccixReq->GetCCIXID().GetKey()] = ccixReq;
+		m_ccix_HN_by_CHI_TxnID[CCIXID::ToKey(ccixReq->GetSrcID(),
+					ccixReq->GetCHITxnID())] = ccixReq;
 	}
 
 	void Receive_CCIXResp(tlm::tlm_generic_payload& gp,
@@ -2915,7 +2955,7 @@ private:
 					//
 					// Keep track of DBID
 					//
-					ccixReq->SetDBID(dat->GetDBID());
+					SetDBID_RN(ccixReq, dat->GetDBID());
 				} else {
 					//
 					// CCIX Atomic non stores ends here and
@@ -2968,7 +3008,8 @@ private:
 						//
 						// Keep track of DBID
 						//
-						ccixReq->SetDBID(rsp.GetDBID());
+						SetDBID_RN(ccixReq,
+							rsp.GetDBID());
 					}
 
 					//
@@ -3011,7 +3052,8 @@ private:
 
 		m_router->RouteSnpReq(msg);
 
-		m_ccix_RN_SnpReq.push_back(ccixSnp);
+		m_ccix_RN_SnpReq[CCIXID::ToKey(ccixSnp->GetSrcID(),
+					chiTxnID)] = ccixSnp;
 	}
 
 	void Receive_CCIXSnpResp(tlm::tlm_generic_payload& gp,
@@ -3104,6 +3146,7 @@ private:
 		while (true) {
 			sc_time delay(SC_ZERO_TIME);
 			CCIXReq *ccixReq;
+			uint32_t key;
 
 			if (m_ccix_RN.empty()) {
 				wait(m_pushEvent);
@@ -3112,31 +3155,33 @@ private:
 			ccixReq = m_ccix_RN.front();
 			assert(ccixReq);
 
-			m_ccix_RN.remove(ccixReq);
-			m_ccix_RN_ongoing.push_back(ccixReq);
+			m_ccix_RN.pop_front();
+
+			key = ccixReq->GetCCIXID().GetKey();
+			m_ccix_RN_ongoing[key] = ccixReq;
 
 			m_ccixLink.Transmit(ccixReq);
 
 			//
 			// One at a time
 			//
-			if (Ongoing(ccixReq)) {
+			if (Ongoing(key, ccixReq)) {
 				wait(m_removeEvent);
 			}
 		}
 	}
 
-	bool Ongoing(CCIXReq *ccixReq)
+	//
+	// ccixReq might have been completed (and deleted) during the
+	// transmit so it is not dereferenced here.
+	//
+	bool Ongoing(uint32_t key, CCIXReq *ccixReq)
 	{
-		typename std::list<CCIXReq*>::iterator it;
-		for (it = m_ccix_RN_ongoing.begin();
-			it != m_ccix_RN_ongoing.end(); it++) {
+		typename CCIXReqMap::iterator it;
 
-			if ((*it) == ccixReq) {
-				return true;
-			}
-		}
-		return false;
+		it = m_ccix_RN_ongoing.find(key);
+
+		return it != m_ccix_RN_ongoing.end() && it->second == ccixReq;
 	}
 
 	void RN_Transmit_CCIXReq(CCIXReq *ccixReq)
@@ -3146,62 +3191,50 @@ private:
 		m_pushEvent.notify();
 	}
 
-	CCIXReq *GetCCIXReq(CCIXID& id, std::list<CCIXReq*>& l)
+	template<typename T>
+	T *Lookup(uint32_t key, std::unordered_map<uint32_t, T*>& m)
 	{
-		typename std::list<CCIXReq*>::iterator it;
+		typename std::unordered_map<uint32_t, T*>::iterator it;
 
-		for (it = l.begin(); it != l.end(); it++) {
-			CCIXReq *ccixReq = (*it);
-
-			if (ccixReq->GetCCIXID() == id) {
-				return ccixReq;
-			}
+		it = m.find(key);
+		if (it != m.end()) {
+			return it->second;
 		}
 		return NULL;
 	}
 
-	CCIXSnpReq *GetCCIXSnpReq(CCIXID& id, std::list<CCIXSnpReq*>& l)
+	CCIXReq *GetCCIXReq(CCIXID& id, CCIXReqMap& m)
 	{
-		typename std::list<CCIXSnpReq*>::iterator it;
-
-		for (it = l.begin(); it != l.end(); it++) {
-			CCIXSnpReq *snpReq = (*it);
-
-			if (snpReq->GetSrcID() == id.GetSrcID() &&
-				snpReq->GetCHITxnID() == id.GetTxnID()) {
-				return snpReq;
-			}
-		}
-		return NULL;
+		return Lookup(id.GetKey(), m);
 	}
 
-	CCIXReq *GetCCIXReq_by_CHI_TxnID(CCIXID& id, std::list<CCIXReq*>& l)
+	//
+	// id contains the CHI SrcID and TxnID
+	//
+	CCIXSnpReq *GetCCIXSnpReq(CCIXID& id)
 	{
-		typename std::list<CCIXReq*>::iterator it;
+		return Lookup(id.GetKey(), m_ccix_RN_SnpReq);
+	}
 
-		for (it = l.begin(); it != l.end(); it++) {
-			CCIXReq *ccixReq = (*it);
+	CCIXReq *GetCCIXReq_by_CHI_TxnID(CCIXID& id)
+	{
+		return Lookup(id.GetKey(), m_ccix_HN_by_CHI_TxnID);
+	}
 
-			if (ccixReq->GetSrcID() == id.GetSrcID() &&
-				ccixReq->GetCHITxnID() == id.GetTxnID()) {
-				return ccixReq;
-			}
+	CCIXReq *GetCCIXReq_by_DBID(uint16_t DBID)
+	{
+		if (DBID < m_ccix_RN_by_DBID.size()) {
+			return m_ccix_RN_by_DBID[DBID];
 		}
 		return NULL;
 	}
 
-	CCIXReq *GetCCIXReq_by_DBID(uint8_t DBID, std::list<CCIXReq*>& l)
+	void SetDBID_RN(CCIXReq *ccixReq, uint16_t DBID)
 	{
-		typename std::list<CCIXReq*>::iterator it;
-
-		for (it = l.begin(); it != l.end(); it++) {
-			CCIXReq *ccixReq = (*it);
+		ccixReq->SetDBID(DBID);
 
-			if (ccixReq->GetDBID() == DBID) {
-				return ccixReq;
-			}
-		}
-		return NULL;
+		assert(DBID < m_ccix_RN_by_DBID.size());
+		m_ccix_RN_by_DBID[DBID] = ccixReq;
 	}
 
 	void CHI_RequestDone(ReqTxn* req)
@@ -3211,7 +3244,14 @@ private:
 
 	void CCIXReq_Done_RN(CCIXReq *ccixReq)
 	{
-		m_ccix_RN_ongoing.remove(ccixReq);
+		uint16_t DBID = ccixReq->GetDBID();
+
+		if (DBID < m_ccix_RN_by_DBID.size() &&
+			m_ccix_RN_by_DBID[DBID] == ccixReq) {
+			m_ccix_RN_by_DBID[DBID] = NULL;
+		}
+
+		m_ccix_RN_ongoing.erase(ccixReq->GetCCIXID().GetKey());
 		delete ccixReq;
 		m_removeEvent.notify();
 	}
@@ -3219,17 +3259,33 @@ private:
 	void CCIXReq_Done_HN(CCIXReq *ccixReq, bool hasData)
 	{
 		m_ccixLink.ReturnCHIReqID(ccixReq->GetCHITxnID(), hasData);
-		m_ccix_HN.remove(ccixReq);
+		m_ccix_HN.erase(ccixReq->GetCCIXID().GetKey());
+		m_ccix_HN_by_CHI_TxnID.erase(
+			CCIXID::ToKey(ccixReq->GetSrcID(),
+					ccixReq->GetCHITxnID()));
 		delete ccixReq;
 	}
 
 	void CCIXSnpReq_Done_RN(CCIXSnpReq *ccixSnp)
 	{
 		m_ccixLink.ReturnCHISnpReqID(ccixSnp->GetCHITxnID());
-		m_ccix_RN_SnpReq.remove(ccixSnp);
+		m_ccix_RN_SnpReq.erase(
+			CCIXID::ToKey(ccixSnp->GetSrcID(),
+					ccixSnp->GetCHITxnID()));
 		delete ccixSnp;
 	}
 
+	CCIXAgent *GetAgent(uint16_t id)
+	{
+		std::unordered_map<uint16_t, unsigned int>::iterator it;
+
+		it = m_agentIdx.find(id);
+		if (it != m_agentIdx.end()) {
+			return &m_agents[it->second];
+		}
+		return NULL;
+	}
+
 	IPacketRouter *m_router;
 	RequestOrderer *m_reqOrderer;
 	TxnIDs *m_ids;
@@ -3244,21 +3300,28 @@ private:
 	CCIXLink m_ccixLink;
 
 	//
-	// Tracks remote CCIX agents
+	// Tracks remote CCIX agents (m_agentIdx maps the agent ID to the
+	// index in m_agents)
 	//
 	std::vector<CCIXAgent> m_agents;
+	std::unordered_map<uint16_t, unsigned int> m_agentIdx;
 
 	//
-	// HN side CCIX txns
+	// HN side CCIX txns, indexed on the CCIX SrcID / TxnID and on the
+	// CHI SrcID / TxnID
 	//
-	std::list<CCIXReq*> m_ccix_HN;
+	CCIXReqMap m_ccix_HN;
+	CCIXReqMap m_ccix_HN_by_CHI_TxnID;
 
 	//
-	// RN side CCIX txns
+	// RN side CCIX txns, ongoing txns are indexed on the CCIX SrcID /
+	// TxnID and on the CHI DBID (when used). Snoop requests are
+	// indexed on the CHI SrcID / TxnID.
 	//
 	std::list<CCIXReq*> m_ccix_RN;
-	std::list<CCIXReq*> m_ccix_RN_ongoing;
-	std::list<CCIXSnpReq*> m_ccix_RN_SnpReq;
+	CCIXReqMap m_ccix_RN_ongoing;
+	std::vector<CCIXReq*> m_ccix_RN_by_DBID;
+	CCIXSnpReqMap m_ccix_RN_SnpReq;
 
 public:
 	tlm_utils::simple_initiator_socket<CCIXPort> txlink_init_socket;
@@ -3281,6 +3344,8 @@ public:
 
 		m_ccixLink("ccix_link", SrcID, txlink_init_socket),
 
+		m_ccix_RN_by_DBID(ids->GetNumIDs()),
+
 		txlink_init_socket("txlink_init_socket"),
 		rxlink_tgt_socket("rxlink_tgt_socket")
 
@@ -3288,9 +3353,18 @@ public:
 		rxlink_tgt_socket.register_b_transport(
 				this, &CCIXPort::b_transport_rxlink);
 
+		TxnPool<CCIXReq>::AddUser();
+		TxnPool<CCIXSnpReq>::AddUser();
+
 		SC_THREAD(req_ordering_thread);
 	}
 
+	~CCIXPort()
+	{
+		TxnPool<CCIXReq>::RemoveUser();
+		TxnPool<CCIXSnpReq>::RemoveUser();
+	}
+
 	void ProcessReq(ReqTxn *req)
 	{
 		//
@@ -3372,8 +3446,7 @@ public:
 			//
 			CCIXID id(dat.GetTgtID(), dat.GetTxnID());
 
-			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(
-						id, m_ccix_HN);
+			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(id);
 
 			assert(ccixReq);
 			if (ccixReq) {
@@ -3480,8 +3553,7 @@ public:
 			//
 			CCIXID id(dat.GetTgtID(), dat.GetTxnID());
 
-			CCIXSnpReq *ccixSnp = GetCCIXSnpReq(id,
-						m_ccix_RN_SnpReq);
+			CCIXSnpReq *ccixSnp = GetCCIXSnpReq(id);
 
 			CCIXSnpResp ccixSnpRsp(dat);
 
@@ -3533,8 +3605,7 @@ public:
 				return;
 			}
 
-			ccixReq = GetCCIXReq_by_DBID(rsp.GetTxnID(),
-							m_ccix_RN_ongoing);
+			ccixReq = GetCCIXReq_by_DBID(rsp.GetTxnID());
 
 			assert(ccixReq);
 			if (ccixReq) {
@@ -3571,8 +3642,7 @@ public:
 			//
 			CCIXID id(rsp.GetTgtID(), rsp.GetTxnID());
 
-			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(
-							id, m_ccix_HN);
+			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(id);
 
 			assert(ccixReq);
 			if (ccixReq) {
@@ -3617,8 +3687,7 @@ public:
 			//
 			CCIXID id(rsp.GetTgtID(), rsp.GetTxnID());
 
-			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(
-							id, m_ccix_HN);
+			CCIXReq *ccixReq = GetCCIXReq_by_CHI_TxnID(id);
 
 			assert(ccixReq);
 			if (ccixReq) {
@@ -3657,8 +3726,7 @@ public:
 			//
 			CCIXID id(rsp.GetTgtID(), rsp.GetTxnID());
 
-			CCIXSnpReq *ccixSnp = GetCCIXSnpReq(id,
-							m_ccix_RN_SnpReq);
+			CCIXSnpReq *ccixSnp = GetCCIXSnpReq(id);
 
 			CCIXSnpResp ccixSnpRsp(rsp);
 
@@ -3722,52 +3790,41 @@ public:
 
 	void UpdateSnoopFilter(ReqTxn *req)
 	{
-		typename std::vector<CCIXAgent>::iterator it;
+		CCIXAgent *agent;
 
 		assert(!m_agents.empty());
 
-		for (it = m_agents.begin(); it != m_agents.end(); it++) {
-			CCIXAgent& agent = (*it);
-
-			if (agent.GetID() == req->GetSrcID()) {
-				agent.GetSnoopFilter().Update(req);
-			}
+		agent = GetAgent(req->GetSrcID());
+		if (agent) {
+			agent->GetSnoopFilter().Update(req);
 		}
 	}
 
 	template<typename MsgType>
 	void UpdateSnoopFilter(MsgType& msg, ReqTxn *req)
 	{
-		typename std::vector<CCIXAgent>::iterator it;
+		CCIXAgent *agent;
 
 		assert(!m_agents.empty());
 
-		for (it = m_agents.begin(); it != m_agents.end(); it++) {
-			CCIXAgent& agent = (*it);
-
-			if (agent.GetID() == req->GetSrcID()) {
-				agent.GetSnoopFilter().Update(msg, req);
-			}
+		agent = GetAgent(req->GetSrcID());
+		if (agent) {
+			agent->GetSnoopFilter().Update(msg, req);
 		}
 	}
 
 	bool Contains(uint16_t id)
 	{
-		typename std::vector<CCIXAgent>::iterator it;
-
 		assert(!m_agents.empty());
 
-		for (it = m_agents.begin(); it != m_agents.end(); it++) {
-
-			if ((*it).GetID() == id) {
-				return true;
-			}
-		}
-		return false;
+		return GetAgent(id) != NULL;
 	}
 
 	void AddRemoteAgent(uint16_t id)
 	{
+		assert(m_agentIdx.find(id) == m_agentIdx.end());
+
+		m_agentIdx[id] = m_agents.size();
 		m_agents.push_back(CCIXAgent(id));
 
 		//
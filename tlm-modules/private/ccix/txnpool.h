@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef TLM_MODULES_PRIV_CCIX_TXNPOOL_H__
+#define TLM_MODULES_PRIV_CCIX_TXNPOOL_H__
+
+#include <vector>
+#include <new>
+#include <stdint.h>
+#include <assert.h>
+
+namespace CCIX {
+
+//
+// Recycles the memory of heap allocated transactions of type T (used
+// through class specific operator new / delete). The free list is shared by
+// all users of the pool and released when the last user is removed, frees
+// after that go straight back to the heap.
+//
+template<typename T>
+class TxnPool
+{
+public:
+	enum { MaxFree = 1024 };
+
+	static void *Alloc(size_t sz)
+	{
+		std::vector<void*>& l = FreeList();
+
+		if (sz == sizeof(T) && !l.empty()) {
+			void *p = l.back();
+
+			l.pop_back();
+			return p;
+		}
+		return ::operator new(sz);
+	}
+
+	static void Free(void *p, size_t sz)
+	{
+		std::vector<void*>& l = FreeList();
+
+		if (sz == sizeof(T) && Users() && l.size() < MaxFree) {
+			l.push_back(p);
+			return;
+		}
+		::operator delete(p);
+	}
+
+	static void AddUser() { Users()++; }
+
+	static void RemoveUser()
+	{
+		std::vector<void*>& l = FreeList();
+
+		assert(Users() > 0);
+
+		if (--Users() > 0) {
+			return;
+		}
+
+		while (!l.empty()) {
+			::operator delete(l.back());
+			l.pop_back();
+		}
+		std::vector<void*>().swap(l);
+	}
+
+	static unsigned int GetNumFree() { return FreeList().size(); }
+
+private:
+	static std::vector<void*>& FreeList()
+	{
+		static std::vector<void*> l;
+		return l;
+	}
+
+	static unsigned int& Users()
+	{
+		static unsigned int users;
+		return users;
+	}
+};
+
+}; // namespace CCIX
+
+#endif /* TLM_MODULES_PRIV_CCIX_TXNPOOL_H__ */
@@ -34,12 +34,15 @@
 #define TLM_MODULES_PRIV_CHI_CACHELINE_H__
 
 #include <list>
+#include <algorithm>
 
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
 #include "tlm_utils/simple_target_socket.h"
 #include "tlm-extensions/chiattr.h"
 #include "tlm-bridges/amba-chi.h"
+#include "utils/bitops.h"
+#include "utils/bytecopy.h"
 
 enum CacheLineStatus { INV = 0, UC, UCE, UD, UDP, SC, SD };
 
@@ -47,6 +50,67 @@ namespace AMBA {
 namespace CHI {
 namespace RN {
 
+//
+// Byte enables within a cacheline are kept as a bitmask, bit n
+// corresponding to byte n in the line.
+//
+typedef uint64_t ByteEnableMask;
+
+static_assert(CACHELINE_SZ == sizeof(ByteEnableMask) * 8,
+		"A cacheline's byte enables must fit in a ByteEnableMask");
+
+//
+// Returns 'len' (max CACHELINE_SZ) bytes of the repeating byte enable
+// pattern 'be' ('be_len' bytes long) starting at 'pos' as a bitmask.
+//
+static inline ByteEnableMask ToByteEnableMask(unsigned char *be,
+						unsigned int be_len,
+						unsigned int pos,
+						unsigned int len)
+{
+	ByteEnableMask mask = 0;
+	unsigned int i = 0;
+
+	if (be_len == 0) {
+		return bitops_mask64(0, len);
+	}
+
+	pos %= be_len;
+
+	while (i < len) {
+		unsigned int run = std::min(be_len - pos, len - i);
+		unsigned int j;
+
+		for (j = 0; j < run; j += 8) {
+			unsigned int n = std::min(run - j, 8u);
+			uint64_t w = 0;
+
+			memcpy(&w, &be[pos + j], n);
+			mask |= static_cast<ByteEnableMask>(
+					bitops_be8_to_mask8(w)) << (i + j);
+		}
+
+		i += run;
+		pos = 0;
+	}
+
+	return mask;
+}
+
+//
+// Expands a bitmask into a CACHELINE_SZ long TLM byte enable array.
+//
+static inline void ToByteEnables(ByteEnableMask mask, unsigned char *be)
+{
+	unsigned int i;
+
+	for (i = 0; i < CACHELINE_SZ; i += 8, mask >>= 8) {
+		uint64_t w = bitops_mask8_to_be8(mask & 0xFF);
+
+		memcpy(&be[i], &w, sizeof(w));
+	}
+}
+
 class CacheLine
 {
 public:
@@ -54,10 +118,9 @@ public:
 		valid(false),
 		tag(0),
 		shared(false),
-		dirty(false)
-	{
-		memset(byteEnable, TLM_BYTE_ENABLED, sizeof(byteEnable));
-	}
+		dirty(false),
+		byteEnable(~(ByteEnableMask)0)
+	{}
 
 	void Write(unsigned int offset,
 			unsigned char *srcData,
@@ -67,19 +130,15 @@ public:
 			unsigned int pos = 0)
 	{
 		if (be_len) {
-			unsigned int i;
+			ByteEnableMask mask =
+				ToByteEnableMask(be, be_len, pos, len);
 
-			for (i = 0; i < len; i++, pos++) {
-				bool do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-
-				if (do_access) {
-					data[offset + i] = srcData[i];
-					byteEnable[offset + i] = TLM_BYTE_ENABLED;
-				}
-			}
+			bytecopy_be(&data[offset], srcData, len,
+					be, be_len, pos);
+			byteEnable |= mask << offset;
 		} else {
 			memcpy(&data[offset], srcData, len);
-			memset(&byteEnable[offset], TLM_BYTE_ENABLED, len);
+			byteEnable |= bitops_mask64(offset, len);
 		}
 	}
 
@@ -90,27 +149,20 @@ public:
 		// zero 2.10.3 [1]
 		//
 		memset(data, 0, sizeof(data));
-		memset(byteEnable, TLM_BYTE_DISABLED, sizeof(byteEnable));
+		byteEnable = 0;
 		dirty = false;
 	}
 
 	void ByteEnablesEnableAll()
 	{
-		memset(byteEnable, TLM_BYTE_ENABLED, sizeof(byteEnable));
+		byteEnable = ~(ByteEnableMask)0;
 	}
 
 	enum EmptyPartialFull { Empty, Partial, Full };
 
 	EmptyPartialFull GetFillGrade()
 	{
-		unsigned int numEnabled = 0;
-		unsigned int i;
-
-		for (i = 0; i < CACHELINE_SZ; i++) {
-			if (byteEnable[i] == TLM_BYTE_ENABLED) {
-				numEnabled++;
-			}
-		}
+		unsigned int numEnabled = __builtin_popcountll(byteEnable);
 
 		if (numEnabled == CACHELINE_SZ) {
 			return Full;
@@ -213,7 +265,18 @@ public:
 	bool GetNonSecure() { return m_chiattr.GetNonSecure(); }
 
 	uint8_t *GetData() { return data; }
-	uint8_t *GetByteEnables() { return byteEnable; }
+
+	ByteEnableMask GetByteEnableMask() { return byteEnable; }
+
+	//
+	// Returns the byte enables expanded into a TLM byte enable array
+	// (for generic payloads carrying the line).
+	//
+	uint8_t *GetByteEnables()
+	{
+		ToByteEnables(byteEnable, byteEnableArray);
+		return byteEnableArray;
+	}
 
 private:
 	bool valid;
@@ -222,7 +285,9 @@ private:
 	bool dirty;
 
 	unsigned char data[CACHELINE_SZ];
-	unsigned char byteEnable[CACHELINE_SZ];
+	ByteEnableMask byteEnable;
+
+	unsigned char byteEnableArray[CACHELINE_SZ];
 
 	chiattr_extension m_chiattr;
 };
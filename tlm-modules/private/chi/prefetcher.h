@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * Stride / next-line prefetch engine used by the RN-F cache model
+ * (cache_chi). The engine is trained with the demand misses (and the demand
+ * hits on prefetched lines) of each requester (LPID) and generates cacheline
+ * aligned prefetch candidates ahead of the detected streams. Issuing the
+ * prefetch requests is left to the cache.
+ *
+ * References:
+ *
+ * [1] AMBA 5 CHI Architecture Specification, ARM IHI 0050C, ID050218
+ *
+ */
+
+#ifndef TLM_MODULES_PRIV_CHI_PREFETCHER_H__
+#define TLM_MODULES_PRIV_CHI_PREFETCHER_H__
+
+#include <list>
+#include <deque>
+#include <unordered_set>
+
+#include "tlm-bridges/amba-chi.h"
+
+namespace AMBA {
+namespace CHI {
+namespace RN {
+
+class Prefetcher
+{
+public:
+	enum {
+		// Streams tracked per requester (LPID)
+		NumStreams = 4,
+
+		// Prefetches are not issued across this boundary
+		PageSz = 4 * 1024,
+
+		// Hits on the same stride required before prefetching
+		ConfidenceThreshold = 2,
+
+		// Retired prefetches per accuracy evaluation
+		EpochSz = 32,
+
+		// Accuracy thresholds (percent) for the throttle
+		AccuracyLow = 40,
+		AccuracyHigh = 75,
+
+		// Max number of prefetched lines tracked for accuracy
+		MaxTracked = 64,
+	};
+
+	class Candidate
+	{
+	public:
+		Candidate(uint64_t addr = 0, bool nonSecure = true,
+				uint8_t qos = 0) :
+			m_addr(addr),
+			m_nonSecure(nonSecure),
+			m_qos(qos)
+		{}
+
+		uint64_t GetAddress() const { return m_addr; }
+		bool GetNonSecure() const { return m_nonSecure; }
+		uint8_t GetQoS() const { return m_qos; }
+	private:
+		uint64_t m_addr;
+		bool m_nonSecure;
+		uint8_t m_qos;
+	};
+
+	Prefetcher() :
+		m_enabled(false),
+		m_opcode(Req::ReadShared),
+		m_maxDegree(2),
+		m_degree(2),
+		m_distance(1),
+		m_throttle(true),
+		m_issued(0),
+		m_useful(0),
+		m_epochRetired(0),
+		m_epochUseful(0)
+	{}
+
+	//
+	// Train with a demand access to the cacheline aligned address
+	// 'addr'. Demand misses and the first demand hit on a prefetched
+	// line are used for training, the other hits are ignored.
+	//
+	void Train(uint8_t lpid, uint64_t addr, bool miss,
+			bool nonSecure = true, uint8_t qos = 0)
+	{
+		Stream *s;
+		int64_t stride;
+
+		if (!m_enabled) {
+			return;
+		}
+
+		if (!miss && !Hit(addr)) {
+			return;
+		}
+
+		s = LookupStream(lpid, addr);
+		stride = static_cast<int64_t>(addr - s->lastAddr);
+
+		if (stride != 0) {
+			if (stride == s->stride) {
+				if (s->confidence < ConfidenceThreshold) {
+					s->confidence++;
+				}
+			} else {
+				//
+				// Start with next line prefetching on a new
+				// stream and train towards the stride.
+				//
+				s->stride = stride;
+				s->confidence = 1;
+			}
+		}
+
+		s->lastAddr = addr;
+
+		if (s->confidence >= ConfidenceThreshold) {
+			GenerateCandidates(s, nonSecure, qos);
+		}
+	}
+
+	bool HasCandidates() { return !m_candidates.empty(); }
+
+	bool GetCandidate(Candidate& c)
+	{
+		if (m_candidates.empty()) {
+			return false;
+		}
+
+		c = m_candidates.front();
+		m_candidates.pop_front();
+
+		return true;
+	}
+
+	//
+	// Called by the cache when a prefetch request has been issued for
+	// the line. Lines fetched into the cache are tracked for the
+	// accuracy calculation.
+	//
+	void Issued(uint64_t addr, bool allocated)
+	{
+		m_issued++;
+
+		if (!allocated) {
+			return;
+		}
+
+		if (m_tracked.size() == MaxTracked) {
+			//
+			// The oldest prefetched line was not used
+			//
+			Forget(m_trackedOrder.front());
+			Retire(false);
+		}
+
+		m_tracked.insert(addr);
+		m_trackedOrder.push_back(addr);
+	}
+
+	void SetEnabled(bool val)
+	{
+		m_enabled = val;
+		if (!m_enabled) {
+			m_candidates.clear();
+		}
+	}
+	bool GetEnabled() { return m_enabled; }
+
+	void SetOpcode(uint8_t opcode)
+	{
+		assert(opcode == Req::ReadShared ||
+			opcode == Req::ReadClean ||
+			opcode == Req::PrefetchTgt);
+		m_opcode = opcode;
+	}
+	uint8_t GetOpcode() { return m_opcode; }
+
+	void SetDegree(unsigned int degree)
+	{
+		m_maxDegree = degree;
+		m_degree = degree;
+	}
+	unsigned int GetDegree() { return m_degree; }
+
+	void SetDistance(unsigned int distance) { m_distance = distance; }
+	unsigned int GetDistance() { return m_distance; }
+
+	void SetThrottle(bool val)
+	{
+		m_throttle = val;
+		if (!m_throttle) {
+			m_degree = m_maxDegree;
+		}
+	}
+
+	uint64_t GetIssued() { return m_issued; }
+	uint64_t GetUseful() { return m_useful; }
+
+	// Accuracy in percent
+	unsigned int GetAccuracy()
+	{
+		if (m_issued == 0) {
+			return 0;
+		}
+		return (m_useful * 100) / m_issued;
+	}
+
+private:
+	class Stream
+	{
+	public:
+		Stream() :
+			lpid(0),
+			lastAddr(0),
+			stride(CACHELINE_SZ),
+			confidence(0)
+		{}
+
+		uint8_t lpid;
+		uint64_t lastAddr;
+		int64_t stride;
+		unsigned int confidence;
+	};
+
+	uint64_t GetPage(uint64_t addr) { return addr & ~(uint64_t)(PageSz - 1); }
+
+	//
+	// Streams are matched on the page, LRU replaced otherwise.
+	//
+	Stream *LookupStream(uint8_t lpid, uint64_t addr)
+	{
+		std::list<Stream>::iterator it;
+		unsigned int numStreams = 0;
+
+		for (it = m_streams.begin(); it != m_streams.end(); it++) {
+			Stream& s = (*it);
+
+			if (s.lpid == lpid) {
+				numStreams++;
+
+				if (GetPage(s.lastAddr) == GetPage(addr)) {
+					// Move to MRU
+					m_streams.splice(m_streams.begin(),
+							m_streams, it);
+					return &m_streams.front();
+				}
+			}
+		}
+
+		if (numStreams == NumStreams) {
+			std::list<Stream>::reverse_iterator rit;
+
+			// Drop the LRU stream of the requester
+			for (rit = m_streams.rbegin();
+				rit != m_streams.rend(); rit++) {
+
+				if ((*rit).lpid == lpid) {
+					m_streams.erase(--rit.base());
+					break;
+				}
+			}
+		}
+
+		m_streams.push_front(Stream());
+		m_streams.front().lpid = lpid;
+
+		//
+		// A new stream is trained as a next line stream
+		//
+		m_streams.front().lastAddr = addr - CACHELINE_SZ;
+
+		return &m_streams.front();
+	}
+
+	void GenerateCandidates(Stream *s, bool nonSecure, uint8_t qos)
+	{
+		uint64_t page = GetPage(s->lastAddr);
+		unsigned int i;
+
+		for (i = 0; i < m_degree; i++) {
+			uint64_t addr = s->lastAddr +
+					s->stride * (m_distance + i);
+
+			if (GetPage(addr) != page) {
+				break;
+			}
+
+			if (m_tracked.find(addr) != m_tracked.end()) {
+				continue;
+			}
+
+			m_candidates.push_back(
+				Candidate(addr, nonSecure, qos));
+		}
+
+		//
+		// Stale candidates are dropped if the cache can't keep up
+		//
+		while (m_candidates.size() > 2 * m_maxDegree) {
+			m_candidates.pop_front();
+		}
+	}
+
+	bool Hit(uint64_t addr)
+	{
+		if (m_tracked.find(addr) == m_tracked.end()) {
+			return false;
+		}
+
+		Forget(addr);
+
+		m_useful++;
+		Retire(true);
+
+		return true;
+	}
+
+	void Forget(uint64_t addr)
+	{
+		std::deque<uint64_t>::iterator it;
+
+		m_tracked.erase(addr);
+
+		for (it = m_trackedOrder.begin();
+			it != m_trackedOrder.end(); it++) {
+			if ((*it) == addr) {
+				m_trackedOrder.erase(it);
+				break;
+			}
+		}
+	}
+
+	//
+	// Adjust the degree after each epoch of retired prefetches
+	//
+	void Retire(bool useful)
+	{
+		unsigned int accuracy;
+
+		m_epochRetired++;
+		if (useful) {
+			m_epochUseful++;
+		}
+
+		if (m_epochRetired < EpochSz) {
+			return;
+		}
+
+		accuracy = (m_epochUseful * 100) / m_epochRetired;
+
+		if (m_throttle) {
+			if (accuracy < AccuracyLow && m_degree > 1) {
+				m_degree--;
+			} else if (accuracy > AccuracyHigh &&
+					m_degree < m_maxDegree) {
+				m_degree++;
+			}
+		}
+
+		m_epochRetired = 0;
+		m_epochUseful = 0;
+	}
+
+	bool m_enabled;
+	uint8_t m_opcode;
+
+	unsigned int m_maxDegree;
+	unsigned int m_degree;
+	unsigned int m_distance;
+	bool m_throttle;
+
+	std::list<Stream> m_streams;
+	std::deque<Candidate> m_candidates;
+
+	std::unordered_set<uint64_t> m_tracked;
+	std::deque<uint64_t> m_trackedOrder;
+
+	uint64_t m_issued;
+	uint64_t m_useful;
+	unsigned int m_epochRetired;
+	unsigned int m_epochUseful;
+};
+
+} /* namespace RN */
+} /* namespace CHI */
+} /* namespace AMBA */
+
+#endif /* TLM_MODULES_PRIV_CHI_PREFETCHER_H__ */
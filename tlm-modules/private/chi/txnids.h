@@ -30,42 +30,97 @@
 #ifndef TLM_MODULES_PRIV_CHI_TXNIDS_H__
 #define TLM_MODULES_PRIV_CHI_TXNIDS_H__
 
+#include <vector>
+
+#include "tlm-bridges/amba-chi.h"
+
 namespace AMBA {
 namespace CHI {
 
+//
+// TxnID allocator, free IDs are tracked with a bitmap (bit set = free) and
+// allocated with a find first set search starting after the last allocated
+// ID. The width can be configured up to 12 bits for the larger TxnID fields
+// in later issues of [1].
+//
 class TxnIDs
 {
 public:
-	enum { NumIDs = 256 };
+	enum {
+		// Default amount of IDs (8 bit TxnID)
+		NumIDs = 1 << Req::TxnID_Width,
 
-	TxnIDs()
+		MaxWidth = 12,
+		MaxIDs = 1 << MaxWidth,
+	};
+
+	TxnIDs(unsigned int width = Req::TxnID_Width) :
+		m_numIDs(1 << width),
+		m_bitmap(((1 << width) + 63) / 64, ~(uint64_t)0),
+		m_hint(0)
 	{
-		for (uint32_t i = 0; i < NumIDs; i++) {
-			m_ids.push_back(static_cast<uint8_t>(i));
+		assert(width > 0 && width <= MaxWidth);
+
+		// Clear unused bits in last word (for widths < 6)
+		if (m_numIDs % 64) {
+			m_bitmap.back() = (1ULL << (m_numIDs % 64)) - 1;
 		}
 	}
 
-	uint8_t GetID()
+	uint16_t GetID()
 	{
-		uint8_t id;
+		int id;
 
-		if (m_ids.empty()) {
+		while ((id = FindFree()) < 0) {
 			sc_core::wait(m_returnIDEvent);
 		}
 
-		id = m_ids.front();
-		m_ids.pop_front();
+		m_bitmap[id / 64] &= ~(1ULL << (id % 64));
+		m_hint = (id + 1) % m_numIDs;
 
-		return id;
+		return static_cast<uint16_t>(id);
 	}
 
-	void ReturnID(uint8_t id)
+	void ReturnID(uint16_t id)
 	{
-		m_ids.push_back(id);
+		assert(id < m_numIDs);
+		assert(!(m_bitmap[id / 64] & (1ULL << (id % 64))));
+
+		m_bitmap[id / 64] |= 1ULL << (id % 64);
 		m_returnIDEvent.notify();
 	}
+
+	unsigned int GetNumIDs() { return m_numIDs; }
+
 private:
-	std::list<uint8_t> m_ids;
+	//
+	// Next fit search, returns -1 if all IDs are in use
+	//
+	int FindFree()
+	{
+		unsigned int numWords = m_bitmap.size();
+		unsigned int w = m_hint / 64;
+		uint64_t word;
+		unsigned int i;
+
+		// Bits at and above the hint in the first word
+		word = m_bitmap[w] & (~(uint64_t)0 << (m_hint % 64));
+
+		for (i = 0; i <= numWords; i++) {
+			if (word) {
+				return w * 64 + __builtin_ctzll(word);
+			}
+
+			w = (w + 1) % numWords;
+			word = m_bitmap[w];
+		}
+
+		return -1;
+	}
+
+	unsigned int m_numIDs;
+	std::vector<uint64_t> m_bitmap;
+	unsigned int m_hint;
 	sc_event m_returnIDEvent;
 };
 
@@ -110,6 +110,7 @@ public:
 		case Req::WriteUniqueFull:
 		case Req::WriteNoSnpPtl:
 		case Req::DVMOp:
+		case Req::PrefetchTgt:
 			return false;
 		default:
 			break;
@@ -170,8 +171,8 @@ public:
 		return m_gp;
 	}
 
-	uint8_t GetTxnID() { return m_txnID; }
-	uint8_t GetDBID() { return m_chiattr->GetDBID(); }
+	uint16_t GetTxnID() { return m_txnID; }
+	uint16_t GetDBID() { return m_chiattr->GetDBID(); }
 
 	bool IsSnp() { return m_isSnp; }
 
@@ -311,7 +312,7 @@ protected:
 	tlm::tlm_generic_payload m_gp;
 	chiattr_extension *m_chiattr;
 	TxnIDs *m_ids;
-	uint8_t m_txnID;
+	uint16_t m_txnID;
 	sc_event m_done;
 	bool m_isSnp;
 	bool m_gotRetryAck;
@@ -541,19 +542,7 @@ public:
 			len = max_len;
 		}
 
-		if (be_len) {
-			unsigned int i;
-
-			for (i = 0; i < len; i++, pos++) {
-				bool do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-
-				if (do_access) {
-					data[i] = m_data[line_offset + i];
-				}
-			}
-		} else {
-			memcpy(data, &m_data[line_offset], len);
-		}
+		bytecopy_be(data, &m_data[line_offset], len, be, be_len, pos);
 
 		return len;
 	}
@@ -773,6 +762,55 @@ private:
 	bool m_isMakeUnique;
 };
 
+//
+// PrefetchTgt does not receive any response and is done as soon as it has
+// been transmitted, 2.3.1 [1]
+//
+template<
+	int NODE_ID,
+	int ICN_ID>
+class PrefetchTgtTxn : public ITxn<NODE_ID, ICN_ID>
+{
+public:
+	typedef ITxn<NODE_ID, ICN_ID> ITxn_t;
+
+	using ITxn_t::m_gp;
+	using ITxn_t::m_chiattr;
+
+	PrefetchTgtTxn(tlm::tlm_generic_payload& gp,
+			uint64_t addr,	// cache aligned
+			TxnIDs *ids) :
+		ITxn<NODE_ID, ICN_ID>(Req::PrefetchTgt, ids, NULL)
+	{
+		unsigned int len = CACHELINE_SZ;
+
+		m_gp.set_command(tlm::TLM_IGNORE_COMMAND);
+
+		m_gp.set_address(addr);
+
+		m_gp.set_data_length(len);
+		m_gp.set_data_ptr(NULL);	// unused on ignore gps
+
+		m_gp.set_byte_enable_ptr(NULL);
+		m_gp.set_byte_enable_length(0);
+
+		m_gp.set_streaming_width(len);
+
+		m_gp.set_dmi_allowed(false);
+		m_gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		m_chiattr->SetSnpAttr(false);
+
+		this->CopyCHIAttr(gp);
+	}
+
+	bool Done()
+	{
+		return m_gp.get_response_status() !=
+				tlm::TLM_INCOMPLETE_RESPONSE;
+	}
+};
+
 template<
 	int NODE_ID,
 	int ICN_ID>
@@ -833,16 +871,12 @@ public:
 		}
 
 		if (be_len) {
-			unsigned int i;
+			ByteEnableMask mask =
+				ToByteEnableMask(be, be_len, pos, len);
 
-			for (i = 0; i < len; i++, pos++) {
-				bool do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-
-				if (do_access) {
-					m_data[line_offset + i] = data[i];
-					m_byteEnable[line_offset + i] = TLM_BYTE_ENABLED;
-				}
-			}
+			bytecopy_be(&m_data[line_offset], data, len,
+					be, be_len, pos);
+			ToByteEnables(mask << line_offset, m_byteEnable);
 		} else {
 			memcpy(&m_data[line_offset], data, len);
 			memset(&m_byteEnable[line_offset],
@@ -878,7 +912,7 @@ public:
 			// Move over data and byte enables
 			//
 			memcpy(m_data, m_l->GetData(), CACHELINE_SZ);
-			memcpy(m_byteEnable, m_l->GetByteEnables(), CACHELINE_SZ);
+			ToByteEnables(m_l->GetByteEnableMask(), m_byteEnable);
 		}
 
 		m_gp.set_data_length(CACHELINE_SZ);
@@ -1406,19 +1440,7 @@ public:
 			len = max_len;
 		}
 
-		if (be_len) {
-			unsigned int i;
-
-			for (i = 0; i < len; i++, pos++) {
-				bool do_access = be[pos % be_len] == TLM_BYTE_ENABLED;
-
-				if (do_access) {
-					data[i] = m_data[line_offset + i];
-				}
-			}
-		} else {
-			memcpy(data, &m_data[line_offset], len);
-		}
+		bytecopy_be(data, &m_data[line_offset], len, be, be_len, pos);
 
 		return len;
 	}
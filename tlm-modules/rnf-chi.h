@@ -33,7 +33,10 @@ using namespace std;
 #include "traffic-generators/tg-tlm.h"
 #include "tlm-modules/cache-chi.h"
 
-template<int NODE_ID, int SZ_CACHE, int ICN_ID = 20>
+template<int NODE_ID,
+	int SZ_CACHE,
+	int ICN_ID = 20,
+	int TXNID_WIDTH = AMBA::CHI::Req::TxnID_Width>
 class RequestNode_F:
 	public sc_core::sc_module
 {
@@ -173,7 +176,7 @@ private:
 	}
 public:
 
-	typedef cache_chi<NODE_ID, SZ_CACHE, ICN_ID> cache_chi_t;
+	typedef cache_chi<NODE_ID, SZ_CACHE, ICN_ID, TXNID_WIDTH> cache_chi_t;
 
 	Port_RN_F port;
 
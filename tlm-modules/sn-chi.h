@@ -73,9 +73,9 @@ private:
 
 		chiattr_extension *GetCHIAttr() { return m_chiattr; }
 
-		uint8_t GetTxnID() { return m_chiattr->GetTxnID(); }
+		uint16_t GetTxnID() { return m_chiattr->GetTxnID(); }
 		uint16_t GetSrcID() { return m_chiattr->GetSrcID(); }
-		uint8_t GetDBID() { return m_chiattr->GetDBID(); }
+		uint16_t GetDBID() { return m_chiattr->GetDBID(); }
 
 	protected:
 
@@ -381,7 +381,7 @@ private:
 	public:
 		using IMsg::m_chiattr;
 
-		RspMsg(ReqTxn *req, uint8_t opcode, uint8_t DBID = 0)
+		RspMsg(ReqTxn *req, uint8_t opcode, uint16_t DBID = 0)
 		{
 			chiattr_extension *attr = req->GetCHIAttr();
 
@@ -1103,7 +1103,7 @@ private:
 			chiattr_extension *chiattr;
 			trans.get_extension(chiattr);
 			if (chiattr) {
-				uint8_t txnID = chiattr->GetTxnID();
+				uint16_t txnID = chiattr->GetTxnID();
 				ReqTxn *req = m_txn[txnID];
 
 				if (req) {
@@ -1144,6 +1144,11 @@ private:
 
 	TxnProcessor<SlaveNode_F> m_txnProcessor;
 
+	//
+	// Requester TxnIDs (up to TxnIDs::MaxWidth bits) are only echoed,
+	// the DBIDs are allocated with Req::TxnID_Width bits and index
+	// m_txn.
+	//
 	TxnIDs m_ids;
 	ReqTxn *m_txn[TxnIDs::NumIDs];
 
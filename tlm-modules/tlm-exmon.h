@@ -29,7 +29,8 @@
 #ifndef TLM_EXMON_H__
 #define TLM_EXMON_H__
 
-#include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "tlm.h"
 #include "tlm_utils/simple_initiator_socket.h"
@@ -45,7 +46,10 @@ public:
 	tlm_exclusive_monitor(sc_core::sc_module_name name,
 				uint32_t id_mask = 0xF) :
 		sc_core::sc_module(name),
-		m_id_mask(id_mask)
+		m_id_mask(id_mask),
+		m_num_exclusive_reads(0),
+		m_num_exclusive_pass(0),
+		m_num_exclusive_fail(0)
 	{
 		target_socket.register_b_transport(this, &tlm_exclusive_monitor::b_transport);
 	}
@@ -53,81 +57,180 @@ public:
 	~tlm_exclusive_monitor()
 	{
 		monitor_clear();
+
+		for (std::vector<Transaction*>::iterator it = m_pool.begin();
+			it != m_pool.end(); it++) {
+			delete (*it);
+		}
+	}
+
+	//
+	// Exclusive access statistics
+	//
+	uint64_t get_num_exclusive_reads() { return m_num_exclusive_reads; }
+	uint64_t get_num_exclusive_pass() { return m_num_exclusive_pass; }
+	uint64_t get_num_exclusive_fail() { return m_num_exclusive_fail; }
+
+	// Exclusive write pass rate in percent
+	unsigned int get_exclusive_pass_rate()
+	{
+		uint64_t num_writes = m_num_exclusive_pass +
+					m_num_exclusive_fail;
+
+		if (num_writes == 0) {
+			return 0;
+		}
+		return (m_num_exclusive_pass * 100) / num_writes;
+	}
+
+	void reset_stats()
+	{
+		m_num_exclusive_reads = 0;
+		m_num_exclusive_pass = 0;
+		m_num_exclusive_fail = 0;
 	}
 
 private:
+	//
+	// Monitored locations are indexed per address granule, a location
+	// spanning multiple granules is inserted into all of them.
+	//
+	enum { GRANULE_SZ = 64 };
+
 	class Transaction
 	{
 	public:
-		Transaction(tlm::tlm_generic_payload& gp, uint32_t id_mask) :
-			m_id_mask(id_mask)
-		{
-			genattr_extension *genattr;
-
-			m_gp.set_address(gp.get_address());
-			m_gp.set_data_length(gp.get_data_length());
+		Transaction() :
+			m_addr(0),
+			m_len(0),
+			m_masked_id(0)
+		{}
 
-			gp.get_extension(genattr);
-			if (genattr) {
-				m_genattr.copy_from(*genattr);
-			}
+		void init(tlm::tlm_generic_payload& gp, uint32_t masked_id)
+		{
+			m_addr = gp.get_address();
+			m_len = gp.get_data_length();
+			m_masked_id = masked_id;
 		}
 
 		bool has_location(tlm::tlm_generic_payload& gp)
 		{
-			uint64_t addr = m_gp.get_address();
-			unsigned int len = m_gp.get_data_length();
-
-			return gp.get_address() >= addr &&
-				gp.get_address() < (addr + len);
+			return gp.get_address() >= m_addr &&
+				gp.get_address() < (m_addr + m_len);
 		}
 
 		bool has_same_location(tlm::tlm_generic_payload& gp)
 		{
-			return m_gp.get_address() == gp.get_address() &&
-				m_gp.get_data_length() == gp.get_data_length();
+			return m_addr == gp.get_address() &&
+				m_len == gp.get_data_length();
 		}
 
-		bool has_masked_id(tlm::tlm_generic_payload& gp)
+		uint64_t get_first_granule()
 		{
-			genattr_extension *genattr;
-
-			gp.get_extension(genattr);
-			if (genattr) {
-				uint32_t masked_id =
-					genattr->get_transaction_id() & m_id_mask;
-
-				return get_masked_id() == masked_id;
-			}
-
-			return false;
+			return m_addr / GRANULE_SZ;
 		}
 
+		uint64_t get_last_granule()
+		{
+			return (m_addr + m_len - 1) / GRANULE_SZ;
+		}
 
 		//
 		// Get the masked id ([1] recommends one exclusive monitor for
 		// every exclusive capable master).
 		//
-		uint32_t get_masked_id()
-		{
-			return m_genattr.get_transaction_id() & m_id_mask;
-		}
+		uint32_t get_masked_id() { return m_masked_id; }
+
+		unsigned int get_data_length() { return m_len; }
 
 	private:
-		tlm::tlm_generic_payload m_gp;
-		genattr_extension m_genattr;
-		uint32_t m_id_mask;
+		uint64_t m_addr;
+		unsigned int m_len;
+		uint32_t m_masked_id;
 	};
 
-	void monitor_clear()
+	typedef std::unordered_map<uint32_t, Transaction*> IDMap;
+	typedef std::unordered_map<uint64_t,
+				std::vector<Transaction*> > GranuleMap;
+
+	Transaction *alloc_transaction()
+	{
+		Transaction *t;
+
+		if (m_pool.empty()) {
+			return new Transaction();
+		}
+
+		t = m_pool.back();
+		m_pool.pop_back();
+
+		return t;
+	}
+
+	void free_transaction(Transaction *t)
 	{
-		for (std::list<Transaction*>::iterator it = m_monitor.begin();
-			it != m_monitor.end();) {
-			Transaction *t = (*it);
+		m_pool.push_back(t);
+	}
+
+	void index_insert(Transaction *t)
+	{
+		uint64_t g;
+
+		m_by_id[t->get_masked_id()] = t;
+
+		if (t->get_data_length() == 0) {
+			return;
+		}
+
+		for (g = t->get_first_granule();
+			g <= t->get_last_granule(); g++) {
+			m_by_granule[g].push_back(t);
+		}
+	}
+
+	//
+	// Empty granule buckets are erased except for 'keep'
+	//
+	void index_remove(Transaction *t,
+			std::vector<Transaction*> *keep = NULL)
+	{
+		uint64_t g;
+
+		m_by_id.erase(t->get_masked_id());
 
-			it = m_monitor.erase(it);
-			delete t;
+		if (t->get_data_length() == 0) {
+			return;
 		}
+
+		for (g = t->get_first_granule();
+			g <= t->get_last_granule(); g++) {
+			GranuleMap::iterator it = m_by_granule.find(g);
+			std::vector<Transaction*>& v = it->second;
+			unsigned int i;
+
+			for (i = 0; i < v.size(); i++) {
+				if (v[i] == t) {
+					v[i] = v.back();
+					v.pop_back();
+					break;
+				}
+			}
+
+			if (v.empty() && &v != keep) {
+				m_by_granule.erase(it);
+			}
+		}
+	}
+
+	void monitor_clear()
+	{
+		for (IDMap::iterator it = m_by_id.begin();
+			it != m_by_id.end(); it++) {
+			free_transaction(it->second);
+		}
+
+		m_by_id.clear();
+		m_by_granule.clear();
 	}
 
 	bool is_exclusive(tlm::tlm_generic_payload& trans)
@@ -142,57 +245,97 @@ private:
 		return false;
 	}
 
-	bool is_monitored_location(tlm::tlm_generic_payload& trans)
+	bool get_masked_id(tlm::tlm_generic_payload& trans,
+				uint32_t& masked_id)
 	{
-		for (std::list<Transaction*>::iterator it = m_monitor.begin();
-			it != m_monitor.end(); it++) {
-			Transaction *t = (*it);
+		genattr_extension *genattr;
 
-			if (t->has_masked_id(trans) &&
-				t->has_same_location(trans)) {
-				return true;
-			}
+		trans.get_extension(genattr);
+		if (genattr) {
+			masked_id = genattr->get_transaction_id() & m_id_mask;
+			return true;
 		}
+
 		return false;
 	}
 
+	bool is_monitored_location(tlm::tlm_generic_payload& trans)
+	{
+		uint32_t masked_id;
+		IDMap::iterator it;
+
+		if (!get_masked_id(trans, masked_id)) {
+			return false;
+		}
+
+		it = m_by_id.find(masked_id);
+		if (it == m_by_id.end()) {
+			return false;
+		}
+
+		return it->second->has_same_location(trans);
+	}
+
 	void monitor_clear_locations(tlm::tlm_generic_payload& trans)
 	{
-		for (std::list<Transaction*>::iterator it = m_monitor.begin();
-			it != m_monitor.end();) {
-			Transaction *t = (*it);
+		uint64_t g = trans.get_address() / GRANULE_SZ;
+		GranuleMap::iterator it;
+		unsigned int i;
+
+		if (m_by_granule.empty()) {
+			return;
+		}
+
+		it = m_by_granule.find(g);
+		if (it == m_by_granule.end()) {
+			return;
+		}
+
+		std::vector<Transaction*>& v = it->second;
+
+		//
+		// Iterate backwards since index_remove moves the last entry
+		// into the removed one's place. The bucket is kept until
+		// done.
+		//
+		for (i = v.size(); i > 0; i--) {
+			Transaction *t = v[i - 1];
 
 			if (t->has_location(trans)) {
-				it = m_monitor.erase(it);
-				delete t;
-			} else {
-				it++;
+				index_remove(t, &v);
+				free_transaction(t);
 			}
 		}
+
+		if (v.empty()) {
+			m_by_granule.erase(it);
+		}
 	}
 
 	void monitor_clear_id(uint32_t masked_id)
 	{
-		for (std::list<Transaction*>::iterator it = m_monitor.begin();
-			it != m_monitor.end(); it++) {
-			Transaction *t = (*it);
-
-			if (t->get_masked_id() == masked_id) {
-				m_monitor.remove(t);
-				delete t;
-				return;
-			}
+		IDMap::iterator it = m_by_id.find(masked_id);
+
+		if (it != m_by_id.end()) {
+			Transaction *t = it->second;
+
+			index_remove(t);
+			free_transaction(t);
 		}
 	}
 
 	void monitor_location(tlm::tlm_generic_payload& trans)
 	{
-		Transaction *t = new Transaction(trans, m_id_mask);
+		Transaction *t = alloc_transaction();
+		uint32_t masked_id = 0;
+
+		get_masked_id(trans, masked_id);
+		t->init(trans, masked_id);
 
 		// If already monitoring transaction ID, remove the old one.
-		monitor_clear_id(t->get_masked_id());
+		monitor_clear_id(masked_id);
 
-		m_monitor.push_back(t);
+		index_insert(t);
 	}
 
 	void set_exclusive_handled(tlm::tlm_generic_payload& trans)
@@ -219,6 +362,7 @@ private:
 
 				if (is_monitored_location(trans)) {
 					monitor_clear_locations(trans);
+					m_num_exclusive_pass++;
 				} else {
 					//
 					// Target address was written to before
@@ -230,6 +374,7 @@ private:
 					//
 
 					trans.set_response_status(tlm::TLM_OK_RESPONSE);
+					m_num_exclusive_fail++;
 					return;
 				}
 
@@ -249,11 +394,23 @@ private:
 				monitor_location(trans);
 
 				set_exclusive_handled(trans);
+
+				m_num_exclusive_reads++;
 			}
 		}
 	}
 
-	std::list<Transaction*> m_monitor;
 	uint32_t m_id_mask;
+
+	// Monitored locations indexed on masked id and on address granule
+	IDMap m_by_id;
+	GranuleMap m_by_granule;
+
+	// Free entries
+	std::vector<Transaction*> m_pool;
+
+	uint64_t m_num_exclusive_reads;
+	uint64_t m_num_exclusive_pass;
+	uint64_t m_num_exclusive_fail;
 };
 #endif
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2019 Xilinx Inc.
+ * Written by Francisco Iglesias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * References:
+ *
+ * [1] AMBA AXI and ACE Protocol Specification, ARM IHI 0022D, ID102711
+ *
+ */
+
+#ifndef TLM_WRITE_COMBINER_H__
+#define TLM_WRITE_COMBINER_H__
+
+#include <vector>
+#include <algorithm>
+
+#include <string.h>
+
+#include "tlm.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+#include "tlm-extensions/genattr.h"
+
+/*
+ * Write combining proxy module. Address contiguous writes with the same
+ * attributes are merged into a single (INCR) write that is issued when a
+ * write can't be merged, before any other transaction is forwarded or when
+ * the flush timeout expires. Merged writes are responded to immediately
+ * (posted), errors on the combined write can therefore only be reported
+ * as warnings.
+ *
+ * Writes carrying a genattr extension are only merged if they are
+ * modifiable and bufferable (section A4.3 [1]) and not exclusive, locked,
+ * wrapping, narrow (burst_width) or barriers. Writes without a genattr
+ * extension are treated as normal memory writes. A combined write never
+ * crosses the address boundary (4 KB by default, section A3.4.1 [1]) and is
+ * never longer than max_len bytes (by default 256 beats of the bus width,
+ * the AXI4 AxLEN limit).
+ */
+class tlm_write_combiner : public sc_core::sc_module
+{
+public:
+	tlm_utils::simple_initiator_socket<tlm_write_combiner> init_socket;
+	tlm_utils::simple_target_socket<tlm_write_combiner> target_socket;
+
+	SC_HAS_PROCESS(tlm_write_combiner);
+
+	tlm_write_combiner(sc_core::sc_module_name name,
+			uint32_t bus_width,
+			sc_time flush_timeout = sc_time(100, SC_NS),
+			uint64_t max_len = 0,
+			uint64_t max_address_boundary = 4 * 1024) :
+		sc_core::sc_module(name),
+		init_socket("init_socket"),
+		target_socket("target_socket"),
+		m_max_len(max_len),
+		m_max_address_boundary(max_address_boundary),
+		m_flush_timeout(flush_timeout),
+		m_addr(0),
+		m_len(0),
+		m_has_be(false),
+		m_has_genattr(false),
+		m_num_writes(0),
+		m_num_flushes(0)
+	{
+		if (m_max_len == 0) {
+			// AXI4 max burst length
+			m_max_len = 256 * (bus_width / 8);
+		}
+
+		m_data.resize(m_max_len);
+		m_be.resize(m_max_len);
+		m_flush_data.resize(m_max_len);
+		m_flush_be.resize(m_max_len);
+
+		target_socket.register_b_transport(this,
+					&tlm_write_combiner::b_transport);
+
+		SC_THREAD(flush_timeout_thread);
+	}
+
+	void set_flush_timeout(sc_time t) { m_flush_timeout = t; }
+	sc_time get_flush_timeout() { return m_flush_timeout; }
+
+	uint64_t get_max_len() { return m_max_len; }
+
+	//
+	// Issue the combined write (if any) and wait for it to complete.
+	// Must be called from a thread.
+	//
+	void flush()
+	{
+		sc_time delay(SC_ZERO_TIME);
+
+		flush(delay);
+		wait(delay);
+	}
+
+	// Number of writes merged and number of combined writes issued
+	uint64_t get_num_writes() { return m_num_writes; }
+	uint64_t get_num_flushes() { return m_num_flushes; }
+
+private:
+	bool combinable(tlm::tlm_generic_payload& trans,
+			genattr_extension *genattr)
+	{
+		unsigned int len = trans.get_data_length();
+		unsigned int streaming_width = trans.get_streaming_width();
+		uint64_t addr = trans.get_address();
+
+		if (!trans.is_write() || len == 0 || len > m_max_len) {
+			return false;
+		}
+
+		if (streaming_width && streaming_width != len) {
+			return false;
+		}
+
+		// Must not cross the address boundary
+		if ((addr % m_max_address_boundary) + len >
+			m_max_address_boundary) {
+			return false;
+		}
+
+		if (genattr) {
+			if (!genattr->get_modifiable() ||
+				!genattr->get_bufferable() ||
+				genattr->get_exclusive() ||
+				genattr->get_locked() ||
+				genattr->get_wrap() ||
+				genattr->get_barrier() ||
+				genattr->get_burst_width()) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool same_attributes(genattr_extension *genattr)
+	{
+		if (!genattr || !m_has_genattr) {
+			return !genattr && !m_has_genattr;
+		}
+
+		return genattr->get_master_id() == m_genattr.get_master_id() &&
+			genattr->get_secure() == m_genattr.get_secure() &&
+			genattr->get_transaction_id() ==
+				m_genattr.get_transaction_id() &&
+			genattr->get_posted() == m_genattr.get_posted() &&
+			genattr->get_read_allocate() ==
+				m_genattr.get_read_allocate() &&
+			genattr->get_write_allocate() ==
+				m_genattr.get_write_allocate() &&
+			genattr->get_qos() == m_genattr.get_qos() &&
+			genattr->get_region() == m_genattr.get_region() &&
+			genattr->get_IO_access() == m_genattr.get_IO_access() &&
+			genattr->get_snoop() == m_genattr.get_snoop() &&
+			genattr->get_domain() == m_genattr.get_domain();
+	}
+
+	//
+	// True if the write can be appended to the combined write
+	//
+	bool can_append(tlm::tlm_generic_payload& trans,
+			genattr_extension *genattr)
+	{
+		uint64_t addr = trans.get_address();
+		unsigned int len = trans.get_data_length();
+
+		if (m_len == 0) {
+			return false;
+		}
+
+		if (addr != m_addr + m_len || m_len + len > m_max_len) {
+			return false;
+		}
+
+		// The combined write starts inside the boundary
+		if ((m_addr % m_max_address_boundary) + m_len + len >
+			m_max_address_boundary) {
+			return false;
+		}
+
+		return same_attributes(genattr);
+	}
+
+	void append(tlm::tlm_generic_payload& trans,
+			genattr_extension *genattr)
+	{
+		unsigned char *be = trans.get_byte_enable_ptr();
+		unsigned int be_len = trans.get_byte_enable_length();
+		unsigned int len = trans.get_data_length();
+
+		if (m_len == 0) {
+			m_addr = trans.get_address();
+			m_has_be = false;
+			m_has_genattr = genattr != NULL;
+			if (genattr) {
+				m_genattr.copy_from(*genattr);
+			}
+
+			//
+			// The timeout is counted from the first write so
+			// that a stream of writes can't hold back the
+			// combined write.
+			//
+			m_timeout_event.cancel();
+			m_timeout_event.notify(m_flush_timeout);
+		}
+
+		memcpy(&m_data[m_len], trans.get_data_ptr(), len);
+
+		if (be && be_len) {
+			unsigned int i;
+
+			for (i = 0; i < len; i++) {
+				m_be[m_len + i] = be[i % be_len];
+			}
+			m_has_be = true;
+		} else {
+			memset(&m_be[m_len], TLM_BYTE_ENABLED, len);
+		}
+
+		m_len += len;
+		m_num_writes++;
+	}
+
+	//
+	// Issue the combined write. A flush already in progress is waited
+	// for so that transactions are forwarded in order.
+	//
+	void flush(sc_time& delay)
+	{
+		tlm::tlm_generic_payload gp;
+		bool has_genattr;
+		unsigned int len;
+		uint64_t addr;
+		bool has_be;
+
+		m_mutex.lock();
+
+		if (m_len == 0) {
+			m_mutex.unlock();
+			return;
+		}
+
+		//
+		// Writes arriving while the combined write is in progress
+		// are merged into the other buffer.
+		//
+		std::swap(m_data, m_flush_data);
+		std::swap(m_be, m_flush_be);
+		addr = m_addr;
+		len = m_len;
+		has_be = m_has_be;
+		has_genattr = m_has_genattr;
+		m_len = 0;
+
+		m_timeout_event.cancel();
+
+		gp.set_command(tlm::TLM_WRITE_COMMAND);
+		gp.set_address(addr);
+		gp.set_data_ptr(&m_flush_data[0]);
+		gp.set_data_length(len);
+		gp.set_streaming_width(len);
+		gp.set_dmi_allowed(false);
+		gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+		if (has_be) {
+			if (std::count(m_flush_be.begin(),
+					m_flush_be.begin() + len,
+					TLM_BYTE_ENABLED) != (long) len) {
+				gp.set_byte_enable_ptr(&m_flush_be[0]);
+				gp.set_byte_enable_length(len);
+			}
+		}
+
+		if (has_genattr) {
+			m_flush_genattr.copy_from(m_genattr);
+			gp.set_extension(&m_flush_genattr);
+		}
+
+		init_socket->b_transport(gp, delay);
+
+		if (has_genattr) {
+			gp.clear_extension(&m_flush_genattr);
+		}
+
+		if (gp.get_response_status() != tlm::TLM_OK_RESPONSE) {
+			SC_REPORT_WARNING("tlm-write-combiner",
+				"Combined write failed");
+		}
+
+		m_num_flushes++;
+
+		m_mutex.unlock();
+	}
+
+	void flush_timeout_thread()
+	{
+		while (true) {
+			wait(m_timeout_event);
+			flush();
+		}
+	}
+
+	virtual void b_transport(tlm::tlm_generic_payload& trans,
+				sc_time& delay)
+	{
+		genattr_extension *genattr;
+
+		trans.get_extension(genattr);
+
+		if (!combinable(trans, genattr)) {
+			//
+			// Keep the order, the combined write is issued
+			// before the transaction.
+			//
+			flush(delay);
+			init_socket->b_transport(trans, delay);
+			return;
+		}
+
+		//
+		// Another writer might have started a new combined write
+		// while the flush was waiting.
+		//
+		while (m_len && !can_append(trans, genattr)) {
+			flush(delay);
+		}
+
+		append(trans, genattr);
+
+		if (m_len == m_max_len ||
+			((m_addr + m_len) % m_max_address_boundary) == 0) {
+			flush(delay);
+		}
+
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	uint64_t m_max_len;
+	uint64_t m_max_address_boundary;
+	sc_time m_flush_timeout;
+
+	// The combined write being built
+	uint64_t m_addr;
+	unsigned int m_len;
+	bool m_has_be;
+	bool m_has_genattr;
+	std::vector<unsigned char> m_data;
+	std::vector<unsigned char> m_be;
+	genattr_extension m_genattr;
+
+	// The combined write being issued
+	std::vector<unsigned char> m_flush_data;
+	std::vector<unsigned char> m_flush_be;
+	genattr_extension m_flush_genattr;
+
+	sc_event m_timeout_event;
+	sc_mutex m_mutex;
+
+	uint64_t m_num_writes;
+	uint64_t m_num_flushes;
+};
+
+#endif
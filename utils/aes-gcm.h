@@ -0,0 +1,802 @@
+/*
+ * AES-GCM (NIST SP 800-38D) encryption and decryption.
+ *
+ * Copyright (c) 2022 Advanced Micro Devices Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * The key schedule and hash subkey tables are computed once per key
+ * (aes_gcm_setkey) and can be shared by any number of contexts.  A context
+ * is started with a 96 bit IV, fed with the AAD and then the text in any
+ * number of chunks, in place or not, and finished with the tag.
+ *
+ * On x86 the AES-NI and PCLMULQDQ instructions are used when the CPU
+ * supports them (checked at runtime), a table based implementation is used
+ * otherwise.
+ */
+
+#ifndef UTILS_AES_GCM_H__
+#define UTILS_AES_GCM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_GCM_X86 1
+#include <immintrin.h>
+#endif
+
+#define AES_GCM_BLOCK_SIZE (16)
+#define AES_GCM_IV_SIZE    (12)
+#define AES_GCM_TAG_SIZE   (16)
+#define AES_MAX_ROUNDS     (14)
+
+struct aes_gcm_key {
+	/* Key length in bytes (16, 24 or 32), 0 if not set.  */
+	unsigned int key_len;
+	unsigned int rounds;
+
+	/* Round keys, as bytes for AES-NI and as big endian words for the
+	 * table implementation.  */
+	uint8_t rk[(AES_MAX_ROUNDS + 1) * 16] __attribute__((aligned(16)));
+	uint32_t rkw[(AES_MAX_ROUNDS + 1) * 4];
+
+	/* H^1 .. H^4, byte reflected, for PCLMULQDQ.  */
+	uint8_t hpow[4][16] __attribute__((aligned(16)));
+
+	/* 4 bit tables of multiples of H for the table implementation.  */
+	uint64_t hl[16];
+	uint64_t hh[16];
+};
+
+struct aes_gcm_ctx {
+	const struct aes_gcm_key *key;
+	bool encrypt;
+	/* Set once the first text byte is processed, AAD can't follow.  */
+	bool in_text;
+
+	/* E(K, J0) xor'ed into the tag.  */
+	uint8_t ekj0[16];
+	/* Next counter block.  */
+	uint8_t ctr[16];
+	/* GHASH accumulator.  */
+	uint8_t x[16];
+	/* Partial block waiting to be hashed, and its keystream.  */
+	uint8_t buf[16];
+	uint8_t ks[16];
+	unsigned int buf_len;
+
+	uint64_t aad_len;
+	uint64_t text_len;
+};
+
+static const uint8_t aes_sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
+	0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+	0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc,
+	0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a,
+	0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+	0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b,
+	0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85,
+	0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+	0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17,
+	0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88,
+	0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+	0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9,
+	0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6,
+	0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+	0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94,
+	0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68,
+	0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static inline uint32_t aes_gcm_get_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+		| ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void aes_gcm_put_be32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static inline void aes_gcm_put_be64(uint8_t *p, uint64_t v)
+{
+	aes_gcm_put_be32(p, v >> 32);
+	aes_gcm_put_be32(p + 4, v);
+}
+
+static inline uint32_t aes_gcm_ror32(uint32_t v, unsigned int n)
+{
+	return (v >> n) | (v << (32 - n));
+}
+
+/* Increment the 32 bit big endian counter in the last word.  */
+static inline void aes_gcm_inc32(uint8_t *ctr)
+{
+	aes_gcm_put_be32(ctr + 12, aes_gcm_get_be32(ctr + 12) + 1);
+}
+
+/* Combined SubBytes / MixColumns table, built on first use.  */
+static inline const uint32_t *aes_gcm_te0(void)
+{
+	static uint32_t te0[256];
+	static bool done = false;
+
+	if (!done) {
+		for (int i = 0; i < 256; i++) {
+			uint32_t s = aes_sbox[i];
+			uint32_t s2 = ((s << 1) ^ ((s & 0x80) ? 0x1b : 0))
+				      & 0xff;
+			uint32_t s3 = s2 ^ s;
+
+			te0[i] = (s2 << 24) | (s << 16) | (s << 8) | s3;
+		}
+		done = true;
+	}
+	return te0;
+}
+
+static inline void aes_encrypt_block_c(const struct aes_gcm_key *k,
+				       const uint8_t *in, uint8_t *out)
+{
+	const uint32_t *te0 = aes_gcm_te0();
+	const uint32_t *rk = k->rkw;
+	uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+	unsigned int r;
+
+	s0 = aes_gcm_get_be32(in) ^ rk[0];
+	s1 = aes_gcm_get_be32(in + 4) ^ rk[1];
+	s2 = aes_gcm_get_be32(in + 8) ^ rk[2];
+	s3 = aes_gcm_get_be32(in + 12) ^ rk[3];
+
+#define AES_GCM_ROUND(a, b, c, d)                                    \
+	(te0[(a) >> 24]                                              \
+	 ^ aes_gcm_ror32(te0[((b) >> 16) & 0xff], 8)                 \
+	 ^ aes_gcm_ror32(te0[((c) >> 8) & 0xff], 16)                 \
+	 ^ aes_gcm_ror32(te0[(d) & 0xff], 24))
+
+	for (r = 1; r < k->rounds; r++) {
+		rk += 4;
+		t0 = AES_GCM_ROUND(s0, s1, s2, s3) ^ rk[0];
+		t1 = AES_GCM_ROUND(s1, s2, s3, s0) ^ rk[1];
+		t2 = AES_GCM_ROUND(s2, s3, s0, s1) ^ rk[2];
+		t3 = AES_GCM_ROUND(s3, s0, s1, s2) ^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+#undef AES_GCM_ROUND
+
+#define AES_GCM_LAST(a, b, c, d)                                     \
+	(((uint32_t)aes_sbox[(a) >> 24] << 24)                       \
+	 | ((uint32_t)aes_sbox[((b) >> 16) & 0xff] << 16)            \
+	 | ((uint32_t)aes_sbox[((c) >> 8) & 0xff] << 8)              \
+	 | aes_sbox[(d) & 0xff])
+
+	rk += 4;
+	aes_gcm_put_be32(out, AES_GCM_LAST(s0, s1, s2, s3) ^ rk[0]);
+	aes_gcm_put_be32(out + 4, AES_GCM_LAST(s1, s2, s3, s0) ^ rk[1]);
+	aes_gcm_put_be32(out + 8, AES_GCM_LAST(s2, s3, s0, s1) ^ rk[2]);
+	aes_gcm_put_be32(out + 12, AES_GCM_LAST(s3, s0, s1, s2) ^ rk[3]);
+#undef AES_GCM_LAST
+}
+
+/* x = x * H with the 4 bit tables (Shoup's method).  */
+static inline void aes_gcm_gmult_c(const struct aes_gcm_key *k, uint8_t *x)
+{
+	static const uint64_t last4[16] = {
+		0x0000, 0x1c20, 0x3840, 0x2460,
+		0x7080, 0x6ca0, 0x48c0, 0x54e0,
+		0xe100, 0xfd20, 0xd940, 0xc560,
+		0x9180, 0x8da0, 0xa9c0, 0xb5e0
+	};
+	uint64_t zh, zl;
+	unsigned int lo, hi, rem;
+	int i;
+
+	lo = x[15] & 0xf;
+	zh = k->hh[lo];
+	zl = k->hl[lo];
+
+	for (i = 15; i >= 0; i--) {
+		lo = x[i] & 0xf;
+		hi = x[i] >> 4;
+
+		if (i != 15) {
+			rem = zl & 0xf;
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ (last4[rem] << 48);
+			zh ^= k->hh[lo];
+			zl ^= k->hl[lo];
+		}
+
+		rem = zl & 0xf;
+		zl = (zh << 60) | (zl >> 4);
+		zh = (zh >> 4) ^ (last4[rem] << 48);
+		zh ^= k->hh[hi];
+		zl ^= k->hl[hi];
+	}
+
+	aes_gcm_put_be64(x, zh);
+	aes_gcm_put_be64(x + 8, zl);
+}
+
+static inline void aes_gcm_ghash_c(const struct aes_gcm_key *k, uint8_t *x,
+				   const uint8_t *data, size_t nblocks)
+{
+	while (nblocks--) {
+		for (int i = 0; i < 16; i++) {
+			x[i] ^= data[i];
+		}
+		aes_gcm_gmult_c(k, x);
+		data += 16;
+	}
+}
+
+static inline void aes_gcm_blocks_c(struct aes_gcm_ctx *ctx,
+				    const uint8_t *in, uint8_t *out,
+				    size_t nblocks)
+{
+	const struct aes_gcm_key *k = ctx->key;
+	uint8_t ks[16];
+
+	while (nblocks--) {
+		aes_encrypt_block_c(k, ctx->ctr, ks);
+		aes_gcm_inc32(ctx->ctr);
+
+		if (!ctx->encrypt) {
+			aes_gcm_ghash_c(k, ctx->x, in, 1);
+		}
+		for (int i = 0; i < 16; i++) {
+			out[i] = in[i] ^ ks[i];
+		}
+		if (ctx->encrypt) {
+			aes_gcm_ghash_c(k, ctx->x, out, 1);
+		}
+		in += 16;
+		out += 16;
+	}
+}
+
+static inline void aes_gcm_setkey_c(struct aes_gcm_key *k, const uint8_t *h)
+{
+	uint64_t vh, vl;
+	int i, j;
+
+	vh = ((uint64_t)aes_gcm_get_be32(h) << 32) | aes_gcm_get_be32(h + 4);
+	vl = ((uint64_t)aes_gcm_get_be32(h + 8) << 32)
+	     | aes_gcm_get_be32(h + 12);
+
+	k->hl[8] = vl;
+	k->hh[8] = vh;
+	k->hl[0] = 0;
+	k->hh[0] = 0;
+
+	for (i = 4; i > 0; i >>= 1) {
+		uint64_t t = (vl & 1) * 0xe1000000U;
+
+		vl = (vh << 63) | (vl >> 1);
+		vh = (vh >> 1) ^ (t << 32);
+		k->hl[i] = vl;
+		k->hh[i] = vh;
+	}
+
+	for (i = 2; i <= 8; i *= 2) {
+		vh = k->hh[i];
+		vl = k->hl[i];
+		for (j = 1; j < i; j++) {
+			k->hh[i + j] = vh ^ k->hh[j];
+			k->hl[i + j] = vl ^ k->hl[j];
+		}
+	}
+}
+
+#ifdef AES_GCM_X86
+#define AES_GCM_NI __attribute__((target("aes,pclmul,ssse3")))
+
+static inline bool aes_gcm_use_ni(void)
+{
+	static int use_ni = -1;
+
+	if (use_ni < 0) {
+		__builtin_cpu_init();
+		use_ni = __builtin_cpu_supports("aes")
+			 && __builtin_cpu_supports("pclmul")
+			 && __builtin_cpu_supports("ssse3");
+	}
+	return use_ni;
+}
+
+AES_GCM_NI static inline __m128i aes_gcm_bswap_ni(__m128i v)
+{
+	return _mm_shuffle_epi8(v, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+						8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/*
+ * Carry-less multiplication of two byte reflected elements, the 256 bit
+ * product is left unreduced in lo / hi so that several products can be
+ * summed before a single reduction.
+ */
+AES_GCM_NI static inline void aes_gcm_clmul_ni(__m128i a, __m128i b,
+					       __m128i *lo, __m128i *hi)
+{
+	__m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+	__m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+	__m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+	__m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+
+	t1 = _mm_xor_si128(t1, t2);
+	*lo = _mm_xor_si128(*lo, _mm_xor_si128(t0, _mm_slli_si128(t1, 8)));
+	*hi = _mm_xor_si128(*hi, _mm_xor_si128(t3, _mm_srli_si128(t1, 8)));
+}
+
+/* Shift the product left by one (bit reflection) and reduce it.  */
+AES_GCM_NI static inline __m128i aes_gcm_reduce_ni(__m128i lo, __m128i hi)
+{
+	__m128i t7, t8, t9, t2, t4, t5;
+
+	t7 = _mm_srli_epi32(lo, 31);
+	t8 = _mm_srli_epi32(hi, 31);
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+	t9 = _mm_srli_si128(t7, 12);
+	t8 = _mm_slli_si128(t8, 4);
+	t7 = _mm_slli_si128(t7, 4);
+	lo = _mm_or_si128(lo, t7);
+	hi = _mm_or_si128(hi, t8);
+	hi = _mm_or_si128(hi, t9);
+
+	t7 = _mm_slli_epi32(lo, 31);
+	t8 = _mm_slli_epi32(lo, 30);
+	t9 = _mm_slli_epi32(lo, 25);
+	t7 = _mm_xor_si128(t7, t8);
+	t7 = _mm_xor_si128(t7, t9);
+	t8 = _mm_srli_si128(t7, 4);
+	t7 = _mm_slli_si128(t7, 12);
+	lo = _mm_xor_si128(lo, t7);
+
+	t2 = _mm_srli_epi32(lo, 1);
+	t4 = _mm_srli_epi32(lo, 2);
+	t5 = _mm_srli_epi32(lo, 7);
+	t2 = _mm_xor_si128(t2, t4);
+	t2 = _mm_xor_si128(t2, t5);
+	t2 = _mm_xor_si128(t2, t8);
+	lo = _mm_xor_si128(lo, t2);
+
+	return _mm_xor_si128(hi, lo);
+}
+
+AES_GCM_NI static inline __m128i aes_gcm_gfmul_ni(__m128i a, __m128i b)
+{
+	__m128i lo = _mm_setzero_si128();
+	__m128i hi = _mm_setzero_si128();
+
+	aes_gcm_clmul_ni(a, b, &lo, &hi);
+	return aes_gcm_reduce_ni(lo, hi);
+}
+
+AES_GCM_NI static inline void aes_gcm_setkey_ni(struct aes_gcm_key *k,
+						const uint8_t *h)
+{
+	__m128i h1 = aes_gcm_bswap_ni(_mm_loadu_si128((const __m128i *)h));
+	__m128i hn = h1;
+
+	for (int i = 0; i < 4; i++) {
+		_mm_store_si128((__m128i *)k->hpow[i], hn);
+		hn = aes_gcm_gfmul_ni(hn, h1);
+	}
+}
+
+/* Hash four byte reflected blocks into x, b0 first.  */
+AES_GCM_NI static inline __m128i aes_gcm_ghash4_ni(
+	const struct aes_gcm_key *k, __m128i x,
+	__m128i b0, __m128i b1, __m128i b2, __m128i b3)
+{
+	__m128i lo = _mm_setzero_si128();
+	__m128i hi = _mm_setzero_si128();
+
+	aes_gcm_clmul_ni(_mm_xor_si128(x, b0),
+			 _mm_load_si128((const __m128i *)k->hpow[3]),
+			 &lo, &hi);
+	aes_gcm_clmul_ni(b1, _mm_load_si128((const __m128i *)k->hpow[2]),
+			 &lo, &hi);
+	aes_gcm_clmul_ni(b2, _mm_load_si128((const __m128i *)k->hpow[1]),
+			 &lo, &hi);
+	aes_gcm_clmul_ni(b3, _mm_load_si128((const __m128i *)k->hpow[0]),
+			 &lo, &hi);
+	return aes_gcm_reduce_ni(lo, hi);
+}
+
+AES_GCM_NI static inline void aes_gcm_ghash_ni(const struct aes_gcm_key *k,
+					       uint8_t *xp,
+					       const uint8_t *data,
+					       size_t nblocks)
+{
+	__m128i h1 = _mm_load_si128((const __m128i *)k->hpow[0]);
+	__m128i x = aes_gcm_bswap_ni(_mm_loadu_si128((const __m128i *)xp));
+	const __m128i *p = (const __m128i *)data;
+
+	for (; nblocks >= 4; nblocks -= 4, p += 4) {
+		x = aes_gcm_ghash4_ni(k, x,
+			aes_gcm_bswap_ni(_mm_loadu_si128(p)),
+			aes_gcm_bswap_ni(_mm_loadu_si128(p + 1)),
+			aes_gcm_bswap_ni(_mm_loadu_si128(p + 2)),
+			aes_gcm_bswap_ni(_mm_loadu_si128(p + 3)));
+	}
+	for (; nblocks; nblocks--, p++) {
+		x = _mm_xor_si128(x, aes_gcm_bswap_ni(_mm_loadu_si128(p)));
+		x = aes_gcm_gfmul_ni(x, h1);
+	}
+
+	_mm_storeu_si128((__m128i *)xp, aes_gcm_bswap_ni(x));
+}
+
+AES_GCM_NI static inline void aes_encrypt_block_ni(
+	const struct aes_gcm_key *k, const uint8_t *in, uint8_t *out)
+{
+	const __m128i *rk = (const __m128i *)k->rk;
+	__m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in),
+				  _mm_load_si128(rk));
+	unsigned int r;
+
+	for (r = 1; r < k->rounds; r++) {
+		b = _mm_aesenc_si128(b, _mm_load_si128(rk + r));
+	}
+	b = _mm_aesenclast_si128(b, _mm_load_si128(rk + r));
+	_mm_storeu_si128((__m128i *)out, b);
+}
+
+/*
+ * CTR and GHASH over whole blocks, four counter blocks are encrypted
+ * interleaved and their ciphertext hashed with a single reduction.
+ */
+AES_GCM_NI static inline void aes_gcm_blocks_ni(struct aes_gcm_ctx *ctx,
+						const uint8_t *in,
+						uint8_t *out,
+						size_t nblocks)
+{
+	const struct aes_gcm_key *k = ctx->key;
+	const __m128i *rk = (const __m128i *)k->rk;
+	const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+	__m128i h1 = _mm_load_si128((const __m128i *)k->hpow[0]);
+	__m128i x = aes_gcm_bswap_ni(_mm_loadu_si128((__m128i *)ctx->x));
+	/* The counter is kept byte reversed so that the 32 bit big endian
+	 * counter is the lowest lane.  */
+	__m128i ctr = aes_gcm_bswap_ni(_mm_loadu_si128((__m128i *)ctx->ctr));
+	const __m128i *src = (const __m128i *)in;
+	__m128i *dst = (__m128i *)out;
+	unsigned int r;
+
+	for (; nblocks >= 4; nblocks -= 4, src += 4, dst += 4) {
+		__m128i k0 = _mm_load_si128(rk);
+		__m128i b0, b1, b2, b3, c0, c1, c2, c3;
+
+		b0 = _mm_xor_si128(aes_gcm_bswap_ni(ctr), k0);
+		ctr = _mm_add_epi32(ctr, one);
+		b1 = _mm_xor_si128(aes_gcm_bswap_ni(ctr), k0);
+		ctr = _mm_add_epi32(ctr, one);
+		b2 = _mm_xor_si128(aes_gcm_bswap_ni(ctr), k0);
+		ctr = _mm_add_epi32(ctr, one);
+		b3 = _mm_xor_si128(aes_gcm_bswap_ni(ctr), k0);
+		ctr = _mm_add_epi32(ctr, one);
+
+		for (r = 1; r < k->rounds; r++) {
+			__m128i kr = _mm_load_si128(rk + r);
+
+			b0 = _mm_aesenc_si128(b0, kr);
+			b1 = _mm_aesenc_si128(b1, kr);
+			b2 = _mm_aesenc_si128(b2, kr);
+			b3 = _mm_aesenc_si128(b3, kr);
+		}
+		b0 = _mm_aesenclast_si128(b0, _mm_load_si128(rk + r));
+		b1 = _mm_aesenclast_si128(b1, _mm_load_si128(rk + r));
+		b2 = _mm_aesenclast_si128(b2, _mm_load_si128(rk + r));
+		b3 = _mm_aesenclast_si128(b3, _mm_load_si128(rk + r));
+
+		/* Loaded before storing, in and out may be the same.  */
+		c0 = _mm_loadu_si128(src);
+		c1 = _mm_loadu_si128(src + 1);
+		c2 = _mm_loadu_si128(src + 2);
+		c3 = _mm_loadu_si128(src + 3);
+		b0 = _mm_xor_si128(b0, c0);
+		b1 = _mm_xor_si128(b1, c1);
+		b2 = _mm_xor_si128(b2, c2);
+		b3 = _mm_xor_si128(b3, c3);
+		_mm_storeu_si128(dst, b0);
+		_mm_storeu_si128(dst + 1, b1);
+		_mm_storeu_si128(dst + 2, b2);
+		_mm_storeu_si128(dst + 3, b3);
+
+		if (ctx->encrypt) {
+			c0 = b0;
+			c1 = b1;
+			c2 = b2;
+			c3 = b3;
+		}
+		x = aes_gcm_ghash4_ni(k, x,
+				      aes_gcm_bswap_ni(c0),
+				      aes_gcm_bswap_ni(c1),
+				      aes_gcm_bswap_ni(c2),
+				      aes_gcm_bswap_ni(c3));
+	}
+
+	for (; nblocks; nblocks--, src++, dst++) {
+		__m128i b = _mm_xor_si128(aes_gcm_bswap_ni(ctr),
+					  _mm_load_si128(rk));
+		__m128i c = _mm_loadu_si128(src);
+
+		ctr = _mm_add_epi32(ctr, one);
+		for (r = 1; r < k->rounds; r++) {
+			b = _mm_aesenc_si128(b, _mm_load_si128(rk + r));
+		}
+		b = _mm_aesenclast_si128(b, _mm_load_si128(rk + r));
+		b = _mm_xor_si128(b, c);
+		_mm_storeu_si128(dst, b);
+
+		x = _mm_xor_si128(x, aes_gcm_bswap_ni(ctx->encrypt ? b : c));
+		x = aes_gcm_gfmul_ni(x, h1);
+	}
+
+	_mm_storeu_si128((__m128i *)ctx->x, aes_gcm_bswap_ni(x));
+	_mm_storeu_si128((__m128i *)ctx->ctr, aes_gcm_bswap_ni(ctr));
+}
+#endif
+
+static inline void aes_encrypt_block(const struct aes_gcm_key *k,
+				     const uint8_t *in, uint8_t *out)
+{
+#ifdef AES_GCM_X86
+	if (aes_gcm_use_ni()) {
+		aes_encrypt_block_ni(k, in, out);
+		return;
+	}
+#endif
+	aes_encrypt_block_c(k, in, out);
+}
+
+static inline void aes_gcm_ghash(struct aes_gcm_ctx *ctx,
+				 const uint8_t *data, size_t nblocks)
+{
+#ifdef AES_GCM_X86
+	if (aes_gcm_use_ni()) {
+		aes_gcm_ghash_ni(ctx->key, ctx->x, data, nblocks);
+		return;
+	}
+#endif
+	aes_gcm_ghash_c(ctx->key, ctx->x, data, nblocks);
+}
+
+/* Zero pad and hash the partial block, if any.  */
+static inline void aes_gcm_ghash_flush(struct aes_gcm_ctx *ctx)
+{
+	if (ctx->buf_len) {
+		memset(ctx->buf + ctx->buf_len, 0, 16 - ctx->buf_len);
+		aes_gcm_ghash(ctx, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+}
+
+/*
+ * Expand the key (16, 24 or 32 bytes) and compute the hash subkey tables.
+ */
+static inline void aes_gcm_setkey(struct aes_gcm_key *k,
+				  const uint8_t *key, unsigned int key_len)
+{
+	static const uint8_t rcon[10] = {
+		0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+	};
+	unsigned int nk = key_len / 4;
+	unsigned int nw;
+	uint8_t h[16];
+	unsigned int i;
+
+	k->key_len = key_len;
+	k->rounds = nk + 6;
+	nw = 4 * (k->rounds + 1);
+
+	for (i = 0; i < nk; i++) {
+		k->rkw[i] = aes_gcm_get_be32(key + 4 * i);
+	}
+	for (; i < nw; i++) {
+		uint32_t t = k->rkw[i - 1];
+
+		if (i % nk == 0) {
+			t = (t << 8) | (t >> 24);
+			t = ((uint32_t)aes_sbox[t >> 24] << 24)
+			    | ((uint32_t)aes_sbox[(t >> 16) & 0xff] << 16)
+			    | ((uint32_t)aes_sbox[(t >> 8) & 0xff] << 8)
+			    | aes_sbox[t & 0xff];
+			t ^= (uint32_t)rcon[i / nk - 1] << 24;
+		} else if (nk > 6 && i % nk == 4) {
+			t = ((uint32_t)aes_sbox[t >> 24] << 24)
+			    | ((uint32_t)aes_sbox[(t >> 16) & 0xff] << 16)
+			    | ((uint32_t)aes_sbox[(t >> 8) & 0xff] << 8)
+			    | aes_sbox[t & 0xff];
+		}
+		k->rkw[i] = k->rkw[i - nk] ^ t;
+	}
+	for (i = 0; i < nw; i++) {
+		aes_gcm_put_be32(k->rk + 4 * i, k->rkw[i]);
+	}
+
+	/* H = E(K, 0^128).  */
+	memset(h, 0, sizeof(h));
+	aes_encrypt_block(k, h, h);
+
+	aes_gcm_setkey_c(k, h);
+#ifdef AES_GCM_X86
+	if (aes_gcm_use_ni()) {
+		aes_gcm_setkey_ni(k, h);
+	}
+#endif
+}
+
+/* Start a new message with a 96 bit IV.  */
+static inline void aes_gcm_start(struct aes_gcm_ctx *ctx,
+				 const struct aes_gcm_key *key,
+				 const uint8_t *iv, bool encrypt)
+{
+	ctx->key = key;
+	ctx->encrypt = encrypt;
+	ctx->in_text = false;
+	ctx->buf_len = 0;
+	ctx->aad_len = 0;
+	ctx->text_len = 0;
+	memset(ctx->x, 0, sizeof(ctx->x));
+
+	/* J0 = IV || 0^31 || 1, the text starts at J0 + 1.  */
+	memcpy(ctx->ctr, iv, AES_GCM_IV_SIZE);
+	aes_gcm_put_be32(ctx->ctr + 12, 1);
+	aes_encrypt_block(key, ctx->ctr, ctx->ekj0);
+	aes_gcm_inc32(ctx->ctr);
+}
+
+/* Additional authenticated data, must all come before the text.  */
+static inline void aes_gcm_aad(struct aes_gcm_ctx *ctx,
+			       const uint8_t *aad, size_t len)
+{
+	size_t n;
+
+	ctx->aad_len += len;
+
+	if (ctx->buf_len) {
+		n = 16 - ctx->buf_len < len ? 16 - ctx->buf_len : len;
+		memcpy(ctx->buf + ctx->buf_len, aad, n);
+		ctx->buf_len += n;
+		aad += n;
+		len -= n;
+		if (ctx->buf_len < 16) {
+			return;
+		}
+		aes_gcm_ghash(ctx, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+
+	n = len / 16;
+	if (n) {
+		aes_gcm_ghash(ctx, aad, n);
+		aad += n * 16;
+		len -= n * 16;
+	}
+
+	memcpy(ctx->buf, aad, len);
+	ctx->buf_len = len;
+}
+
+/*
+ * Encrypt (decrypt) len bytes of text from in to out, in and out may be
+ * the same buffer.
+ */
+static inline void aes_gcm_update(struct aes_gcm_ctx *ctx,
+				  const uint8_t *in, uint8_t *out,
+				  size_t len)
+{
+	size_t n;
+
+	if (!ctx->in_text) {
+		aes_gcm_ghash_flush(ctx);
+		ctx->in_text = true;
+	}
+	ctx->text_len += len;
+
+	/* Finish the partial block of the previous call.  */
+	while (len && ctx->buf_len) {
+		uint8_t c = *in++;
+		uint8_t o = c ^ ctx->ks[ctx->buf_len];
+
+		ctx->buf[ctx->buf_len++] = ctx->encrypt ? o : c;
+		*out++ = o;
+		len--;
+
+		if (ctx->buf_len == 16) {
+			aes_gcm_ghash(ctx, ctx->buf, 1);
+			ctx->buf_len = 0;
+		}
+	}
+
+	n = len / 16;
+	if (n) {
+#ifdef AES_GCM_X86
+		if (aes_gcm_use_ni()) {
+			aes_gcm_blocks_ni(ctx, in, out, n);
+		} else
+#endif
+		{
+			aes_gcm_blocks_c(ctx, in, out, n);
+		}
+		in += n * 16;
+		out += n * 16;
+		len -= n * 16;
+	}
+
+	if (len) {
+		aes_encrypt_block(ctx->key, ctx->ctr, ctx->ks);
+		aes_gcm_inc32(ctx->ctr);
+
+		for (n = 0; n < len; n++) {
+			uint8_t c = in[n];
+			uint8_t o = c ^ ctx->ks[n];
+
+			ctx->buf[n] = ctx->encrypt ? o : c;
+			out[n] = o;
+		}
+		ctx->buf_len = len;
+	}
+}
+
+static inline void aes_gcm_finish(struct aes_gcm_ctx *ctx, uint8_t *tag)
+{
+	uint8_t lens[16];
+
+	aes_gcm_ghash_flush(ctx);
+
+	aes_gcm_put_be64(lens, ctx->aad_len * 8);
+	aes_gcm_put_be64(lens + 8, ctx->text_len * 8);
+	aes_gcm_ghash(ctx, lens, 1);
+
+	for (int i = 0; i < AES_GCM_TAG_SIZE; i++) {
+		tag[i] = ctx->x[i] ^ ctx->ekj0[i];
+	}
+}
+
+#endif /* UTILS_AES_GCM_H__ */
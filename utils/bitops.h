@@ -62,6 +62,30 @@ static inline uint64_t bitops_mask64(unsigned int start, unsigned int len)
 	return v;
 }
 
+//
+// Byte enable helpers. A TLM byte enable array (TLM_BYTE_ENABLED 0xff,
+// TLM_BYTE_DISABLED 0x0) is represented with one bit per byte, bit n
+// corresponding to byte n. The conversions operate on 8 byte words
+// and assume a little endian host.
+//
+
+// Gathers the MSB of each byte in the 8 byte word into an 8 bit mask.
+static inline uint8_t bitops_be8_to_mask8(uint64_t be)
+{
+	be &= 0x8080808080808080ULL;
+	return (be * 0x0002040810204081ULL) >> 56;
+}
+
+// Expands an 8 bit mask into an 8 byte word of 0xff / 0x0 bytes.
+static inline uint64_t bitops_mask8_to_be8(uint8_t mask)
+{
+	uint64_t v = mask * 0x0101010101010101ULL;
+
+	v &= 0x8040201008040201ULL;
+	v = (v | (v + 0x7F7F7F7F7F7F7F7FULL)) & 0x8080808080808080ULL;
+	return (v >> 7) * 0xFF;
+}
+
 // Maps an sc_bv into a vector of booleans.
 template <int width>
 static void map_sc_bv2v(sc_vector<sc_signal<bool> > &v, const sc_bv<width> &s)
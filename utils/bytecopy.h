@@ -0,0 +1,280 @@
+/*
+ * Byte enable and streaming width aware copying of TLM data.
+ *
+ * Copyright (c) 2019 Xilinx Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *
+ * A byte is copied if its byte enable is TLM_BYTE_ENABLED (0xff), any other
+ * value leaves the destination byte untouched. The byte enables are a
+ * repeating pattern of be_len bytes as in the TLM generic payload.
+ *
+ * The blending is done with AVX2, SSE2 or NEON when the compiler targets
+ * them (e.g. -march=native) and 8 bytes at the time otherwise.
+ */
+
+#ifndef UTILS_BYTECOPY_H__
+#define UTILS_BYTECOPY_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+enum {
+	// Byte enable patterns shorter than this are expanded before copying
+	BYTECOPY_PATTERN_MIN = 64,
+};
+
+// Returns 0xff for the bytes equal to 0xff and 0x0 for the others.
+static inline uint64_t bytecopy_be8_to_mask(uint64_t be)
+{
+	uint64_t x = ~be;
+	uint64_t t;
+
+	t = ~(((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x);
+	t &= 0x8080808080808080ULL;
+
+	return (t >> 7) * 0xFF;
+}
+
+//
+// Copies n bytes where the byte enables (be, not repeating) are enabled.
+//
+static inline void bytecopy_blend(uint8_t *dst, const uint8_t *src,
+					const uint8_t *be, unsigned int n)
+{
+	unsigned int i = 0;
+
+#if defined(__AVX2__)
+	const __m256i ones = _mm256_set1_epi8(-1);
+
+	for (; (i + 32) <= n; i += 32) {
+		__m256i b = _mm256_loadu_si256((const __m256i *) (be + i));
+		__m256i m = _mm256_cmpeq_epi8(b, ones);
+		uint32_t bits = _mm256_movemask_epi8(m);
+		__m256i s, d;
+
+		if (bits == 0) {
+			continue;
+		}
+
+		s = _mm256_loadu_si256((const __m256i *) (src + i));
+		if (bits != 0xFFFFFFFF) {
+			d = _mm256_loadu_si256((const __m256i *) (dst + i));
+			s = _mm256_blendv_epi8(d, s, m);
+		}
+		_mm256_storeu_si256((__m256i *) (dst + i), s);
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i ones128 = _mm_set1_epi8(-1);
+
+	for (; (i + 16) <= n; i += 16) {
+		__m128i b = _mm_loadu_si128((const __m128i *) (be + i));
+		__m128i m = _mm_cmpeq_epi8(b, ones128);
+		uint32_t bits = _mm_movemask_epi8(m);
+		__m128i s, d;
+
+		if (bits == 0) {
+			continue;
+		}
+
+		s = _mm_loadu_si128((const __m128i *) (src + i));
+		if (bits != 0xFFFF) {
+			d = _mm_loadu_si128((const __m128i *) (dst + i));
+			s = _mm_or_si128(_mm_and_si128(m, s),
+					_mm_andnot_si128(m, d));
+		}
+		_mm_storeu_si128((__m128i *) (dst + i), s);
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for (; (i + 16) <= n; i += 16) {
+		uint8x16_t m = vceqq_u8(vld1q_u8(be + i), vdupq_n_u8(0xFF));
+		uint8x16_t s;
+
+		if (vmaxvq_u8(m) == 0) {
+			continue;
+		}
+
+		s = vld1q_u8(src + i);
+		if (vminvq_u8(m) == 0) {
+			s = vbslq_u8(m, s, vld1q_u8(dst + i));
+		}
+		vst1q_u8(dst + i, s);
+	}
+#endif
+
+	for (; (i + 8) <= n; i += 8) {
+		uint64_t b, m, s, d;
+
+		memcpy(&b, be + i, sizeof(b));
+		m = bytecopy_be8_to_mask(b);
+
+		if (m == 0) {
+			continue;
+		}
+
+		memcpy(&s, src + i, sizeof(s));
+		if (m != ~(uint64_t)0) {
+			memcpy(&d, dst + i, sizeof(d));
+			s = (d & ~m) | (s & m);
+		}
+		memcpy(dst + i, &s, sizeof(s));
+	}
+
+	for (; i < n; i++) {
+		if (be[i] == 0xFF) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+//
+// Copies len bytes from src to dst where enabled by the byte enables,
+// be_pos is the byte enable index of the first byte (the byte enables
+// wrap at be_len). Without byte enables everything is copied.
+//
+static inline void bytecopy_be(uint8_t *dst, const uint8_t *src,
+				unsigned int len, const uint8_t *be,
+				unsigned int be_len, unsigned int be_pos = 0)
+{
+	uint8_t pattern[BYTECOPY_PATTERN_MIN * 2];
+	unsigned int i = 0;
+
+	if (!be || !be_len) {
+		memcpy(dst, src, len);
+		return;
+	}
+
+	be_pos %= be_len;
+
+	//
+	// Short repeating patterns are expanded so that the blending can
+	// run over longer stretches.
+	//
+	if (be_len < BYTECOPY_PATTERN_MIN && len > (be_len - be_pos)) {
+		unsigned int period = 0;
+
+		do {
+			memcpy(pattern + period, be, be_len);
+			period += be_len;
+		} while (period < BYTECOPY_PATTERN_MIN);
+
+		be = pattern;
+		be_len = period;
+	}
+
+	while (i < len) {
+		unsigned int n = be_len - be_pos;
+
+		if (n > (len - i)) {
+			n = len - i;
+		}
+
+		bytecopy_blend(dst + i, src + i, be + be_pos, n);
+
+		i += n;
+		be_pos = 0;
+	}
+}
+
+//
+// Reads len bytes into dst from a streaming width sw wide window,
+// dst[i] = win[i % sw], where enabled by the byte enables. A sw of 0 (or
+// larger than len) means no streaming.
+//
+static inline void bytecopy_from_sw(uint8_t *dst, const uint8_t *win,
+				unsigned int len, unsigned int sw,
+				const uint8_t *be = NULL,
+				unsigned int be_len = 0)
+{
+	unsigned int i;
+
+	if (sw == 0 || sw > len) {
+		sw = len;
+	}
+
+	if (be && be_len) {
+		for (i = 0; i < len; i += sw) {
+			unsigned int n = (len - i) < sw ? (len - i) : sw;
+
+			bytecopy_be(dst + i, win, n, be, be_len, i);
+		}
+		return;
+	}
+
+	//
+	// Without byte enables the window is copied once and then
+	// replicated, doubling the copied length each round.
+	//
+	memcpy(dst, win, sw);
+	for (i = sw; i < len; ) {
+		unsigned int n = (len - i) < i ? (len - i) : i;
+
+		memcpy(dst + i, dst, n);
+		i += n;
+	}
+}
+
+//
+// Writes len bytes from src into a streaming width sw wide window,
+// win[i % sw] = src[i], where enabled by the byte enables. Later bytes
+// overwrite earlier ones as if written in order. A sw of 0 (or larger
+// than len) means no streaming.
+//
+static inline void bytecopy_to_sw(uint8_t *win, const uint8_t *src,
+				unsigned int len, unsigned int sw,
+				const uint8_t *be = NULL,
+				unsigned int be_len = 0)
+{
+	const uint8_t *last;
+	unsigned int rem;
+	unsigned int i;
+
+	if (sw == 0 || sw > len) {
+		sw = len;
+	}
+
+	if (be && be_len) {
+		for (i = 0; i < len; i += sw) {
+			unsigned int n = (len - i) < sw ? (len - i) : sw;
+
+			bytecopy_be(win, src + i, n, be, be_len, i);
+		}
+		return;
+	}
+
+	//
+	// Only the last sw bytes remain in the window, rotated by
+	// len % sw.
+	//
+	last = src + len - sw;
+	rem = len % sw;
+
+	memcpy(win + rem, last, sw - rem);
+	memcpy(win, last + sw - rem, rem);
+}
+
+#endif
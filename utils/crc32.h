@@ -21,8 +21,32 @@
  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
+ *
+ *
+ * The CRC is computed 8 bytes at the time with the slicing-by-8 tables
+ * (built on first use from crc32_table).  On x86 the PCLMULQDQ instruction
+ * is used to fold 64 bytes at the time when the CPU supports it (checked
+ * at runtime), on AArch64 the CRC32 instructions are used when the
+ * compiler targets them.
+ *
+ * crc32() continues from a finished CRC (0 to start), a crc32_ctx can be
+ * used to feed a frame in several chunks instead.
  */
 
+#ifndef UTILS_CRC32_H__
+#define UTILS_CRC32_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 static const uint32_t crc32_table[] = {
     0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
     0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
@@ -69,16 +93,202 @@ static const uint32_t crc32_table[] = {
     0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 };
 
+/* Slicing-by-8 tables, crc32_table being the first one.  */
+static inline const uint32_t (*crc32_sb8_tables(void))[256]
+{
+	static uint32_t t[8][256];
+	static bool done = false;
+
+	if (!done) {
+		for (int i = 0; i < 256; i++) {
+			t[0][i] = crc32_table[i];
+		}
+		for (int k = 1; k < 8; k++) {
+			for (int i = 0; i < 256; i++) {
+				uint32_t c = t[k - 1][i];
+
+				t[k][i] = (c >> 8) ^ t[0][c & 0xFF];
+			}
+		}
+		done = true;
+	}
+	return t;
+}
+
+/* Update the (inverted) CRC state with the bytes, one at the time.  */
+static inline uint32_t crc32_bytewise(uint32_t crc, const unsigned char *buf,
+				      size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		crc = crc32_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+static inline uint32_t crc32_sb8(uint32_t crc, const unsigned char *buf,
+				 size_t len)
+{
+#if defined(__ARM_FEATURE_CRC32)
+	for (; len >= 8; buf += 8, len -= 8) {
+		uint64_t v;
+
+		memcpy(&v, buf, sizeof(v));
+		crc = __crc32d(crc, v);
+	}
+	for (; len; buf++, len--) {
+		crc = __crc32b(crc, *buf);
+	}
+	return crc;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	const uint32_t (*t)[256];
+
+	if (len < 16) {
+		return crc32_bytewise(crc, buf, len);
+	}
+
+	t = crc32_sb8_tables();
+	for (; len >= 8; buf += 8, len -= 8) {
+		uint32_t lo, hi;
+
+		memcpy(&lo, buf, sizeof(lo));
+		memcpy(&hi, buf + 4, sizeof(hi));
+		lo ^= crc;
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF]
+		      ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+		      ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF]
+		      ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+	}
+	return crc32_bytewise(crc, buf, len);
+#else
+	return crc32_bytewise(crc, buf, len);
+#endif
+}
+
+#ifdef CRC32_X86
+#define CRC32_CLMUL __attribute__((target("pclmul,sse2")))
+
+static inline bool crc32_use_clmul(void)
+{
+	static int use_clmul = -1;
+
+	if (use_clmul < 0) {
+		__builtin_cpu_init();
+		use_clmul = __builtin_cpu_supports("pclmul");
+	}
+	return use_clmul;
+}
+
+/* x = x[127:64] * k[127:64] ^ x[63:0] * k[63:0] ^ next.  */
+CRC32_CLMUL static inline __m128i crc32_fold_clmul(__m128i x, __m128i k,
+						   __m128i next)
+{
+	__m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+	__m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+
+	return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+/*
+ * Fold len bytes (at least 64, a multiple of 16) into the (inverted) CRC
+ * state, 4 x 128 bits in parallel, then reduce to 32 bits with a Barrett
+ * reduction.  The constants are x^n mod P for the bit reflected
+ * polynomial, see "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction" (Intel).
+ */
+CRC32_CLMUL static inline uint32_t crc32_clmul(uint32_t crc,
+					       const unsigned char *buf,
+					       size_t len)
+{
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596ULL, 0x0154442bd4ULL);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eULL, 0x01751997d0ULL);
+	const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124ULL);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641ULL, 0x01db710641ULL);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+	const __m128i *p = (const __m128i *)buf;
+	__m128i x0, x1, x2, x3;
+
+	x0 = _mm_xor_si128(_mm_loadu_si128(p),
+			   _mm_cvtsi32_si128(crc));
+	x1 = _mm_loadu_si128(p + 1);
+	x2 = _mm_loadu_si128(p + 2);
+	x3 = _mm_loadu_si128(p + 3);
+	p += 4;
+	len -= 64;
+
+	for (; len >= 64; p += 4, len -= 64) {
+		x0 = crc32_fold_clmul(x0, k1k2, _mm_loadu_si128(p));
+		x1 = crc32_fold_clmul(x1, k1k2, _mm_loadu_si128(p + 1));
+		x2 = crc32_fold_clmul(x2, k1k2, _mm_loadu_si128(p + 2));
+		x3 = crc32_fold_clmul(x3, k1k2, _mm_loadu_si128(p + 3));
+	}
+
+	/* Down to 128 bits.  */
+	x0 = crc32_fold_clmul(x0, k3k4, x1);
+	x0 = crc32_fold_clmul(x0, k3k4, x2);
+	x0 = crc32_fold_clmul(x0, k3k4, x3);
+	for (; len >= 16; p++, len -= 16) {
+		x0 = crc32_fold_clmul(x0, k3k4, _mm_loadu_si128(p));
+	}
+
+	/* 128 to 64 bits.  */
+	x1 = _mm_clmulepi64_si128(x0, k3k4, 0x10);
+	x0 = _mm_xor_si128(_mm_srli_si128(x0, 8), x1);
+	x1 = _mm_srli_si128(x0, 4);
+	x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k5, 0x00);
+	x0 = _mm_xor_si128(x0, x1);
+
+	/* Barrett reduction to 32 bits.  */
+	x1 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), poly, 0x10);
+	x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x00);
+	x0 = _mm_xor_si128(x0, x1);
+
+	return _mm_cvtsi128_si32(_mm_srli_si128(x0, 4));
+}
+#endif
+
+/* Update the (inverted) CRC state with the bytes.  */
+static inline uint32_t crc32_raw(uint32_t crc, const unsigned char *buf,
+				 size_t len)
+{
+#ifdef CRC32_X86
+	if (len >= 64 && crc32_use_clmul()) {
+		size_t n = len & ~(size_t)15;
+
+		crc = crc32_clmul(crc, buf, n);
+		buf += n;
+		len -= n;
+	}
+#endif
+	return crc32_sb8(crc, buf, len);
+}
+
 static inline uint32_t crc32(uint32_t crc, const unsigned char *buf, int len)
 {
-	int i;
+	if (len <= 0) {
+		return crc;
+	}
+	return crc32_raw(crc ^ UINT32_MAX, buf, len) ^ UINT32_MAX;
+}
 
-	crc = crc ^ UINT32_MAX;
+/* Incremental CRC32 of a frame fed in several chunks.  */
+struct crc32_ctx {
+	uint32_t crc;
+};
 
-	for (i = 0; i < len; i++) {
-		unsigned char c = buf[i];
-		crc = crc32_table[(crc ^ c) & 0xFF] ^ (crc >> 8);
-        }
+static inline void crc32_init(struct crc32_ctx *ctx)
+{
+	ctx->crc = UINT32_MAX;
+}
+
+static inline void crc32_update(struct crc32_ctx *ctx,
+				const unsigned char *buf, size_t len)
+{
+	ctx->crc = crc32_raw(ctx->crc, buf, len);
+}
 
-	return crc ^ UINT32_MAX;
+static inline uint32_t crc32_final(const struct crc32_ctx *ctx)
+{
+	return ctx->crc ^ UINT32_MAX;
 }
+
+#endif